@@ -7,6 +7,7 @@
 
 #include <string>
 #include <iostream>
+#include <filesystem>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -16,6 +17,12 @@
 #include <imgui/imgui_impl_opengl3.h>
 
 #include "sources/application.h"
+#include "sources/offline_renderer.h"
+#include "sources/graphics/gpu_profiler.h"
+#include "sources/graphics/program_cache.h"
+#include "sources/scenes/scene_converter.h"
+#include "sources/tracing/sphere_kernel_benchmark.h"
+#include "sources/utils/arguments.h"
 #include "sources/utils/debug.h"
 
 // Global variables.
@@ -62,8 +69,46 @@ static void showFramesPerSecond(GLFWwindow* window)
 	}
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	Arguments arguments(argc, argv);
+
+	// Compiled shaders are reused across launches unless asked otherwise (e.g. to measure cold starts).
+	if (arguments.has("--no-program-cache"))
+	{
+		ProgramCache::setDirectory("");
+	}
+
+	// Micro-benchmark of the CPU intersection kernels.
+	if (arguments.has("--kernel-benchmark"))
+	{
+		return SphereKernelBenchmark(arguments.getInt("--spheres", 1024), arguments.getInt("--rays", 200000)).run();
+	}
+
+	// Writes the scene file of a JSON description, next to it unless "--output" is given.
+	if (arguments.has("--convert-scene"))
+	{
+		std::string descriptionPath = arguments.getString("--convert-scene", "");
+		std::string scenePath = arguments.getString("--output", std::filesystem::path(descriptionPath).replace_extension(".rtscene").string());
+
+		return SceneConverter::convert(descriptionPath, scenePath) ? 0 : -1;
+	}
+
+	// Offline mode, renders to an image (or a benchmark, convergence or ReSTIR report) without opening a window.
+	if (arguments.has("--headless") || arguments.has("--benchmark") || arguments.has("--convergence") || arguments.has("--restir-comparison"))
+	{
+		OfflineRenderSettings settings;
+
+		if (arguments.has("--help") || !OfflineRenderSettings::fromArguments(arguments, settings))
+		{
+			OfflineRenderSettings::printUsage();
+
+			return arguments.has("--help") ? 0 : -1;
+		}
+
+		return OfflineRenderer(settings).run();
+	}
+
 	if (!glfwInit())
 	{
 		std::cout << "Failed to initialize GLFW!" << std::endl;
@@ -147,8 +192,19 @@ int main()
 	ImGui_ImplGlfw_InitForOpenGL(window, true); // Second param will install GLFW callbacks and chain to existing ones.
 	ImGui_ImplOpenGL3_Init();
 
+	if (arguments.has("--scene-file"))
+	{
+		app.setSceneFile(arguments.getString("--scene-file", ""));
+	}
+
 	app.setup();
 
+	// Per frame GPU timings of every pass, written on exit.
+	if (arguments.has("--profile-csv"))
+	{
+		GpuProfiler::startCapture(arguments.getString("--profile-csv", "gpu_profile.csv"));
+	}
+
 	while (!glfwWindowShouldClose(window))
 	{
 		float currTime = float(glfwGetTime());
@@ -162,10 +218,15 @@ int main()
 
 		app.update(DELTA_TIME);
 		app.processInput(DELTA_TIME);
+
+		GpuProfiler::beginFrame();
+
 		app.render(DELTA_TIME);
 
 		app.processGUI(io);
 
+		GpuProfiler::endFrame();
+
 		glfwSwapBuffers(window);
 	}
 
@@ -4,31 +4,34 @@ Application::Application(int screenWidth, int screenHeight)
 	: screenWidth(screenWidth), screenHeight(screenHeight),
 	  keyboardState(), keyboardProcessedState(), mouseState(), mouseProcessedState(), cursorAttached(false), cursorTracked(true), lastMousePosition(), currMousePosition(),
 	  camera(glm::vec3(0.0f, 4.0f, 4.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), { float(screenWidth) / float(screenHeight) }),
-	  lastSceneType(SceneTypes::SPHERES), currSceneType(SceneTypes::SPHERES), currScene(nullptr)
+	  lastSceneType(SceneTypes::SPHERES), currSceneType(SceneTypes::SPHERES), currScene(nullptr), scenePath(), scenePathInput(), reloadScene(false), shaderReloader(),
+	  sceneSetupTime(0.0f), sceneSetupStatistics(), recordedCameraPath(), recordingCameraPath(false), cameraPathTime(0.0f), nextCameraKeyframeTime(0.0f),
+	  qualityGovernor(), governQuality(false), manualSettings()
 {
 }
 
 void Application::setup()
 {
-	switch (currSceneType)
-	{
-	case SceneTypes::SPHERES:
-		currScene = new SpheresScene();
-		break;
+	shaderReloader.setup();
 
-	default:
-		std::cout << "Scene not found!" << std::endl;
-		break;
-	}
+	GpuProfiler::setup();
 
-	if (currScene != nullptr)
-	{
-		currScene->setup();
-	}
+	setupScene();
 }
 
 void Application::clean()
 {
+	shaderReloader.clean();
+
+	// A capture still running is written with every frame in flight.
+	if (GpuProfiler::isCapturing())
+	{
+		GpuProfiler::finish();
+		GpuProfiler::stopCapture();
+	}
+
+	GpuProfiler::clean();
+
 	if (currScene != nullptr)
 	{
 		currScene->clean();
@@ -41,28 +44,139 @@ void Application::update(float deltaTime)
 {
 	if (currScene != nullptr)
 	{
-		if (lastSceneType != currSceneType)
+		if (lastSceneType != currSceneType || reloadScene)
 		{
+			shaderReloader.clear();
+
 			currScene->clean();
 
-			switch (currSceneType)
+			delete currScene;
+
+			setupScene();
+
+			// Limits come from the settings of the new scene.
+			if (governQuality)
 			{
-			case SceneTypes::SPHERES:
-				currScene = new SpheresScene();
-				break;
+				startGoverningQuality();
+			}
+		}
 
-			default:
-				std::cout << "Scene not found!" << std::endl;
-				break;
+		// Compiles in the background (see "ShaderReloader"), swapped programs are used from this frame on.
+		if (shaderReloader.update())
+		{
+			currScene->onShadersReloaded();
+		}
+
+		currScene->update(deltaTime);
+
+		if (governQuality)
+		{
+			uint64_t measuredFrame = 0;
+			float frameTime = GpuProfiler::getLatestTime("Frame", &measuredFrame);
+
+			if (qualityGovernor.update(frameTime, measuredFrame, GpuProfiler::getFrameNumber()))
+			{
+				applyQualityLevel();
 			}
+		}
+	}
 
-			currScene->setup();
+	if (recordingCameraPath)
+	{
+		if (cameraPathTime >= nextCameraKeyframeTime)
+		{
+			recordedCameraPath.addKeyframe({ cameraPathTime, camera.getPosition(), camera.getYaw(), camera.getPitch() });
 
-			lastSceneType = currSceneType;
+			nextCameraKeyframeTime += CAMERA_PATH_INTERVAL;
 		}
 
-		currScene->update(deltaTime);
+		cameraPathTime += deltaTime;
+	}
+}
+
+void Application::setupScene()
+{
+	std::chrono::high_resolution_clock::time_point setupStart = std::chrono::high_resolution_clock::now();
+
+	ProgramCache::resetStatistics();
+
+	currScene = Scene::create(currSceneType, screenWidth, screenHeight, scenePath);
+
+	if (currScene == nullptr && currSceneType == SceneTypes::SCENE_FILE)
+	{
+		currSceneType = SceneTypes::SPHERES;
+		currScene = Scene::create(currSceneType, screenWidth, screenHeight);
+	}
+
+	lastSceneType = currSceneType;
+	reloadScene = false;
+
+	if (currScene != nullptr)
+	{
+		currScene->setup();
+		currScene->watchShaders(shaderReloader);
 	}
+
+	// Shader compilation and uploads may still be queued.
+	glFinish();
+
+	sceneSetupTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - setupStart).count();
+	sceneSetupStatistics = ProgramCache::getStatistics();
+
+	ProgramCache::printStatistics("Scene setup", sceneSetupTime);
+}
+
+void Application::startGoverningQuality()
+{
+	if (currScene == nullptr)
+	{
+		return;
+	}
+
+	manualSettings = currScene->getRenderSettings();
+
+	QualityLevel maximum = { manualSettings.resolutionScale, manualSettings.samplesPerPixel, manualSettings.maxBounces };
+	QualityLevel minimum = { 0.25f, 1, 4 };
+
+	qualityGovernor.setLimits(maximum, minimum);
+
+	applyQualityLevel();
+}
+
+void Application::stopGoverningQuality()
+{
+	if (currScene == nullptr)
+	{
+		return;
+	}
+
+	// Only gives back what the governor owns, the rest may have been changed in the scene's dialog meanwhile.
+	RenderSettings settings = currScene->getRenderSettings();
+
+	settings.resolutionScale = manualSettings.resolutionScale;
+	settings.samplesPerPixel = manualSettings.samplesPerPixel;
+	settings.maxBounces = manualSettings.maxBounces;
+	settings.gpuTimeBudget = manualSettings.gpuTimeBudget;
+	settings.dynamicBounces = manualSettings.dynamicBounces;
+
+	currScene->setRenderSettings(settings);
+}
+
+void Application::applyQualityLevel()
+{
+	// Settings the governor doesn't own may have changed in the scene's dialog since it started.
+	RenderSettings settings = currScene->getRenderSettings();
+	const QualityLevel& level = qualityGovernor.getLevel();
+
+	settings.resolutionScale = level.resolutionScale;
+	settings.samplesPerPixel = level.samplesPerPixel;
+	settings.maxBounces = level.maxBounces;
+	settings.gpuTimeBudget = 0.0f;
+
+	// Every bounce step would otherwise compile its own variant, stalling the very frame time being held.
+	settings.dynamicBounces = true;
+
+	currScene->setRenderSettings(settings);
 }
 
 void Application::processInput(float deltaTime)
@@ -131,12 +245,100 @@ void Application::processGUI(const ImGuiIO& io)
 				currSceneType = SceneTypes::SPHERES;
 			}
 
+			if (ImGui::MenuItem("Spheres (Wavefront)", "2", currSceneType == SceneTypes::SPHERES_WAVEFRONT))
+			{
+				currSceneType = SceneTypes::SPHERES_WAVEFRONT;
+			}
+
+			if (ImGui::MenuItem("Scene File", "3", currSceneType == SceneTypes::SCENE_FILE, !scenePath.empty()))
+			{
+				currSceneType = SceneTypes::SCENE_FILE;
+			}
+
 			ImGui::EndMenu();
 		}
 
 		ImGui::EndMenuBar();
 	}
 
+	ImGui::Text("Scene setup: %.1f ms (%d programs cached, %d compiled)", sceneSetupTime, sceneSetupStatistics.hits, sceneSetupStatistics.misses);
+
+	if (ImGui::CollapsingHeader("Scene File"))
+	{
+		ImGui::InputText("Path", scenePathInput, sizeof(scenePathInput));
+
+		if (ImGui::Button("Load Scene"))
+		{
+			setSceneFile(scenePathInput);
+		}
+	}
+
+	if (ImGui::CollapsingHeader("GPU Profiler"))
+	{
+		GpuProfiler::processGUI();
+	}
+
+	if (ImGui::CollapsingHeader("Camera Path"))
+	{
+		if (!recordingCameraPath)
+		{
+			if (ImGui::Button("Record"))
+			{
+				recordedCameraPath.clear();
+				recordingCameraPath = true;
+				cameraPathTime = 0.0f;
+				nextCameraKeyframeTime = 0.0f;
+			}
+		}
+		else if (ImGui::Button("Stop"))
+		{
+			recordingCameraPath = false;
+
+			// Closes the path on the camera it was stopped at.
+			recordedCameraPath.addKeyframe({ cameraPathTime, camera.getPosition(), camera.getYaw(), camera.getPitch() });
+
+			recordedCameraPath.save(CAMERA_PATH_FILEPATH);
+		}
+
+		ImGui::SameLine();
+		ImGui::Text("%d keyframes, %.1f s", int(recordedCameraPath.getKeyframes().size()), recordedCameraPath.getDuration());
+		ImGui::TextWrapped("Saved to \"%s\", replay with \"--benchmark --camera-path %s\".", CAMERA_PATH_FILEPATH, CAMERA_PATH_FILEPATH);
+	}
+
+	if (ImGui::CollapsingHeader("Quality Governor"))
+	{
+		if (ImGui::Checkbox("Hold Frame Time", &governQuality))
+		{
+			if (governQuality)
+			{
+				startGoverningQuality();
+			}
+			else
+			{
+				stopGoverningQuality();
+			}
+		}
+
+		float targetFrameTime = qualityGovernor.getTargetFrameTime();
+
+		if (ImGui::DragFloat("Target (ms)", &targetFrameTime, 0.1f, 1.0f, 1000.0f, "%.1f"))
+		{
+			qualityGovernor.setTargetFrameTime(targetFrameTime);
+		}
+
+		if (governQuality)
+		{
+			const QualityLevel& level = qualityGovernor.getLevel();
+			const QualityLevel& maximum = qualityGovernor.getMaximumLevel();
+
+			ImGui::Text("Resolution Scale: %.2f (of %.2f)", level.resolutionScale, maximum.resolutionScale);
+			ImGui::Text("Samples Per Pixel: %d (of %d)", level.samplesPerPixel, maximum.samplesPerPixel);
+			ImGui::Text("Max Bounces: %d (of %d)", level.maxBounces, maximum.maxBounces);
+			ImGui::Text("Frame Time: %.2f ms", qualityGovernor.getAverageFrameTime());
+			ImGui::TextWrapped("Samples, bounces and resolution scale set in the scene's dialog are overridden until governing stops.");
+		}
+	}
+
 	ImGui::Text("Mouse to rotare the camera.");
 	ImGui::Text("W/S/A/D and Q/E to move.");
 	ImGui::Text("LEFT CTRL to unlock/lock the cursor.");
@@ -149,7 +351,10 @@ void Application::processGUI(const ImGuiIO& io)
 	}
 
 	ImGui::Render();
+
+	GpuProfiler::beginScope("ImGui");
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	GpuProfiler::endScope();
 }
 
 void Application::setScreenDimensions(int width, int height)
@@ -162,6 +367,11 @@ void Application::setScreenDimensions(int width, int height)
 	projProps.aspectRatio = float(screenWidth) / float(screenHeight);
 
 	camera.updateProjextionMatrix(projProps);
+
+	if (currScene != nullptr)
+	{
+		currScene->setScreenDimensions(screenWidth, screenHeight);
+	}
 }
 
 void Application::setKeyboardState(int index, bool keyPressed)
@@ -183,3 +393,13 @@ void Application::setMousePosition(float x, float y)
 		lastMousePosition = glm::vec2(x, y);
 	}
 }
+
+void Application::setSceneFile(const std::string& path)
+{
+	scenePath = path;
+
+	std::snprintf(scenePathInput, sizeof(scenePathInput), "%s", path.c_str());
+
+	currSceneType = SceneTypes::SCENE_FILE;
+	reloadScene = true;
+}
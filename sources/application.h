@@ -1,6 +1,9 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <string>
+#include <cstdio>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,9 +13,16 @@
 #include <imgui/imgui_impl_opengl3.h>
 
 #include "camera.h"
+#include "camera_path.h"
+#include "quality_governor.h"
 #include "scene.h"
 
+#include "graphics/gpu_profiler.h"
+#include "graphics/program_cache.h"
+#include "graphics/shader_reloader.h"
+
 #include "scenes/spheres_scene.h"
+#include "scenes/wavefront_scene.h"
 
 class Application
 {
@@ -35,6 +45,9 @@ public:
 
 	void setMousePosition(float x, float y);
 
+	// Switches to the scene of "path" (see "FileScene") on the next update, or on "setup" when called before it.
+	void setSceneFile(const std::string& path);
+
 private:
 	int screenWidth, screenHeight;
 
@@ -50,4 +63,38 @@ private:
 
 	SceneTypes lastSceneType, currSceneType;
 	Scene* currScene;
+
+	// File of "SceneTypes::SCENE_FILE", loading one restarts the scene even when it already is a file scene. A file
+	// that fails to load leaves the spheres scene.
+	std::string scenePath;
+	char scenePathInput[256];
+	bool reloadScene;
+
+	// Programs of the current scene are recompiled when their sources are edited.
+	ShaderReloader shaderReloader;
+
+	// Of the last scene creation (startup or switch), shown in the debug dialog.
+	float sceneSetupTime;
+	ProgramCacheStatistics sceneSetupStatistics;
+
+	// Camera motion recorded for "--benchmark --camera-path", one keyframe every "CAMERA_PATH_INTERVAL" seconds.
+	static constexpr float CAMERA_PATH_INTERVAL = 0.1f;
+	static constexpr const char* CAMERA_PATH_FILEPATH = "camera_path.txt";
+
+	CameraPath recordedCameraPath;
+	bool recordingCameraPath;
+	float cameraPathTime, nextCameraKeyframeTime;
+
+	// Holds a GPU frame time (the profiler's "Frame" scope) by lowering the scene's samples, bounces and resolution
+	// below "manualSettings", the settings it had when governing started (those it owns come back when it stops).
+	// Time slicing is off while governed, it would hide the cost of a level by spreading it over frames.
+	QualityGovernor qualityGovernor;
+	bool governQuality;
+	RenderSettings manualSettings;
+
+	void setupScene();
+
+	void startGoverningQuality();
+	void stopGoverningQuality();
+	void applyQualityLevel();
 };
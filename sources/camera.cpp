@@ -67,6 +67,16 @@ ProjectionProperties Camera::getProjectionProperties() const
 	return projectionProperties;
 }
 
+float Camera::getPitch() const
+{
+	return pitch;
+}
+
+float Camera::getYaw() const
+{
+	return yaw;
+}
+
 void Camera::processTranslation(TDirection translationDirection, float deltaTime)
 {
 	switch (translationDirection)
@@ -34,6 +34,10 @@ public:
 	const glm::vec3& getUp() const;
 	ProjectionProperties getProjectionProperties() const;
 
+	// Euler angles in degrees.
+	float getPitch() const;
+	float getYaw() const;
+
 	void processTranslation(TDirection translationDirection, float deltaTime);
 	void processRotation(float xOffset, float yOffset, float deltaTime);
 
@@ -0,0 +1,177 @@
+#include "camera_path.h"
+
+CameraPath::CameraPath() : keyframes()
+{
+}
+
+bool CameraPath::load(const std::string& filepath)
+{
+	std::ifstream fileStream(filepath);
+
+	if (!fileStream)
+	{
+		std::cout << "[ERROR] CAMERA PATH: Failed to read \"" << filepath << "\"." << std::endl;
+
+		return false;
+	}
+
+	keyframes.clear();
+
+	std::string line;
+	int lineNumber = 0;
+
+	while (std::getline(fileStream, line))
+	{
+		lineNumber += 1;
+
+		std::string content = line.substr(0, line.find('#'));
+
+		if (content.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+
+		std::istringstream lineStream(content);
+		CameraKeyframe keyframe;
+
+		if (!(lineStream >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.yaw >> keyframe.pitch))
+		{
+			std::cout << "[ERROR] CAMERA PATH: Malformed keyframe at \"" << filepath << "\" line " << lineNumber << "." << std::endl;
+
+			return false;
+		}
+
+		if (!keyframes.empty() && keyframe.time < keyframes.back().time)
+		{
+			std::cout << "[ERROR] CAMERA PATH: Keyframes of \"" << filepath << "\" aren't in time order (line " << lineNumber << ")." << std::endl;
+
+			return false;
+		}
+
+		keyframes.push_back(keyframe);
+	}
+
+	if (keyframes.empty())
+	{
+		std::cout << "[ERROR] CAMERA PATH: \"" << filepath << "\" has no keyframes." << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+bool CameraPath::save(const std::string& filepath) const
+{
+	std::ofstream fileStream(filepath);
+
+	if (!fileStream)
+	{
+		std::cout << "[ERROR] CAMERA PATH: Failed to write \"" << filepath << "\"." << std::endl;
+
+		return false;
+	}
+
+	fileStream << "# time x y z yaw pitch\n";
+
+	for (const CameraKeyframe& keyframe : keyframes)
+	{
+		fileStream << keyframe.time << " " << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << " " << keyframe.yaw << " " << keyframe.pitch << "\n";
+	}
+
+	return true;
+}
+
+void CameraPath::addKeyframe(const CameraKeyframe& keyframe)
+{
+	keyframes.push_back(keyframe);
+}
+
+void CameraPath::clear()
+{
+	keyframes.clear();
+}
+
+bool CameraPath::isEmpty() const
+{
+	return keyframes.empty();
+}
+
+float CameraPath::getDuration() const
+{
+	return keyframes.empty() ? 0.0f : keyframes.back().time - keyframes.front().time;
+}
+
+const std::vector<CameraKeyframe>& CameraPath::getKeyframes() const
+{
+	return keyframes;
+}
+
+CameraKeyframe CameraPath::sample(float time) const
+{
+	if (keyframes.size() < 2 || time <= keyframes.front().time)
+	{
+		return keyframes.empty() ? CameraKeyframe{ 0.0f, glm::vec3(0.0f), -90.0f, 0.0f } : keyframes.front();
+	}
+
+	if (time >= keyframes.back().time)
+	{
+		return keyframes.back();
+	}
+
+	// Segment [i, i + 1] holding "time".
+	size_t i = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](float t, const CameraKeyframe& keyframe) { return t < keyframe.time; }) - keyframes.begin() - 1;
+
+	const CameraKeyframe& k1 = keyframes[i];
+	const CameraKeyframe& k2 = keyframes[i + 1];
+
+	// The ends repeat themselves as outer control points.
+	const CameraKeyframe& k0 = keyframes[i > 0 ? i - 1 : i];
+	const CameraKeyframe& k3 = keyframes[std::min(i + 2, keyframes.size() - 1)];
+
+	float segmentLength = k2.time - k1.time;
+	float t = segmentLength > 0.0f ? (time - k1.time) / segmentLength : 0.0f;
+	float t2 = t * t;
+	float t3 = t2 * t;
+
+	CameraKeyframe result;
+
+	result.time = time;
+	result.position = 0.5f * ((2.0f * k1.position) + (-k0.position + k2.position) * t + (2.0f * k0.position - 5.0f * k1.position + 4.0f * k2.position - k3.position) * t2 + (-k0.position + 3.0f * k1.position - 3.0f * k2.position + k3.position) * t3);
+	result.yaw = k1.yaw + (k2.yaw - k1.yaw) * t;
+	result.pitch = k1.pitch + (k2.pitch - k1.pitch) * t;
+
+	return result;
+}
+
+Camera CameraPath::createCamera(float time, float aspectRatio) const
+{
+	CameraKeyframe keyframe = sample(time);
+
+	Camera camera(keyframe.position, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), { aspectRatio }, keyframe.pitch, keyframe.yaw);
+
+	camera.processRotation(0.0f, 0.0f, 0.0f); // Derives the direction from the Euler angles.
+
+	return camera;
+}
+
+CameraPath CameraPath::createOrbit(const glm::vec3& center, float radius, float height, float duration, int numberOfKeyframes)
+{
+	CameraPath path;
+
+	for (int i = 0; i <= numberOfKeyframes; i++)
+	{
+		float angle = 2.0f * glm::pi<float>() * float(i) / float(numberOfKeyframes);
+
+		glm::vec3 position = center + glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle));
+		glm::vec3 direction = glm::normalize(center - position);
+
+		// Yaw keeps growing with the angle instead of wrapping, so the interpolation turns the short way.
+		float yaw = glm::degrees(angle) + 180.0f;
+		float pitch = glm::degrees(std::asin(direction.y));
+
+		path.addKeyframe({ duration * float(i) / float(numberOfKeyframes), position, yaw, pitch });
+	}
+
+	return path;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "camera.h"
+
+struct CameraKeyframe
+{
+	float time; // Seconds from the start of the path.
+
+	glm::vec3 position;
+	float yaw, pitch; // Degrees, as in "Camera".
+};
+
+// Camera motion that can be replayed exactly, e.g. by the benchmark mode.
+//
+// Paths are keyframed by hand or recorded from the interactive camera, and stored as text with one
+// "time x y z yaw pitch" keyframe per line ("#" starts a comment). Positions follow a Catmull-Rom spline through the
+// keyframes, angles are interpolated linearly (recorded yaws aren't wrapped, so they never jump by 360 degrees).
+//
+class CameraPath
+{
+public:
+	CameraPath();
+
+	bool load(const std::string& filepath);
+	bool save(const std::string& filepath) const;
+
+	// Keyframes must be added in time order.
+	void addKeyframe(const CameraKeyframe& keyframe);
+	void clear();
+
+	bool isEmpty() const;
+	float getDuration() const;
+
+	const std::vector<CameraKeyframe>& getKeyframes() const;
+
+	// Clamped to the ends of the path.
+	CameraKeyframe sample(float time) const;
+	Camera createCamera(float time, float aspectRatio) const;
+
+	// A full turn around "center" looking at it, the default benchmark path.
+	static CameraPath createOrbit(const glm::vec3& center, float radius, float height, float duration, int numberOfKeyframes = 16);
+
+private:
+	std::vector<CameraKeyframe> keyframes;
+};
@@ -100,3 +100,123 @@ void IBO::clean()
 {
 	glDeleteBuffers(1, &ID);
 }
+
+SSBO::SSBO(const void* data, int size, GLenum usage) : ID(), capacity(size), usage(usage)
+{
+	glGenBuffers(1, &ID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, usage);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void SSBO::bind()
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+}
+
+void SSBO::unbind()
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void SSBO::bindBase(uint32_t index)
+{
+	// Attaches the whole buffer to the "layout(std430, binding = index)" block of the shaders.
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, ID);
+}
+
+void SSBO::bindIndirect()
+{
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, ID);
+}
+
+void SSBO::update(const void* data, int size)
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+
+	// Only reallocate the storage when the new data doesn't fit, otherwise it is a single copy.
+	if (size > capacity)
+	{
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, usage);
+
+		capacity = size;
+	}
+	else
+	{
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void SSBO::copyTo(SSBO& destination, int readOffset, int writeOffset, int size)
+{
+	// Stays on the GPU, no synchronization with the host.
+	glBindBuffer(GL_COPY_READ_BUFFER, ID);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, destination.ID);
+
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset, writeOffset, size);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void SSBO::read(void* data, int offset, int size)
+{
+	// Waits for the commands writing the range, read ranges the GPU is known to be done with.
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void SSBO::clean()
+{
+	glDeleteBuffers(1, &ID);
+}
+
+UBO::UBO(const void* data, int size, GLenum usage) : ID(), capacity(size), usage(usage)
+{
+	glGenBuffers(1, &ID);
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+	glBufferData(GL_UNIFORM_BUFFER, size, data, usage);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::bind()
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+}
+
+void UBO::unbind()
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::bindBase(uint32_t index)
+{
+	// Attaches the whole buffer to the uniform blocks bound to "index" (see "ShaderProgram::setUniformBlockBinding").
+	glBindBufferBase(GL_UNIFORM_BUFFER, index, ID);
+}
+
+void UBO::update(const void* data, int size)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+
+	if (size > capacity)
+	{
+		glBufferData(GL_UNIFORM_BUFFER, size, data, usage);
+
+		capacity = size;
+	}
+	else
+	{
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::clean()
+{
+	glDeleteBuffers(1, &ID);
+}
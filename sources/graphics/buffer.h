@@ -53,3 +53,51 @@ public:
 private:
 	uint32_t ID;
 };
+
+class SSBO
+{
+public:
+	SSBO(const void* data, int size, GLenum usage = GL_STATIC_DRAW);
+
+	void bind();
+	void unbind();
+
+	void bindBase(uint32_t index);
+
+	// Source of the "glDispatchComputeIndirect" arguments.
+	void bindIndirect();
+
+	void update(const void* data, int size);
+
+	void copyTo(SSBO& destination, int readOffset, int writeOffset, int size);
+	void read(void* data, int offset, int size);
+
+	void clean();
+
+private:
+	uint32_t ID;
+
+	int capacity;
+	GLenum usage;
+};
+
+class UBO
+{
+public:
+	UBO(const void* data, int size, GLenum usage = GL_DYNAMIC_DRAW);
+
+	void bind();
+	void unbind();
+
+	void bindBase(uint32_t index);
+
+	void update(const void* data, int size);
+
+	void clean();
+
+private:
+	uint32_t ID;
+
+	int capacity;
+	GLenum usage;
+};
@@ -1,7 +1,7 @@
 #include "framebuffer.h"
 
 FrameBuffer::FrameBuffer(int width, int height, int numberOfColorBuffers, GLenum colorInternalFormat, GLenum filter, GLenum clampMode, DepthAndStencilType depthAndStencilType, int samples)
-	: ID(), numberOfColorBuffers(numberOfColorBuffers), colorBufferIDs(), depthAndStencilBufferID(), depthAndStencilType(depthAndStencilType)
+	: ID(), numberOfColorBuffers(numberOfColorBuffers), colorBufferIDs(), depthAndStencilBufferID(), depthAndStencilType(depthAndStencilType), width(width), height(height)
 {
 	glGenFramebuffers(1, &ID);
 	glBindFramebuffer(GL_FRAMEBUFFER, ID);
@@ -67,7 +67,7 @@ FrameBuffer::FrameBuffer(int width, int height, int numberOfColorBuffers, GLenum
 }
 
 FrameBuffer::FrameBuffer(int width, int height, std::vector<ColorBufferConfig> configurations, DepthAndStencilType depthAndStencilType, int samples)
-	: ID(), numberOfColorBuffers(configurations.size()), colorBufferIDs(), depthAndStencilBufferID(), depthAndStencilType(depthAndStencilType)
+	: ID(), numberOfColorBuffers(configurations.size()), colorBufferIDs(), depthAndStencilBufferID(), depthAndStencilType(depthAndStencilType), width(width), height(height)
 {
 	glGenFramebuffers(1, &ID);
 	glBindFramebuffer(GL_FRAMEBUFFER, ID);
@@ -159,6 +159,11 @@ void FrameBuffer::bindColorBuffer(int unit, int attachmentNumber)
 	}
 }
 
+void FrameBuffer::bindColorBufferImage(int unit, GLenum access, GLenum format, int attachmentNumber)
+{
+	glBindImageTexture(unit, colorBufferIDs[attachmentNumber], 0, GL_FALSE, 0, access, format);
+}
+
 void FrameBuffer::bindDepthAndStencilBuffer(int unit)
 {
 	if (depthAndStencilType == DepthAndStencilType::TEXTURE)
@@ -179,6 +184,28 @@ void FrameBuffer::bindDepthAndStencilBuffer(int unit)
 	}
 }
 
+void FrameBuffer::readColorBuffer(void* pixels, GLenum format, GLenum type, int attachmentNumber)
+{
+	// Rows are returned bottom-up, as stored by OpenGL.
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, ID);
+	glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentNumber);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, format, type, pixels);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+int FrameBuffer::getWidth() const
+{
+	return width;
+}
+
+int FrameBuffer::getHeight() const
+{
+	return height;
+}
+
 void FrameBuffer::clean()
 {
 	glDeleteFramebuffers(1, &ID);
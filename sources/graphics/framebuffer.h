@@ -29,12 +29,22 @@ public:
 	void bindColorBuffer(int unit, int attachmentNumber = 0);
 	void bindDepthAndStencilBuffer(int unit);
 
+	// Attaches a color buffer to the "layout(binding = unit) image2D" of the shaders, "format" must match its internal format.
+	void bindColorBufferImage(int unit, GLenum access, GLenum format, int attachmentNumber = 0);
+
+	void readColorBuffer(void* pixels, GLenum format = GL_RGBA, GLenum type = GL_FLOAT, int attachmentNumber = 0);
+
+	int getWidth() const;
+	int getHeight() const;
+
 	void clean();
 
 private:
 	uint32_t ID, numberOfColorBuffers, colorBufferIDs[32], depthAndStencilBufferID;
 	DepthAndStencilType depthAndStencilType;
 
+	int width, height;
+
 	void attachTextureAsColorBuffer(int width, int height, int attachmentNumber, GLenum internalFormat = GL_RGBA, GLenum filter = GL_LINEAR, GLenum clampMode = GL_CLAMP_TO_EDGE, int samples = 1);
 	void attachTextureAsDepthAndStencilBuffer(int width, int height);
 	void attachRenderBufferAsDepthAndStencilBuffer(int width, int height, int samples = 1);
@@ -0,0 +1,370 @@
+#include "gpu_profiler.h"
+
+bool GpuProfiler::enabled = false;
+
+std::vector<GpuProfiler::Pass> GpuProfiler::passes;
+GpuProfiler::Frame GpuProfiler::frames[GpuProfiler::FRAMES_IN_FLIGHT];
+GpuProfiler::Frame* GpuProfiler::currentFrame = nullptr;
+int GpuProfiler::nextFrame = 0;
+uint64_t GpuProfiler::frameNumber = 0;
+
+std::vector<int> GpuProfiler::openScopes;
+
+std::chrono::steady_clock::time_point GpuProfiler::lastFrameStart;
+
+std::string GpuProfiler::captureFilepath;
+std::vector<GpuProfiler::CaptureRow> GpuProfiler::captureRows;
+bool GpuProfiler::capturing = false;
+
+void GpuProfiler::setup()
+{
+	for (Frame& frame : frames)
+	{
+		frame = { {}, {}, 0, 0, 0.0f, false };
+	}
+
+	passes.clear();
+	openScopes.clear();
+
+	currentFrame = nullptr;
+	nextFrame = 0;
+	frameNumber = 0;
+
+	lastFrameStart = std::chrono::steady_clock::now();
+
+	enabled = true;
+}
+
+void GpuProfiler::clean()
+{
+	for (Frame& frame : frames)
+	{
+		if (!frame.queryIDs.empty())
+		{
+			glDeleteQueries(int(frame.queryIDs.size()), frame.queryIDs.data());
+		}
+
+		frame.queryIDs.clear();
+	}
+
+	enabled = false;
+}
+
+void GpuProfiler::beginFrame()
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	retrieveFrames(false);
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	float cpuTime = std::chrono::duration<float, std::milli>(now - lastFrameStart).count();
+
+	lastFrameStart = now;
+	frameNumber += 1;
+
+	Frame& frame = frames[nextFrame];
+
+	// The GPU is more than "FRAMES_IN_FLIGHT" frames behind, this one goes unmeasured.
+	if (frame.pending)
+	{
+		currentFrame = nullptr;
+
+		return;
+	}
+
+	frame.scopes.clear();
+	frame.numberOfQueries = 0;
+	frame.frameNumber = frameNumber;
+	frame.cpuTime = cpuTime;
+
+	currentFrame = &frame;
+	nextFrame = (nextFrame + 1) % FRAMES_IN_FLIGHT;
+
+	beginScope("Frame");
+}
+
+void GpuProfiler::endFrame()
+{
+	if (currentFrame == nullptr)
+	{
+		return;
+	}
+
+	// Scopes left open by mistake end with the frame.
+	while (!openScopes.empty())
+	{
+		endScope();
+	}
+
+	currentFrame->pending = true;
+	currentFrame = nullptr;
+}
+
+void GpuProfiler::beginScope(const char* passName)
+{
+	if (currentFrame == nullptr)
+	{
+		return;
+	}
+
+	Scope scope = { getPassIndex(passName), createQuery(), -1 };
+
+	glQueryCounter(currentFrame->queryIDs[scope.beginQuery], GL_TIMESTAMP);
+
+	currentFrame->scopes.push_back(scope);
+	openScopes.push_back(int(currentFrame->scopes.size()) - 1);
+}
+
+void GpuProfiler::endScope()
+{
+	if (currentFrame == nullptr || openScopes.empty())
+	{
+		return;
+	}
+
+	Scope& scope = currentFrame->scopes[openScopes.back()];
+
+	scope.endQuery = createQuery();
+
+	glQueryCounter(currentFrame->queryIDs[scope.endQuery], GL_TIMESTAMP);
+
+	openScopes.pop_back();
+}
+
+void GpuProfiler::finish()
+{
+	if (enabled)
+	{
+		retrieveFrames(true);
+	}
+}
+
+void GpuProfiler::startCapture(const std::string& filepath)
+{
+	captureFilepath = filepath;
+	captureRows.clear();
+
+	capturing = true;
+}
+
+bool GpuProfiler::stopCapture()
+{
+	if (!capturing)
+	{
+		return false;
+	}
+
+	capturing = false;
+
+	std::ofstream fileStream(captureFilepath);
+
+	if (!fileStream)
+	{
+		std::cout << "[ERROR] GPU PROFILER: Failed to write \"" << captureFilepath << "\"." << std::endl;
+
+		return false;
+	}
+
+	// Passes seen after a row was captured are empty in it.
+	fileStream << "frame,cpu_ms";
+
+	for (const Pass& pass : passes)
+	{
+		fileStream << "," << pass.name << "_ms";
+	}
+
+	fileStream << "\n";
+
+	for (const CaptureRow& row : captureRows)
+	{
+		fileStream << row.frameNumber << "," << row.cpuTime;
+
+		for (size_t i = 0; i < passes.size(); i++)
+		{
+			fileStream << ",";
+
+			if (i < row.passTimes.size() && row.passTimes[i] >= 0.0f)
+			{
+				fileStream << row.passTimes[i];
+			}
+		}
+
+		fileStream << "\n";
+	}
+
+	std::cout << "Saved " << captureRows.size() << " profiled frames to \"" << captureFilepath << "\"." << std::endl;
+
+	captureRows.clear();
+
+	return true;
+}
+
+bool GpuProfiler::isCapturing()
+{
+	return capturing;
+}
+
+float GpuProfiler::getLatestTime(const char* passName, uint64_t* measuredFrame)
+{
+	for (const Pass& pass : passes)
+	{
+		if (pass.name == passName || strcmp(pass.name, passName) == 0)
+		{
+			if (measuredFrame != nullptr)
+			{
+				*measuredFrame = pass.latestFrame;
+			}
+
+			return pass.historyCount > 0 ? pass.latest : -1.0f;
+		}
+	}
+
+	return -1.0f;
+}
+
+uint64_t GpuProfiler::getFrameNumber()
+{
+	return frameNumber;
+}
+
+void GpuProfiler::processGUI()
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	for (const Pass& pass : passes)
+	{
+		float average = 0.0f;
+
+		for (int i = 0; i < pass.historyCount; i++)
+		{
+			average += pass.history[i];
+		}
+
+		average /= float(std::max(pass.historyCount, 1));
+
+		char overlay[64];
+		snprintf(overlay, sizeof(overlay), "%.3f ms (avg %.3f)", pass.latest, average);
+
+		// The oldest sample sits at "historyIndex" once the ring is full.
+		ImGui::PlotLines(pass.name, pass.history.data(), HISTORY_SIZE, pass.historyIndex, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+	}
+
+	if (capturing)
+	{
+		if (ImGui::Button("Stop CSV"))
+		{
+			stopCapture();
+		}
+
+		ImGui::SameLine();
+		ImGui::Text("%d frames to \"%s\"", int(captureRows.size()), captureFilepath.c_str());
+	}
+	else if (ImGui::Button("Record CSV"))
+	{
+		startCapture("gpu_profile.csv");
+	}
+}
+
+int GpuProfiler::getPassIndex(const char* passName)
+{
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		if (passes[i].name == passName || strcmp(passes[i].name, passName) == 0)
+		{
+			return int(i);
+		}
+	}
+
+	passes.push_back({ passName, std::vector<float>(HISTORY_SIZE, 0.0f), 0, 0, 0.0f, 0 });
+
+	return int(passes.size()) - 1;
+}
+
+int GpuProfiler::createQuery()
+{
+	if (currentFrame->numberOfQueries == int(currentFrame->queryIDs.size()))
+	{
+		uint32_t queryID;
+		glGenQueries(1, &queryID);
+
+		currentFrame->queryIDs.push_back(queryID);
+	}
+
+	currentFrame->numberOfQueries += 1;
+
+	return currentFrame->numberOfQueries - 1;
+}
+
+void GpuProfiler::retrieveFrames(bool wait)
+{
+	// Pending frames are retrieved oldest first: the slot after the last one used is the oldest.
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		Frame& frame = frames[(nextFrame + i) % FRAMES_IN_FLIGHT];
+
+		if (!frame.pending)
+		{
+			continue;
+		}
+
+		// Timestamps complete in order, the last one covers the whole frame.
+		int available = 0;
+		glGetQueryObjectiv(frame.queryIDs[frame.numberOfQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available && !wait)
+		{
+			return;
+		}
+
+		retrieveFrame(frame);
+	}
+}
+
+void GpuProfiler::retrieveFrame(Frame& frame)
+{
+	std::vector<uint64_t> timestamps(frame.numberOfQueries);
+
+	for (int i = 0; i < frame.numberOfQueries; i++)
+	{
+		glGetQueryObjectui64v(frame.queryIDs[i], GL_QUERY_RESULT, &timestamps[i]);
+	}
+
+	std::vector<float> passTimes(passes.size(), -1.0f);
+
+	for (const Scope& scope : frame.scopes)
+	{
+		float milliseconds = float(double(timestamps[scope.endQuery] - timestamps[scope.beginQuery]) / 1.0e6);
+
+		passTimes[scope.pass] = std::max(passTimes[scope.pass], 0.0f) + milliseconds;
+	}
+
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		if (passTimes[i] < 0.0f)
+		{
+			continue;
+		}
+
+		Pass& pass = passes[i];
+
+		pass.history[pass.historyIndex] = passTimes[i];
+		pass.historyIndex = (pass.historyIndex + 1) % HISTORY_SIZE;
+		pass.historyCount = std::min(pass.historyCount + 1, HISTORY_SIZE);
+		pass.latest = passTimes[i];
+		pass.latestFrame = frame.frameNumber;
+	}
+
+	if (capturing)
+	{
+		captureRows.push_back({ frame.frameNumber, frame.cpuTime, passTimes });
+	}
+
+	frame.pending = false;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cfloat>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <imgui/imgui.h>
+
+// GPU time of every named pass of a frame.
+//
+// Scopes put a "GL_TIMESTAMP" query on each side of their commands, so they can nest (the whole frame is a scope
+// too) and a pass entered several times in a frame (e.g. tiles) is summed. Results are read a few frames later from
+// a ring of per frame query pools, only once the GPU reports them available: a frame is left unmeasured instead of
+// waiting when every pool is still in flight.
+//
+class GpuProfiler
+{
+public:
+	static const int HISTORY_SIZE = 240; // Frames shown by the graphs.
+
+	// Needs a current context, scopes do nothing until then.
+	static void setup();
+	static void clean();
+
+	static void beginFrame();
+	static void endFrame();
+
+	// "passName" must outlive the profiler (e.g. a string literal).
+	static void beginScope(const char* passName);
+	static void endScope();
+
+	// Waits for every frame in flight, e.g. before writing the capture.
+	static void finish();
+
+	// Per frame timings of every pass, written as CSV (one row per measured frame) by "stopCapture".
+	static void startCapture(const std::string& filepath);
+	static bool stopCapture();
+	static bool isCapturing();
+
+	// Milliseconds of the latest measured frame running "passName", negative until one was measured.
+	// "measuredFrame" receives the number of that frame (see "getFrameNumber"), when given.
+	static float getLatestTime(const char* passName, uint64_t* measuredFrame = nullptr);
+
+	// Frames begun so far, the current one included.
+	static uint64_t getFrameNumber();
+
+	// Rolling graph per pass, and capture controls.
+	static void processGUI();
+
+private:
+	static const int FRAMES_IN_FLIGHT = 4;
+
+	struct Pass
+	{
+		const char* name;
+
+		std::vector<float> history; // Milliseconds, a ring written at "historyIndex".
+		int historyIndex, historyCount;
+
+		float latest;
+		uint64_t latestFrame;
+	};
+
+	struct Scope
+	{
+		int pass;
+
+		int beginQuery, endQuery;
+	};
+
+	struct Frame
+	{
+		std::vector<uint32_t> queryIDs; // Grown on demand, reused by later frames of this slot.
+		std::vector<Scope> scopes;
+
+		int numberOfQueries;
+		uint64_t frameNumber;
+		float cpuTime; // Milliseconds since the previous "beginFrame".
+
+		bool pending;
+	};
+
+	struct CaptureRow
+	{
+		uint64_t frameNumber;
+		float cpuTime;
+
+		std::vector<float> passTimes; // Indexed like "passes", negative when the pass didn't run.
+	};
+
+	static bool enabled;
+
+	static std::vector<Pass> passes;
+	static Frame frames[FRAMES_IN_FLIGHT];
+	static Frame* currentFrame; // Null when this frame isn't measured.
+	static int nextFrame;
+	static uint64_t frameNumber;
+
+	static std::vector<int> openScopes; // Indices in "currentFrame->scopes".
+
+	static std::chrono::steady_clock::time_point lastFrameStart;
+
+	static std::string captureFilepath;
+	static std::vector<CaptureRow> captureRows;
+	static bool capturing;
+
+	static int getPassIndex(const char* passName);
+	static int createQuery();
+
+	// Retrieves finished frames in submission order, stops at the first one still in flight unless "wait".
+	static void retrieveFrames(bool wait);
+	static void retrieveFrame(Frame& frame);
+};
@@ -0,0 +1,137 @@
+#include "headless_context.h"
+
+#ifdef _WIN32
+
+HeadlessContext::HeadlessContext() : window(nullptr)
+{
+}
+
+bool HeadlessContext::create(int majorVersion, int minorVersion)
+{
+	if (!glfwInit())
+	{
+		std::cout << "[ERROR] HEADLESS CONTEXT: Failed to initialize GLFW!" << std::endl;
+
+		return false;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	window = glfwCreateWindow(1, 1, "", NULL, NULL);
+
+	if (!window)
+	{
+		std::cout << "[ERROR] HEADLESS CONTEXT: Failed to create GLFW context!" << std::endl;
+		glfwTerminate();
+
+		return false;
+	}
+
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "[ERROR] HEADLESS CONTEXT: Failed to initialize GLAD!" << std::endl;
+		destroy();
+
+		return false;
+	}
+
+	return true;
+}
+
+void HeadlessContext::destroy()
+{
+	if (window != nullptr)
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+
+		window = nullptr;
+	}
+}
+
+#else
+
+HeadlessContext::HeadlessContext() : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT)
+{
+}
+
+bool HeadlessContext::create(int majorVersion, int minorVersion)
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	// Prefer the surfaceless platform, it doesn't need a display server nor a GPU.
+	if (eglGetPlatformDisplayEXT != nullptr)
+	{
+		display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+
+	if (display == EGL_NO_DISPLAY)
+	{
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+	{
+		std::cout << "[ERROR] HEADLESS CONTEXT: Failed to initialize EGL!" << std::endl;
+
+		return false;
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+
+	EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+		EGL_CONTEXT_MINOR_VERSION, minorVersion,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	// Rendering only happens on framebuffer objects, so neither a config nor a surface is needed.
+	context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+
+	if (context == EGL_NO_CONTEXT)
+	{
+		std::cout << "[ERROR] HEADLESS CONTEXT: Failed to create an OpenGL " << majorVersion << "." << minorVersion << " core context!" << std::endl;
+		std::cout << "Drivers exposing an older version (e.g. Mesa llvmpipe) may accept MESA_GL_VERSION_OVERRIDE=4.6 and MESA_GLSL_VERSION_OVERRIDE=460." << std::endl;
+		destroy();
+
+		return false;
+	}
+
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+	{
+		std::cout << "[ERROR] HEADLESS CONTEXT: Failed to initialize GLAD!" << std::endl;
+		destroy();
+
+		return false;
+	}
+
+	return true;
+}
+
+void HeadlessContext::destroy()
+{
+	if (display != EGL_NO_DISPLAY)
+	{
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+		if (context != EGL_NO_CONTEXT)
+		{
+			eglDestroyContext(display, context);
+		}
+
+		eglTerminate(display);
+
+		display = EGL_NO_DISPLAY;
+		context = EGL_NO_CONTEXT;
+	}
+}
+
+#endif
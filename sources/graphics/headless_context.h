@@ -0,0 +1,34 @@
+#pragma once
+
+#include <iostream>
+
+#include <glad/glad.h>
+
+#ifdef _WIN32
+#include <GLFW/glfw3.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// OpenGL context without a visible window, used by the offline modes.
+//
+// On Linux it is a surfaceless EGL context, so it also works without a display server (e.g. Mesa llvmpipe on render nodes).
+// Windows has no EGL driver by default, so a hidden GLFW window is used instead.
+//
+class HeadlessContext
+{
+public:
+	HeadlessContext();
+
+	bool create(int majorVersion = 4, int minorVersion = 6);
+	void destroy();
+
+private:
+#ifdef _WIN32
+	GLFWwindow* window;
+#else
+	EGLDisplay display;
+	EGLContext context;
+#endif
+};
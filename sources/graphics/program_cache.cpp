@@ -0,0 +1,207 @@
+#include "program_cache.h"
+
+// "GLPB" and a layout version, followed by the key, the binary format and the binary length.
+static const uint32_t CACHE_FILE_MAGIC = 0x42504c47;
+static const uint32_t CACHE_FILE_VERSION = 1;
+
+struct CacheFileHeader
+{
+	uint32_t magic, version;
+	uint64_t key;
+
+	uint32_t binaryFormat, binaryLength;
+};
+
+std::string ProgramCache::directory = "cache/programs";
+ProgramCacheStatistics ProgramCache::statistics = {};
+
+static void hashBytes(uint64_t& hash, const void* data, size_t size)
+{
+	// 64 bits FNV-1a, plenty to tell a few hundred sources apart.
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+static void hashString(uint64_t& hash, const char* string)
+{
+	std::string value = string != nullptr ? string : "";
+
+	// The length goes first, so consecutive strings can't be shifted into each other.
+	uint64_t length = value.size();
+
+	hashBytes(hash, &length, sizeof(length));
+	hashBytes(hash, value.data(), value.size());
+}
+
+void ProgramCache::setDirectory(const std::string& directory)
+{
+	ProgramCache::directory = directory;
+}
+
+const std::string& ProgramCache::getDirectory()
+{
+	return directory;
+}
+
+uint64_t ProgramCache::computeKey(const std::vector<GLenum>& stageTypes, const std::vector<std::string>& sources)
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+	hashString(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+	hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		hashBytes(hash, &stageTypes[i], sizeof(GLenum));
+		hashString(hash, sources[i].c_str());
+	}
+
+	return hash;
+}
+
+bool ProgramCache::load(uint64_t key, uint32_t programID)
+{
+	if (directory.empty())
+	{
+		return false;
+	}
+
+	std::ifstream file(getFilepath(key), std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	CacheFileHeader header = {};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!file || header.magic != CACHE_FILE_MAGIC || header.version != CACHE_FILE_VERSION || header.key != key)
+	{
+		return false;
+	}
+
+	std::error_code error;
+	uintmax_t fileSize = std::filesystem::file_size(getFilepath(key), error);
+
+	// A truncated or corrupted file mustn't make it allocate whatever length it claims.
+	if (error || fileSize <= sizeof(header) || header.binaryLength != fileSize - sizeof(header))
+	{
+		return false;
+	}
+
+	std::vector<char> binary(header.binaryLength);
+	file.read(binary.data(), header.binaryLength);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	glProgramBinary(programID, header.binaryFormat, binary.data(), int(header.binaryLength));
+
+	int success = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+
+	if (!success)
+	{
+		std::cout << "[ERROR] PROGRAM CACHE: The driver rejected \"" << getFilepath(key) << "\", compiling the sources." << std::endl;
+	}
+
+	return success != 0;
+}
+
+void ProgramCache::store(uint64_t key, uint32_t programID)
+{
+	if (directory.empty())
+	{
+		return;
+	}
+
+	int binaryLength = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+
+	// Drivers without any binary format report an empty binary.
+	if (binaryLength <= 0)
+	{
+		return;
+	}
+
+	CacheFileHeader header = { CACHE_FILE_MAGIC, CACHE_FILE_VERSION, key, 0, 0 };
+	std::vector<char> binary(binaryLength);
+
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(programID, binaryLength, &binaryLength, &binaryFormat, binary.data());
+
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = uint32_t(binaryLength);
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	// Written aside and renamed, so a crash (or another instance) never leaves a truncated entry behind.
+	std::string filepath = getFilepath(key);
+	std::string temporaryFilepath = filepath + ".tmp";
+
+	{
+		std::ofstream file(temporaryFilepath, std::ios::binary | std::ios::trunc);
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), binaryLength);
+
+		if (!file)
+		{
+			std::cout << "[ERROR] PROGRAM CACHE: Failed to write \"" << temporaryFilepath << "\"." << std::endl;
+
+			return;
+		}
+	}
+
+	std::filesystem::rename(temporaryFilepath, filepath, error);
+}
+
+void ProgramCache::recordLoad(float milliseconds)
+{
+	statistics.hits += 1;
+	statistics.loadTime += milliseconds;
+}
+
+void ProgramCache::recordCompile(float milliseconds)
+{
+	statistics.misses += 1;
+	statistics.compileTime += milliseconds;
+}
+
+const ProgramCacheStatistics& ProgramCache::getStatistics()
+{
+	return statistics;
+}
+
+void ProgramCache::resetStatistics()
+{
+	statistics = {};
+}
+
+void ProgramCache::printStatistics(const char* operation, float setupTime)
+{
+	// Warm when every program came from the cache.
+	const char* start = statistics.misses == 0 && statistics.hits > 0 ? "warm" : "cold";
+
+	std::cout << operation << ": " << setupTime << " ms (" << start << " start), shader programs: ";
+	std::cout << statistics.hits << " from cache in " << statistics.loadTime << " ms, ";
+	std::cout << statistics.misses << " compiled in " << statistics.compileTime << " ms." << std::endl;
+}
+
+std::string ProgramCache::getFilepath(uint64_t key)
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+
+	return directory + "/" + name;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+#include <glad/glad.h>
+
+struct ProgramCacheStatistics
+{
+	int hits, misses; // Programs loaded from the cache, and programs compiled from their sources.
+
+	float loadTime, compileTime; // Milliseconds spent on each path, linking included.
+};
+
+// Linked programs saved with "glGetProgramBinary", so later launches (and scene switches) skip the GLSL compiler.
+//
+// Entries are keyed by a hash of the final sources of every stage (injected defines included) and of the driver
+// vendor, renderer and version strings: editing a shader or updating the driver misses and recompiles. Drivers may
+// still reject a binary (e.g. an internal format change), "load" reports it and the caller compiles as usual.
+//
+class ProgramCache
+{
+public:
+	// Empty disables the cache. Defaults to "cache/programs", next to "sources".
+	static void setDirectory(const std::string& directory);
+	static const std::string& getDirectory();
+
+	static uint64_t computeKey(const std::vector<GLenum>& stageTypes, const std::vector<std::string>& sources);
+
+	// Returns true if "programID" was linked from the cached binary.
+	static bool load(uint64_t key, uint32_t programID);
+	static void store(uint64_t key, uint32_t programID);
+
+	static void recordLoad(float milliseconds);
+	static void recordCompile(float milliseconds);
+
+	static const ProgramCacheStatistics& getStatistics();
+	static void resetStatistics();
+
+	// One line about the programs created since the last reset, "setupTime" is the whole operation they were part of.
+	static void printStatistics(const char* operation, float setupTime);
+
+private:
+	static std::string directory;
+	static ProgramCacheStatistics statistics;
+
+	static std::string getFilepath(uint64_t key);
+};
@@ -1,96 +1,36 @@
 #include "shader.h"
 
-ShaderProgram::ShaderProgram(const char* vsFilepath, const char* fsFilepath) : ID()
+// "glUniform1i" also sets booleans, samplers and images (their enums come in contiguous ranges, the second one
+// interleaves the unsigned vectors).
+static bool isSetAsInteger(GLenum type)
 {
-	int success;
-	char infoLog[512];
-
-	uint32_t vsID = createShader(vsFilepath, GL_VERTEX_SHADER);
-	uint32_t fsID = createShader(fsFilepath, GL_FRAGMENT_SHADER);
-
-	ID = glCreateProgram();
-
-	glAttachShader(ID, vsID);
-	glAttachShader(ID, fsID);
-
-	glLinkProgram(ID);
-
-	glGetProgramiv(ID, GL_LINK_STATUS, &success);
-
-	if (!success)
-	{
-		glGetProgramInfoLog(ID, 512, NULL, infoLog);
-
-		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
-	}
-
-	glDeleteShader(vsID);
-	glDeleteShader(fsID);
+	return type == GL_INT || type == GL_BOOL ||
+		(type >= GL_SAMPLER_1D && type <= GL_SAMPLER_2D_RECT_SHADOW) ||
+		(type >= GL_SAMPLER_1D_ARRAY && type <= GL_UNSIGNED_INT_SAMPLER_BUFFER && (type < GL_UNSIGNED_INT_VEC2 || type > GL_UNSIGNED_INT_VEC4)) ||
+		(type >= GL_SAMPLER_CUBE_MAP_ARRAY && type <= GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY) ||
+		(type >= GL_SAMPLER_2D_MULTISAMPLE && type <= GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY) ||
+		(type >= GL_IMAGE_1D && type <= GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY);
 }
 
-ShaderProgram::ShaderProgram(const char* vsFilepath, const char* gsFilepath, const char* fsFilepath) : ID()
+ShaderProgram::ShaderProgram(const char* vsFilepath, const char* fsFilepath, const std::vector<ShaderDefine>& defines)
+	: ID(), stageTypes(), filepaths(), defines(), sourceFiles(), pendingID(0), pendingShaderIDs(), pendingKey(0)
 {
-	int success;
-	char infoLog[512];
-
-	uint32_t vsID = createShader(vsFilepath, GL_VERTEX_SHADER);
-	uint32_t gsID = createShader(gsFilepath, GL_GEOMETRY_SHADER);
-	uint32_t fsID = createShader(fsFilepath, GL_FRAGMENT_SHADER);
-
-	ID = glCreateProgram();
-
-	glAttachShader(ID, vsID);
-	glAttachShader(ID, gsID);
-	glAttachShader(ID, fsID);
-
-	glLinkProgram(ID);
-
-	glGetProgramiv(ID, GL_LINK_STATUS, &success);
-
-	if (!success)
-	{
-		glGetProgramInfoLog(ID, 512, NULL, infoLog);
-
-		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
-	}
-
-	glDeleteShader(vsID);
-	glDeleteShader(gsID);
-	glDeleteShader(fsID);
+	createProgram({ GL_VERTEX_SHADER, GL_FRAGMENT_SHADER }, { vsFilepath, fsFilepath }, defines);
 }
 
-ShaderProgram::ShaderProgram(const char* vsFilepath, const char* tcsFilepath, const char* tesFilepath, const char* fsFilepath)
+ShaderProgram::ShaderProgram(const char* vsFilepath, const char* gsFilepath, const char* fsFilepath) : ID(), stageTypes(), filepaths(), defines(), sourceFiles(), pendingID(0), pendingShaderIDs(), pendingKey(0)
 {
-	int success;
-	char infoLog[512];
-
-	uint32_t vsID = createShader(vsFilepath, GL_VERTEX_SHADER);
-	uint32_t tcsID = createShader(tcsFilepath, GL_TESS_CONTROL_SHADER);
-	uint32_t tesID = createShader(tesFilepath, GL_TESS_EVALUATION_SHADER);
-	uint32_t fsID = createShader(fsFilepath, GL_FRAGMENT_SHADER);
-
-	ID = glCreateProgram();
-
-	glAttachShader(ID, vsID);
-	glAttachShader(ID, tcsID);
-	glAttachShader(ID, tesID);
-	glAttachShader(ID, fsID);
-
-	glLinkProgram(ID);
-
-	glGetProgramiv(ID, GL_LINK_STATUS, &success);
-
-	if (!success)
-	{
-		glGetProgramInfoLog(ID, 512, NULL, infoLog);
+	createProgram({ GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER }, { vsFilepath, gsFilepath, fsFilepath });
+}
 
-		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
-	}
+ShaderProgram::ShaderProgram(const char* vsFilepath, const char* tcsFilepath, const char* tesFilepath, const char* fsFilepath) : ID(), stageTypes(), filepaths(), defines(), sourceFiles(), pendingID(0), pendingShaderIDs(), pendingKey(0)
+{
+	createProgram({ GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER }, { vsFilepath, tcsFilepath, tesFilepath, fsFilepath });
+}
 
-	glDeleteShader(vsID);
-	glDeleteShader(tcsID);
-	glDeleteShader(tesID);
-	glDeleteShader(fsID);
+ShaderProgram::ShaderProgram(const char* csFilepath, const std::vector<ShaderDefine>& defines) : ID(), stageTypes(), filepaths(), defines(), sourceFiles(), pendingID(0), pendingShaderIDs(), pendingKey(0)
+{
+	createProgram({ GL_COMPUTE_SHADER }, { csFilepath }, defines);
 }
 
 void ShaderProgram::bind()
@@ -123,6 +63,26 @@ void ShaderProgram::setUniform1f(const char* uniformName, float data)
 	}
 }
 
+void ShaderProgram::setUniform2i(const char* uniformName, const glm::ivec2& data)
+{
+	int uniformLocation = getUniformLocation(uniformName);
+
+	if (uniformLocation > -1)
+	{
+		glUniform2i(uniformLocation, data.x, data.y);
+	}
+}
+
+void ShaderProgram::setUniform2f(const char* uniformName, const glm::vec2& data)
+{
+	int uniformLocation = getUniformLocation(uniformName);
+
+	if (uniformLocation > -1)
+	{
+		glUniform2f(uniformLocation, data.x, data.y);
+	}
+}
+
 void ShaderProgram::setUniform3f(const char* uniformName, const glm::vec3& data)
 {
 	int uniformLocation = getUniformLocation(uniformName);
@@ -163,46 +123,547 @@ void ShaderProgram::setUniformMatrix4fv(const char* uniformName, const glm::mat4
 	}
 }
 
-void ShaderProgram::clean()
+void ShaderProgram::setUniform(UniformHandle<int> handle, int data)
 {
-	glDeleteProgram(ID);
+	if (handle.location > -1)
+	{
+		glUniform1i(handle.location, data);
+	}
+}
+
+void ShaderProgram::setUniform(UniformHandle<float> handle, float data)
+{
+	if (handle.location > -1)
+	{
+		glUniform1f(handle.location, data);
+	}
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::ivec2> handle, const glm::ivec2& data)
+{
+	if (handle.location > -1)
+	{
+		glUniform2i(handle.location, data.x, data.y);
+	}
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::vec2> handle, const glm::vec2& data)
+{
+	if (handle.location > -1)
+	{
+		glUniform2f(handle.location, data.x, data.y);
+	}
 }
 
-int ShaderProgram::getUniformLocation(const char* uniformName)
+void ShaderProgram::setUniform(UniformHandle<glm::vec3> handle, const glm::vec3& data)
 {
-	std::map<std::string, int>::iterator it = uniformsLocations.find(uniformName);
+	if (handle.location > -1)
+	{
+		glUniform3f(handle.location, data.x, data.y, data.z);
+	}
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::vec4> handle, const glm::vec4& data)
+{
+	if (handle.location > -1)
+	{
+		glUniform4f(handle.location, data.x, data.y, data.z, data.w);
+	}
+}
 
-	if (it != uniformsLocations.end())
+void ShaderProgram::setUniform(UniformHandle<glm::mat3> handle, const glm::mat3& data)
+{
+	if (handle.location > -1)
 	{
-		return it->second;
+		glUniformMatrix3fv(handle.location, 1, GL_FALSE, glm::value_ptr(data));
+	}
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::mat4> handle, const glm::mat4& data)
+{
+	if (handle.location > -1)
+	{
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(data));
+	}
+}
+
+void ShaderProgram::setUniformBlockBinding(const char* blockName, uint32_t bindingPoint)
+{
+	uint32_t blockIndex = glGetUniformBlockIndex(ID, blockName);
+
+	if (blockIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(ID, blockIndex, bindingPoint);
 	}
 	else
 	{
-		int uniformLocation = glGetUniformLocation(ID, uniformName);
+		std::cout << "[ERROR] SHADER PROGRAM: Failed to get index of uniform block \"" << blockName << "\"." << std::endl;
+	}
+}
+
+int ShaderProgram::getUniformBlockSize(const char* blockName)
+{
+	uint32_t blockIndex = glGetUniformBlockIndex(ID, blockName);
+
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		return -1;
+	}
+
+	int size = 0;
+	glGetActiveUniformBlockiv(ID, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+
+	return size;
+}
+
+void ShaderProgram::beginReload()
+{
+	std::vector<GLenum> reloadStageTypes;
+	std::vector<std::string> sources;
+
+	if (prepareReload(reloadStageTypes, sources))
+	{
+		compileProgram(reloadStageTypes, sources, pendingID, pendingShaderIDs);
+	}
+}
+
+bool ShaderProgram::prepareReload(std::vector<GLenum>& stageTypes, std::vector<std::string>& sources)
+{
+	cancelReload();
+
+	sources = readShaderSources();
+
+	pendingKey = ProgramCache::computeKey(this->stageTypes, sources);
+	pendingID = glCreateProgram();
+
+	// Going back to an earlier version of the sources doesn't need to compile anything.
+	if (ProgramCache::load(pendingKey, pendingID))
+	{
+		return false;
+	}
+
+	glDeleteProgram(pendingID);
+
+	pendingID = 0;
+	stageTypes = this->stageTypes;
+
+	return true;
+}
+
+void ShaderProgram::adoptReload(uint32_t programID, const std::vector<uint32_t>& shaderIDs)
+{
+	cancelReload();
+
+	pendingID = programID;
+	pendingShaderIDs = shaderIDs;
+}
+
+void ShaderProgram::compileProgram(const std::vector<GLenum>& stageTypes, const std::vector<std::string>& sources, uint32_t& programID, std::vector<uint32_t>& shaderIDs)
+{
+	programID = glCreateProgram();
+	shaderIDs.clear();
+
+	// No status is read here: with parallel compilation these calls return right away, and a shader that fails to
+	// compile only makes the linkage fail, reported by "pollReload".
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		const char* sourceCodePtr = sources[i].c_str();
+
+		uint32_t shaderID = glCreateShader(stageTypes[i]);
+
+		glShaderSource(shaderID, 1, &sourceCodePtr, NULL);
+		glCompileShader(shaderID);
+
+		glAttachShader(programID, shaderID);
+
+		shaderIDs.push_back(shaderID);
+	}
+
+	glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	glLinkProgram(programID);
+}
+
+void ShaderProgram::cancelReload()
+{
+	for (uint32_t shaderID : pendingShaderIDs)
+	{
+		glDeleteShader(shaderID);
+	}
+
+	if (pendingID != 0)
+	{
+		glDeleteProgram(pendingID);
+	}
+
+	pendingID = 0;
+	pendingShaderIDs.clear();
+}
+
+ShaderReloadStatus ShaderProgram::pollReload(bool nonBlocking)
+{
+	if (pendingID == 0)
+	{
+		return ShaderReloadStatus::NONE;
+	}
+
+	int success;
+	char infoLog[512];
+
+	if (nonBlocking)
+	{
+		glGetProgramiv(pendingID, GL_COMPLETION_STATUS_KHR, &success);
+
+		if (!success)
+		{
+			return ShaderReloadStatus::PENDING;
+		}
+	}
+
+	glGetProgramiv(pendingID, GL_LINK_STATUS, &success);
+
+	if (!success)
+	{
+		for (uint32_t shaderID : pendingShaderIDs)
+		{
+			glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+
+			if (!success)
+			{
+				glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+
+				std::cout << "[ERROR] SHADER PROGRAM: Compilation failed!\n" << infoLog << std::endl;
+			}
+		}
+
+		glGetProgramInfoLog(pendingID, 512, NULL, infoLog);
+
+		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
+
+		printSourceFiles();
+
+		cancelReload();
+
+		return ShaderReloadStatus::FAILED;
+	}
+
+	if (!pendingShaderIDs.empty())
+	{
+		ProgramCache::store(pendingKey, pendingID);
+	}
+
+	for (uint32_t shaderID : pendingShaderIDs)
+	{
+		glDeleteShader(shaderID);
+	}
+
+	glDeleteProgram(ID);
+
+	ID = pendingID;
+
+	pendingID = 0;
+	pendingShaderIDs.clear();
+
+	missingUniforms.clear();
+
+	reflectUniforms();
+
+	return ShaderReloadStatus::SWAPPED;
+}
+
+const std::vector<std::string>& ShaderProgram::getFilepaths() const
+{
+	return filepaths;
+}
+
+const std::vector<std::string>& ShaderProgram::getSourceFiles() const
+{
+	return sourceFiles;
+}
+
+void ShaderProgram::clean()
+{
+	cancelReload();
+
+	glDeleteProgram(ID);
+}
+
+void ShaderProgram::reflectUniforms()
+{
+	int numberOfUniforms = 0, maxNameLength = 0;
+
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &numberOfUniforms);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<char> nameBuffer(std::max(maxNameLength, 1));
+
+	activeUniforms.clear();
+
+	for (int i = 0; i < numberOfUniforms; i++)
+	{
+		int size = 0;
+		GLenum type = GL_NONE;
+
+		glGetActiveUniform(ID, uint32_t(i), int(nameBuffer.size()), NULL, &size, &type, nameBuffer.data());
 
-		if (uniformLocation > -1)
+		std::string name = nameBuffer.data();
+		int location = glGetUniformLocation(ID, name.c_str());
+
+		// Members of uniform blocks have no location, they are set through their buffer.
+		if (location < 0)
 		{
-			uniformsLocations.insert({ uniformName, uniformLocation });
+			continue;
 		}
-		else
+
+		// Arrays are reported once as "name[0]", every element gets an entry and the bare name stands for the first.
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
 		{
-			std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform \"" << uniformName << "\"." << std::endl;
+			std::string baseName = name.substr(0, name.size() - 3);
+
+			activeUniforms.push_back({ baseName, location, type });
+
+			for (int j = 1; j < size; j++)
+			{
+				std::string elementName = baseName + "[" + std::to_string(j) + "]";
+
+				activeUniforms.push_back({ elementName, glGetUniformLocation(ID, elementName.c_str()), type });
+			}
 		}
-		
-		return uniformLocation;
+
+		activeUniforms.push_back({ name, location, type });
 	}
+
+	std::sort(activeUniforms.begin(), activeUniforms.end(), [](const ActiveUniform& a, const ActiveUniform& b) { return a.name < b.name; });
 }
 
-uint32_t ShaderProgram::createShader(const char* filepath, int shaderType)
+int ShaderProgram::getUniformLocation(const char* uniformName, GLenum type)
 {
+	// Binary search on the reflected table, comparing with "strcmp" doesn't build any string.
+	std::vector<ActiveUniform>::const_iterator it = std::lower_bound(activeUniforms.begin(), activeUniforms.end(), uniformName,
+		[](const ActiveUniform& uniform, const char* name) { return std::strcmp(uniform.name.c_str(), name) < 0; });
+
+	if (it == activeUniforms.end() || std::strcmp(it->name.c_str(), uniformName) != 0)
+	{
+		// Optimized out (or misspelled): reported once, then silently ignored.
+		if (missingUniforms.insert(uniformName).second)
+		{
+			std::cout << "[ERROR] SHADER PROGRAM: Uniform \"" << uniformName << "\" isn't active." << std::endl;
+		}
+
+		return -1;
+	}
+
+	bool compatible = type == GL_NONE || it->type == type || (type == GL_INT && isSetAsInteger(it->type));
+
+	if (!compatible)
+	{
+		std::cout << "[ERROR] SHADER PROGRAM: Uniform \"" << uniformName << "\" doesn't match the type of its handle." << std::endl;
+
+		return -1;
+	}
+
+	return it->location;
+}
+
+void ShaderProgram::createProgram(const std::vector<GLenum>& stageTypes, const std::vector<const char*>& filepaths, const std::vector<ShaderDefine>& defines)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	this->stageTypes = stageTypes;
+	this->filepaths.assign(filepaths.begin(), filepaths.end());
+	this->defines = defines;
+
+	std::vector<std::string> sources = readShaderSources();
+
+	uint64_t key = ProgramCache::computeKey(stageTypes, sources);
+
+	ID = glCreateProgram();
+
+	if (ProgramCache::load(key, ID))
+	{
+		ProgramCache::recordLoad(std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+		reflectUniforms();
+
+		return;
+	}
+
+	// A rejected binary may leave the program in any state, start over from a fresh one.
+	glDeleteProgram(ID);
+
+	ID = glCreateProgram();
+
 	int success;
 	char infoLog[512];
 
+	std::vector<uint32_t> shaderIDs;
+
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		shaderIDs.push_back(createShader(sources[i], int(stageTypes[i])));
+
+		glAttachShader(ID, shaderIDs.back());
+	}
+
+	glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	glLinkProgram(ID);
+
+	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+
+	if (!success)
+	{
+		glGetProgramInfoLog(ID, 512, NULL, infoLog);
+
+		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
+	}
+	else
+	{
+		ProgramCache::store(key, ID);
+	}
+
+	for (uint32_t shaderID : shaderIDs)
+	{
+		glDeleteShader(shaderID);
+	}
+
+	ProgramCache::recordCompile(std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+	reflectUniforms();
+}
+
+std::vector<std::string> ShaderProgram::readShaderSources()
+{
+	std::vector<std::string> sources;
+
+	sourceFiles.clear();
+
+	for (const std::string& filepath : filepaths)
+	{
+		sources.push_back(readShaderSource(filepath.c_str(), defines));
+	}
+
+	return sources;
+}
+
+std::string ShaderProgram::readShaderSource(const char* filepath, const std::vector<ShaderDefine>& defines)
+{
+	std::set<std::string> includedFiles = { filepath };
+	std::string shaderSourceCode = expandIncludes(filepath, includedFiles);
+
+	if (!defines.empty())
+	{
+		// "#version" must stay the first directive, the defines go on the line after it.
+		size_t versionEnd = shaderSourceCode.find('\n', shaderSourceCode.find("#version"));
+		size_t insertPosition = versionEnd == std::string::npos ? shaderSourceCode.size() : versionEnd + 1;
+
+		int nextLine = int(std::count(shaderSourceCode.begin(), shaderSourceCode.begin() + insertPosition, '\n')) + 1;
+
+		std::string definesCode;
+
+		for (const ShaderDefine& define : defines)
+		{
+			definesCode += "#define " + define.name + " " + define.value + "\n";
+		}
+
+		definesCode += "#line " + std::to_string(nextLine) + " " + std::to_string(getSourceFileIndex(filepath)) + "\n";
+
+		shaderSourceCode.insert(insertPosition, definesCode);
+	}
+
+	return shaderSourceCode;
+}
+
+std::string ShaderProgram::expandIncludes(const std::string& filepath, std::set<std::string>& includedFiles)
+{
 	std::ifstream fileStream(filepath);
-	std::stringstream stringStream; stringStream << fileStream.rdbuf();
-	std::string shaderSourceCode = stringStream.str();
 
-	const char* shaderSourceCodePtr = shaderSourceCode.c_str();
+	if (!fileStream)
+	{
+		std::cout << "[ERROR] SHADER PROGRAM: Failed to read \"" << filepath << "\"." << std::endl;
+
+		return "";
+	}
+
+	int fileIndex = getSourceFileIndex(filepath);
+
+	std::string sourceCode, line;
+	int lineNumber = 0;
+
+	while (std::getline(fileStream, line))
+	{
+		lineNumber += 1;
+
+		size_t directiveBegin = line.find_first_not_of(" \t");
+
+		if (directiveBegin == std::string::npos || line.compare(directiveBegin, 8, "#include") != 0)
+		{
+			sourceCode += line + "\n";
+
+			continue;
+		}
+
+		size_t nameBegin = line.find('"', directiveBegin);
+		size_t nameEnd = nameBegin == std::string::npos ? std::string::npos : line.find('"', nameBegin + 1);
+
+		if (nameEnd == std::string::npos)
+		{
+			std::cout << "[ERROR] SHADER PROGRAM: Malformed \"#include\" at \"" << filepath << "\" line " << lineNumber << "." << std::endl;
+
+			sourceCode += "\n";
+
+			continue;
+		}
+
+		std::filesystem::path includePath = std::filesystem::path(filepath).parent_path() / line.substr(nameBegin + 1, nameEnd - nameBegin - 1);
+		std::string includeFilepath = includePath.lexically_normal().generic_string();
+
+		// Files already in this stage become an empty line, so includes need no guards.
+		if (!includedFiles.insert(includeFilepath).second)
+		{
+			sourceCode += "\n";
+
+			continue;
+		}
+
+		sourceCode += "#line 1 " + std::to_string(getSourceFileIndex(includeFilepath)) + "\n";
+		sourceCode += expandIncludes(includeFilepath, includedFiles);
+		sourceCode += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+	}
+
+	return sourceCode;
+}
+
+int ShaderProgram::getSourceFileIndex(const std::string& filepath)
+{
+	std::vector<std::string>::iterator it = std::find(sourceFiles.begin(), sourceFiles.end(), filepath);
+
+	if (it != sourceFiles.end())
+	{
+		return int(it - sourceFiles.begin());
+	}
+
+	sourceFiles.push_back(filepath);
+
+	return int(sourceFiles.size()) - 1;
+}
+
+void ShaderProgram::printSourceFiles()
+{
+	std::cout << "Source strings:" << std::endl;
+
+	for (size_t i = 0; i < sourceFiles.size(); i++)
+	{
+		std::cout << "  " << i << ": \"" << sourceFiles[i] << "\"" << std::endl;
+	}
+}
+
+uint32_t ShaderProgram::createShader(const std::string& sourceCode, int shaderType)
+{
+	int success;
+	char infoLog[512];
+
+	const char* shaderSourceCodePtr = sourceCode.c_str();
 
 	uint32_t shaderID = glCreateShader(shaderType);
 
@@ -216,6 +677,8 @@ uint32_t ShaderProgram::createShader(const char* filepath, int shaderType)
 
 		std::cout << "[ERROR] SHADER PROGRAM: Compilation failed!\n" << infoLog << std::endl;
 
+		printSourceFiles();
+
 		glDeleteShader(shaderID);
 
 		return -1;
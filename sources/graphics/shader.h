@@ -1,9 +1,15 @@
 #pragma once
 
-#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <filesystem>
 
 #include <glad/glad.h>
 
@@ -11,33 +17,169 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "program_cache.h"
 #include "../utils/debug.h"
 
+// From "GL_KHR_parallel_shader_compile", which the loader doesn't include.
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// "#define name value" lines inserted right after the "#version" directive of a source.
+struct ShaderDefine
+{
+	std::string name, value;
+};
+
+// GL type a handle refers to, checked against the reflected one when the handle is resolved.
+template <typename T> struct UniformTypeOf;
+
+template <> struct UniformTypeOf<int> { static constexpr GLenum value = GL_INT; }; // Also booleans, samplers and images.
+template <> struct UniformTypeOf<float> { static constexpr GLenum value = GL_FLOAT; };
+template <> struct UniformTypeOf<glm::ivec2> { static constexpr GLenum value = GL_INT_VEC2; };
+template <> struct UniformTypeOf<glm::vec2> { static constexpr GLenum value = GL_FLOAT_VEC2; };
+template <> struct UniformTypeOf<glm::vec3> { static constexpr GLenum value = GL_FLOAT_VEC3; };
+template <> struct UniformTypeOf<glm::vec4> { static constexpr GLenum value = GL_FLOAT_VEC4; };
+template <> struct UniformTypeOf<glm::mat3> { static constexpr GLenum value = GL_FLOAT_MAT3; };
+template <> struct UniformTypeOf<glm::mat4> { static constexpr GLenum value = GL_FLOAT_MAT4; };
+
+// Location of a uniform of type "T", resolved once with "ShaderProgram::getUniformHandle".
+// Handles of uniforms the compiler optimized out are invalid, and setting them does nothing.
+template <typename T>
+class UniformHandle
+{
+public:
+	UniformHandle() : location(-1) {}
+
+	bool isValid() const { return location > -1; }
+
+private:
+	friend class ShaderProgram;
+
+	int location;
+};
+
+enum class ShaderReloadStatus
+{
+	NONE, PENDING, SWAPPED, FAILED
+};
+
 class ShaderProgram
 {
 public:
-	ShaderProgram(const char* vsFilepath, const char* fsFilepath);
+	ShaderProgram(const char* vsFilepath, const char* fsFilepath, const std::vector<ShaderDefine>& defines = {});
 	ShaderProgram(const char* vsFilepath, const char* gsFilepath, const char* fsFilepath);
 	ShaderProgram(const char* vsFilepath, const char* tcsFilepath, const char* tesFilepath, const char* fsFilepath);
 
+	// Compute program, "defines" pick one kernel out of sources holding several of them.
+	ShaderProgram(const char* csFilepath, const std::vector<ShaderDefine>& defines = {});
+
 	void bind();
 	void unbind();
 
 	void setUniform1i(const char* uniformName, int data);
 	void setUniform1f(const char* uniformName, float data);
+	void setUniform2i(const char* uniformName, const glm::ivec2& data);
+	void setUniform2f(const char* uniformName, const glm::vec2& data);
 	void setUniform3f(const char* uniformName, const glm::vec3& data);
 	void setUniform4f(const char* uniformName, const glm::vec4& data);
 	void setUniformMatrix3fv(const char* uniformName, const glm::mat3& data);
 	void setUniformMatrix4fv(const char* uniformName, const glm::mat4& data);
 
+	// "uniformName" is any active uniform, array elements ("uLights[1]") and struct members ("uLights[1].color")
+	// included. Resolve handles at setup, setting them is a plain "glUniform*" call.
+	template <typename T>
+	UniformHandle<T> getUniformHandle(const char* uniformName)
+	{
+		UniformHandle<T> handle;
+		handle.location = getUniformLocation(uniformName, UniformTypeOf<T>::value);
+
+		return handle;
+	}
+
+	void setUniform(UniformHandle<int> handle, int data);
+	void setUniform(UniformHandle<float> handle, float data);
+	void setUniform(UniformHandle<glm::ivec2> handle, const glm::ivec2& data);
+	void setUniform(UniformHandle<glm::vec2> handle, const glm::vec2& data);
+	void setUniform(UniformHandle<glm::vec3> handle, const glm::vec3& data);
+	void setUniform(UniformHandle<glm::vec4> handle, const glm::vec4& data);
+	void setUniform(UniformHandle<glm::mat3> handle, const glm::mat3& data);
+	void setUniform(UniformHandle<glm::mat4> handle, const glm::mat4& data);
+
+	// Uniform blocks read from the buffer bound to "bindingPoint" (see "UBO::bindBase"), set once after linking.
+	void setUniformBlockBinding(const char* blockName, uint32_t bindingPoint);
+
+	// Size of the block as laid out by the driver, -1 when the program has no such block.
+	int getUniformBlockSize(const char* blockName);
+
+	// Hot-reload: "beginReload" reads the sources again and issues their compilation and linkage into a second program
+	// without waiting for them. "pollReload" swaps it in once it links, the current program stays in use meanwhile and
+	// is kept when the new one fails. Uniform locations may change: handles must be resolved again after a swap.
+	void beginReload();
+	void cancelReload();
+
+	// "nonBlocking" when the driver supports "GL_KHR_parallel_shader_compile", otherwise the status query waits for the driver.
+	ShaderReloadStatus pollReload(bool nonBlocking);
+
+	// Reload compiled on another context (see "ShaderReloader"): "prepareReload" reads the sources like "beginReload"
+	// and returns false when the program cache already has them ("pollReload" then swaps them in), otherwise the stages
+	// to build with "compileProgram", whose program is handed back to "adoptReload" once linked.
+	bool prepareReload(std::vector<GLenum>& stageTypes, std::vector<std::string>& sources);
+	void adoptReload(uint32_t programID, const std::vector<uint32_t>& shaderIDs);
+
+	// Issues the compilation and linkage of "sources" without reading any status.
+	static void compileProgram(const std::vector<GLenum>& stageTypes, const std::vector<std::string>& sources, uint32_t& programID, std::vector<uint32_t>& shaderIDs);
+
+	const std::vector<std::string>& getFilepaths() const;
+
+	// Every file read to build the program: the stage sources and what they include. Compiler logs refer to them by
+	// their index ("source string number" of the "#line" directives).
+	const std::vector<std::string>& getSourceFiles() const;
+
 	void clean();
 
 private:
+	struct ActiveUniform
+	{
+		std::string name;
+
+		int location;
+		GLenum type;
+	};
+
 	uint32_t ID;
 
-	std::map<std::string, int> uniformsLocations;
+	// Kept to compile the program again.
+	std::vector<GLenum> stageTypes;
+	std::vector<std::string> filepaths;
+	std::vector<ShaderDefine> defines;
+
+	std::vector<std::string> sourceFiles;
+
+	// Program being reloaded, zero when there is none.
+	uint32_t pendingID;
+	std::vector<uint32_t> pendingShaderIDs; // Empty when it was loaded from the cache.
+	uint64_t pendingKey;
+
+	std::vector<ActiveUniform> activeUniforms; // Reflected after linking, sorted by name.
+	std::set<std::string> missingUniforms; // Names already reported as not active.
+
+	void reflectUniforms();
+
+	int getUniformLocation(const char* uniformName, GLenum type = GL_NONE);
+
+	// Loads the program from "ProgramCache" when possible, otherwise compiles the sources and caches the result.
+	void createProgram(const std::vector<GLenum>& stageTypes, const std::vector<const char*>& filepaths, const std::vector<ShaderDefine>& defines = {});
+
+	// Sources go through a small preprocessor before reaching the driver: "#include "path"" (relative to the including
+	// file, each file included once per stage) is replaced by the file, with "#line" directives keeping compiler
+	// messages pointing at the original lines, and the defines are inserted after "#version".
+	std::vector<std::string> readShaderSources();
+	std::string readShaderSource(const char* filepath, const std::vector<ShaderDefine>& defines);
+	std::string expandIncludes(const std::string& filepath, std::set<std::string>& includedFiles);
 
-	int getUniformLocation(const char* uniformName);
+	int getSourceFileIndex(const std::string& filepath);
+	void printSourceFiles();
 
-	uint32_t createShader(const char* filepath, int shaderType);
+	uint32_t createShader(const std::string& sourceCode, int shaderType);
 };
@@ -0,0 +1,352 @@
+#include "shader_reloader.h"
+
+ShaderReloader::ShaderReloader() : programs(), writeTimes(), lastCheck(), parallelCompile(false), compileContext(), compileThread(), compileMutex(), compileAvailable(),
+	queuedJobs(), compiledJobs(), stoppingCompile(false), latestJobs(), nextJobIndex(0), startedReloads()
+{
+}
+
+ShaderReloader::~ShaderReloader()
+{
+	stopCompileThread();
+}
+
+void ShaderReloader::setup()
+{
+	int numberOfExtensions = 0;
+
+	glGetIntegerv(GL_NUM_EXTENSIONS, &numberOfExtensions);
+
+	for (int i = 0; i < numberOfExtensions; i++)
+	{
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+
+		// The ARB version defines the same query.
+		if (strcmp(extension, "GL_KHR_parallel_shader_compile") == 0 || strcmp(extension, "GL_ARB_parallel_shader_compile") == 0)
+		{
+			parallelCompile = true;
+		}
+	}
+
+	if (!parallelCompile && compileContext.create())
+	{
+		stoppingCompile = false;
+		compileThread = std::thread(&ShaderReloader::compileLoop, this);
+	}
+
+	lastCheck = std::chrono::steady_clock::now();
+}
+
+void ShaderReloader::clean()
+{
+	clear();
+
+	stopCompileThread();
+
+	// Objects are shared, the render context deletes what was compiled for nobody.
+	for (const CompileJob& job : compiledJobs)
+	{
+		deleteJobObjects(job);
+	}
+
+	compiledJobs.clear();
+
+	compileContext.destroy();
+}
+
+void ShaderReloader::watch(ShaderProgram* program)
+{
+	programs.push_back(program);
+
+	watchFiles(program);
+}
+
+void ShaderReloader::unwatch(ShaderProgram* program)
+{
+	std::vector<ShaderProgram*>::iterator it = std::find(programs.begin(), programs.end(), program);
+
+	if (it != programs.end())
+	{
+		program->cancelReload();
+		cancelJob(program);
+
+		programs.erase(it);
+	}
+}
+
+void ShaderReloader::clear()
+{
+	for (ShaderProgram* program : programs)
+	{
+		program->cancelReload();
+		cancelJob(program);
+	}
+
+	programs.clear();
+	writeTimes.clear();
+}
+
+bool ShaderReloader::update()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	startedReloads.clear();
+
+	if (std::chrono::duration<float>(now - lastCheck).count() >= CHECK_INTERVAL)
+	{
+		checkFiles();
+
+		lastCheck = now;
+	}
+
+	adoptCompiledJobs();
+
+	bool swapped = false;
+
+	for (ShaderProgram* program : programs)
+	{
+		// Reading the status right after issuing the compilation would wait for it in this very frame.
+		if (startedReloads.count(program) > 0)
+		{
+			continue;
+		}
+
+		// Adopted programs are already linked, the status is there without waiting.
+		ShaderReloadStatus status = program->pollReload(parallelCompile);
+
+		if (status == ShaderReloadStatus::SWAPPED)
+		{
+			std::cout << "Reloaded \"" << program->getFilepaths().back() << "\"." << std::endl;
+
+			// The new version may include other files.
+			watchFiles(program);
+
+			swapped = true;
+		}
+		else if (status == ShaderReloadStatus::FAILED)
+		{
+			std::cout << "[ERROR] SHADER RELOADER: Kept the previous version of \"" << program->getFilepaths().back() << "\"." << std::endl;
+		}
+	}
+
+	return swapped;
+}
+
+bool ShaderReloader::hasParallelCompile() const
+{
+	return parallelCompile;
+}
+
+bool ShaderReloader::hasCompileThread() const
+{
+	return compileThread.joinable();
+}
+
+void ShaderReloader::checkFiles()
+{
+	std::vector<std::string> changedFiles;
+
+	for (std::pair<const std::string, std::filesystem::file_time_type>& entry : writeTimes)
+	{
+		std::filesystem::file_time_type writeTime = getWriteTime(entry.first);
+
+		// Editors may remove the file for a moment while saving, it's checked again next time.
+		if (writeTime != std::filesystem::file_time_type::min() && writeTime != entry.second)
+		{
+			entry.second = writeTime;
+
+			changedFiles.push_back(entry.first);
+		}
+	}
+
+	for (ShaderProgram* program : programs)
+	{
+		const std::vector<std::string>& filepaths = program->getSourceFiles();
+
+		bool changed = std::any_of(filepaths.begin(), filepaths.end(), [&changedFiles](const std::string& filepath)
+		{
+			return std::find(changedFiles.begin(), changedFiles.end(), filepath) != changedFiles.end();
+		});
+
+		// Restarts a reload still in flight, its sources are outdated.
+		if (changed)
+		{
+			beginReload(program);
+		}
+	}
+}
+
+void ShaderReloader::watchFiles(ShaderProgram* program)
+{
+	for (const std::string& filepath : program->getSourceFiles())
+	{
+		if (writeTimes.find(filepath) == writeTimes.end())
+		{
+			writeTimes[filepath] = getWriteTime(filepath);
+		}
+	}
+}
+
+void ShaderReloader::beginReload(ShaderProgram* program)
+{
+	cancelJob(program);
+
+	if (parallelCompile)
+	{
+		program->beginReload();
+
+		return;
+	}
+
+	if (!compileThread.joinable())
+	{
+		program->beginReload();
+
+		startedReloads.insert(program);
+
+		return;
+	}
+
+	CompileJob job = { nextJobIndex++, {}, {}, 0, {} };
+
+	// Programs found in the cache have nothing to compile.
+	if (!program->prepareReload(job.stageTypes, job.sources))
+	{
+		return;
+	}
+
+	latestJobs[program] = job.index;
+
+	{
+		std::lock_guard<std::mutex> lock(compileMutex);
+
+		queuedJobs.push_back(std::move(job));
+	}
+
+	compileAvailable.notify_one();
+}
+
+void ShaderReloader::adoptCompiledJobs()
+{
+	std::vector<CompileJob> jobs;
+
+	{
+		std::lock_guard<std::mutex> lock(compileMutex);
+
+		jobs.swap(compiledJobs);
+	}
+
+	for (const CompileJob& job : jobs)
+	{
+		std::map<ShaderProgram*, uint64_t>::iterator it = std::find_if(latestJobs.begin(), latestJobs.end(),
+			[&job](const std::pair<ShaderProgram* const, uint64_t>& entry) { return entry.second == job.index; });
+
+		// Its program was edited again, unwatched or deleted meanwhile.
+		if (it == latestJobs.end())
+		{
+			deleteJobObjects(job);
+
+			continue;
+		}
+
+		it->first->adoptReload(job.programID, job.shaderIDs);
+
+		latestJobs.erase(it);
+	}
+}
+
+void ShaderReloader::cancelJob(ShaderProgram* program)
+{
+	std::map<ShaderProgram*, uint64_t>::iterator it = latestJobs.find(program);
+
+	if (it == latestJobs.end())
+	{
+		return;
+	}
+
+	uint64_t index = it->second;
+
+	latestJobs.erase(it);
+
+	// A job already compiling is deleted once it comes back.
+	std::lock_guard<std::mutex> lock(compileMutex);
+
+	queuedJobs.erase(std::remove_if(queuedJobs.begin(), queuedJobs.end(), [index](const CompileJob& job) { return job.index == index; }), queuedJobs.end());
+}
+
+void ShaderReloader::compileLoop()
+{
+	compileContext.makeCurrent();
+
+	while (true)
+	{
+		CompileJob job;
+
+		{
+			std::unique_lock<std::mutex> lock(compileMutex);
+
+			compileAvailable.wait(lock, [this]() { return stoppingCompile || !queuedJobs.empty(); });
+
+			if (stoppingCompile)
+			{
+				break;
+			}
+
+			job = std::move(queuedJobs.front());
+			queuedJobs.pop_front();
+		}
+
+		ShaderProgram::compileProgram(job.stageTypes, job.sources, job.programID, job.shaderIDs);
+
+		// The status query waits for the compiler here instead of in the render loop, and "glFinish" makes the
+		// finished objects visible to the render context.
+		int linked = 0;
+		glGetProgramiv(job.programID, GL_LINK_STATUS, &linked);
+
+		glFinish();
+
+		std::lock_guard<std::mutex> lock(compileMutex);
+
+		compiledJobs.push_back(std::move(job));
+	}
+
+	compileContext.releaseCurrent();
+}
+
+void ShaderReloader::stopCompileThread()
+{
+	if (!compileThread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(compileMutex);
+
+		stoppingCompile = true;
+	}
+
+	compileAvailable.notify_all();
+
+	compileThread.join();
+
+	queuedJobs.clear();
+	latestJobs.clear();
+}
+
+void ShaderReloader::deleteJobObjects(const CompileJob& job)
+{
+	for (uint32_t shaderID : job.shaderIDs)
+	{
+		glDeleteShader(shaderID);
+	}
+
+	glDeleteProgram(job.programID);
+}
+
+std::filesystem::file_time_type ShaderReloader::getWriteTime(const std::string& filepath)
+{
+	std::error_code error;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filepath, error);
+
+	return error ? std::filesystem::file_time_type::min() : writeTime;
+}
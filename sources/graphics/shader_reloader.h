@@ -0,0 +1,103 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <condition_variable>
+
+#include <glad/glad.h>
+
+#include "shader.h"
+#include "shared_context.h"
+
+// Recompiles watched programs when one of their source files (included ones too) changes on disk.
+//
+// Files are checked a few times per second by their write time. Changed programs are compiled and linked in the
+// background and swapped in once they link, so the render loop never waits for the compiler; a program that fails
+// keeps running its previous version. The driver compiles in the background with "GL_KHR_parallel_shader_compile",
+// otherwise a thread compiles on a context sharing the programs ("SharedContext"). Without either, a reload is only
+// polled from the frame after the one that issued it, which still waits on drivers that compile synchronously.
+//
+class ShaderReloader
+{
+public:
+	ShaderReloader();
+	~ShaderReloader(); // Joins the compile thread, "clean" also deletes its context and what it compiled.
+
+	// Needs a current context, to check for the extension and share it with the compile thread.
+	void setup();
+	void clean();
+
+	void watch(ShaderProgram* program);
+
+	// Forgets "program" (e.g. before it's deleted), cancelling its pending reload.
+	void unwatch(ShaderProgram* program);
+
+	// Forgets every program, cancelling their pending reloads (e.g. before their scene is cleaned).
+	void clear();
+
+	// Returns true when a program was swapped: its uniform handles, sampler units and block bindings must be set again.
+	bool update();
+
+	bool hasParallelCompile() const;
+	bool hasCompileThread() const;
+
+private:
+	static constexpr float CHECK_INTERVAL = 0.25f; // Seconds between file checks.
+
+	struct CompileJob
+	{
+		uint64_t index; // Only the latest job of a program is adopted, the others are outdated.
+
+		std::vector<GLenum> stageTypes;
+		std::vector<std::string> sources;
+
+		uint32_t programID;
+		std::vector<uint32_t> shaderIDs;
+	};
+
+	std::vector<ShaderProgram*> programs;
+	std::map<std::string, std::filesystem::file_time_type> writeTimes;
+
+	std::chrono::steady_clock::time_point lastCheck;
+
+	bool parallelCompile;
+
+	// Compile thread, only started without parallel compilation.
+	SharedContext compileContext;
+	std::thread compileThread;
+	std::mutex compileMutex;
+	std::condition_variable compileAvailable;
+	std::deque<CompileJob> queuedJobs;
+	std::vector<CompileJob> compiledJobs;
+	bool stoppingCompile;
+
+	std::map<ShaderProgram*, uint64_t> latestJobs; // Jobs queued or compiling, by program.
+	uint64_t nextJobIndex;
+
+	std::set<ShaderProgram*> startedReloads; // Issued by this "update" without any background compilation.
+
+	void checkFiles();
+	void watchFiles(ShaderProgram* program);
+
+	void beginReload(ShaderProgram* program);
+	void adoptCompiledJobs();
+	void cancelJob(ShaderProgram* program);
+
+	void compileLoop();
+	void stopCompileThread();
+
+	static void deleteJobObjects(const CompileJob& job);
+
+	static std::filesystem::file_time_type getWriteTime(const std::string& filepath);
+};
@@ -0,0 +1,106 @@
+#include "shader_variant_cache.h"
+
+ShaderVariantCache::ShaderVariantCache(const char* vsFilepath, const char* fsFilepath, int maxVariants)
+	: vsFilepath(vsFilepath), fsFilepath(fsFilepath), maxVariants(std::max(maxVariants, 1)), variants(), programs(), useCount(0), reloader(nullptr)
+{
+}
+
+ShaderProgram* ShaderVariantCache::get(const std::vector<ShaderDefine>& defines, bool* created)
+{
+	std::string key = getKey(defines);
+	std::map<std::string, Variant>::iterator it = variants.find(key);
+
+	if (created != nullptr)
+	{
+		*created = it == variants.end();
+	}
+
+	if (it != variants.end())
+	{
+		it->second.lastUse = ++useCount;
+
+		return it->second.program;
+	}
+
+	if (int(variants.size()) >= maxVariants)
+	{
+		evictLeastRecentlyUsed();
+	}
+
+	ShaderProgram* program = new ShaderProgram(vsFilepath.c_str(), fsFilepath.c_str(), defines);
+
+	variants[key] = { program, ++useCount };
+	programs.push_back(program);
+
+	if (reloader != nullptr)
+	{
+		reloader->watch(program);
+	}
+
+	return program;
+}
+
+void ShaderVariantCache::watch(ShaderReloader& reloader)
+{
+	for (ShaderProgram* program : programs)
+	{
+		reloader.watch(program);
+	}
+
+	this->reloader = &reloader;
+}
+
+const std::vector<ShaderProgram*>& ShaderVariantCache::getPrograms() const
+{
+	return programs;
+}
+
+int ShaderVariantCache::getMaxVariants() const
+{
+	return maxVariants;
+}
+
+void ShaderVariantCache::clean()
+{
+	for (ShaderProgram* program : programs)
+	{
+		program->clean();
+
+		delete program;
+	}
+
+	variants.clear();
+	programs.clear();
+}
+
+void ShaderVariantCache::evictLeastRecentlyUsed()
+{
+	std::map<std::string, Variant>::iterator oldest = std::min_element(variants.begin(), variants.end(),
+		[](const std::pair<const std::string, Variant>& a, const std::pair<const std::string, Variant>& b) { return a.second.lastUse < b.second.lastUse; });
+
+	ShaderProgram* program = oldest->second.program;
+
+	if (reloader != nullptr)
+	{
+		reloader->unwatch(program);
+	}
+
+	programs.erase(std::find(programs.begin(), programs.end(), program));
+	variants.erase(oldest);
+
+	program->clean();
+
+	delete program;
+}
+
+std::string ShaderVariantCache::getKey(const std::vector<ShaderDefine>& defines)
+{
+	std::string key;
+
+	for (const ShaderDefine& define : defines)
+	{
+		key += define.name + "=" + define.value + ";";
+	}
+
+	return key;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "shader.h"
+#include "shader_reloader.h"
+
+// Programs built from the same vertex and fragment sources with different defines.
+//
+// Each variant is compiled the first time it's asked for (or loaded by "ProgramCache") and kept, so going back to an
+// earlier configuration is free. Variants specialize a shader for what a scene actually uses: constants instead of
+// uniforms let the driver unroll loops and drop dead branches. At most "maxVariants" are kept, the least recently used
+// one is deleted to make room for a new one.
+//
+class ShaderVariantCache
+{
+public:
+	static const int DEFAULT_MAX_VARIANTS = 8;
+
+	ShaderVariantCache(const char* vsFilepath, const char* fsFilepath, int maxVariants = DEFAULT_MAX_VARIANTS);
+
+	// "created" is set when the variant was built by this call. The program stays valid until "maxVariants" other
+	// variants were asked for since.
+	ShaderProgram* get(const std::vector<ShaderDefine>& defines, bool* created = nullptr);
+
+	// Has "reloader" watch the variants kept now and the ones built later, and forget the deleted ones.
+	void watch(ShaderReloader& reloader);
+
+	const std::vector<ShaderProgram*>& getPrograms() const;
+	int getMaxVariants() const;
+
+	void clean();
+
+private:
+	struct Variant
+	{
+		ShaderProgram* program;
+
+		uint64_t lastUse;
+	};
+
+	std::string vsFilepath, fsFilepath;
+	int maxVariants;
+
+	std::map<std::string, Variant> variants; // Keyed by their defines.
+	std::vector<ShaderProgram*> programs; // In creation order.
+	uint64_t useCount;
+
+	ShaderReloader* reloader;
+
+	void evictLeastRecentlyUsed();
+
+	static std::string getKey(const std::vector<ShaderDefine>& defines);
+};
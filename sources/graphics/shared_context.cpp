@@ -0,0 +1,129 @@
+#include "shared_context.h"
+
+#ifdef _WIN32
+
+SharedContext::SharedContext() : window(nullptr)
+{
+}
+
+#else
+
+SharedContext::SharedContext() : window(nullptr), display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT)
+{
+}
+
+#endif
+
+bool SharedContext::create()
+{
+	int majorVersion = 0, minorVersion = 0;
+
+	glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+	glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+#ifndef _WIN32
+	EGLContext currentContext = eglGetCurrentContext();
+
+	if (currentContext != EGL_NO_CONTEXT)
+	{
+		display = eglGetCurrentDisplay();
+
+		EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+			EGL_CONTEXT_MINOR_VERSION, minorVersion,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+
+		// Like "HeadlessContext", nothing is ever drawn to a surface.
+		context = eglCreateContext(display, EGL_NO_CONFIG_KHR, currentContext, contextAttributes);
+
+		if (context == EGL_NO_CONTEXT)
+		{
+			std::cout << "[ERROR] SHARED CONTEXT: Failed to create an EGL context!" << std::endl;
+
+			display = EGL_NO_DISPLAY;
+
+			return false;
+		}
+
+		return true;
+	}
+#endif
+
+	GLFWwindow* currentWindow = glfwGetCurrentContext();
+
+	if (currentWindow == nullptr)
+	{
+		std::cout << "[ERROR] SHARED CONTEXT: No current context to share!" << std::endl;
+
+		return false;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, glfwGetWindowAttrib(currentWindow, GLFW_OPENGL_PROFILE));
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	window = glfwCreateWindow(1, 1, "", NULL, currentWindow);
+
+	// Later windows get the usual hints.
+	glfwDefaultWindowHints();
+
+	if (!window)
+	{
+		std::cout << "[ERROR] SHARED CONTEXT: Failed to create GLFW context!" << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+void SharedContext::makeCurrent()
+{
+#ifndef _WIN32
+	if (context != EGL_NO_CONTEXT)
+	{
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+
+		return;
+	}
+#endif
+
+	glfwMakeContextCurrent(window);
+}
+
+void SharedContext::releaseCurrent()
+{
+#ifndef _WIN32
+	if (context != EGL_NO_CONTEXT)
+	{
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+		return;
+	}
+#endif
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+void SharedContext::destroy()
+{
+#ifndef _WIN32
+	if (context != EGL_NO_CONTEXT)
+	{
+		eglDestroyContext(display, context);
+
+		display = EGL_NO_DISPLAY;
+		context = EGL_NO_CONTEXT;
+	}
+#endif
+
+	if (window != nullptr)
+	{
+		glfwDestroyWindow(window);
+
+		window = nullptr;
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <iostream>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// Hidden OpenGL context sharing the objects (programs, buffers, textures) of the context current where it is created,
+// to be made current on another thread, e.g. to compile programs without holding up the render loop.
+//
+// It follows the kind of the current context: a hidden GLFW window next to a GLFW one, or a surfaceless EGL context
+// next to the EGL context of "HeadlessContext" on Linux.
+//
+class SharedContext
+{
+public:
+	SharedContext();
+
+	// On the thread of the context to share, false when none is current or the driver refuses.
+	bool create();
+
+	// On the thread using it, at most one at a time.
+	void makeCurrent();
+	void releaseCurrent();
+
+	// On the creating thread, once no thread uses it anymore.
+	void destroy();
+
+private:
+	GLFWwindow* window;
+
+#ifndef _WIN32
+	EGLDisplay display;
+	EGLContext context;
+#endif
+};
@@ -0,0 +1,48 @@
+#include "texture.h"
+
+Texture::Texture(int width, int height, GLenum internalFormat, GLenum format, GLenum type, const void* data, GLenum filter, GLenum clampMode)
+	: ID(), width(width), height(height)
+{
+	glGenTextures(1, &ID);
+	glBindTexture(GL_TEXTURE_2D, ID);
+
+	// Rows of single channel data aren't 4 byte aligned in general.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clampMode);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clampMode);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::bind(int unit)
+{
+	if (unit >= 0 && unit <= 15)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, ID);
+	}
+	else
+	{
+		std::cout << "[ERROR] TEXTURE: Failed to bind texture in " << unit << " unit." << std::endl;
+	}
+}
+
+int Texture::getWidth() const
+{
+	return width;
+}
+
+int Texture::getHeight() const
+{
+	return height;
+}
+
+void Texture::clean()
+{
+	glDeleteTextures(1, &ID);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#include <glad/glad.h>
+
+// Immutable 2D texture uploaded once from host memory, e.g. lookup tables read with "texelFetch".
+class Texture
+{
+public:
+	// "format" and "type" describe "data", "internalFormat" the texture.
+	Texture(int width, int height, GLenum internalFormat, GLenum format, GLenum type, const void* data, GLenum filter = GL_NEAREST, GLenum clampMode = GL_REPEAT);
+
+	void bind(int unit);
+
+	int getWidth() const;
+	int getHeight() const;
+
+	void clean();
+
+private:
+	uint32_t ID;
+
+	int width, height;
+};
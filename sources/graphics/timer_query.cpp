@@ -0,0 +1,74 @@
+#include "timer_query.h"
+
+TimerQuery::TimerQuery(int numberOfQueries) : IDs(numberOfQueries), tags(numberOfQueries), beginTimes(numberOfQueries), first(0), count(0), active(false)
+{
+	glGenQueries(numberOfQueries, IDs.data());
+}
+
+bool TimerQuery::begin(int tag)
+{
+	if (count == int(IDs.size()))
+	{
+		return false;
+	}
+
+	int index = (first + count) % int(IDs.size());
+
+	glBeginQuery(GL_TIME_ELAPSED, IDs[index]);
+
+	tags[index] = tag;
+	beginTimes[index] = std::chrono::steady_clock::now();
+	active = true;
+
+	return true;
+}
+
+void TimerQuery::end()
+{
+	if (!active)
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+
+	count += 1;
+	active = false;
+}
+
+bool TimerQuery::retrieveResult(float& milliseconds, int& tag)
+{
+	while (count > 0)
+	{
+		int available = 0;
+		glGetQueryObjectiv(IDs[first], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available)
+		{
+			return false;
+		}
+
+		uint64_t nanoseconds = 0;
+		glGetQueryObjectui64v(IDs[first], GL_QUERY_RESULT, &nanoseconds);
+
+		std::chrono::duration<double, std::nano> sinceBegin = std::chrono::steady_clock::now() - beginTimes[first];
+
+		milliseconds = float(double(nanoseconds) / 1.0e6);
+		tag = tags[first];
+
+		first = (first + 1) % int(IDs.size());
+		count -= 1;
+
+		if (double(nanoseconds) <= sinceBegin.count())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TimerQuery::clean()
+{
+	glDeleteQueries(int(IDs.size()), IDs.data());
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+// GPU time of a range of commands ("GL_TIME_ELAPSED"), read back without stalling the pipeline.
+//
+// Results only arrive once the GPU caught up, usually a few frames later, so the query objects form a ring:
+// a measurement is skipped when all of them are still in flight, and finished ones are retrieved in submission order.
+//
+class TimerQuery
+{
+public:
+	TimerQuery(int numberOfQueries = 4);
+
+	// "tag" travels with the measurement (e.g. the amount of work it covers). Returns false when it is skipped.
+	bool begin(int tag = 0);
+	void end();
+
+	// Pops the oldest measurement if the GPU finished it. Measurements longer than the time since their "begin" can't
+	// be right and are dropped: Mesa llvmpipe loses the start of the first query of a context and reports the whole
+	// clock instead.
+	bool retrieveResult(float& milliseconds, int& tag);
+
+	void clean();
+
+private:
+	std::vector<uint32_t> IDs;
+	std::vector<int> tags;
+	std::vector<std::chrono::steady_clock::time_point> beginTimes;
+
+	int first, count; // Queries in flight, oldest first.
+
+	bool active;
+};
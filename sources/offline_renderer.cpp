@@ -0,0 +1,1170 @@
+#include "offline_renderer.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stbi/stb_image_write.h>
+
+bool OfflineRenderSettings::fromArguments(const Arguments& arguments, OfflineRenderSettings& settings)
+{
+	std::string sceneName = arguments.getString("--scene", "spheres");
+
+	settings.sceneName = sceneName;
+	settings.scenePath = arguments.getString("--scene-file", "");
+
+	if (!settings.scenePath.empty())
+	{
+		settings.sceneType = SceneTypes::SCENE_FILE;
+		settings.sceneName = settings.scenePath;
+	}
+	else if (sceneName == "spheres")
+	{
+		settings.sceneType = SceneTypes::SPHERES;
+	}
+	else if (sceneName == "spheres-wavefront")
+	{
+		settings.sceneType = SceneTypes::SPHERES_WAVEFRONT;
+	}
+	else
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Unknown scene \"" << sceneName << "\"." << std::endl;
+
+		return false;
+	}
+
+	std::string backendName = arguments.getString("--backend", "gpu");
+
+	if (backendName == "gpu")
+	{
+		settings.backend = RenderBackend::GPU;
+	}
+	else if (backendName == "cpu")
+	{
+		settings.backend = RenderBackend::CPU;
+	}
+	else
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Unknown backend \"" << backendName << "\"." << std::endl;
+
+		return false;
+	}
+
+	settings.threads = arguments.getInt("--threads", 0);
+	settings.simdLevel = CPUPathTracer::getPreferredSimdLevel();
+
+	if (arguments.has("--simd") && !parseSimdLevel(arguments.getString("--simd", ""), settings.simdLevel))
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Unknown SIMD level \"" << arguments.getString("--simd", "") << "\"." << std::endl;
+
+		return false;
+	}
+
+	settings.compare = arguments.has("--compare");
+
+	settings.width = arguments.getInt("--width", 1600);
+	settings.height = arguments.getInt("--height", 900);
+	settings.frames = arguments.getInt("--frames", 64);
+	settings.renderSettings.samplesPerPixel = arguments.getInt("--spp", 1);
+	settings.renderSettings.maxBounces = arguments.getInt("--bounces", 16);
+	settings.renderSettings.gpuTimeBudget = 0.0f; // Every frame is traced in full, so each one accumulates.
+	settings.renderSettings.specializeShaders = !arguments.has("--generic-shaders");
+	settings.renderSettings.dynamicBounces = false;
+	settings.renderSettings.adaptiveThreshold = arguments.getFloat("--adaptive", 0.0f);
+	settings.renderSettings.denoise = arguments.has("--denoise");
+	settings.renderSettings.resolutionScale = 1.0f; // The output image is read at the render resolution.
+	settings.renderSettings.rouletteDepth = arguments.getInt("--roulette", 0);
+	settings.renderSettings.restir = arguments.has("--restir");
+
+	std::string samplerName = arguments.getString("--sampler", "white");
+
+	if (samplerName == "white")
+	{
+		settings.renderSettings.samplerType = SamplerTypes::WHITE_NOISE;
+	}
+	else if (samplerName == "sobol")
+	{
+		settings.renderSettings.samplerType = SamplerTypes::SOBOL;
+	}
+	else if (samplerName == "blue")
+	{
+		settings.renderSettings.samplerType = SamplerTypes::BLUE_NOISE;
+	}
+	else
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Unknown sampler \"" << samplerName << "\"." << std::endl;
+
+		return false;
+	}
+
+	// Same defaults as the interactive camera.
+	settings.cameraPosition = arguments.getVec3("--camera", glm::vec3(0.0f, 4.0f, 4.0f));
+	settings.cameraYaw = arguments.getFloat("--yaw", -90.0f);
+	settings.cameraPitch = arguments.getFloat("--pitch", 0.0f);
+
+	settings.outputPath = arguments.getString("--output", "render.png");
+	settings.profilePath = arguments.getString("--profile-csv", "");
+
+	settings.benchmark = arguments.has("--benchmark");
+
+	// Benchmarks report Mrays/s, which the spheres tracer only knows while counting (its atomics cost some time).
+	settings.renderSettings.countRays = arguments.has("--ray-statistics") || (settings.benchmark && !arguments.has("--no-ray-statistics"));
+	settings.warmupFrames = settings.benchmark ? arguments.getInt("--warmup", 8) : 0;
+	settings.cameraPathFile = arguments.getString("--camera-path", "");
+	settings.benchmarkPath = arguments.getString("--json", "benchmark.json");
+	settings.label = arguments.getString("--label", "");
+	settings.writeImage = !settings.benchmark || arguments.has("--output");
+
+	settings.convergence = arguments.has("--convergence");
+	settings.referenceSamples = arguments.getInt("--reference-spp", 4096);
+	settings.convergencePath = arguments.getString("--csv", "convergence.csv");
+
+	settings.restirComparison = arguments.has("--restir-comparison");
+	settings.comparisonPath = arguments.getString("--csv", "restir.csv");
+
+	if (settings.warmupFrames < 0 || settings.width <= 0 || settings.height <= 0 || settings.frames <= 0 || settings.renderSettings.samplesPerPixel <= 0 || settings.renderSettings.maxBounces <= 0)
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Dimensions, frames, samples and bounces must be positive." << std::endl;
+
+		return false;
+	}
+
+	if (settings.renderSettings.rouletteDepth < 0)
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: The roulette depth can't be negative." << std::endl;
+
+		return false;
+	}
+
+	settings.meshPath = arguments.getString("--mesh", "");
+	settings.meshScale = arguments.getFloat("--mesh-scale", 1.0f);
+	settings.meshOffset = arguments.getVec3("--mesh-offset", glm::vec3(0.0f));
+
+	// Only the fragment tracer of the spheres scenes intersects triangles.
+	if (!settings.meshPath.empty() && (settings.sceneType == SceneTypes::SPHERES_WAVEFRONT || settings.backend == RenderBackend::CPU || settings.compare))
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Meshes are only rendered by the spheres and file scenes on the GPU backend, without \"--compare\"." << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+void OfflineRenderSettings::printUsage()
+{
+	std::cout << "Usage: OpenGLRayTracer --headless|--benchmark|--convergence|--restir-comparison [options]" << std::endl;
+	std::cout << "  --scene <name>      Scene to render, spheres or spheres-wavefront (spheres)." << std::endl;
+	std::cout << "  --scene-file <path> Renders a scene file (see \"--convert-scene\") instead of \"--scene\"." << std::endl;
+	std::cout << "  --backend <name>    Renderer, \"gpu\" or the \"cpu\" reference (gpu)." << std::endl;
+	std::cout << "  --threads <count>   CPU backend threads, 0 for all cores (0)." << std::endl;
+	std::cout << "  --simd <level>      CPU backend kernels: scalar, sse4, avx2 or avx512 (best up to avx2)." << std::endl;
+	std::cout << "  --compare           Also render the CPU reference and report the difference." << std::endl;
+	std::cout << "  --width <pixels>    Image width (1600)." << std::endl;
+	std::cout << "  --height <pixels>   Image height (900)." << std::endl;
+	std::cout << "  --frames <count>    Accumulated frames (64)." << std::endl;
+	std::cout << "  --spp <count>       Samples per pixel traced each frame (1)." << std::endl;
+	std::cout << "  --bounces <count>   Max ray bounces (16)." << std::endl;
+	std::cout << "  --generic-shaders   Don't specialize the fragment tracer for the scene and these settings." << std::endl;
+	std::cout << "  --adaptive <error>  Stops sampling pixels under this relative error (off), spheres scene only." << std::endl;
+	std::cout << "  --denoise           Filters the image with the a-trous denoiser, spheres scene only." << std::endl;
+	std::cout << "  --sampler <name>    Random numbers: white (PCG), sobol (Owen scrambled) or blue (noise), spheres scene only (white)." << std::endl;
+	std::cout << "  --roulette <depth>  Russian roulette past this many bounces, 0 traces every path to the end (0), spheres scene only." << std::endl;
+	std::cout << "  --ray-statistics    Counts the rays of every bounce and reports them, spheres scene only (on for \"--benchmark\")." << std::endl;
+	std::cout << "  --restir            Lights the camera hits with resampled reservoirs (ReSTIR DI), spheres scene only." << std::endl;
+	std::cout << "  --mesh <path>       Triangle mesh (\".obj\" or \".ply\") traced along the spheres, spheres scene on the GPU only." << std::endl;
+	std::cout << "  --mesh-scale <factor> Scale of the mesh (1)." << std::endl;
+	std::cout << "  --mesh-offset <x,y,z> Position of the mesh origin (0,0,0)." << std::endl;
+	std::cout << "  --camera <x,y,z>    Camera position (0,4,4)." << std::endl;
+	std::cout << "  --yaw <degrees>     Camera yaw (-90)." << std::endl;
+	std::cout << "  --pitch <degrees>   Camera pitch (0)." << std::endl;
+	std::cout << "  --output <path>     Output image, \".png\" or \".hdr\" (render.png)." << std::endl;
+	std::cout << "  --profile-csv <path> Write the GPU time of every pass and frame as CSV (GPU backend)." << std::endl;
+	std::cout << "  --no-program-cache  Always compile the shaders, without reading or writing \"" << ProgramCache::getDirectory() << "\"." << std::endl;
+	std::cout << "Benchmark (\"--benchmark\") options:" << std::endl;
+	std::cout << "  --camera-path <path> Keyframes replayed over the frames (an orbit around the scene)." << std::endl;
+	std::cout << "  --warmup <count>    Unmeasured frames rendered first (8)." << std::endl;
+	std::cout << "  --json <path>       Report with the frame time percentiles (benchmark.json)." << std::endl;
+	std::cout << "  --label <text>      Stored in the report, e.g. the commit being measured." << std::endl;
+	std::cout << "  --no-ray-statistics Doesn't count the rays of the spheres scene, the report then has no Mrays/s." << std::endl;
+	std::cout << "Convergence (\"--convergence\") options, RMSE of every sampler up to \"--frames\":" << std::endl;
+	std::cout << "  --reference-spp <count> Samples per pixel of the white noise reference (4096)." << std::endl;
+	std::cout << "  --csv <path>        Table of the RMSE at every power of two of frames (convergence.csv)." << std::endl;
+	std::cout << "ReSTIR comparison (\"--restir-comparison\") options, RMSE and GPU time without and with ReSTIR up to \"--frames\":" << std::endl;
+	std::cout << "  --reference-spp <count> Samples per pixel of the reference (4096)." << std::endl;
+	std::cout << "  --csv <path>        Table of the RMSE and time of every frame (restir.csv)." << std::endl;
+}
+
+OfflineRenderer::OfflineRenderer(const OfflineRenderSettings& settings) : settings(settings)
+{
+}
+
+int OfflineRenderer::run()
+{
+	if (settings.convergence)
+	{
+		return renderConvergence() ? 0 : -1;
+	}
+
+	if (settings.restirComparison)
+	{
+		return renderReSTIRComparison() ? 0 : -1;
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	if (!settings.cameraPathFile.empty())
+	{
+		if (!cameraPath.load(settings.cameraPathFile))
+		{
+			return -1;
+		}
+	}
+	else if (settings.benchmark)
+	{
+		cameraPath = CameraPath::createOrbit(glm::vec3(0.0f, 1.0f, 0.0f), 14.0f, 4.0f, 10.0f);
+	}
+
+	std::vector<float> pixels;
+	std::vector<float> frameTimes(settings.frames);
+	std::vector<float> gpuTimes;
+	std::vector<uint64_t> frameRays;
+	double raysPerSecond = 0.0;
+
+	bool rendered = settings.backend == RenderBackend::CPU ? renderCPU(pixels, frameTimes, frameRays, raysPerSecond) : renderGPU(pixels, frameTimes, gpuTimes, frameRays);
+
+	if (!rendered)
+	{
+		return -1;
+	}
+
+	if (settings.compare && settings.backend == RenderBackend::GPU)
+	{
+		std::vector<float> referencePixels;
+		std::vector<float> referenceFrameTimes(settings.frames);
+		std::vector<uint64_t> referenceFrameRays;
+		double rmse = 0.0, maxError = 0.0;
+
+		if (!renderCPU(referencePixels, referenceFrameTimes, referenceFrameRays, raysPerSecond))
+		{
+			return -1;
+		}
+
+		getImageError(pixels, referencePixels, rmse, maxError);
+
+		std::cout << "CPU reference: RMSE " << rmse << ", max error " << maxError << "." << std::endl;
+	}
+
+	bool written = !settings.writeImage || writeImage(pixels);
+
+	if (settings.benchmark)
+	{
+		written = writeBenchmark(frameTimes, gpuTimes, frameRays) && written;
+	}
+
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+	double renderSeconds = 0.0;
+
+	for (float frameTime : frameTimes)
+	{
+		renderSeconds += frameTime / 1000.0;
+	}
+
+	double wallSeconds = std::chrono::duration<double>(end - start).count();
+	double samples = double(settings.width) * settings.height * settings.renderSettings.samplesPerPixel * settings.frames;
+	double meanFrameTime = 1000.0 * renderSeconds / settings.frames;
+
+	std::cout << "Rendered " << settings.width << "x" << settings.height << ", " << settings.frames << " frames x " << settings.renderSettings.samplesPerPixel << " spp";
+	std::cout << " (" << settings.frames * settings.renderSettings.samplesPerPixel << " samples per pixel)." << std::endl;
+	std::cout << "Wall-clock: " << wallSeconds << " s (render " << renderSeconds << " s)." << std::endl;
+	std::cout << "Per-frame: mean " << meanFrameTime << " ms, min " << *std::min_element(frameTimes.begin(), frameTimes.end());
+	std::cout << " ms, max " << *std::max_element(frameTimes.begin(), frameTimes.end()) << " ms." << std::endl;
+	std::cout << "Throughput: " << samples / renderSeconds / 1.0e6 << " Msamples/s";
+
+	if (settings.backend == RenderBackend::CPU)
+	{
+		std::cout << ", " << raysPerSecond / 1.0e6 << " Mrays/s";
+	}
+
+	std::cout << "." << std::endl;
+
+	return written ? 0 : -1;
+}
+
+Camera OfflineRenderer::createCamera() const
+{
+	Camera camera(settings.cameraPosition, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), { float(settings.width) / float(settings.height) }, settings.cameraPitch, settings.cameraYaw);
+
+	camera.processRotation(0.0f, 0.0f, 0.0f); // Derives the direction from the Euler angles.
+
+	return camera;
+}
+
+Camera OfflineRenderer::createFrameCamera(int frame) const
+{
+	if (cameraPath.isEmpty())
+	{
+		return createCamera();
+	}
+
+	// The first and last frames sit on the ends of the path.
+	float time = cameraPath.getKeyframes().front().time + cameraPath.getDuration() * float(frame) / float(std::max(settings.frames - 1, 1));
+
+	return cameraPath.createCamera(time, float(settings.width) / float(settings.height));
+}
+
+bool OfflineRenderer::renderGPU(std::vector<float>& pixels, std::vector<float>& frameTimes, std::vector<float>& gpuTimes, std::vector<uint64_t>& frameRays)
+{
+	HeadlessContext context;
+
+	if (!context.create())
+	{
+		return false;
+	}
+
+	rendererName = std::string(reinterpret_cast<const char*>(glGetString(GL_RENDERER))) + " (" + reinterpret_cast<const char*>(glGetString(GL_VERSION)) + ")";
+
+	std::cout << "OpenGL: " << rendererName << std::endl;
+
+	glViewport(0, 0, settings.width, settings.height);
+
+	Scene* scene = Scene::create(settings.sceneType, settings.width, settings.height, settings.scenePath);
+
+	if (scene == nullptr)
+	{
+		context.destroy();
+
+		return false;
+	}
+
+	std::chrono::high_resolution_clock::time_point setupStart = std::chrono::high_resolution_clock::now();
+
+	ProgramCache::resetStatistics();
+
+	scene->setup();
+	scene->setRenderSettings(settings.renderSettings);
+
+	FileScene* fileScene = dynamic_cast<FileScene*>(scene);
+
+	if (fileScene != nullptr)
+	{
+		std::cout << "Scene file: " << fileScene->getFileSize() << " bytes loaded in " << fileScene->getLoadTime() << " ms." << std::endl;
+
+		printInstanceStatistics(*fileScene);
+	}
+
+	if (!loadMesh(*scene))
+	{
+		scene->clean();
+		delete scene;
+
+		context.destroy();
+
+		return false;
+	}
+
+	// There is no default framebuffer without a surface, so the presentation pass needs a target of its own.
+	FrameBuffer presentBuffer(settings.width, settings.height, 1, GL_RGBA8, GL_NEAREST, GL_CLAMP_TO_EDGE, DepthAndStencilType::NONE);
+
+	presentBuffer.bind();
+
+	// Make sure setup work (uploads, shader compilation) isn't billed to the first frame.
+	glFinish();
+
+	ProgramCache::printStatistics("Scene setup", std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - setupStart).count());
+
+	if (!settings.profilePath.empty())
+	{
+		GpuProfiler::setup();
+		GpuProfiler::startCapture(settings.profilePath);
+	}
+
+	// Rays of every bounce summed over the measured frames, the scene counts them per frame.
+	RayStatistics rayStatistics = { {}, 0 };
+
+	// Timestamps rather than a "GL_TIME_ELAPSED" query, which can't nest with the ones scenes issue themselves.
+	uint32_t frameQueryIDs[2];
+	glGenQueries(2, frameQueryIDs);
+
+	// Warmup frames stay on the first camera and aren't measured.
+	for (int i = -settings.warmupFrames; i < settings.frames; i++)
+	{
+		Camera camera = createFrameCamera(std::max(i, 0));
+
+		std::chrono::high_resolution_clock::time_point frameStart = std::chrono::high_resolution_clock::now();
+
+		GpuProfiler::beginFrame();
+		glQueryCounter(frameQueryIDs[0], GL_TIMESTAMP);
+
+		scene->update(0.0f);
+		scene->render(camera, 0.0f);
+
+		glQueryCounter(frameQueryIDs[1], GL_TIMESTAMP);
+		GpuProfiler::endFrame();
+
+		glFinish();
+
+		if (i < 0)
+		{
+			continue;
+		}
+
+		frameTimes[i] = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+
+		uint64_t frameBegin = 0, frameEnd = 0;
+
+		glGetQueryObjectui64v(frameQueryIDs[0], GL_QUERY_RESULT, &frameBegin);
+		glGetQueryObjectui64v(frameQueryIDs[1], GL_QUERY_RESULT, &frameEnd);
+
+		gpuTimes.push_back(float(double(frameEnd - frameBegin) / 1.0e6));
+		frameRays.push_back(scene->getTracedRays());
+
+		if (settings.renderSettings.countRays)
+		{
+			RayStatistics frameStatistics = scene->getRayStatistics();
+
+			rayStatistics.bounceRays.resize(std::max(rayStatistics.bounceRays.size(), frameStatistics.bounceRays.size()), 0);
+			rayStatistics.shadowRays += frameStatistics.shadowRays;
+
+			for (size_t bounce = 0; bounce < frameStatistics.bounceRays.size(); bounce++)
+			{
+				rayStatistics.bounceRays[bounce] += frameStatistics.bounceRays[bounce];
+			}
+		}
+	}
+
+	scene->readFrame(pixels);
+
+	if (settings.renderSettings.adaptiveThreshold > 0.0f)
+	{
+		SamplingStatistics statistics = scene->getSamplingStatistics();
+
+		std::cout << "Adaptive sampling: " << statistics.samples << " samples, " << statistics.uniformSamples << " uniform at equal error (";
+		std::cout << 100.0 * (1.0 - double(statistics.samples) / double(std::max(statistics.uniformSamples, uint64_t(1)))) << "% saved), ";
+		std::cout << statistics.convergedPixels << " / " << statistics.pixels << " pixels converged." << std::endl;
+	}
+
+	if (!rayStatistics.bounceRays.empty())
+	{
+		printRayStatistics(rayStatistics);
+	}
+
+	glDeleteQueries(2, frameQueryIDs);
+
+	// Scenes without ray statistics report zero.
+	if (std::all_of(frameRays.begin(), frameRays.end(), [](uint64_t rays) { return rays == 0; }))
+	{
+		frameRays.clear();
+	}
+
+	if (!settings.profilePath.empty())
+	{
+		GpuProfiler::finish();
+		GpuProfiler::stopCapture();
+		GpuProfiler::clean();
+	}
+
+	presentBuffer.clean();
+
+	scene->clean();
+	delete scene;
+
+	context.destroy();
+
+	return true;
+}
+
+bool OfflineRenderer::renderCPU(std::vector<float>& pixels, std::vector<float>& frameTimes, std::vector<uint64_t>& frameRays, double& raysPerSecond)
+{
+	std::vector<Sphere> spheres;
+	std::vector<PointLight> lights;
+	LightTable lightTable;
+	BVH bvh;
+
+	CPUPathTracer pathTracer(settings.threads);
+
+	pathTracer.setSimdLevel(settings.simdLevel);
+
+	// Leaves sized for the kernels, the GPU keeps its own hierarchy.
+	int primitivesPerTest = SphereKernels::get(pathTracer.getSimdLevel()).width;
+
+	glm::vec3 skyColor(0.5f, 0.7f, 1.0f); // Same sky as "SpheresScene".
+
+	switch (settings.sceneType)
+	{
+	case SceneTypes::SPHERES:
+	case SceneTypes::SPHERES_WAVEFRONT:
+		SpheresScene::createSpheres(spheres, lights);
+		SphereBVH::build(spheres, bvh, primitivesPerTest);
+		break;
+
+	case SceneTypes::SCENE_FILE:
+	{
+		SceneFile file;
+		size_t count = 0;
+
+		if (!file.open(settings.scenePath))
+		{
+			return false;
+		}
+
+		if (file.getSection<Instance>(SceneSection::INSTANCES, count) != nullptr)
+		{
+			std::cout << "[ERROR] OFFLINE RENDERER: The CPU backend doesn't trace instances." << std::endl;
+
+			return false;
+		}
+
+		skyColor = file.getSection<SceneSettings>(SceneSection::SETTINGS, count)->skyColor;
+
+		const Sphere* fileSpheres = file.getSection<Sphere>(SceneSection::SPHERES, count);
+		spheres.assign(fileSpheres, fileSpheres + count);
+
+		const PointLight* filePointLights = file.getSection<PointLight>(SceneSection::POINT_LIGHTS, count);
+		lights.assign(filePointLights, filePointLights + count);
+
+		// The hierarchy of the file has the leaves of the GPU.
+		SphereBVH::build(spheres, bvh, primitivesPerTest);
+		break;
+	}
+
+	default:
+		std::cout << "[ERROR] OFFLINE RENDERER: The CPU backend doesn't support this scene." << std::endl;
+
+		return false;
+	}
+
+	CPURenderSettings renderSettings = { skyColor, settings.renderSettings.maxBounces, settings.renderSettings.samplesPerPixel };
+	uint64_t rays = 0;
+	double renderSeconds = 0.0;
+
+	lightTable.build(spheres, lights);
+	pathTracer.setScene(spheres, lightTable, bvh.getNodes());
+
+	std::cout << "CPU: " << pathTracer.getNumberOfThreads() << " threads, " << CPUPathTracer::TILE_SIZE << "x" << CPUPathTracer::TILE_SIZE << " tiles, ";
+	std::cout << getSimdLevelName(pathTracer.getSimdLevel()) << " kernels." << std::endl;
+
+	rendererName = std::string("CPU, ") + std::to_string(pathTracer.getNumberOfThreads()) + " threads, " + getSimdLevelName(pathTracer.getSimdLevel());
+
+	for (int i = -settings.warmupFrames; i < settings.frames; i++)
+	{
+		// A moving camera restarts the accumulation every frame, like the GPU scenes do.
+		int frameIndex = cameraPath.isEmpty() ? std::max(i, 0) : 0;
+
+		pathTracer.render(createFrameCamera(std::max(i, 0)), renderSettings, settings.width, settings.height, frameIndex, pixels);
+
+		if (i < 0)
+		{
+			continue;
+		}
+
+		frameTimes[i] = pathTracer.getStatistics().renderTime;
+		frameRays.push_back(pathTracer.getStatistics().rays);
+
+		rays += pathTracer.getStatistics().rays;
+		renderSeconds += pathTracer.getStatistics().renderTime / 1000.0;
+	}
+
+	raysPerSecond = double(rays) / renderSeconds;
+
+	return true;
+}
+
+bool OfflineRenderer::renderConvergence()
+{
+	if (settings.backend != RenderBackend::GPU || settings.sceneType == SceneTypes::SPHERES_WAVEFRONT)
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: The convergence mode needs the GPU backend and the spheres (or a file) scene." << std::endl;
+
+		return false;
+	}
+
+	HeadlessContext context;
+
+	if (!context.create())
+	{
+		return false;
+	}
+
+	std::cout << "OpenGL: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+
+	glViewport(0, 0, settings.width, settings.height);
+
+	// Every sampler runs the same program (the sampler is a uniform of the generic one), so the images only differ by
+	// their samples.
+	RenderSettings renderSettings = settings.renderSettings;
+	renderSettings.specializeShaders = false;
+
+	std::vector<float> referencePixels;
+
+	bool rendered = renderReference(renderSettings, referencePixels);
+
+	const char* samplerNames[] = { "white", "sobol", "blue" };
+	const SamplerTypes samplerTypes[] = { SamplerTypes::WHITE_NOISE, SamplerTypes::SOBOL, SamplerTypes::BLUE_NOISE };
+
+	std::vector<int> measuredFrames;
+	std::vector<double> errors[3];
+
+	for (int frames = 1; frames < settings.frames; frames *= 2)
+	{
+		measuredFrames.push_back(frames);
+	}
+
+	measuredFrames.push_back(settings.frames);
+
+	for (int i = 0; i < 3 && rendered; i++)
+	{
+		renderSettings.samplerType = samplerTypes[i];
+
+		rendered = renderScene(renderSettings, settings.frames, [&](Scene& scene, int frames, float)
+		{
+			if (std::find(measuredFrames.begin(), measuredFrames.end(), frames) == measuredFrames.end())
+			{
+				return;
+			}
+
+			std::vector<float> pixels;
+			double rmse = 0.0, maxError = 0.0;
+
+			scene.readFrame(pixels);
+			clampPixels(pixels);
+			getImageError(pixels, referencePixels, rmse, maxError);
+
+			errors[i].push_back(rmse);
+		});
+	}
+
+	context.destroy();
+
+	if (!rendered)
+	{
+		return false;
+	}
+
+	std::ofstream file(settings.convergencePath);
+
+	if (!file.is_open())
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Failed to write \"" << settings.convergencePath << "\"." << std::endl;
+
+		return false;
+	}
+
+	file << "spp," << samplerNames[0] << "," << samplerNames[1] << "," << samplerNames[2] << "\n";
+
+	std::cout << "RMSE (spp: white, sobol, blue):" << std::endl;
+
+	for (size_t row = 0; row < measuredFrames.size(); row++)
+	{
+		int samples = measuredFrames[row] * settings.renderSettings.samplesPerPixel;
+
+		file << samples << "," << errors[0][row] << "," << errors[1][row] << "," << errors[2][row] << "\n";
+
+		std::cout << "  " << samples << ": " << errors[0][row] << ", " << errors[1][row] << ", " << errors[2][row] << std::endl;
+	}
+
+	file.close();
+
+	// Slope of the error over the samples on a log-log scale, -0.5 for plain Monte Carlo.
+	if (measuredFrames.size() > 1)
+	{
+		double logSamples = std::log(double(measuredFrames.back()) / double(measuredFrames.front()));
+
+		std::cout << "Convergence rate:";
+
+		for (int i = 0; i < 3; i++)
+		{
+			std::cout << " " << samplerNames[i] << " " << std::log(errors[i].back() / errors[i].front()) / logSamples;
+		}
+
+		std::cout << "." << std::endl;
+	}
+
+	std::cout << "Saved \"" << settings.convergencePath << "\"." << std::endl;
+
+	return true;
+}
+
+bool OfflineRenderer::renderReSTIRComparison()
+{
+	if (settings.backend != RenderBackend::GPU || settings.sceneType == SceneTypes::SPHERES_WAVEFRONT)
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: The ReSTIR comparison needs the GPU backend and the spheres (or a file) scene." << std::endl;
+
+		return false;
+	}
+
+	HeadlessContext context;
+
+	if (!context.create())
+	{
+		return false;
+	}
+
+	std::cout << "OpenGL: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+
+	glViewport(0, 0, settings.width, settings.height);
+
+	RenderSettings renderSettings = settings.renderSettings;
+	std::vector<float> referencePixels;
+
+	renderSettings.restir = false;
+
+	bool rendered = renderReference(renderSettings, referencePixels);
+
+	// Error and cumulated GPU time after every frame, without then with ReSTIR.
+	std::vector<double> errors[2];
+	std::vector<double> times[2];
+
+	for (int i = 0; i < 2 && rendered; i++)
+	{
+		double time = 0.0;
+
+		renderSettings.restir = i == 1;
+
+		rendered = renderScene(renderSettings, settings.frames, [&](Scene& scene, int, float frameTime)
+		{
+			std::vector<float> pixels;
+			double rmse = 0.0, maxError = 0.0;
+
+			scene.readFrame(pixels);
+			clampPixels(pixels);
+			getImageError(pixels, referencePixels, rmse, maxError);
+
+			time += frameTime;
+
+			errors[i].push_back(rmse);
+			times[i].push_back(time);
+		});
+	}
+
+	context.destroy();
+
+	if (!rendered)
+	{
+		return false;
+	}
+
+	std::ofstream file(settings.comparisonPath);
+
+	if (!file.is_open())
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Failed to write \"" << settings.comparisonPath << "\"." << std::endl;
+
+		return false;
+	}
+
+	file << "frames,time_ms,rmse,restir_time_ms,restir_rmse\n";
+
+	for (int frame = 0; frame < settings.frames; frame++)
+	{
+		file << frame + 1 << "," << times[0][frame] << "," << errors[0][frame] << "," << times[1][frame] << "," << errors[1][frame] << "\n";
+	}
+
+	file.close();
+
+	// Frames of each side that fit in the GPU time of the whole other side, at least one.
+	auto getFramesWithin = [&](int side, double time)
+	{
+		int frames = 1;
+
+		while (frames < settings.frames && times[side][frames] <= time)
+		{
+			frames++;
+		}
+
+		return frames;
+	};
+
+	int baselineFrames = getFramesWithin(0, times[1].back());
+	int restirFrames = getFramesWithin(1, times[0].back());
+
+	std::cout << "Without ReSTIR: " << settings.frames << " frames, " << times[0].back() << " ms, RMSE " << errors[0].back() << "." << std::endl;
+	std::cout << "With ReSTIR:    " << settings.frames << " frames, " << times[1].back() << " ms, RMSE " << errors[1].back() << "." << std::endl;
+
+	// Whichever side is cheaper per frame gets the frames the other one needed the time of.
+	if (restirFrames < settings.frames)
+	{
+		std::cout << "Equal time (" << times[0].back() << " ms): " << restirFrames << " ReSTIR frames, RMSE " << errors[1][restirFrames - 1];
+		std::cout << " vs " << errors[0].back() << " (" << 100.0 * (1.0 - errors[1][restirFrames - 1] / errors[0].back()) << "% lower)." << std::endl;
+	}
+	else
+	{
+		std::cout << "Equal time (" << times[1].back() << " ms): " << baselineFrames << " frames without ReSTIR, RMSE " << errors[0][baselineFrames - 1];
+		std::cout << " vs " << errors[1].back() << " (" << 100.0 * (1.0 - errors[1].back() / errors[0][baselineFrames - 1]) << "% lower)." << std::endl;
+	}
+
+	std::cout << "Saved \"" << settings.comparisonPath << "\"." << std::endl;
+
+	return true;
+}
+
+bool OfflineRenderer::renderReference(const RenderSettings& renderSettings, std::vector<float>& referencePixels)
+{
+	// The reference draws white noise, many samples per frame: only the first sample of each of its frames repeats the
+	// seed of a measured white noise sample, a sixty-fourth of the reference.
+	const int referenceSamplesPerFrame = 64;
+
+	RenderSettings referenceSettings = renderSettings;
+	referenceSettings.samplesPerPixel = referenceSamplesPerFrame;
+	referenceSettings.samplerType = SamplerTypes::WHITE_NOISE;
+	referenceSettings.adaptiveThreshold = 0.0f;
+	referenceSettings.denoise = false;
+	referenceSettings.restir = false;
+
+	int referenceFrames = std::max(settings.referenceSamples / referenceSamplesPerFrame, 1);
+
+	std::cout << "Reference: " << referenceFrames * referenceSamplesPerFrame << " samples per pixel." << std::endl;
+
+	bool rendered = renderScene(referenceSettings, referenceFrames, [&](Scene& scene, int frames, float)
+	{
+		if (frames == referenceFrames)
+		{
+			scene.readFrame(referencePixels);
+		}
+	});
+
+	clampPixels(referencePixels);
+
+	return rendered;
+}
+
+bool OfflineRenderer::loadMesh(Scene& scene)
+{
+	SpheresScene* spheresScene = dynamic_cast<SpheresScene*>(&scene);
+
+	if (settings.meshPath.empty() || spheresScene == nullptr)
+	{
+		return true;
+	}
+
+	glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.0f), settings.meshOffset), glm::vec3(settings.meshScale));
+
+	if (!spheresScene->loadMesh(settings.meshPath, transform))
+	{
+		return false;
+	}
+
+	const MeshStatistics& statistics = spheresScene->getMeshStatistics();
+
+	std::cout << "Mesh: " << statistics.triangleCount << " triangles, " << statistics.vertexCount << " vertices, loaded in " << statistics.loadTime;
+	std::cout << " ms, BVH built in " << statistics.buildTime << " ms." << std::endl;
+
+	printInstanceStatistics(*spheresScene);
+
+	return true;
+}
+
+void OfflineRenderer::printInstanceStatistics(const SpheresScene& scene)
+{
+	const InstanceStatistics& statistics = scene.getInstanceStatistics();
+
+	if (statistics.instanceCount == 0)
+	{
+		return;
+	}
+
+	std::cout << "Instances: " << statistics.instanceCount << " of " << statistics.meshCount << " meshes (" << statistics.triangleCount << " triangles), ";
+	std::cout << statistics.geometryBytes << " bytes of meshes and " << statistics.instanceBytes << " bytes of instances, BVH built in " << statistics.buildTime << " ms." << std::endl;
+}
+
+bool OfflineRenderer::renderScene(const RenderSettings& renderSettings, int frames, const std::function<void(Scene&, int, float)>& onFrame)
+{
+	Scene* scene = Scene::create(settings.sceneType, settings.width, settings.height, settings.scenePath);
+
+	if (scene == nullptr)
+	{
+		return false;
+	}
+
+	scene->setup();
+	scene->setRenderSettings(renderSettings);
+
+	if (!loadMesh(*scene))
+	{
+		scene->clean();
+		delete scene;
+
+		return false;
+	}
+
+	FrameBuffer presentBuffer(settings.width, settings.height, 1, GL_RGBA8, GL_NEAREST, GL_CLAMP_TO_EDGE, DepthAndStencilType::NONE);
+
+	presentBuffer.bind();
+
+	Camera camera = createCamera();
+
+	// Timestamps, like "renderGPU", so shader compilation on the first frames isn't measured.
+	uint32_t frameQueryIDs[2];
+	glGenQueries(2, frameQueryIDs);
+
+	for (int i = 0; i < frames; i++)
+	{
+		glQueryCounter(frameQueryIDs[0], GL_TIMESTAMP);
+
+		scene->update(0.0f);
+		scene->render(camera, 0.0f);
+
+		glQueryCounter(frameQueryIDs[1], GL_TIMESTAMP);
+
+		// Long runs would otherwise queue frames faster than the GPU traces them.
+		glFinish();
+
+		uint64_t frameBegin = 0, frameEnd = 0;
+
+		glGetQueryObjectui64v(frameQueryIDs[0], GL_QUERY_RESULT, &frameBegin);
+		glGetQueryObjectui64v(frameQueryIDs[1], GL_QUERY_RESULT, &frameEnd);
+
+		onFrame(*scene, i + 1, float(double(frameEnd - frameBegin) / 1.0e6));
+	}
+
+	glDeleteQueries(2, frameQueryIDs);
+
+	presentBuffer.clean();
+
+	scene->clean();
+	delete scene;
+
+	return true;
+}
+
+bool OfflineRenderer::writeImage(const std::vector<float>& pixels)
+{
+	int pixelCount = settings.width * settings.height;
+	bool hdr = settings.outputPath.size() >= 4 && settings.outputPath.compare(settings.outputPath.size() - 4, 4, ".hdr") == 0;
+	int result = 0;
+
+	// OpenGL rows are bottom-up.
+	stbi_flip_vertically_on_write(1);
+
+	if (hdr)
+	{
+		std::vector<float> rgb(size_t(pixelCount) * 3);
+
+		for (int i = 0; i < pixelCount; i++)
+		{
+			rgb[i * 3 + 0] = pixels[i * 4 + 0];
+			rgb[i * 3 + 1] = pixels[i * 4 + 1];
+			rgb[i * 3 + 2] = pixels[i * 4 + 2];
+		}
+
+		result = stbi_write_hdr(settings.outputPath.c_str(), settings.width, settings.height, 3, rgb.data());
+	}
+	else
+	{
+		std::vector<unsigned char> rgb(size_t(pixelCount) * 3);
+
+		// Same gamma correction as "present.frag".
+		for (int i = 0; i < pixelCount * 3; i++)
+		{
+			float value = std::pow(std::clamp(pixels[(i / 3) * 4 + i % 3], 0.0f, 1.0f), 1.0f / 2.2f);
+
+			rgb[i] = (unsigned char)(value * 255.0f + 0.5f);
+		}
+
+		result = stbi_write_png(settings.outputPath.c_str(), settings.width, settings.height, 3, rgb.data(), settings.width * 3);
+	}
+
+	if (result == 0)
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Failed to write \"" << settings.outputPath << "\"." << std::endl;
+
+		return false;
+	}
+
+	std::cout << "Saved \"" << settings.outputPath << "\"." << std::endl;
+
+	return true;
+}
+
+bool OfflineRenderer::writeBenchmark(const std::vector<float>& frameTimes, const std::vector<float>& gpuTimes, const std::vector<uint64_t>& frameRays)
+{
+	std::ofstream file(settings.benchmarkPath);
+
+	if (!file.is_open())
+	{
+		std::cout << "[ERROR] OFFLINE RENDERER: Failed to write \"" << settings.benchmarkPath << "\"." << std::endl;
+
+		return false;
+	}
+
+	// Quotes and backslashes are the only characters labels and paths are expected to need escaped.
+	auto quote = [](const std::string& text)
+	{
+		std::string result = "\"";
+
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				result += '\\';
+			}
+
+			result += c;
+		}
+
+		return result + "\"";
+	};
+
+	auto writeTimes = [&](const char* name, const std::vector<float>& times)
+	{
+		file << "\t\"" << name << "\": ";
+
+		if (times.empty())
+		{
+			file << "null,\n";
+
+			return;
+		}
+
+		double sum = 0.0;
+
+		for (float time : times)
+		{
+			sum += time;
+		}
+
+		file << "{ \"mean\": " << sum / double(times.size()) << ", \"p50\": " << getPercentile(times, 50.0f) << ", \"p95\": " << getPercentile(times, 95.0f);
+		file << ", \"p99\": " << getPercentile(times, 99.0f) << ", \"min\": " << *std::min_element(times.begin(), times.end());
+		file << ", \"max\": " << *std::max_element(times.begin(), times.end()) << " },\n";
+	};
+
+	double frameSeconds = 0.0, gpuSeconds = 0.0;
+	uint64_t rays = 0;
+
+	for (float frameTime : frameTimes)
+	{
+		frameSeconds += frameTime / 1000.0;
+	}
+
+	for (float gpuTime : gpuTimes)
+	{
+		gpuSeconds += gpuTime / 1000.0;
+	}
+
+	for (uint64_t frameRay : frameRays)
+	{
+		rays += frameRay;
+	}
+
+	// Rays are divided by the time the device spent tracing them: GPU time when measured, CPU frame time otherwise.
+	double traceSeconds = gpuTimes.empty() ? frameSeconds : gpuSeconds;
+	double samples = double(settings.width) * settings.height * settings.renderSettings.samplesPerPixel * settings.frames;
+
+	file << "{\n";
+	file << "\t\"label\": " << quote(settings.label) << ",\n";
+	file << "\t\"scene\": " << quote(settings.sceneName) << ",\n";
+	file << "\t\"backend\": " << quote(settings.backend == RenderBackend::CPU ? "cpu" : "gpu") << ",\n";
+	file << "\t\"renderer\": " << quote(rendererName) << ",\n";
+	file << "\t\"width\": " << settings.width << ",\n";
+	file << "\t\"height\": " << settings.height << ",\n";
+	file << "\t\"samples_per_pixel\": " << settings.renderSettings.samplesPerPixel << ",\n";
+	file << "\t\"max_bounces\": " << settings.renderSettings.maxBounces << ",\n";
+	file << "\t\"restir\": " << (settings.renderSettings.restir ? "true" : "false") << ",\n";
+	file << "\t\"ray_statistics\": " << (settings.renderSettings.countRays ? "true" : "false") << ",\n";
+	file << "\t\"frames\": " << settings.frames << ",\n";
+	file << "\t\"warmup_frames\": " << settings.warmupFrames << ",\n";
+	file << "\t\"camera_path\": " << (settings.cameraPathFile.empty() ? (cameraPath.isEmpty() ? "null" : quote("orbit")) : quote(settings.cameraPathFile)) << ",\n";
+
+	writeTimes("frame_time_ms", frameTimes);
+	writeTimes("gpu_time_ms", gpuTimes);
+
+	file << "\t\"msamples_per_second\": " << samples / frameSeconds / 1.0e6 << ",\n";
+	file << "\t\"mrays_per_second\": ";
+
+	if (rays > 0)
+	{
+		file << double(rays) / traceSeconds / 1.0e6 << "\n";
+	}
+	else
+	{
+		file << "null\n";
+	}
+
+	file << "}\n";
+
+	file.close();
+
+	std::cout << "Benchmark: frame time p50 " << getPercentile(frameTimes, 50.0f) << " ms, p95 " << getPercentile(frameTimes, 95.0f) << " ms, p99 ";
+	std::cout << getPercentile(frameTimes, 99.0f) << " ms";
+
+	if (rays > 0)
+	{
+		std::cout << ", " << double(rays) / traceSeconds / 1.0e6 << " Mrays/s";
+	}
+
+	std::cout << "." << std::endl;
+
+	if (rays == 0)
+	{
+		std::cout << "[WARNING] OFFLINE RENDERER: No rays were counted, \"mrays_per_second\" is null (see \"--no-ray-statistics\")." << std::endl;
+	}
+
+	std::cout << "Saved \"" << settings.benchmarkPath << "\"." << std::endl;
+
+	return true;
+}
+
+void OfflineRenderer::printRayStatistics(const RayStatistics& statistics)
+{
+	// Every sample traces a camera ray, so the first bounce counts the samples.
+	uint64_t samples = std::max(statistics.bounceRays[0], uint64_t(1));
+	uint64_t extensionRays = 0;
+
+	std::cout << "Rays per bounce (percent of the samples still traced):" << std::endl;
+
+	for (size_t bounce = 0; bounce < statistics.bounceRays.size(); bounce++)
+	{
+		extensionRays += statistics.bounceRays[bounce];
+
+		std::cout << "  " << bounce << ": " << statistics.bounceRays[bounce] << " (" << 100.0 * double(statistics.bounceRays[bounce]) / double(samples) << "%)" << std::endl;
+	}
+
+	std::cout << "Rays: " << extensionRays << " extension, " << statistics.shadowRays << " shadow, " << double(extensionRays + statistics.shadowRays) / double(samples);
+	std::cout << " per sample (mean path length " << double(extensionRays) / double(samples) << " bounces)." << std::endl;
+}
+
+float OfflineRenderer::getPercentile(std::vector<float> values, float percentile)
+{
+	if (values.empty())
+	{
+		return 0.0f;
+	}
+
+	// Smallest value with at least "percentile" percent of the values at or below it.
+	size_t rank = size_t(std::ceil(percentile / 100.0f * float(values.size())));
+	size_t index = std::clamp(rank, size_t(1), values.size()) - 1;
+
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+
+	return values[index];
+}
+
+void OfflineRenderer::clampPixels(std::vector<float>& pixels)
+{
+	for (float& value : pixels)
+	{
+		value = std::min(value, 1.0f);
+	}
+}
+
+void OfflineRenderer::getImageError(const std::vector<float>& pixels, const std::vector<float>& referencePixels, double& rmse, double& maxError)
+{
+	double sumSquaredError = 0.0;
+
+	maxError = 0.0;
+
+	for (size_t i = 0; i < pixels.size(); i++)
+	{
+		// Alpha is always one.
+		if (i % 4 == 3)
+		{
+			continue;
+		}
+
+		double error = std::abs(double(pixels[i]) - double(referencePixels[i]));
+
+		sumSquaredError += error * error;
+		maxError = std::max(maxError, error);
+	}
+
+	rmse = std::sqrt(sumSquaredError / (double(pixels.size()) * 0.75));
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "camera.h"
+#include "camera_path.h"
+#include "scene.h"
+
+#include "graphics/framebuffer.h"
+#include "graphics/gpu_profiler.h"
+#include "graphics/program_cache.h"
+#include "graphics/headless_context.h"
+#include "scenes/file_scene.h"
+#include "scenes/spheres_scene.h"
+#include "scenes/wavefront_scene.h"
+#include "tracing/cpu_path_tracer.h"
+#include "utils/arguments.h"
+
+enum class RenderBackend { GPU, CPU };
+
+struct OfflineRenderSettings
+{
+	SceneTypes sceneType;
+	std::string sceneName; // As given to "--scene", or the path of the scene file.
+	std::string scenePath; // Scene file of "SceneTypes::SCENE_FILE".
+	RenderBackend backend;
+
+	int threads; // CPU backend workers, zero uses every hardware thread.
+	SimdLevel simdLevel; // CPU backend kernels, capped to what the processor supports.
+	bool compare; // Also renders the CPU reference and reports how far the GPU image is from it.
+
+	int width, height, frames;
+
+	RenderSettings renderSettings;
+
+	glm::vec3 cameraPosition;
+	float cameraYaw, cameraPitch;
+
+	std::string outputPath; // ".png" (gamma corrected) or ".hdr" (linear radiance).
+	std::string profilePath; // GPU timings of every frame as CSV, empty when not profiled.
+
+	// Benchmark mode: every frame is rendered from the next point of "cameraPathFile" (a default orbit when empty),
+	// after "warmupFrames" unmeasured ones, and the frame time percentiles are written as JSON to "benchmarkPath".
+	bool benchmark;
+	int warmupFrames;
+	std::string cameraPathFile, benchmarkPath, label;
+
+	bool writeImage; // Benchmarks only write the image when "--output" is given.
+
+	// Convergence mode: the RMSE of every sampler against a high sample count reference, after each power of two of
+	// frames (up to "frames"), written as CSV to "convergencePath".
+	bool convergence;
+	int referenceSamples;
+	std::string convergencePath;
+
+	// ReSTIR comparison mode: the same reference, then the RMSE of "frames" frames without and with ReSTIR DI, and of
+	// both at the same GPU time. Every frame is written as CSV to "comparisonPath".
+	bool restirComparison;
+	std::string comparisonPath;
+
+	// Triangle mesh (OBJ or PLY) traced along the spheres, scaled by "meshScale" then moved by "meshOffset". Empty
+	// renders the spheres alone.
+	std::string meshPath;
+	float meshScale;
+	glm::vec3 meshOffset;
+
+	static bool fromArguments(const Arguments& arguments, OfflineRenderSettings& settings);
+	static void printUsage();
+};
+
+// Renders a scene without a window and writes the accumulated image to disk, e.g. on render nodes without a display.
+class OfflineRenderer
+{
+public:
+	OfflineRenderer(const OfflineRenderSettings& settings);
+
+	int run();
+
+private:
+	OfflineRenderSettings settings;
+
+	CameraPath cameraPath; // Empty renders every frame from the static camera.
+	std::string rendererName;
+
+	Camera createCamera() const;
+	Camera createFrameCamera(int frame) const;
+
+	// "gpuTimes" and "frameRays" are left empty when the backend doesn't measure them.
+	bool renderGPU(std::vector<float>& pixels, std::vector<float>& frameTimes, std::vector<float>& gpuTimes, std::vector<uint64_t>& frameRays);
+	bool renderCPU(std::vector<float>& pixels, std::vector<float>& frameTimes, std::vector<uint64_t>& frameRays, double& raysPerSecond);
+
+	// Sampler comparison of the convergence mode.
+	bool renderConvergence();
+
+	// Direct lighting comparison of the ReSTIR mode.
+	bool renderReSTIRComparison();
+
+	// Loads the mesh of the settings into a new GPU scene, if any, and reports its timings.
+	bool loadMesh(Scene& scene);
+
+	// Instances of the scene with the memory they take, nothing without any.
+	static void printInstanceStatistics(const SpheresScene& scene);
+
+	// White noise image of "referenceSamples" samples per pixel, clamped like the images it is compared with.
+	// Needs a current context.
+	bool renderReference(const RenderSettings& renderSettings, std::vector<float>& referencePixels);
+
+	// Renders "frames" frames of a new GPU scene from the static camera, "onFrame" gets the number of frames so far and
+	// the GPU time of the last one in milliseconds. Needs a current context.
+	bool renderScene(const RenderSettings& renderSettings, int frames, const std::function<void(Scene&, int, float)>& onFrame);
+
+	bool writeImage(const std::vector<float>& pixels);
+	bool writeBenchmark(const std::vector<float>& frameTimes, const std::vector<float>& gpuTimes, const std::vector<uint64_t>& frameRays);
+
+	// Ray counts of every bounce, and the work per sample they add up to.
+	static void printRayStatistics(const RayStatistics& statistics);
+
+	// Nearest-rank percentile, "percentile" in [0, 100].
+	static float getPercentile(std::vector<float> values, float percentile);
+
+	// Images are compared in the displayed range, the rare unbounded fireflies (e.g. caustics of the glass spheres)
+	// would otherwise make the error of the reference itself dominate the measurement.
+	static void clampPixels(std::vector<float>& pixels);
+
+	// Over the color channels of RGBA pixels.
+	static void getImageError(const std::vector<float>& pixels, const std::vector<float>& referencePixels, double& rmse, double& maxError);
+};
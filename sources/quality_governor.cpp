@@ -0,0 +1,160 @@
+#include "quality_governor.h"
+
+QualityGovernor::QualityGovernor()
+	: level({ 1.0f, 1, 1 }), maximumLevel({ 1.0f, 1, 1 }), minimumLevel({ 1.0f, 1, 1 }), targetFrameTime(16.6f), averageFrameTime(0.0f),
+	  lastMeasuredFrame(0), changeFrame(0), framesOver(0), framesUnder(0)
+{
+}
+
+void QualityGovernor::setLimits(const QualityLevel& maximum, const QualityLevel& minimum)
+{
+	maximumLevel = maximum;
+
+	// The minimum never exceeds the maximum, e.g. a single bounce stays single.
+	minimumLevel.resolutionScale = std::min(minimum.resolutionScale, maximum.resolutionScale);
+	minimumLevel.samplesPerPixel = std::min(minimum.samplesPerPixel, maximum.samplesPerPixel);
+	minimumLevel.maxBounces = std::min(minimum.maxBounces, maximum.maxBounces);
+
+	reset();
+}
+
+void QualityGovernor::setTargetFrameTime(float milliseconds)
+{
+	targetFrameTime = std::max(milliseconds, 1.0f);
+
+	framesOver = 0;
+	framesUnder = 0;
+}
+
+bool QualityGovernor::update(float frameTime, uint64_t measuredFrame, uint64_t currentFrame)
+{
+	// The profiler repeats its latest measurement until a newer frame is retrieved, and frames of the previous level
+	// say nothing about this one.
+	if (frameTime < 0.0f || measuredFrame <= lastMeasuredFrame || measuredFrame <= changeFrame)
+	{
+		return false;
+	}
+
+	lastMeasuredFrame = measuredFrame;
+	averageFrameTime = averageFrameTime == 0.0f ? frameTime : averageFrameTime + 0.2f * (frameTime - averageFrameTime);
+
+	framesOver = averageFrameTime > targetFrameTime * (1.0f + HYSTERESIS) ? framesOver + 1 : 0;
+
+	QualityLevel nextLevel = level;
+
+	if (framesOver >= LOWER_FRAMES)
+	{
+		// As many steps as the cost model predicts, a camera move into a heavy view shouldn't take seconds to settle.
+		while (averageFrameTime * getCost(nextLevel) / getCost(level) > targetFrameTime && lower(nextLevel))
+		{
+		}
+	}
+	else
+	{
+		QualityLevel raisedLevel = level;
+
+		bool fits = raise(raisedLevel) && averageFrameTime * getCost(raisedLevel) / getCost(level) < targetFrameTime * (1.0f - HYSTERESIS);
+
+		framesUnder = fits ? framesUnder + 1 : 0;
+
+		if (framesUnder >= RAISE_FRAMES)
+		{
+			nextLevel = raisedLevel;
+		}
+	}
+
+	if (nextLevel.resolutionScale == level.resolutionScale && nextLevel.samplesPerPixel == level.samplesPerPixel && nextLevel.maxBounces == level.maxBounces)
+	{
+		return false;
+	}
+
+	level = nextLevel;
+	averageFrameTime = 0.0f;
+	changeFrame = currentFrame;
+	framesOver = 0;
+	framesUnder = 0;
+
+	return true;
+}
+
+void QualityGovernor::reset()
+{
+	level = maximumLevel;
+	averageFrameTime = 0.0f;
+	lastMeasuredFrame = 0;
+	changeFrame = 0;
+	framesOver = 0;
+	framesUnder = 0;
+}
+
+const QualityLevel& QualityGovernor::getLevel() const
+{
+	return level;
+}
+
+const QualityLevel& QualityGovernor::getMaximumLevel() const
+{
+	return maximumLevel;
+}
+
+float QualityGovernor::getTargetFrameTime() const
+{
+	return targetFrameTime;
+}
+
+float QualityGovernor::getAverageFrameTime() const
+{
+	return averageFrameTime;
+}
+
+float QualityGovernor::getCost(const QualityLevel& level)
+{
+	return level.resolutionScale * level.resolutionScale * float(level.samplesPerPixel) * float(level.maxBounces);
+}
+
+bool QualityGovernor::lower(QualityLevel& level) const
+{
+	if (level.samplesPerPixel > minimumLevel.samplesPerPixel)
+	{
+		level.samplesPerPixel = std::max(level.samplesPerPixel / 2, minimumLevel.samplesPerPixel);
+	}
+	else if (level.maxBounces > minimumLevel.maxBounces)
+	{
+		level.maxBounces = std::max(level.maxBounces - BOUNCES_STEP, minimumLevel.maxBounces);
+	}
+	else if (level.resolutionScale > minimumLevel.resolutionScale)
+	{
+		level.resolutionScale = std::max(level.resolutionScale * RESOLUTION_STEP, minimumLevel.resolutionScale);
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool QualityGovernor::raise(QualityLevel& level) const
+{
+	if (level.resolutionScale < maximumLevel.resolutionScale)
+	{
+		float scale = level.resolutionScale / RESOLUTION_STEP;
+
+		// Snaps to the maximum instead of stopping a rounding error short of it.
+		level.resolutionScale = scale > maximumLevel.resolutionScale * 0.99f ? maximumLevel.resolutionScale : scale;
+	}
+	else if (level.maxBounces < maximumLevel.maxBounces)
+	{
+		level.maxBounces = std::min(level.maxBounces + BOUNCES_STEP, maximumLevel.maxBounces);
+	}
+	else if (level.samplesPerPixel < maximumLevel.samplesPerPixel)
+	{
+		level.samplesPerPixel = std::min(level.samplesPerPixel * 2, maximumLevel.samplesPerPixel);
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
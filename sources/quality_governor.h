@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+struct QualityLevel
+{
+	float resolutionScale; // Internal render resolution relative to the screen.
+
+	int samplesPerPixel, maxBounces;
+};
+
+// Trades image quality for frame time, to hold a target while the camera moves.
+//
+// Every lowered level first halves the samples, then cuts bounces and finally shrinks the internal resolution, raising
+// walks the same steps back. Lowering is measured: it happens after a few frames over the target (plus a margin),
+// and steps as far as the cost model predicts is needed. Raising is predicted: it happens once the next level would
+// still fit under the target (minus the margin) for a longer run of frames, so a level isn't left as soon as it fits.
+// Frames still rendered at the previous level when a change happened are ignored.
+//
+class QualityGovernor
+{
+public:
+	QualityGovernor();
+
+	// "maximum" is the level of the user's own settings, the governor never goes above it.
+	void setLimits(const QualityLevel& maximum, const QualityLevel& minimum);
+	void setTargetFrameTime(float milliseconds);
+
+	// "frameTime" was measured for frame "measuredFrame", "currentFrame" is the latest one submitted (the next one is
+	// the first to use a changed level). Returns true when the level changed.
+	bool update(float frameTime, uint64_t measuredFrame, uint64_t currentFrame);
+
+	// Back to the maximum level, forgetting every measurement.
+	void reset();
+
+	const QualityLevel& getLevel() const;
+	const QualityLevel& getMaximumLevel() const;
+
+	float getTargetFrameTime() const;
+	float getAverageFrameTime() const; // Zero until measured at the current level.
+
+private:
+	static constexpr float HYSTERESIS = 0.1f; // Margin around the target, relative to it.
+	static constexpr float RESOLUTION_STEP = 0.8f;
+	static constexpr int BOUNCES_STEP = 2;
+
+	static const int LOWER_FRAMES = 3; // Measurements over the target before lowering.
+	static const int RAISE_FRAMES = 30; // Measurements with room for the next level before raising.
+
+	QualityLevel level, maximumLevel, minimumLevel;
+
+	float targetFrameTime;
+	float averageFrameTime; // Moving average at the current level.
+
+	uint64_t lastMeasuredFrame, changeFrame;
+	int framesOver, framesUnder;
+
+	// Relative GPU cost of a level. Linear in bounces, which overestimates deep levels (most paths end early), so
+	// raising stays on the safe side.
+	static float getCost(const QualityLevel& level);
+
+	bool lower(QualityLevel& level) const;
+	bool raise(QualityLevel& level) const;
+};
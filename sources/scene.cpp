@@ -1 +1,35 @@
 #include "scene.h"
+
+#include "scenes/file_scene.h"
+#include "scenes/spheres_scene.h"
+#include "scenes/wavefront_scene.h"
+
+Scene* Scene::create(SceneTypes type, int screenWidth, int screenHeight, const std::string& path)
+{
+	switch (type)
+	{
+	case SceneTypes::SPHERES:
+		return new SpheresScene(screenWidth, screenHeight);
+
+	case SceneTypes::SPHERES_WAVEFRONT:
+		return new WavefrontScene(screenWidth, screenHeight);
+
+	case SceneTypes::SCENE_FILE:
+	{
+		FileScene* scene = new FileScene(screenWidth, screenHeight);
+
+		if (!scene->load(path))
+		{
+			delete scene;
+
+			return nullptr;
+		}
+
+		return scene;
+	}
+
+	default:
+		std::cout << "Scene not found!" << std::endl;
+		return nullptr;
+	}
+}
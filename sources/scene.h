@@ -1,20 +1,81 @@
 #pragma once
 
+#include <string>
+#include <vector>
+#include <cstdint>
+
 #include <glm/glm.hpp>
 
 #include <imgui/imgui.h>
 
 #include "camera.h"
 
+#include "graphics/shader_reloader.h"
+
 enum class SceneTypes
 {
-	SPHERES
+	SPHERES, SPHERES_WAVEFRONT, SCENE_FILE
+};
+
+// Random numbers of the paths, see "sampler.glsl". The values match its "SAMPLER_*" constants.
+enum class SamplerTypes
+{
+	WHITE_NOISE, SOBOL, BLUE_NOISE
+};
+
+struct RenderSettings
+{
+	int maxBounces, samplesPerPixel;
+
+	float gpuTimeBudget; // Milliseconds of trace work per frame, zero traces every frame in full.
+
+	bool specializeShaders; // Compile the tracer for the scene content and these settings (see "ShaderVariantCache").
+
+	// Leaves the bounce count a uniform of the specialized tracer, for callers that change it every few frames (the
+	// quality governor): a new count then never compiles a program in the middle of a frame.
+	bool dynamicBounces;
+
+	float adaptiveThreshold; // Relative error under which pixels stop being sampled, zero samples every pixel evenly.
+
+	bool denoise; // Filter the accumulated image with the scene's denoiser, when it has one.
+
+	float resolutionScale; // Internal render resolution relative to the screen, upscaled when presented.
+
+	SamplerTypes samplerType;
+
+	int rouletteDepth; // Bounces every path traces before Russian roulette may end it, zero disables the roulette.
+
+	bool countRays; // Counts the rays of every bounce (see "Scene::getRayStatistics"), at the cost of a few atomics per path.
+
+	bool restir; // Lights the camera hits with reservoirs resampled over space and time (ReSTIR DI), when the scene has them.
+};
+
+// Samples accumulated since the last reset. A uniformly sampled image needs "uniformSamples" to give every pixel as many
+// samples as the most sampled one, so no pixel is noisier than in the adaptive image.
+struct SamplingStatistics
+{
+	uint64_t samples, uniformSamples;
+
+	int pixels, convergedPixels;
+};
+
+// Rays traced since the start of the current pass: "bounceRays[i]" extension rays (camera rays first, then the
+// scattered ones) at bounce i, and the shadow rays of every bounce together.
+struct RayStatistics
+{
+	std::vector<uint64_t> bounceRays;
+
+	uint64_t shadowRays;
 };
 
 class Scene
 {
 public:
 	Scene() = default;
+	virtual ~Scene() = default;
+
+	// "path" is the scene file of "SceneTypes::SCENE_FILE", null is returned when it fails to load.
+	static Scene* create(SceneTypes type, int screenWidth, int screenHeight, const std::string& path = "");
 
 	virtual void setup() = 0;
 	virtual void clean() = 0;
@@ -23,4 +84,25 @@ public:
 	virtual void render(const Camera& camera, float deltaTime) = 0;
 
 	virtual void processGUI() = 0;
+
+	virtual void setScreenDimensions(int width, int height) = 0;
+
+	virtual RenderSettings getRenderSettings() = 0;
+	virtual void setRenderSettings(const RenderSettings& settings) = 0;
+
+	// Hot-reload: registers the scene programs, and sets their uniform handles and constant state again after swaps.
+	virtual void watchShaders(ShaderReloader& reloader) = 0;
+	virtual void onShadersReloaded() = 0;
+
+	// Reads the accumulated image (denoised when "RenderSettings::denoise" is on) as linear RGBA floats (bottom-up rows).
+	virtual void readFrame(std::vector<float>& pixels) = 0;
+
+	// Rays (camera, scattered and shadow) of the latest measured frame, zero when the scene doesn't count them.
+	virtual uint64_t getTracedRays() = 0;
+
+	// Reads the per-pixel sample counts back, waits for the GPU.
+	virtual SamplingStatistics getSamplingStatistics() = 0;
+
+	// Reads the ray counters back, waits for the GPU. Empty when the scene doesn't count them.
+	virtual RayStatistics getRayStatistics() = 0;
 };
@@ -0,0 +1,88 @@
+#include "file_scene.h"
+
+FileScene::FileScene(int screenWidth, int screenHeight) : SpheresScene(screenWidth, screenHeight), file(), path(), fileSize(0), loadTime(0.0f)
+{
+}
+
+bool FileScene::load(const std::string& path)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	if (!file.open(path))
+	{
+		std::cout << "[ERROR] FILE SCENE: Failed to load \"" << path << "\"." << std::endl;
+
+		return false;
+	}
+
+	this->path = path;
+	fileSize = file.getSize();
+	loadTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return true;
+}
+
+const std::string& FileScene::getPath() const
+{
+	return path;
+}
+
+size_t FileScene::getFileSize() const
+{
+	return fileSize;
+}
+
+float FileScene::getLoadTime() const
+{
+	return loadTime;
+}
+
+void FileScene::createContent()
+{
+	if (fileSize == 0)
+	{
+		std::cout << "[ERROR] FILE SCENE: No scene file was loaded, using the default spheres." << std::endl;
+
+		SpheresScene::createContent();
+
+		return;
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	size_t count = 0, vertexCount = 0, triangleCount = 0, meshNodeCount = 0, meshCount = 0, instanceCount = 0, instanceNodeCount = 0;
+
+	uniforms.skyColor = file.getSection<SceneSettings>(SceneSection::SETTINGS, count)->skyColor;
+
+	const Sphere* fileSpheres = file.getSection<Sphere>(SceneSection::SPHERES, count);
+	spheres.assign(fileSpheres, fileSpheres + count);
+
+	const PointLight* filePointLights = file.getSection<PointLight>(SceneSection::POINT_LIGHTS, count);
+	lights.assign(filePointLights, filePointLights + count);
+
+	const Light* fileLights = file.getSection<Light>(SceneSection::LIGHTS, count);
+	lightTable.assign(fileLights, count);
+
+	const BVHNode* fileNodes = file.getSection<BVHNode>(SceneSection::SPHERES_BVH, count);
+	spheresBVH.assign(fileNodes, count);
+
+	const glm::vec4* vertices = file.getSection<glm::vec4>(SceneSection::MESH_VERTICES, vertexCount);
+	const Triangle* triangles = file.getSection<Triangle>(SceneSection::TRIANGLES, triangleCount);
+	const BVHNode* meshNodes = file.getSection<BVHNode>(SceneSection::MESH_BVH, meshNodeCount);
+	const MeshRange* meshes = file.getSection<MeshRange>(SceneSection::MESH_RANGES, meshCount);
+	const Instance* fileInstances = file.getSection<Instance>(SceneSection::INSTANCES, instanceCount);
+	const BVHNode* instanceNodes = file.getSection<BVHNode>(SceneSection::INSTANCES_BVH, instanceNodeCount);
+
+	if (instanceCount > 0)
+	{
+		const Material* materials = file.getSection<Material>(SceneSection::MESH_MATERIALS, count);
+
+		instances.assign(vertices, vertexCount, triangles, triangleCount, meshNodes, meshNodeCount, meshes, meshCount, fileInstances, instanceCount, instanceNodes, instanceNodeCount);
+		meshMaterials.assign(materials, materials + count);
+	}
+
+	// Everything was copied, the pages of the mapping can go.
+	file.close();
+
+	loadTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <iostream>
+
+#include "../tracing/scene_file.h"
+
+#include "spheres_scene.h"
+
+// Spheres scene whose content comes from a scene file (see "SceneFile", written by "SceneConverter") instead of
+// "createSpheres". The arrays of the file are copied as they are into the scene and uploaded by "setup", nothing is
+// parsed or built.
+//
+class FileScene : public SpheresScene
+{
+public:
+	FileScene(int screenWidth, int screenHeight);
+
+	// Maps and checks "path", which "setup" reads (and closes) once. False on errors.
+	bool load(const std::string& path);
+
+	const std::string& getPath() const;
+	size_t getFileSize() const;
+
+	// Opening, checking and copying the file, in milliseconds.
+	float getLoadTime() const;
+
+protected:
+	void createContent();
+
+private:
+	SceneFile file;
+	std::string path;
+	size_t fileSize;
+
+	float loadTime;
+};
@@ -0,0 +1,338 @@
+#include "scene_converter.h"
+
+bool SceneConverter::convert(const std::string& descriptionPath, const std::string& scenePath)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	MappedFile file;
+	JSONValue description;
+
+	if (!file.open(descriptionPath) || !JSONValue::parse(file.getData(), file.getData() + file.getSize(), description))
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: Failed to read \"" << descriptionPath << "\"." << std::endl;
+
+		return false;
+	}
+
+	file.close();
+
+	SceneContent content;
+
+	if (!description.isObject())
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: \"" << descriptionPath << "\" must hold an object." << std::endl;
+
+		return false;
+	}
+
+	if (!readContent(description, std::filesystem::path(descriptionPath).parent_path(), content))
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: Failed to convert \"" << descriptionPath << "\"." << std::endl;
+
+		return false;
+	}
+
+	if (!SceneFile::write(scenePath, content))
+	{
+		return false;
+	}
+
+	std::cout << "Converted \"" << descriptionPath << "\" to \"" << scenePath << "\" (" << std::filesystem::file_size(scenePath) << " bytes) in ";
+	std::cout << std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() << " ms: " << content.spheres.size() << " spheres, ";
+	std::cout << content.pointLights.size() << " point lights, " << content.instances.getStatistics().triangleCount << " triangles in ";
+	std::cout << content.instances.getStatistics().instanceCount << " instances." << std::endl;
+
+	return true;
+}
+
+bool SceneConverter::readContent(const JSONValue& description, const std::filesystem::path& directory, SceneContent& content)
+{
+	const std::vector<JSONValue>* spheres = nullptr;
+	const std::vector<JSONValue>* lights = nullptr;
+	const std::vector<JSONValue>* meshes = nullptr;
+	const std::vector<JSONValue>* instances = nullptr;
+
+	content.settings = { glm::vec3(0.5f, 0.7f, 1.0f), 0.0f }; // Same sky as "SpheresScene".
+
+	if (!readVec3(description, "sky", "the scene", content.settings.skyColor, content.settings.skyColor) || !readArray(description, "spheres", "the scene", spheres) ||
+		!readArray(description, "lights", "the scene", lights) || !readArray(description, "meshes", "the scene", meshes) ||
+		!readArray(description, "instances", "the scene", instances))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < spheres->size(); i++)
+	{
+		const JSONValue& object = (*spheres)[i];
+		std::string context = "spheres[" + std::to_string(i) + "]";
+
+		Sphere sphere = {};
+
+		if (!readVec3(object, "center", context, glm::vec3(0.0f), sphere.center) || !readFloat(object, "radius", context, 1.0f, sphere.radius) ||
+			!readMaterial(object, context, sphere.material))
+		{
+			return false;
+		}
+
+		content.spheres.push_back(sphere);
+	}
+
+	for (size_t i = 0; i < lights->size(); i++)
+	{
+		const JSONValue& object = (*lights)[i];
+		std::string context = "lights[" + std::to_string(i) + "]";
+
+		PointLight light = {};
+
+		if (!readVec3(object, "position", context, glm::vec3(0.0f), light.position) || !readFloat(object, "radius", context, 0.15f, light.radius) ||
+			!readVec3(object, "color", context, glm::vec3(1.0f), light.color) || !readFloat(object, "power", context, 1.0f, light.power))
+		{
+			return false;
+		}
+
+		content.pointLights.push_back(light);
+	}
+
+	for (size_t i = 0; i < meshes->size(); i++)
+	{
+		const JSONValue& object = (*meshes)[i];
+		std::string context = "meshes[" + std::to_string(i) + "]";
+
+		const JSONValue* path = object.isObject() ? object.find("path") : nullptr;
+
+		TriangleMesh mesh;
+
+		if (path == nullptr || !path->isString())
+		{
+			std::cout << "[ERROR] SCENE CONVERTER: \"path\" of " << context << " must be a string." << std::endl;
+
+			return false;
+		}
+
+		if (!mesh.load((directory / path->getString()).string()))
+		{
+			return false;
+		}
+
+		mesh.buildBVH();
+
+		content.instances.addMesh(mesh);
+	}
+
+	for (size_t i = 0; i < instances->size(); i++)
+	{
+		const JSONValue& object = (*instances)[i];
+		std::string context = "instances[" + std::to_string(i) + "]";
+
+		if (!readInstances(object, context, int(meshes->size()), int(content.meshMaterials.size()), content.instances))
+		{
+			return false;
+		}
+
+		content.meshMaterials.push_back(Material());
+
+		if (!readMaterial(object, context, content.meshMaterials.back()))
+		{
+			return false;
+		}
+	}
+
+	if (!content.instances.isEmpty())
+	{
+		content.instances.buildBVH();
+	}
+
+	SphereBVH::build(content.spheres, content.spheresBVH);
+	content.lightTable.build(content.spheres, content.pointLights);
+
+	return true;
+}
+
+bool SceneConverter::readInstances(const JSONValue& object, const std::string& context, int meshCount, int material, MeshInstances& instances)
+{
+	const JSONValue* meshValue = object.isObject() ? object.find("mesh") : nullptr;
+
+	int mesh = -1;
+	float scale = 1.0f;
+	glm::vec3 offset(0.0f), rotation(0.0f), count(1.0f), spacing(0.0f);
+
+	if (meshValue == nullptr || !(meshValue->isString() ? meshValue->getString() == "sphere" : meshValue->isNumber()))
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: \"mesh\" of " << context << " must be the index of a mesh or \"sphere\"." << std::endl;
+
+		return false;
+	}
+
+	if (meshValue->isNumber())
+	{
+		double index = meshValue->getNumber();
+
+		if (index < 0.0 || index >= double(meshCount) || index != double(int(index)))
+		{
+			std::cout << "[ERROR] SCENE CONVERTER: \"mesh\" of " << context << " must be the index of a mesh (" << meshCount << " in the scene)." << std::endl;
+
+			return false;
+		}
+
+		mesh = int(index);
+	}
+
+	if (!readVec3(object, "offset", context, offset, offset) || !readFloat(object, "scale", context, scale, scale) || !readVec3(object, "rotation", context, rotation, rotation))
+	{
+		return false;
+	}
+
+	const JSONValue* repeat = object.find("repeat");
+	std::string repeatContext = "the repeat of " + context;
+
+	if (repeat != nullptr && (!readVec3(*repeat, "count", repeatContext, count, count) || !readVec3(*repeat, "spacing", repeatContext, spacing, spacing)))
+	{
+		return false;
+	}
+
+	if (count.x < 1.0f || count.y < 1.0f || count.z < 1.0f || count.x * count.y * count.z > 1.0e8f)
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: \"count\" of " << repeatContext << " must be at least 1 and at most 10^8 in total." << std::endl;
+
+		return false;
+	}
+
+	if (scale == 0.0f)
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: \"scale\" of " << context << " can't be zero." << std::endl;
+
+		return false;
+	}
+
+	// Rotated around x, then y, then z, scaled first.
+	glm::mat4 placement = glm::rotate(glm::mat4(1.0f), glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+	placement = glm::rotate(placement, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	placement = glm::rotate(placement, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	placement = glm::scale(placement, glm::vec3(scale));
+
+	glm::ivec3 counts(count);
+
+	for (int z = 0; z < counts.z; z++)
+	{
+		for (int y = 0; y < counts.y; y++)
+		{
+			for (int x = 0; x < counts.x; x++)
+			{
+				glm::vec3 position = offset + glm::vec3(float(x), float(y), float(z)) * spacing;
+
+				instances.addInstance(mesh, glm::translate(glm::mat4(1.0f), position) * placement, material);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool SceneConverter::readMaterial(const JSONValue& object, const std::string& context, Material& material)
+{
+	const JSONValue* value = object.find("material");
+
+	material = { glm::vec3(0.8f), 0, glm::vec3(0.0f), 0.0f, 1.5f, { 0.0f, 0.0f, 0.0f } };
+
+	if (value == nullptr)
+	{
+		return true;
+	}
+
+	std::string materialContext = "the material of " + context;
+
+	if (!value->isObject())
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: \"material\" of " << context << " must be an object." << std::endl;
+
+		return false;
+	}
+
+	const JSONValue* type = value->find("type");
+
+	if (type != nullptr)
+	{
+		const char* typeNames[] = { "lambertian", "metal", "dielectric" };
+
+		material.type = -1;
+
+		for (int i = 0; i < 3 && type->isString(); i++)
+		{
+			if (type->getString() == typeNames[i])
+			{
+				material.type = i;
+			}
+		}
+
+		if (material.type == -1)
+		{
+			std::cout << "[ERROR] SCENE CONVERTER: \"type\" of " << materialContext << " must be \"lambertian\", \"metal\" or \"dielectric\"." << std::endl;
+
+			return false;
+		}
+	}
+
+	return readVec3(*value, "albedo", materialContext, material.albedo, material.albedo) && readVec3(*value, "emission", materialContext, material.emission, material.emission) &&
+		readFloat(*value, "roughness", materialContext, material.roughness, material.roughness) && readFloat(*value, "ior", materialContext, material.indexOfRefraction, material.indexOfRefraction);
+}
+
+bool SceneConverter::readFloat(const JSONValue& object, const char* key, const std::string& context, float fallback, float& value)
+{
+	const JSONValue* member = object.isObject() ? object.find(key) : nullptr;
+
+	if (!object.isObject() || (member != nullptr && !member->isNumber()))
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: \"" << key << "\" of " << context << " must be a number." << std::endl;
+
+		return false;
+	}
+
+	value = member != nullptr ? float(member->getNumber()) : fallback;
+
+	return true;
+}
+
+bool SceneConverter::readVec3(const JSONValue& object, const char* key, const std::string& context, const glm::vec3& fallback, glm::vec3& value)
+{
+	const JSONValue* member = object.isObject() ? object.find(key) : nullptr;
+
+	if (member == nullptr && object.isObject())
+	{
+		value = fallback;
+
+		return true;
+	}
+
+	if (member == nullptr || !member->isArray() || member->getElements().size() != 3 ||
+		!std::all_of(member->getElements().begin(), member->getElements().end(), [](const JSONValue& element) { return element.isNumber(); }))
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: \"" << key << "\" of " << context << " must be an array of 3 numbers." << std::endl;
+
+		return false;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		value[i] = float(member->getElements()[i].getNumber());
+	}
+
+	return true;
+}
+
+bool SceneConverter::readArray(const JSONValue& object, const char* key, const std::string& context, const std::vector<JSONValue>*& elements)
+{
+	static const std::vector<JSONValue> EMPTY_ARRAY;
+
+	const JSONValue* member = object.find(key);
+
+	if (member != nullptr && !member->isArray())
+	{
+		std::cout << "[ERROR] SCENE CONVERTER: \"" << key << "\" of " << context << " must be an array." << std::endl;
+
+		return false;
+	}
+
+	elements = member != nullptr ? &member->getElements() : &EMPTY_ARRAY;
+
+	return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../tracing/bvh.h"
+#include "../tracing/sphere_bvh.h"
+#include "../tracing/scene_file.h"
+#include "../utils/json.h"
+#include "../utils/mapped_file.h"
+
+// Writes scene files (see "SceneFile") from a JSON description, so scenes change without recompiling. Hierarchies and
+// the light table are built here once, and loading the file then has nothing left to compute. For example:
+//
+// {
+//     "sky": [0.5, 0.7, 1.0],
+//     "spheres": [
+//         { "center": [0, 1, 0], "radius": 1, "material": { "type": "dielectric", "ior": 1.5 } },
+//         { "center": [4, 4, -4], "radius": 0.15, "material": { "type": "lambertian", "albedo": [0, 0, 0], "emission": [15, 13.5, 12] } }
+//     ],
+//     "lights": [ { "position": [4, 4, 4], "radius": 0.15, "color": [1, 0.9, 0.8], "power": 15 } ],
+//     "meshes": [ { "path": "bunny.ply" } ],
+//     "instances": [
+//         { "mesh": 0, "scale": 10, "offset": [0, 0, 2], "rotation": [0, 90, 0], "material": { "type": "metal", "roughness": 0.2 } },
+//         { "mesh": "sphere", "scale": 0.2, "offset": [-5, 0.2, -5], "repeat": { "count": [50, 1, 50], "spacing": [0.5, 0, 0.5] } }
+//     ]
+// }
+//
+// Every member is optional. Materials are "lambertian" (the default), "metal" or "dielectric", with an "albedo"
+// (0.8 gray), an "emission" (none), a "roughness" (0) and an "ior" (1.5).
+//
+// Meshes are only geometry, stored once (mesh paths are relative to the description). Instances place a mesh (by index)
+// or a unit sphere in the world, scaled, then rotated (in degrees around x, y, then z) and moved by "offset". A "repeat"
+// places a grid of "count" copies, "spacing" apart, which all share the material of the entry. Emissive instances
+// aren't in the light table, so only the paths that hit them see their light.
+//
+class SceneConverter
+{
+public:
+	// Reads "descriptionPath" and writes its scene to "scenePath", false on errors.
+	static bool convert(const std::string& descriptionPath, const std::string& scenePath);
+
+private:
+	static bool readContent(const JSONValue& description, const std::filesystem::path& directory, SceneContent& content);
+	static bool readMaterial(const JSONValue& object, const std::string& context, Material& material);
+
+	// Adds the instances of an "instances" entry, shaded with the mesh material "material".
+	static bool readInstances(const JSONValue& object, const std::string& context, int meshCount, int material, MeshInstances& instances);
+
+	// Members of "object" (described by "context" in errors), "fallback" when missing.
+	static bool readFloat(const JSONValue& object, const char* key, const std::string& context, float fallback, float& value);
+	static bool readVec3(const JSONValue& object, const char* key, const std::string& context, const glm::vec3& fallback, glm::vec3& value);
+	static bool readArray(const JSONValue& object, const char* key, const std::string& context, const std::vector<JSONValue>*& elements);
+};
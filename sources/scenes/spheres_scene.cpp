@@ -1,8 +1,26 @@
 #include "spheres_scene.h"
 
-SpheresScene::SpheresScene()
-	: Scene(), pathTracerShader(nullptr), quadVAO(nullptr), quadVBO(nullptr), quadIBO(nullptr),
-	  uniforms({ 0.0f, glm::vec3(0.5f, 0.7f, 1.0f), 16, 32 })
+const char* SpheresScene::DENOISE_SCOPE_NAMES[MAX_DENOISE_ITERATIONS] = {
+	"Denoise 1", "Denoise 2", "Denoise 3", "Denoise 4", "Denoise 5", "Denoise 6", "Denoise 7", "Denoise 8"
+};
+
+SpheresScene::SpheresScene(int screenWidth, int screenHeight)
+	: Scene(), screenWidth(screenWidth), screenHeight(screenHeight), resolutionScale(1.0f), renderWidth(screenWidth), renderHeight(screenHeight),
+	  pathTracerShader(nullptr), presentShader(nullptr), pathTracerVariants(nullptr), specializeShaders(true), dynamicBounces(false), draggingBounces(false), materialMask(0), frameIndexUniform(), tileSizeUniform(), tilesXUniform(), completedTilesUniform(), adaptiveThresholdUniform(), adaptiveMinSamplesUniform(),
+	  debugViewUniform(), uniformSamplesUniform(), errorScaleUniform(), renderScaleUniform(), samplerTypeUniform(), rouletteDepthUniform(), countRaysUniform(), quadVAO(nullptr), quadVBO(nullptr),
+	  quadIBO(nullptr), spheres(), lights(), lightTable(), spheresBVH(), samplerType(SamplerTypes::WHITE_NOISE), blueNoiseTexture(nullptr), spheresSSBO(nullptr), lightsSSBO(nullptr), bvhSSBO(nullptr),
+	  instances(), meshMaterials({ { glm::vec3(0.8f), 0, glm::vec3(0.0f), 0.0f, 1.5f, { 0.0f, 0.0f, 0.0f } } }), meshPathInput(), meshStatistics(), meshVerticesSSBO(nullptr), trianglesSSBO(nullptr), meshBVHSSBO(nullptr),
+	  meshMaterialsSSBO(nullptr), meshRangesSSBO(nullptr), instancesSSBO(nullptr), instanceBVHSSBO(nullptr),
+	  accumulationBuffers(), accumulationIndex(0), frameIndex(0), adaptiveThreshold(0.0f), adaptiveMinSamples(16), adaptiveSSBO(nullptr), debugView(0), samplingStatistics(),
+	  rouletteDepth(0), countRays(false), rayStatisticsSSBO(nullptr), rayStatistics(), rayStatisticsAge(0),
+	  restirTemporalShader(nullptr), restirSpatialShader(nullptr), restir(false), restirCandidates(8), restirNeighbours(5), restirRadius(30.0f), restirMaxHistory(20.0f), reservoirSSBOs(),
+	  restirHistory(false), restirSeed(0), restirViewProjection(1.0f), restirUniform(), restirTemporalSeedUniform(), restirSpatialSeedUniform(), restirCandidatesUniform(),
+	  restirTemporalReuseUniform(), restirViewProjectionUniform(), restirMaxHistoryUniform(), restirRadiusUniform(), restirNeighboursUniform(),
+	  denoiseShader(nullptr), denoiseBuffers(), denoise(false), denoiseIterations(5), denoiseColorPhi(4.0f), denoiseNormalPhi(128.0f), denoiseDepthPhi(1.0f), denoisedIndex(-1),
+	  writeGBufferUniform(), denoiseIterationUniform(), denoiseStepSizeUniform(), denoiseColorPhiUniform(), denoiseNormalPhiUniform(), denoiseDepthPhiUniform(),
+	  lastViewMatrix(0.0f), lastProjectionMatrix(0.0f),
+	  tileSize(256), nextTile(0), tilesLastFrame(0), gpuTimeBudget(10.0f), tileTime(0.0f), traceTimer(nullptr),
+	  uniforms({ 0.0f, glm::vec3(0.5f, 0.7f, 1.0f), 16, 1 }), frameUniforms(), frameUniformsBuffer(nullptr)
 {
 }
 
@@ -20,108 +38,37 @@ void SpheresScene::setup()
 		2, 3, 0
 	};
 
-	pathTracerShader = new ShaderProgram("sources/shaders/path_tracer.vert", "sources/shaders/path_tracer_2.frag");
-
-	pathTracerShader->bind();
-
-	// Sphere 0 (lambertian, ground).
-	pathTracerShader->setUniform3f("uSpheres[0].center", glm::vec3(0.0f, -1000.0f, 0.0f));
-	pathTracerShader->setUniform1f("uSpheres[0].radius", 1000.0f);
-	pathTracerShader->setUniform1i("uSpheres[0].material.type", 0);
-	pathTracerShader->setUniform3f("uSpheres[0].material.albedo", glm::vec3(0.5f, 0.5f, 0.5f));
-	pathTracerShader->setUniform3f("uSpheres[0].material.emission", glm::vec3(0.0f, 0.0f, 0.0f));
-	pathTracerShader->setUniform1f("uSpheres[0].material.roughness", 0.0f); // Not used.
-	pathTracerShader->setUniform1f("uSpheres[0].material.indexOfRefraction", 0.0f); // Not used.
-
-	// Sphere 1 (dielectric).
-	pathTracerShader->setUniform3f("uSpheres[1].center", glm::vec3(0.0f, 1.0f, 0.0f));
-	pathTracerShader->setUniform1f("uSpheres[1].radius", 1.0f);
-	pathTracerShader->setUniform1i("uSpheres[1].material.type", 2);
-	pathTracerShader->setUniform3f("uSpheres[1].material.albedo", glm::vec3(0.0f, 0.0f, 0.0f)); // Not used.
-	pathTracerShader->setUniform3f("uSpheres[1].material.emission", glm::vec3(0.0f, 0.0f, 0.0f));
-	pathTracerShader->setUniform1f("uSpheres[1].material.roughness", 0.0f); // Not used.
-	pathTracerShader->setUniform1f("uSpheres[1].material.indexOfRefraction", 1.5f);
-
-	// Sphere 2 (lambertian).
-	pathTracerShader->setUniform3f("uSpheres[2].center", glm::vec3(-4.0f, 1.0f, 0.0f));
-	pathTracerShader->setUniform1f("uSpheres[2].radius", 1.0f);
-	pathTracerShader->setUniform1i("uSpheres[2].material.type", 0);
-	pathTracerShader->setUniform3f("uSpheres[2].material.albedo", glm::vec3(0.4f, 0.2f, 0.1f));
-	pathTracerShader->setUniform3f("uSpheres[2].material.emission", glm::vec3(0.0f, 0.0f, 0.0f));
-	pathTracerShader->setUniform1f("uSpheres[2].material.roughness", 0.0f); // Not used.
-	pathTracerShader->setUniform1f("uSpheres[2].material.indexOfRefraction", 0.0f); // Not used.
+	createContent();
+	updateMaterialMask();
 
-	// Sphere 3 (metal).
-	pathTracerShader->setUniform3f("uSpheres[3].center", glm::vec3(4.0f, 1.0f, 0.0f));
-	pathTracerShader->setUniform1f("uSpheres[3].radius", 1.0f);
-	pathTracerShader->setUniform1i("uSpheres[3].material.type", 1);
-	pathTracerShader->setUniform3f("uSpheres[3].material.albedo", glm::vec3(0.7f, 0.6f, 0.5f));
-	pathTracerShader->setUniform3f("uSpheres[3].material.emission", glm::vec3(0.0f, 0.0f, 0.0f));
-	pathTracerShader->setUniform1f("uSpheres[3].material.roughness", 0.1f);
-	pathTracerShader->setUniform1f("uSpheres[3].material.indexOfRefraction", 0.0f); // Not used.
+	pathTracerVariants = new ShaderVariantCache("sources/shaders/path_tracer.vert", "sources/shaders/path_tracer_2.frag");
+	presentShader = new ShaderProgram("sources/shaders/path_tracer.vert", "sources/shaders/present.frag");
+	denoiseShader = new ShaderProgram("sources/shaders/path_tracer.vert", "sources/shaders/denoise.frag");
+	restirTemporalShader = new ShaderProgram("sources/shaders/restir.comp", { { "KERNEL_TEMPORAL", "1" } });
+	restirSpatialShader = new ShaderProgram("sources/shaders/restir.comp", { { "KERNEL_SPATIAL", "1" } });
 
-	// Sphere 4 (dielectric, emissive).
-	pathTracerShader->setUniform3f("uSpheres[4].center", glm::vec3(4.0f, 4.0f, -4.0f));
-	pathTracerShader->setUniform1f("uSpheres[4].radius", 0.15f);
-	pathTracerShader->setUniform1i("uSpheres[4].material.type", 2);
-	pathTracerShader->setUniform3f("uSpheres[4].material.albedo", glm::vec3(0.0f, 0.0f, 0.0f)); // Not used.
-	pathTracerShader->setUniform3f("uSpheres[4].material.emission", glm::vec3(1.0f, 0.9f, 0.8f) * 15.0f);
-	pathTracerShader->setUniform1f("uSpheres[4].material.roughness", 0.0f); // Not used.
-	pathTracerShader->setUniform1f("uSpheres[4].material.indexOfRefraction", 1.5f);
+	selectPathTracerVariant();
 
-	// Light.
-	uniforms.lights[0].position = glm::vec3(4.0f, 4.0f, 4.0f);
-	uniforms.lights[0].color = glm::vec3(1.0f, 0.9f, 0.8f);
-	uniforms.lights[0].radius = 0.15f;
-	uniforms.lights[0].power = 15.0f;
+	frameUniformsBuffer = new FrameUniformsBuffer();
 
-	/*
-	int i = 5;
+	// The whole scene is uploaded with a single copy per buffer.
+	spheresSSBO = new SSBO(spheres.data(), int(spheres.size() * sizeof(Sphere)));
+	bvhSSBO = new SSBO(spheresBVH.getNodes().data(), int(spheresBVH.getNodes().size() * sizeof(BVHNode)));
+	lightsSSBO = new SSBO(lightTable.getLights().data(), int(lightTable.getLights().size() * sizeof(Light)), GL_DYNAMIC_DRAW);
 
-	for (int a = -4; a < 4; a++)
+	if (!instances.isEmpty())
 	{
-		for (int b = -4; b < 4; b++)
-		{
-			float material = randomNumber();
-			glm::vec3 center(a + 0.9f * randomNumber(), 0.2f, b + 0.9f * randomNumber());
-
-			if (material < 0.8f) // Lambertian.
-			{
-				glm::vec3 albedo = randomVec3() * randomVec3();
+		createMeshBuffers();
+	}
 
-				pathTracerShader->setUniform3f(("uSpheres[" + std::to_string(i) + "].center").c_str(), center);
-				pathTracerShader->setUniform1f(("uSpheres[" + std::to_string(i) + "].radius").c_str(), 0.2f);
-				pathTracerShader->setUniform1i(("uSpheres[" + std::to_string(i) + "].material.type").c_str(), 0);
-				pathTracerShader->setUniform3f(("uSpheres[" + std::to_string(i) + "].material.albedo").c_str(), albedo);
-				pathTracerShader->setUniform3f(("uSpheres[" + std::to_string(i) + "].material.emission").c_str(), glm::vec3(0.0f, 0.0f, 0.0f));
-			}
-			else if (material < 0.95f) // Metal.
-			{
-				glm::vec3 albedo = randomVec3(0.5f, 1.0f);
-				float fuzz = randomNumber(0.0f, 0.5f);
-
-				pathTracerShader->setUniform3f(("uSpheres[" + std::to_string(i) + "].center").c_str(), center);
-				pathTracerShader->setUniform1f(("uSpheres[" + std::to_string(i) + "].radius").c_str(), 0.2f);
-				pathTracerShader->setUniform1i(("uSpheres[" + std::to_string(i) + "].material.type").c_str(), 1);
-				pathTracerShader->setUniform1f(("uSpheres[" + std::to_string(i) + "].material.fuzz").c_str(), fuzz);
-				pathTracerShader->setUniform3f(("uSpheres[" + std::to_string(i) + "].material.albedo").c_str(), albedo);
-				pathTracerShader->setUniform3f(("uSpheres[" + std::to_string(i) + "].material.emission").c_str(), glm::vec3(0.0f, 0.0f, 0.0f));
-			}
-			else // Dielectric.
-			{
-				pathTracerShader->setUniform3f(("uSpheres[" + std::to_string(i) + "].center").c_str(), center);
-				pathTracerShader->setUniform1f(("uSpheres[" + std::to_string(i) + "].radius").c_str(), 0.2f);
-				pathTracerShader->setUniform1i(("uSpheres[" + std::to_string(i) + "].material.type").c_str(), 2);
-				pathTracerShader->setUniform1f(("uSpheres[" + std::to_string(i) + "].material.indexOfRefraction").c_str(), 1.5f);
-				pathTracerShader->setUniform3f(("uSpheres[" + std::to_string(i) + "].material.emission").c_str(), glm::vec3(0.0f, 0.0f, 0.0f));
-			}
+	std::vector<float> blueNoise = BlueNoise::generate(BLUE_NOISE_SIZE);
+	blueNoiseTexture = new Texture(BLUE_NOISE_SIZE, BLUE_NOISE_SIZE, GL_R32F, GL_RED, GL_FLOAT, blueNoise.data());
 
-			i++;
-		}
-	}
-	*/
+	uint32_t activePixels[2] = {};
+	adaptiveSSBO = new SSBO(activePixels, sizeof(activePixels), GL_DYNAMIC_COPY);
 
-	pathTracerShader->unbind();
+	std::vector<uint32_t> rayCounters(1 + MAX_COUNTED_BOUNCES, 0);
+	rayStatisticsSSBO = new SSBO(rayCounters.data(), int(rayCounters.size() * sizeof(uint32_t)), GL_DYNAMIC_COPY);
 
 	quadVAO = new VAO();
 	quadVBO = new VBO(vertices, sizeof(vertices));
@@ -136,15 +83,63 @@ void SpheresScene::setup()
 	quadVAO->unbind(); // Unbind VAO before another buffer.
 	quadVBO->unbind();
 	quadIBO->unbind();
+
+	traceTimer = new TimerQuery();
+
+	createAccumulationBuffers();
+}
+
+void SpheresScene::watchShaders(ShaderReloader& reloader)
+{
+	pathTracerVariants->watch(reloader);
+
+	reloader.watch(presentShader);
+	reloader.watch(denoiseShader);
+	reloader.watch(restirTemporalShader);
+	reloader.watch(restirSpatialShader);
+}
+
+void SpheresScene::onShadersReloaded()
+{
+	setupShaders();
+
+	// Samples of the previous version would blend with the new ones.
+	resetAccumulation();
 }
 
 void SpheresScene::clean()
 {
-	pathTracerShader->clean();
+	pathTracerVariants->clean();
+	presentShader->clean();
+	denoiseShader->clean();
+	restirTemporalShader->clean();
+	restirSpatialShader->clean();
+
+	delete pathTracerVariants;
+
+	cleanAccumulationBuffers();
 
 	quadVBO->clean();
 	quadVAO->clean();
 	quadIBO->clean();
+
+	spheresSSBO->clean();
+	lightsSSBO->clean();
+	bvhSSBO->clean();
+	adaptiveSSBO->clean();
+
+	cleanMeshBuffers();
+	rayStatisticsSSBO->clean();
+
+	blueNoiseTexture->clean();
+
+	delete blueNoiseTexture;
+
+	traceTimer->clean();
+
+	frameUniformsBuffer->clean();
+
+	delete frameUniformsBuffer;
 }
 
 void SpheresScene::update(float deltaTime)
@@ -154,22 +149,175 @@ void SpheresScene::update(float deltaTime)
 
 void SpheresScene::render(const Camera& camera, float deltaTime)
 {
+	// Any camera movement invalidates the samples gathered so far.
+	if (camera.getViewMatrix() != lastViewMatrix || camera.getProjectionMatrix() != lastProjectionMatrix)
+	{
+		lastViewMatrix = camera.getViewMatrix();
+		lastProjectionMatrix = camera.getProjectionMatrix();
+
+		// Only inverted when the camera moved, still frames reuse them.
+		frameUniforms.inverseProjectionMatrix = glm::inverse(lastProjectionMatrix);
+		frameUniforms.inverseViewMatrix = glm::inverse(lastViewMatrix);
+		frameUniforms.cameraPosition = camera.getPosition();
+
+		resetAccumulation();
+	}
+
+	frameUniforms.skyColor = uniforms.skyColor;
+	frameUniforms.viewportSize = glm::ivec2(renderWidth, renderHeight);
+	frameUniforms.maxBounces = uniforms.maxBounces;
+	frameUniforms.samplesPerPixel = uniforms.samplesPerPixel;
+	frameUniforms.numSpheres = int(spheres.size());
+	frameUniforms.numLights = int(lightTable.getLights().size());
+	frameUniforms.numNodes = int(spheresBVH.getNodes().size());
+	frameUniforms.numInstanceNodes = int(instances.getBVH().getNodes().size());
+
+	// Uploads nothing while the camera and the settings stay still.
+	frameUniformsBuffer->update(frameUniforms);
+	frameUniformsBuffer->bindBase();
+
+	FrameBuffer* readBuffer = accumulationBuffers[accumulationIndex];
+	FrameBuffer* writeBuffer = accumulationBuffers[1 - accumulationIndex];
+
+	int numberOfTiles = getNumberOfTiles();
+	int tilesX = (renderWidth + tileSize - 1) / tileSize;
+	int tilesThisFrame = getTilesThisFrame();
+
+	// Presentation goes to whatever target the caller bound (the window, or an offscreen buffer in the offline modes).
+	int targetFramebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+
+	// A new pass counts its sampled pixels from zero.
+	if (nextTile == 0)
+	{
+		uint32_t activePixels = 0;
+		adaptiveSSBO->update(&activePixels, sizeof(activePixels));
+
+		if (countRays)
+		{
+			std::vector<uint32_t> rayCounters(1 + MAX_COUNTED_BOUNCES, 0);
+			rayStatisticsSSBO->update(rayCounters.data(), int(rayCounters.size() * sizeof(uint32_t)));
+		}
+	}
+
+	spheresSSBO->bindBase(0);
+	lightsSSBO->bindBase(1);
+	bvhSSBO->bindBase(2);
+	adaptiveSSBO->bindBase(3);
+	rayStatisticsSSBO->bindBase(4);
+
+	if (!instances.isEmpty())
+	{
+		meshVerticesSSBO->bindBase(7);
+		trianglesSSBO->bindBase(8);
+		meshBVHSSBO->bindBase(9);
+		meshMaterialsSSBO->bindBase(10);
+		instancesSSBO->bindBase(11);
+		instanceBVHSSBO->bindBase(12);
+		meshRangesSSBO->bindBase(13);
+	}
+
+	// Every tile of the pass shades with the same reservoirs.
+	if (restir && nextTile == 0)
+	{
+		resampleReservoirs();
+	}
+
+	if (restir)
+	{
+		reservoirSSBOs[1]->bindBase(5);
+	}
+
+	// Trace pass: blend this frame's samples into the running average.
+	writeBuffer->bind();
+	glViewport(0, 0, renderWidth, renderHeight);
+	readBuffer->bindColorBuffer(0);
+	readBuffer->bindColorBuffer(1, 1);
+	blueNoiseTexture->bind(2);
+
 	pathTracerShader->bind();
 	quadVAO->bind();
 
-	pathTracerShader->setUniform3f("uCameraPosition", camera.getPosition());
-	pathTracerShader->setUniformMatrix4fv("uInverseProjectionMatrix", glm::inverse(camera.getProjectionMatrix()));
-	pathTracerShader->setUniformMatrix4fv("uInverseViewMatrix", glm::inverse(camera.getViewMatrix()));
-
-	pathTracerShader->setUniform3f("uSkyColor", uniforms.skyColor);
-	pathTracerShader->setUniform1i("uMaxBounces", uniforms.maxBounces);
-	pathTracerShader->setUniform1i("uSamplesPerPixel", uniforms.samplesPerPixel);
+	pathTracerShader->setUniform(frameIndexUniform, frameIndex);
+	pathTracerShader->setUniform(adaptiveThresholdUniform, adaptiveThreshold);
+	pathTracerShader->setUniform(adaptiveMinSamplesUniform, adaptiveMinSamples);
+	pathTracerShader->setUniform(writeGBufferUniform, denoise ? 1 : 0);
+	pathTracerShader->setUniform(samplerTypeUniform, int(samplerType));
+	pathTracerShader->setUniform(rouletteDepthUniform, rouletteDepth);
+	pathTracerShader->setUniform(countRaysUniform, countRays ? 1 : 0);
+	pathTracerShader->setUniform(restirUniform, restir ? 1 : 0);
 	// pathTracerShader->setUniform1f("uTime", uniforms.time);
 
-	pathTracerShader->setUniform3f("uLights[0].position", uniforms.lights[0].position);
-	pathTracerShader->setUniform3f("uLights[0].color", uniforms.lights[0].color);
-	pathTracerShader->setUniform1f("uLights[0].radius", uniforms.lights[0].radius);
-	pathTracerShader->setUniform1f("uLights[0].power", uniforms.lights[0].power);
+	GpuProfiler::beginScope("Trace");
+	traceTimer->begin(tilesThisFrame);
+
+	if (tilesThisFrame == numberOfTiles)
+	{
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+	}
+	else
+	{
+		glEnable(GL_SCISSOR_TEST);
+
+		for (int i = nextTile; i < nextTile + tilesThisFrame; i++)
+		{
+			glScissor((i % tilesX) * tileSize, (i / tilesX) * tileSize, tileSize, tileSize);
+			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+			// Submit every tile on its own, so no single command batch runs for long.
+			glFlush();
+		}
+
+		glDisable(GL_SCISSOR_TEST);
+	}
+
+	traceTimer->end();
+	GpuProfiler::endScope();
+
+	// The counter is copied (and cleared) by buffer commands, which must see the atomics of the pass.
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	nextTile += tilesThisFrame;
+	tilesLastFrame = tilesThisFrame;
+
+	if (nextTile == numberOfTiles && denoise)
+	{
+		denoiseAccumulation(writeBuffer);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+	glViewport(0, 0, screenWidth, screenHeight);
+
+	// Present pass: tone the accumulated (linear) radiance into the default framebuffer.
+	// Tiles the current pass hasn't reached yet still show the previous average, the denoised image covers every tile.
+	GpuProfiler::beginScope("Present");
+
+	bool denoised = denoise && denoisedIndex != -1;
+
+	presentShader->bind();
+	quadVAO->bind();
+
+	if (denoised)
+	{
+		denoiseBuffers[denoisedIndex]->bindColorBuffer(0);
+		denoiseBuffers[denoisedIndex]->bindColorBuffer(1);
+	}
+	else
+	{
+		writeBuffer->bindColorBuffer(0);
+		readBuffer->bindColorBuffer(1);
+	}
+
+	writeBuffer->bindColorBuffer(2, 1);
+	readBuffer->bindColorBuffer(3, 1);
+
+	presentShader->setUniform(tileSizeUniform, tileSize);
+	presentShader->setUniform(tilesXUniform, tilesX);
+	presentShader->setUniform(completedTilesUniform, denoised ? numberOfTiles : nextTile);
+	presentShader->setUniform(debugViewUniform, debugView);
+	presentShader->setUniform(uniformSamplesUniform, float((frameIndex + 1) * uniforms.samplesPerPixel));
+	presentShader->setUniform(errorScaleUniform, adaptiveThreshold > 0.0f ? adaptiveThreshold : 0.05f);
+	presentShader->setUniform(renderScaleUniform, glm::vec2(float(renderWidth) / float(screenWidth), float(renderHeight) / float(screenHeight)));
 
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -177,24 +325,898 @@ void SpheresScene::render(const Camera& camera, float deltaTime)
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
 	quadVAO->unbind();
-	pathTracerShader->unbind();
+	presentShader->unbind();
+
+	GpuProfiler::endScope();
+
+	// The pass is over once every tile was traced, its average becomes the input of the next one.
+	if (nextTile == numberOfTiles)
+	{
+		// The sampled pixels of this pass size the sample budget of the next one.
+		adaptiveSSBO->copyTo(*adaptiveSSBO, 0, sizeof(uint32_t), sizeof(uint32_t));
+
+		accumulationIndex = 1 - accumulationIndex;
+		frameIndex += 1;
+		nextTile = 0;
+	}
 }
 
 void SpheresScene::processGUI()
 {
 	bool dialogOpen = true;
+	bool changed = false;
+
 	ImGui::Begin("Spheres Scene", &dialogOpen, ImGuiWindowFlags_MenuBar);
 
+	bool bouncesActive = false;
+
+	changed |= processUniformsGUI(uniforms, bouncesActive);
+
+	// A drag goes through every count: the tracer reads it from a uniform meanwhile, and only the released one is
+	// specialized.
+	bool bouncesDragChanged = bouncesActive != draggingBounces;
+
+	draggingBounces = bouncesActive;
+
+	int samplerIndex = int(samplerType);
+
+	if (ImGui::Combo("Sampler", &samplerIndex, "White Noise (PCG)\0Sobol (Owen Scrambled)\0Blue Noise\0"))
+	{
+		samplerType = SamplerTypes(samplerIndex);
+
+		changed = true;
+	}
+
+	bool resolutionChanged = ImGui::DragFloat("Resolution Scale", &resolutionScale, 0.01f, 0.1f, 1.0f, "%.2f");
+
+	ImGui::Text("Render Resolution: %d x %d", renderWidth, renderHeight);
+
+	ImGui::SeparatorText("Shader Variant");
+
+	bool variantChanged = ImGui::Checkbox("Specialized", &specializeShaders);
+
+	for (const ShaderDefine& define : getPathTracerDefines())
+	{
+		ImGui::Text("%s = %s", define.name.c_str(), define.value.c_str());
+	}
+
+	ImGui::Text("Variants Kept: %d / %d", int(pathTracerVariants->getPrograms().size()), pathTracerVariants->getMaxVariants());
+
+	if (processLightsGUI(lights, spheres, lightTable, lightsSSBO))
+	{
+		// Reservoirs point into the previous table.
+		restirHistory = false;
+		changed = true;
+	}
+
+	const BVHStatistics& bvhStatistics = spheresBVH.getStatistics();
+
+	ImGui::SeparatorText("BVH");
+	ImGui::Text("Nodes: %d (%d leaves)", bvhStatistics.nodeCount, bvhStatistics.leafCount);
+	ImGui::Text("Depth: %d", bvhStatistics.depth);
+	ImGui::Text("Build Time: %.3f ms", bvhStatistics.buildTime);
+
+	ImGui::SeparatorText("Mesh");
+	ImGui::InputText("Path (OBJ, PLY)", meshPathInput, sizeof(meshPathInput));
+
+	if (ImGui::Button("Load Mesh"))
+	{
+		loadMesh(meshPathInput);
+	}
+
+	if (!instances.isEmpty())
+	{
+		const InstanceStatistics& instanceStatistics = instances.getStatistics();
+		const BVHStatistics& instanceBVHStatistics = instances.getBVH().getStatistics();
+
+		ImGui::SameLine();
+
+		bool removed = ImGui::Button("Remove Mesh");
+
+		if (meshStatistics.triangleCount > 0)
+		{
+			ImGui::Text("Loaded: %d triangles (%d vertices)", meshStatistics.triangleCount, meshStatistics.vertexCount);
+			ImGui::Text("Load Time: %.3f ms, BVH Build Time: %.3f ms", meshStatistics.loadTime, meshStatistics.buildTime);
+		}
+
+		ImGui::Text("Meshes: %d (%d triangles), Instances: %d", instanceStatistics.meshCount, instanceStatistics.triangleCount, instanceStatistics.instanceCount);
+		ImGui::Text("Memory: %.2f MB of meshes, %.2f MB of instances", float(instanceStatistics.geometryBytes) / (1024.0f * 1024.0f), float(instanceStatistics.instanceBytes) / (1024.0f * 1024.0f));
+		ImGui::Text("Instances BVH Nodes: %d (%d leaves), Depth: %d", instanceBVHStatistics.nodeCount, instanceBVHStatistics.leafCount, instanceBVHStatistics.depth);
+
+		bool materialChanged = ImGui::ColorEdit3("Mesh Albedo", glm::value_ptr(meshMaterials[0].albedo));
+
+		materialChanged |= ImGui::Combo("Mesh Material", &meshMaterials[0].type, "Lambertian\0Metal\0Dielectric\0");
+		materialChanged |= ImGui::DragFloat("Mesh Roughness", &meshMaterials[0].roughness, 0.01f, 0.0f, 1.0f);
+
+		if (materialChanged)
+		{
+			meshMaterialsSSBO->update(meshMaterials.data(), int(meshMaterials.size() * sizeof(Material)));
+
+			updateMaterialMask();
+
+			changed = true;
+		}
+
+		// Last, the statistics above read the instances.
+		if (removed)
+		{
+			removeMesh();
+		}
+	}
+
+	ImGui::SeparatorText("Accumulation");
+	ImGui::Text("Frames: %d (%d samples per pixel)", frameIndex, frameIndex * uniforms.samplesPerPixel);
+
+	ImGui::SeparatorText("Adaptive Sampling");
+	changed |= ImGui::DragFloat("Error Threshold", &adaptiveThreshold, 0.001f, 0.0f, 1.0f, "%.3f");
+	changed |= ImGui::DragInt("Min Samples", &adaptiveMinSamples, 1, 1, 4096);
+	ImGui::Combo("Debug View", &debugView, "Image\0Samples\0Relative Error\0");
+
+	if (ImGui::Button("Measure Samples"))
+	{
+		samplingStatistics = getSamplingStatistics();
+	}
+
+	if (samplingStatistics.pixels > 0)
+	{
+		double saved = samplingStatistics.uniformSamples > 0 ? 100.0 * (1.0 - double(samplingStatistics.samples) / double(samplingStatistics.uniformSamples)) : 0.0;
+
+		ImGui::Text("Samples: %llu (uniform: %llu, %.1f%% saved)", (unsigned long long)samplingStatistics.samples, (unsigned long long)samplingStatistics.uniformSamples, saved);
+		ImGui::Text("Converged: %d / %d pixels", samplingStatistics.convergedPixels, samplingStatistics.pixels);
+	}
+
+	ImGui::SeparatorText("Russian Roulette");
+	changed |= ImGui::DragInt("Roulette Depth", &rouletteDepth, 1, 0, 128);
+	ImGui::Checkbox("Count Rays", &countRays);
+
+	// Reading the counters waits for the tracer, so they are only read while shown, every few frames.
+	if (!countRays || !ImGui::TreeNode("Ray Statistics"))
+	{
+		rayStatisticsAge = 0;
+	}
+	else
+	{
+		if (--rayStatisticsAge <= 0)
+		{
+			rayStatistics = getRayStatistics();
+			rayStatisticsAge = RAY_STATISTICS_INTERVAL;
+		}
+
+		std::vector<float> bounceRays(rayStatistics.bounceRays.begin(), rayStatistics.bounceRays.end());
+		uint64_t extensionRays = 0;
+
+		for (uint64_t rays : rayStatistics.bounceRays)
+		{
+			extensionRays += rays;
+		}
+
+		// Counted over the tiles traced so far, a new pass starts from zero.
+		ImGui::PlotHistogram("Rays Per Bounce", bounceRays.data(), int(bounceRays.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 80.0f));
+		ImGui::Text("Extension Rays: %llu", (unsigned long long)extensionRays);
+		ImGui::Text("Shadow Rays: %llu", (unsigned long long)rayStatistics.shadowRays);
+
+		if (!rayStatistics.bounceRays.empty() && rayStatistics.bounceRays[0] > 0)
+		{
+			ImGui::Text("Mean Path Length: %.2f bounces", double(extensionRays) / double(rayStatistics.bounceRays[0]));
+		}
+
+		ImGui::TreePop();
+	}
+
+	ImGui::SeparatorText("ReSTIR DI");
+
+	if (ImGui::Checkbox("Resample Lights", &restir))
+	{
+		restirHistory = false;
+		changed = true;
+	}
+
+	changed |= ImGui::DragInt("Candidates", &restirCandidates, 1, 1, 64);
+	changed |= ImGui::DragInt("Spatial Neighbours", &restirNeighbours, 1, 0, 16);
+	changed |= ImGui::DragFloat("Spatial Radius", &restirRadius, 1.0f, 1.0f, 128.0f, "%.0f px");
+	changed |= ImGui::DragFloat("Max History", &restirMaxHistory, 1.0f, 0.0f, 100.0f, "%.0fx");
+
+	if (restir)
+	{
+		ImGui::Text("Resampling: %.3f ms", std::max(GpuProfiler::getLatestTime("ReSTIR"), 0.0f));
+	}
+
+	ImGui::SeparatorText("Denoiser");
+	ImGui::Checkbox("Denoise", &denoise);
+	ImGui::DragInt("Iterations", &denoiseIterations, 1, 1, MAX_DENOISE_ITERATIONS);
+	ImGui::DragFloat("Color Phi", &denoiseColorPhi, 0.1f, 0.1f, 100.0f);
+	ImGui::DragFloat("Normal Phi", &denoiseNormalPhi, 1.0f, 1.0f, 1024.0f);
+	ImGui::DragFloat("Depth Phi", &denoiseDepthPhi, 0.1f, 0.1f, 100.0f);
+
+	if (denoise)
+	{
+		ImGui::Text("Variance: %.3f ms", std::max(GpuProfiler::getLatestTime("Denoise Variance"), 0.0f));
+
+		for (int i = 0; i < denoiseIterations; i++)
+		{
+			float iterationTime = GpuProfiler::getLatestTime(DENOISE_SCOPE_NAMES[i]);
+
+			ImGui::Text("Iteration %d (step %d): %.3f ms", i + 1, 1 << i, std::max(iterationTime, 0.0f));
+		}
+	}
+
+	ImGui::SeparatorText("Time Slicing");
+	ImGui::DragFloat("GPU Budget (ms)", &gpuTimeBudget, 0.5f, 0.0f, 1000.0f);
+	changed |= ImGui::DragInt("Tile Size", &tileSize, 8, 16, 2048);
+	ImGui::Text("Pass: %d / %d tiles (%d this frame)", nextTile, getNumberOfTiles(), tilesLastFrame);
+	ImGui::Text("Tile GPU Time: %.3f ms", tileTime);
+
+	if (resolutionChanged)
+	{
+		resolutionScale = std::clamp(resolutionScale, 0.1f, 1.0f);
+
+		cleanAccumulationBuffers();
+		createAccumulationBuffers();
+	}
+
+	// A new bounce count may need another variant.
+	if (variantChanged || changed || bouncesDragChanged)
+	{
+		selectPathTracerVariant();
+	}
+
+	if (ImGui::Button("Reset") || changed || variantChanged)
+	{
+		resetAccumulation();
+	}
+
+	ImGui::End();
+}
+
+bool SpheresScene::processUniformsGUI(SpheresSceneUniforms& uniforms, bool& bouncesActive)
+{
+	bool changed = false;
+
 	ImGui::SeparatorText("General");
-	ImGui::ColorEdit3("Sky Color", glm::value_ptr(uniforms.skyColor));
-	ImGui::DragInt("Max Bounces", &uniforms.maxBounces, 1, 1, 128);
-	ImGui::DragInt("Samples Per Pixel", &uniforms.samplesPerPixel, 1, 1, 256);
+	changed |= ImGui::ColorEdit3("Sky Color", glm::value_ptr(uniforms.skyColor));
+	changed |= ImGui::DragInt("Max Bounces", &uniforms.maxBounces, 1, 1, 128);
+
+	bouncesActive = ImGui::IsItemActive();
+
+	changed |= ImGui::DragInt("Samples Per Pixel", &uniforms.samplesPerPixel, 1, 1, 256);
+
+	return changed;
+}
+
+bool SpheresScene::processLightsGUI(std::vector<PointLight>& lights, const std::vector<Sphere>& spheres, LightTable& lightTable, SSBO* lightsSSBO)
+{
+	bool changed = false;
 
 	ImGui::SeparatorText("Lights");
-	ImGui::DragFloat3("Light [0] Position", glm::value_ptr(uniforms.lights[0].position));
-	ImGui::ColorEdit3("Light [0] Color", glm::value_ptr(uniforms.lights[0].color));
-	ImGui::DragFloat("Light [0] Radius", &uniforms.lights[0].radius, 0.05f, 0.05f, 5.0f);
-	ImGui::DragFloat("Light [0] Power", &uniforms.lights[0].power, 0.0f, 0.5f, 100.0f);
 
-	ImGui::End();
+	const LightTableStatistics& lightStatistics = lightTable.getStatistics();
+
+	ImGui::Text("Light Table: %d point lights, %d emissive spheres", lightStatistics.pointLights, lightStatistics.emissiveSpheres);
+
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		std::string label = "Light [" + std::to_string(i) + "]";
+
+		changed |= ImGui::DragFloat3((label + " Position").c_str(), glm::value_ptr(lights[i].position));
+		changed |= ImGui::ColorEdit3((label + " Color").c_str(), glm::value_ptr(lights[i].color));
+		changed |= ImGui::DragFloat((label + " Radius").c_str(), &lights[i].radius, 0.05f, 0.05f, 5.0f);
+		changed |= ImGui::DragFloat((label + " Power").c_str(), &lights[i].power, 0.0f, 0.5f, 100.0f);
+	}
+
+	if (changed)
+	{
+		lightTable.build(spheres, lights);
+		lightsSSBO->update(lightTable.getLights().data(), int(lightTable.getLights().size() * sizeof(Light)));
+	}
+
+	return changed;
+}
+
+void SpheresScene::setScreenDimensions(int width, int height)
+{
+	// Minimized windows report a zero sized framebuffer.
+	if (width <= 0 || height <= 0 || (width == screenWidth && height == screenHeight))
+	{
+		return;
+	}
+
+	screenWidth = width;
+	screenHeight = height;
+
+	cleanAccumulationBuffers();
+	createAccumulationBuffers();
+}
+
+RenderSettings SpheresScene::getRenderSettings()
+{
+	return { uniforms.maxBounces, uniforms.samplesPerPixel, gpuTimeBudget, specializeShaders, dynamicBounces, adaptiveThreshold, denoise, resolutionScale, samplerType, rouletteDepth, countRays, restir };
+}
+
+void SpheresScene::setRenderSettings(const RenderSettings& settings)
+{
+	gpuTimeBudget = settings.gpuTimeBudget;
+	denoise = settings.denoise;
+	countRays = settings.countRays;
+
+	// Buffers of the new size start from a reset accumulation.
+	if (settings.resolutionScale != resolutionScale)
+	{
+		resolutionScale = settings.resolutionScale;
+
+		cleanAccumulationBuffers();
+		createAccumulationBuffers();
+	}
+
+	if (settings.maxBounces != uniforms.maxBounces || settings.samplesPerPixel != uniforms.samplesPerPixel || settings.specializeShaders != specializeShaders ||
+		settings.dynamicBounces != dynamicBounces || settings.adaptiveThreshold != adaptiveThreshold || settings.samplerType != samplerType || settings.rouletteDepth != rouletteDepth || settings.restir != restir)
+	{
+		uniforms.maxBounces = settings.maxBounces;
+		uniforms.samplesPerPixel = settings.samplesPerPixel;
+		specializeShaders = settings.specializeShaders;
+		dynamicBounces = settings.dynamicBounces;
+		adaptiveThreshold = settings.adaptiveThreshold;
+		samplerType = settings.samplerType;
+		rouletteDepth = settings.rouletteDepth;
+		restirHistory = restirHistory && settings.restir == restir;
+		restir = settings.restir;
+
+		selectPathTracerVariant();
+		resetAccumulation();
+	}
+}
+
+void SpheresScene::readFrame(std::vector<float>& pixels)
+{
+	// The latest average lives in the buffer the next frame will read from, and was denoised when it completed.
+	FrameBuffer* frameBuffer = denoise && denoisedIndex != -1 ? denoiseBuffers[denoisedIndex] : accumulationBuffers[accumulationIndex];
+
+	pixels.resize(size_t(frameBuffer->getWidth()) * frameBuffer->getHeight() * 4);
+
+	frameBuffer->readColorBuffer(pixels.data(), GL_RGBA, GL_FLOAT);
+}
+
+uint64_t SpheresScene::getTracedRays()
+{
+	if (!countRays)
+	{
+		return 0;
+	}
+
+	RayStatistics statistics = getRayStatistics();
+	uint64_t rays = statistics.shadowRays;
+
+	for (uint64_t bounceRays : statistics.bounceRays)
+	{
+		rays += bounceRays;
+	}
+
+	return rays;
+}
+
+SamplingStatistics SpheresScene::getSamplingStatistics()
+{
+	// Moments of the latest complete pass, like "readFrame".
+	FrameBuffer* frameBuffer = accumulationBuffers[accumulationIndex];
+	SamplingStatistics statistics = { 0, 0, frameBuffer->getWidth() * frameBuffer->getHeight(), 0 };
+
+	if (frameIndex == 0)
+	{
+		return statistics;
+	}
+
+	std::vector<glm::vec4> moments(statistics.pixels);
+	frameBuffer->readColorBuffer(moments.data(), GL_RGBA, GL_FLOAT, 1);
+
+	uint64_t maxSamples = 0;
+
+	for (const glm::vec4& pixelMoments : moments)
+	{
+		uint64_t samples = uint64_t(pixelMoments.z);
+
+		statistics.samples += samples;
+		statistics.convergedPixels += pixelMoments.w == 0.0f ? 1 : 0;
+
+		maxSamples = std::max(maxSamples, samples);
+	}
+
+	statistics.uniformSamples = maxSamples * uint64_t(statistics.pixels);
+
+	return statistics;
+}
+
+RayStatistics SpheresScene::getRayStatistics()
+{
+	std::vector<uint32_t> rayCounters(1 + MAX_COUNTED_BOUNCES);
+	rayStatisticsSSBO->read(rayCounters.data(), 0, int(rayCounters.size() * sizeof(uint32_t)));
+
+	RayStatistics statistics = { std::vector<uint64_t>(MAX_COUNTED_BOUNCES, 0), rayCounters[0] };
+
+	// A path of length n traced a ray at every bounce before n, so each bounce counts the paths at least that long.
+	uint64_t paths = 0;
+
+	for (int i = MAX_COUNTED_BOUNCES - 1; i >= 0; i--)
+	{
+		paths += rayCounters[1 + i];
+		statistics.bounceRays[i] = paths;
+	}
+
+	// Bounces no path reached are left out.
+	while (!statistics.bounceRays.empty() && statistics.bounceRays.back() == 0)
+	{
+		statistics.bounceRays.pop_back();
+	}
+
+	return statistics;
+}
+
+void SpheresScene::createSpheres(std::vector<Sphere>& spheres, std::vector<PointLight>& lights)
+{
+	// Same sequence as an unseeded "std::rand", so every caller (and every run) gets the same spheres.
+	std::srand(1);
+
+	// Sphere 0 (lambertian, ground).
+	spheres.push_back({ glm::vec3(0.0f, -1000.0f, 0.0f), 1000.0f, { glm::vec3(0.5f, 0.5f, 0.5f), 0, glm::vec3(0.0f), 0.0f, 0.0f, { 0.0f, 0.0f, 0.0f } } });
+
+	// Sphere 1 (dielectric).
+	spheres.push_back({ glm::vec3(0.0f, 1.0f, 0.0f), 1.0f, { glm::vec3(0.0f), 2, glm::vec3(0.0f), 0.0f, 1.5f, { 0.0f, 0.0f, 0.0f } } });
+
+	// Sphere 2 (lambertian).
+	spheres.push_back({ glm::vec3(-4.0f, 1.0f, 0.0f), 1.0f, { glm::vec3(0.4f, 0.2f, 0.1f), 0, glm::vec3(0.0f), 0.0f, 0.0f, { 0.0f, 0.0f, 0.0f } } });
+
+	// Sphere 3 (metal).
+	spheres.push_back({ glm::vec3(4.0f, 1.0f, 0.0f), 1.0f, { glm::vec3(0.7f, 0.6f, 0.5f), 1, glm::vec3(0.0f), 0.1f, 0.0f, { 0.0f, 0.0f, 0.0f } } });
+
+	// Sphere 4 (dielectric, emissive).
+	spheres.push_back({ glm::vec3(4.0f, 4.0f, -4.0f), 0.15f, { glm::vec3(0.0f), 2, glm::vec3(1.0f, 0.9f, 0.8f) * 15.0f, 0.0f, 1.5f, { 0.0f, 0.0f, 0.0f } } });
+
+	for (int a = -4; a < 4; a++)
+	{
+		for (int b = -4; b < 4; b++)
+		{
+			float material = randomNumber();
+			glm::vec3 center(a + 0.9f * randomNumber(), 0.2f, b + 0.9f * randomNumber());
+
+			if (material < 0.8f) // Lambertian.
+			{
+				glm::vec3 albedo = randomVec3() * randomVec3();
+
+				spheres.push_back({ center, 0.2f, { albedo, 0, glm::vec3(0.0f), 0.0f, 0.0f, { 0.0f, 0.0f, 0.0f } } });
+			}
+			else if (material < 0.95f) // Metal.
+			{
+				glm::vec3 albedo = randomVec3(0.5f, 1.0f);
+				float roughness = randomNumber(0.0f, 0.5f);
+
+				spheres.push_back({ center, 0.2f, { albedo, 1, glm::vec3(0.0f), roughness, 0.0f, { 0.0f, 0.0f, 0.0f } } });
+			}
+			else // Dielectric.
+			{
+				spheres.push_back({ center, 0.2f, { glm::vec3(0.0f), 2, glm::vec3(0.0f), 0.0f, 1.5f, { 0.0f, 0.0f, 0.0f } } });
+			}
+		}
+	}
+
+	// Light.
+	lights.push_back({ glm::vec3(4.0f, 4.0f, 4.0f), 0.15f, glm::vec3(1.0f, 0.9f, 0.8f), 15.0f });
+}
+
+void SpheresScene::createContent()
+{
+	createSpheres(spheres, lights);
+	SphereBVH::build(spheres, spheresBVH);
+
+	lightTable.build(spheres, lights);
+}
+
+bool SpheresScene::loadMesh(const std::string& path, const glm::mat4& transform)
+{
+	TriangleMesh loadedMesh;
+
+	if (!loadedMesh.load(path))
+	{
+		return false;
+	}
+
+	// The hierarchy stays in object space, the instance places the mesh.
+	loadedMesh.buildBVH();
+
+	instances.clear();
+	instances.addInstance(instances.addMesh(loadedMesh), transform, 0);
+	instances.buildBVH();
+
+	meshStatistics = loadedMesh.getStatistics();
+
+	cleanMeshBuffers();
+	createMeshBuffers();
+
+	std::snprintf(meshPathInput, sizeof(meshPathInput), "%s", path.c_str());
+
+	// Reservoirs index the primitives of the previous scene.
+	restirHistory = false;
+
+	updateMaterialMask();
+	selectPathTracerVariant();
+	resetAccumulation();
+
+	return true;
+}
+
+void SpheresScene::removeMesh()
+{
+	instances.clear();
+	meshStatistics = {};
+
+	cleanMeshBuffers();
+
+	restirHistory = false;
+
+	updateMaterialMask();
+	selectPathTracerVariant();
+	resetAccumulation();
+}
+
+const MeshStatistics& SpheresScene::getMeshStatistics() const
+{
+	return meshStatistics;
+}
+
+const InstanceStatistics& SpheresScene::getInstanceStatistics() const
+{
+	return instances.getStatistics();
+}
+
+void SpheresScene::createAccumulationBuffers()
+{
+	// Never smaller than a pixel, however small the window or the scale.
+	renderWidth = std::max(int(float(screenWidth) * resolutionScale), 1);
+	renderHeight = std::max(int(float(screenHeight) * resolutionScale), 1);
+
+	// Color, luminance moments, then the G-buffer: normal and distance, albedo and sphere index.
+	std::vector<ColorBufferConfig> attachments = {
+		{ GL_RGBA32F, GL_NEAREST, GL_CLAMP_TO_EDGE },
+		{ GL_RGBA32F, GL_NEAREST, GL_CLAMP_TO_EDGE },
+		{ GL_RGBA16F, GL_NEAREST, GL_CLAMP_TO_EDGE },
+		{ GL_RGBA32F, GL_NEAREST, GL_CLAMP_TO_EDGE }
+	};
+
+	for (int i = 0; i < 2; i++)
+	{
+		accumulationBuffers[i] = new FrameBuffer(renderWidth, renderHeight, attachments, DepthAndStencilType::NONE);
+		denoiseBuffers[i] = new FrameBuffer(renderWidth, renderHeight, 1, GL_RGBA32F, GL_NEAREST, GL_CLAMP_TO_EDGE, DepthAndStencilType::NONE);
+	}
+
+	resetAccumulation();
+}
+
+void SpheresScene::cleanAccumulationBuffers()
+{
+	// Sized like the accumulation, created again on the next resampling.
+	cleanReservoirBuffers();
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (accumulationBuffers[i] != nullptr)
+		{
+			accumulationBuffers[i]->clean();
+
+			delete accumulationBuffers[i];
+
+			accumulationBuffers[i] = nullptr;
+		}
+
+		if (denoiseBuffers[i] != nullptr)
+		{
+			denoiseBuffers[i]->clean();
+
+			delete denoiseBuffers[i];
+
+			denoiseBuffers[i] = nullptr;
+		}
+	}
+}
+
+void SpheresScene::resetAccumulation()
+{
+	// The first frame after a reset overwrites the target instead of blending with it (see "path_tracer_2.frag").
+	frameIndex = 0;
+	nextTile = 0;
+	denoisedIndex = -1;
+
+	// Counts of the previous image don't apply to the next one, the first pass samples every pixel evenly.
+	if (adaptiveSSBO != nullptr)
+	{
+		uint32_t activePixels[2] = {};
+		adaptiveSSBO->update(activePixels, sizeof(activePixels));
+	}
+}
+
+void SpheresScene::denoiseAccumulation(FrameBuffer* accumulationBuffer)
+{
+	GpuProfiler::beginScope("Denoise");
+
+	denoiseShader->bind();
+	quadVAO->bind();
+
+	accumulationBuffer->bindColorBuffer(1, 1);
+	accumulationBuffer->bindColorBuffer(2, 2);
+	accumulationBuffer->bindColorBuffer(3, 3);
+
+	denoiseShader->setUniform(denoiseColorPhiUniform, denoiseColorPhi);
+	denoiseShader->setUniform(denoiseNormalPhiUniform, denoiseNormalPhi);
+	denoiseShader->setUniform(denoiseDepthPhiUniform, denoiseDepthPhi);
+
+	int iterations = std::clamp(denoiseIterations, 1, MAX_DENOISE_ITERATIONS);
+
+	// The variance pass reads the accumulation, the wavelet iterations then ping-pong between the denoise buffers.
+	for (int i = 0; i <= iterations; i++)
+	{
+		GpuProfiler::beginScope(i == 0 ? "Denoise Variance" : DENOISE_SCOPE_NAMES[i - 1]);
+
+		denoiseBuffers[i % 2]->bind();
+
+		if (i == 0)
+		{
+			accumulationBuffer->bindColorBuffer(0);
+		}
+		else
+		{
+			denoiseBuffers[(i - 1) % 2]->bindColorBuffer(0);
+		}
+
+		denoiseShader->setUniform(denoiseIterationUniform, i);
+		denoiseShader->setUniform(denoiseStepSizeUniform, i == 0 ? 1 : 1 << (i - 1));
+
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+		GpuProfiler::endScope();
+	}
+
+	denoisedIndex = iterations % 2;
+
+	GpuProfiler::endScope();
+}
+
+void SpheresScene::createReservoirBuffers()
+{
+	int size = renderWidth * renderHeight * int(sizeof(ReSTIRReservoir));
+
+	for (int i = 0; i < 2; i++)
+	{
+		reservoirSSBOs[i] = new SSBO(nullptr, size, GL_DYNAMIC_COPY);
+	}
+
+	restirHistory = false;
+}
+
+void SpheresScene::cleanReservoirBuffers()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (reservoirSSBOs[i] != nullptr)
+		{
+			reservoirSSBOs[i]->clean();
+
+			delete reservoirSSBOs[i];
+
+			reservoirSSBOs[i] = nullptr;
+		}
+	}
+}
+
+void SpheresScene::createMeshBuffers()
+{
+	// Like the spheres, the meshes and the instances are uploaded with a single copy per buffer.
+	meshVerticesSSBO = new SSBO(instances.getVertices().data(), int(instances.getVertices().size() * sizeof(glm::vec4)));
+	trianglesSSBO = new SSBO(instances.getTriangles().data(), int(instances.getTriangles().size() * sizeof(Triangle)));
+	meshBVHSSBO = new SSBO(instances.getMeshNodes().data(), int(instances.getMeshNodes().size() * sizeof(BVHNode)));
+	meshMaterialsSSBO = new SSBO(meshMaterials.data(), int(meshMaterials.size() * sizeof(Material)), GL_DYNAMIC_DRAW);
+	meshRangesSSBO = new SSBO(instances.getMeshes().data(), int(instances.getMeshes().size() * sizeof(MeshRange)));
+	instancesSSBO = new SSBO(instances.getInstances().data(), int(instances.getInstances().size() * sizeof(Instance)));
+	instanceBVHSSBO = new SSBO(instances.getBVH().getNodes().data(), int(instances.getBVH().getNodes().size() * sizeof(BVHNode)));
+}
+
+void SpheresScene::cleanMeshBuffers()
+{
+	SSBO** meshBuffers[] = { &meshVerticesSSBO, &trianglesSSBO, &meshBVHSSBO, &meshMaterialsSSBO, &meshRangesSSBO, &instancesSSBO, &instanceBVHSSBO };
+
+	for (SSBO** buffer : meshBuffers)
+	{
+		if (*buffer != nullptr)
+		{
+			(*buffer)->clean();
+
+			delete *buffer;
+
+			*buffer = nullptr;
+		}
+	}
+}
+
+void SpheresScene::resampleReservoirs()
+{
+	if (reservoirSSBOs[0] == nullptr)
+	{
+		createReservoirBuffers();
+	}
+
+	glm::mat4 viewProjection = lastProjectionMatrix * lastViewMatrix;
+	glm::ivec2 groups((renderWidth + 7) / 8, (renderHeight + 7) / 8); // "local_size" of the kernels.
+
+	GpuProfiler::beginScope("ReSTIR");
+
+	// Candidates and temporal reuse: the reservoirs of the previous pass go in, the new ones out.
+	restirTemporalShader->bind();
+	restirTemporalShader->setUniform(restirTemporalSeedUniform, restirSeed);
+	restirTemporalShader->setUniform(restirCandidatesUniform, std::max(restirCandidates, 1));
+	restirTemporalShader->setUniform(restirTemporalReuseUniform, restirHistory ? 1 : 0);
+	restirTemporalShader->setUniform(restirViewProjectionUniform, restirViewProjection);
+	restirTemporalShader->setUniform(restirMaxHistoryUniform, restirMaxHistory);
+
+	reservoirSSBOs[1]->bindBase(5);
+	reservoirSSBOs[0]->bindBase(6);
+
+	glDispatchCompute(groups.x, groups.y, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// Spatial reuse back into the reservoirs of the pass.
+	restirSpatialShader->bind();
+	restirSpatialShader->setUniform(restirSpatialSeedUniform, restirSeed);
+	restirSpatialShader->setUniform(restirNeighboursUniform, restirNeighbours);
+	restirSpatialShader->setUniform(restirRadiusUniform, restirRadius);
+
+	reservoirSSBOs[0]->bindBase(5);
+	reservoirSSBOs[1]->bindBase(6);
+
+	glDispatchCompute(groups.x, groups.y, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	restirSpatialShader->unbind();
+
+	GpuProfiler::endScope();
+
+	restirHistory = true;
+	restirSeed += 1;
+	restirViewProjection = viewProjection;
+}
+
+int SpheresScene::getNumberOfTiles() const
+{
+	return ((renderWidth + tileSize - 1) / tileSize) * ((renderHeight + tileSize - 1) / tileSize);
+}
+
+int SpheresScene::getTilesThisFrame()
+{
+	float milliseconds = 0.0f;
+	int tiles = 0;
+
+	// Timings come back a few frames late, they only steer the tile count of the frames to come.
+	while (traceTimer->retrieveResult(milliseconds, tiles))
+	{
+		float measuredTileTime = milliseconds / float(std::max(tiles, 1));
+
+		tileTime = tileTime == 0.0f ? measuredTileTime : glm::mix(tileTime, measuredTileTime, 0.25f);
+	}
+
+	int remainingTiles = getNumberOfTiles() - nextTile;
+
+	if (gpuTimeBudget <= 0.0f)
+	{
+		return remainingTiles;
+	}
+
+	// A single tile until the first measurement arrives, then as many as the budget affords (at least one).
+	int affordableTiles = tileTime > 0.0f ? int(gpuTimeBudget / tileTime) : 1;
+
+	return std::clamp(affordableTiles, 1, remainingTiles);
+}
+
+void SpheresScene::selectPathTracerVariant()
+{
+	ShaderProgram* program = pathTracerVariants->get(specializeShaders ? getPathTracerDefines() : std::vector<ShaderDefine>());
+
+	if (program == pathTracerShader)
+	{
+		return;
+	}
+
+	pathTracerShader = program;
+
+	// Uniform handles belong to a program, the ones of the previous variant don't apply.
+	setupShaders();
+}
+
+void SpheresScene::updateMaterialMask()
+{
+	materialMask = 0;
+
+	for (const Sphere& sphere : spheres)
+	{
+		materialMask |= 1 << sphere.material.type;
+	}
+
+	// Material types absent from the scene are compiled out of the specialized variants.
+	if (!instances.isEmpty())
+	{
+		for (const Material& material : meshMaterials)
+		{
+			materialMask |= 1 << material.type;
+		}
+	}
+}
+
+std::vector<ShaderDefine> SpheresScene::getPathTracerDefines() const
+{
+	std::vector<ShaderDefine> defines = {
+		{ "MATERIAL_MASK", std::to_string(materialMask) },
+		{ "SAMPLER_TYPE", std::to_string(int(samplerType)) }
+	};
+
+	// Without the define the tracer reads "uMaxBounces", so every count shares a single variant.
+	if (!dynamicBounces && !draggingBounces)
+	{
+		defines.insert(defines.begin(), { "MAX_BOUNCES", std::to_string(uniforms.maxBounces) });
+	}
+
+	return defines;
+}
+
+void SpheresScene::setupShaders()
+{
+	// Texture units never change, only the per frame state is set in "render".
+	pathTracerShader->bind();
+	pathTracerShader->setUniform1i("uAccumulationTexture", 0);
+	pathTracerShader->setUniform1i("uMomentsTexture", 1);
+
+	// Specialized variants only keep the uniforms of their own sampler.
+	if (!specializeShaders || samplerType == SamplerTypes::BLUE_NOISE)
+	{
+		pathTracerShader->setUniform1i("uBlueNoiseTexture", 2);
+	}
+
+	presentShader->bind();
+	presentShader->setUniform1i("uAccumulationTexture", 0);
+	presentShader->setUniform1i("uPreviousTexture", 1);
+	presentShader->setUniform1i("uMomentsTexture", 2);
+	presentShader->setUniform1i("uPreviousMomentsTexture", 3);
+	presentShader->unbind();
+
+	denoiseShader->bind();
+	denoiseShader->setUniform1i("uColorTexture", 0);
+	denoiseShader->setUniform1i("uMomentsTexture", 1);
+	denoiseShader->setUniform1i("uNormalDepthTexture", 2);
+	denoiseShader->setUniform1i("uAlbedoIDTexture", 3);
+	denoiseShader->unbind();
+
+	frameIndexUniform = pathTracerShader->getUniformHandle<int>("uFrameIndex");
+	tileSizeUniform = presentShader->getUniformHandle<int>("uTileSize");
+	tilesXUniform = presentShader->getUniformHandle<int>("uTilesX");
+	completedTilesUniform = presentShader->getUniformHandle<int>("uCompletedTiles");
+	adaptiveThresholdUniform = pathTracerShader->getUniformHandle<float>("uAdaptiveThreshold");
+	adaptiveMinSamplesUniform = pathTracerShader->getUniformHandle<int>("uAdaptiveMinSamples");
+	debugViewUniform = presentShader->getUniformHandle<int>("uDebugView");
+	uniformSamplesUniform = presentShader->getUniformHandle<float>("uUniformSamples");
+	errorScaleUniform = presentShader->getUniformHandle<float>("uErrorScale");
+	renderScaleUniform = presentShader->getUniformHandle<glm::vec2>("uRenderScale");
+	writeGBufferUniform = pathTracerShader->getUniformHandle<int>("uWriteGBuffer");
+	samplerTypeUniform = specializeShaders ? UniformHandle<int>() : pathTracerShader->getUniformHandle<int>("uSamplerType");
+	rouletteDepthUniform = pathTracerShader->getUniformHandle<int>("uRouletteDepth");
+	countRaysUniform = pathTracerShader->getUniformHandle<int>("uCountRays");
+	denoiseIterationUniform = denoiseShader->getUniformHandle<int>("uIteration");
+	denoiseStepSizeUniform = denoiseShader->getUniformHandle<int>("uStepSize");
+	denoiseColorPhiUniform = denoiseShader->getUniformHandle<float>("uColorPhi");
+	denoiseNormalPhiUniform = denoiseShader->getUniformHandle<float>("uNormalPhi");
+	denoiseDepthPhiUniform = denoiseShader->getUniformHandle<float>("uDepthPhi");
+	restirUniform = pathTracerShader->getUniformHandle<int>("uReSTIR");
+	restirTemporalSeedUniform = restirTemporalShader->getUniformHandle<int>("uSeed");
+	restirCandidatesUniform = restirTemporalShader->getUniformHandle<int>("uCandidates");
+	restirTemporalReuseUniform = restirTemporalShader->getUniformHandle<int>("uTemporalReuse");
+	restirViewProjectionUniform = restirTemporalShader->getUniformHandle<glm::mat4>("uPreviousViewProjection");
+	restirMaxHistoryUniform = restirTemporalShader->getUniformHandle<float>("uMaxHistory");
+	restirSpatialSeedUniform = restirSpatialShader->getUniformHandle<int>("uSeed");
+	restirNeighboursUniform = restirSpatialShader->getUniformHandle<int>("uSpatialNeighbours");
+	restirRadiusUniform = restirSpatialShader->getUniformHandle<float>("uSpatialRadius");
+
+	FrameUniformsBuffer::attach(*pathTracerShader);
+	FrameUniformsBuffer::attach(*restirTemporalShader);
+	FrameUniformsBuffer::attach(*restirSpatialShader);
 }
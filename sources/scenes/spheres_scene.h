@@ -1,35 +1,54 @@
 #pragma once
 
+#include <vector>
+#include <cfloat>
+#include <cstdio>
+#include <algorithm>
+
 #include "../graphics/shader.h"
+#include "../graphics/shader_variant_cache.h"
 #include "../graphics/buffer.h"
+#include "../graphics/framebuffer.h"
+#include "../graphics/gpu_profiler.h"
+#include "../graphics/timer_query.h"
+#include "../graphics/texture.h"
 #include "../scene.h"
+#include "../tracing/bvh.h"
+#include "../tracing/sphere_bvh.h"
+#include "../tracing/blue_noise.h"
+#include "../tracing/triangle_mesh.h"
+#include "../tracing/mesh_instances.h"
+#include "../tracing/primitives.h"
+#include "../tracing/light_table.h"
+#include "../tracing/frame_uniforms.h"
 #include "../utils/common.h"
 
-struct Material
+// Mirrors the std430 "Reservoir" of "restir.glsl".
+struct ReSTIRReservoir
 {
-	int type;
+	glm::vec3 lightPoint;
 
-	glm::vec3 albedo, emission;
+	int lightIndex;
 
-	float roughness, indexOfRefraction;
-};
+	glm::vec3 hitPoint;
 
-struct Sphere
-{
-	glm::vec3 center;
+	int hitPrimitive;
 
-	float radius;
+	glm::vec3 hitNormal;
 
-	Material material;
-};
+	float weightSum;
 
-struct PointLight
-{
-	glm::vec3 position, color;
+	glm::vec3 rayDirection;
+
+	float sampleCount;
+
+	float targetDensity, contributionWeight;
 
-	float radius, power;
+	float padding[2];
 };
 
+static_assert(sizeof(ReSTIRReservoir) == 80, "ReSTIRReservoir must match its std430 layout.");
+
 struct SpheresSceneUniforms
 {
 	float time;
@@ -37,14 +56,12 @@ struct SpheresSceneUniforms
 	glm::vec3 skyColor;
 		
 	int maxBounces, samplesPerPixel;
-
-	PointLight lights[1];
 };
 
 class SpheresScene : public Scene
 {
 public:
-	SpheresScene();
+	SpheresScene(int screenWidth, int screenHeight);
 
 	void setup();
 	void clean();
@@ -54,12 +71,214 @@ public:
 
 	void processGUI();
 
+	void setScreenDimensions(int width, int height);
+
+	RenderSettings getRenderSettings();
+	void setRenderSettings(const RenderSettings& settings);
+
+	void readFrame(std::vector<float>& pixels);
+
+	uint64_t getTracedRays();
+	SamplingStatistics getSamplingStatistics();
+	RayStatistics getRayStatistics();
+
+	void watchShaders(ShaderReloader& reloader);
+	void onShadersReloaded();
+
+	// Scene content without any OpenGL object, shared with the CPU path tracer.
+	static void createSpheres(std::vector<Sphere>& spheres, std::vector<PointLight>& lights);
+
+	// Dialog sections shared with "WavefrontScene", true when the edits need a new accumulation. "bouncesActive" tells
+	// whether the bounces are being dragged. Edited lights rebuild "lightTable" and are uploaded to "lightsSSBO".
+	static bool processUniformsGUI(SpheresSceneUniforms& uniforms, bool& bouncesActive);
+	static bool processLightsGUI(std::vector<PointLight>& lights, const std::vector<Sphere>& spheres, LightTable& lightTable, SSBO* lightsSSBO);
+
+	// Traces the triangles of "path" (OBJ or PLY) along the spheres, as a single instance placed by "transform".
+	// Replaces the current instances, which are kept when the file fails to load. Needs "setup".
+	bool loadMesh(const std::string& path, const glm::mat4& transform = glm::mat4(1.0f));
+	void removeMesh();
+
+	const MeshStatistics& getMeshStatistics() const; // Of the last mesh "loadMesh" loaded.
+	const InstanceStatistics& getInstanceStatistics() const;
+
+protected:
+	// Fills the spheres (in the leaf order of "spheresBVH"), the lights and their table, and optionally the sky, the
+	// instances and their materials, before "setup" uploads them. The default content comes from "createSpheres".
+	virtual void createContent();
+
 private:
-	ShaderProgram* pathTracerShader;
+	int screenWidth, screenHeight;
+
+	// Tracing (and denoising) happens at "resolutionScale" times the screen size, the present pass upscales it.
+	float resolutionScale;
+	int renderWidth, renderHeight;
+
+	ShaderProgram* pathTracerShader; // Current variant of "pathTracerVariants".
+	ShaderProgram* presentShader;
+
+	// The tracer compiled with the bounce count, material types and sampler as constants (or without any of them when
+	// "specializeShaders" is off). Changing the bounces or the sampler picks another variant, the least recently used
+	// ones are deleted past "ShaderVariantCache::DEFAULT_MAX_VARIANTS".
+	ShaderVariantCache* pathTracerVariants;
+	bool specializeShaders;
+	bool dynamicBounces; // "MAX_BOUNCES" is left out of the variants, see "RenderSettings".
+	bool draggingBounces; // Same while the bounces are dragged in the dialog.
+	int materialMask; // Bit "1 << type" for every material type of the spheres and the instances.
+
+	// Uniforms set every frame, resolved in "setup".
+	UniformHandle<int> frameIndexUniform;
+	UniformHandle<int> tileSizeUniform, tilesXUniform, completedTilesUniform;
+	UniformHandle<float> adaptiveThresholdUniform;
+	UniformHandle<int> adaptiveMinSamplesUniform;
+	UniformHandle<int> debugViewUniform;
+	UniformHandle<float> uniformSamplesUniform, errorScaleUniform;
+	UniformHandle<glm::vec2> renderScaleUniform;
+	UniformHandle<int> samplerTypeUniform;
+	UniformHandle<int> rouletteDepthUniform, countRaysUniform;
 
 	VAO* quadVAO;
 	VBO* quadVBO;
 	IBO* quadIBO;
 
+protected:
+	std::vector<Sphere> spheres;
+	std::vector<PointLight> lights;
+	LightTable lightTable; // Point lights and emissive spheres, uploaded to "lightsSSBO" (see "lights.glsl").
+
+	BVH spheresBVH;
+
+private:
+	// Random numbers of the paths (see "sampler.glsl"), the mask is read by the blue noise sampler.
+	static const int BLUE_NOISE_SIZE = 64;
+
+	SamplerTypes samplerType;
+	Texture* blueNoiseTexture;
+
+	SSBO* spheresSSBO;
+	SSBO* lightsSSBO;
+	SSBO* bvhSSBO;
+
+protected:
+	// Meshes and spheres placed by instances, traced along the spheres (see "intersection.glsl"), empty until
+	// "loadMesh" unless the content has some. Instances index "meshMaterials", the one of "loadMesh" uses the first
+	// (a lambertian material unless edited). The buffers only exist with instances.
+	MeshInstances instances;
+	std::vector<Material> meshMaterials;
+
+private:
+	char meshPathInput[256];
+	MeshStatistics meshStatistics;
+
+	SSBO* meshVerticesSSBO;
+	SSBO* trianglesSSBO;
+	SSBO* meshBVHSSBO;
+	SSBO* meshMaterialsSSBO;
+	SSBO* meshRangesSSBO;
+	SSBO* instancesSSBO;
+	SSBO* instanceBVHSSBO;
+
+	// Ping-pong targets holding the running average of every frame traced since the last reset.
+	// Each frame reads from one of them and writes the new average into the other.
+	// The second attachment holds the luminance moments of every pixel (see "adaptive.glsl").
+	FrameBuffer* accumulationBuffers[2];
+	int accumulationIndex, frameIndex;
+
+	// Adaptive sampling: pixels whose relative error fell under "adaptiveThreshold" stop being sampled, and the
+	// samples they free go to the others. The shader counts the sampled pixels of every pass in "adaptiveSSBO"
+	// and the next pass spreads its budget over them, without the count ever coming back to the host.
+	float adaptiveThreshold;
+	int adaptiveMinSamples;
+	SSBO* adaptiveSSBO;
+
+	int debugView; // 0: image, 1: samples heatmap, 2: relative error heatmap.
+	SamplingStatistics samplingStatistics; // Last measured from the GUI.
+
+	// Russian roulette ends paths past "rouletteDepth" bounces with the probability of their throughput (zero disables
+	// it). When "countRays" is on, the tracer counts the paths of every length and the shadow rays of the pass in
+	// "rayStatisticsSSBO" (one entry per bounce up to "MAX_COUNTED_BOUNCES", see "path_tracer_2.frag").
+	static const int MAX_COUNTED_BOUNCES = 128;
+	static const int RAY_STATISTICS_INTERVAL = 30; // GUI frames between two reads of "rayStatistics".
+
+	int rouletteDepth;
+	bool countRays;
+	SSBO* rayStatisticsSSBO;
+	RayStatistics rayStatistics; // Last read by the GUI.
+	int rayStatisticsAge; // GUI frames left before the next read, zero reads as soon as the statistics are shown.
+
+	// ReSTIR DI (see "restir.comp"): at the start of every pass, each pixel resamples "restirCandidates" lights at the hit
+	// of a jittered camera ray, merges the reservoir of the previous pass at the reprojected hit, then the reservoirs of
+	// "restirNeighbours" pixels around it. The first sample of the pixel follows that ray and shades its hit with the
+	// reservoir and a single shadow ray. Reservoirs take 80 bytes per pixel, they are only allocated once enabled.
+	ShaderProgram* restirTemporalShader;
+	ShaderProgram* restirSpatialShader;
+	bool restir;
+	int restirCandidates, restirNeighbours;
+	float restirRadius, restirMaxHistory;
+	SSBO* reservoirSSBOs[2]; // Output of the temporal kernel, then the reservoirs of the pass (read by the next one).
+	bool restirHistory; // The reservoirs of the pass belong to the current scene and resolution.
+	int restirSeed; // Passes resampled so far, unlike "frameIndex" never reset.
+	glm::mat4 restirViewProjection; // Camera of the previous resampling.
+
+	UniformHandle<int> restirUniform;
+	UniformHandle<int> restirTemporalSeedUniform, restirSpatialSeedUniform, restirCandidatesUniform, restirTemporalReuseUniform;
+	UniformHandle<glm::mat4> restirViewProjectionUniform;
+	UniformHandle<float> restirMaxHistoryUniform, restirRadiusUniform;
+	UniformHandle<int> restirNeighboursUniform;
+
+	// Denoiser: "denoiseIterations" à-trous passes over the latest complete accumulation, guided by the first-hit
+	// G-buffer the trace pass writes in the last two attachments (see "denoise.frag"). It runs once per pass, so with
+	// time slicing the denoised image trails the traced one.
+	static const int MAX_DENOISE_ITERATIONS = 8;
+	static const char* DENOISE_SCOPE_NAMES[MAX_DENOISE_ITERATIONS]; // Profiler scope of every iteration.
+
+	ShaderProgram* denoiseShader;
+	FrameBuffer* denoiseBuffers[2];
+	bool denoise;
+	int denoiseIterations;
+	float denoiseColorPhi, denoiseNormalPhi, denoiseDepthPhi;
+	int denoisedIndex; // Buffer holding the denoised image, -1 while there is none for the current accumulation.
+
+	UniformHandle<int> writeGBufferUniform;
+	UniformHandle<int> denoiseIterationUniform, denoiseStepSizeUniform;
+	UniformHandle<float> denoiseColorPhiUniform, denoiseNormalPhiUniform, denoiseDepthPhiUniform;
+
+	glm::mat4 lastViewMatrix, lastProjectionMatrix;
+
+	// The trace pass is split in square tiles, and each frame only traces as many as fit in "gpuTimeBudget",
+	// so heavy settings spread one accumulated frame over several displayed ones instead of freezing the UI
+	// (or tripping the driver watchdog). Tiles are traced in order and "nextTile" is where the pass resumes.
+	int tileSize, nextTile, tilesLastFrame;
+	float gpuTimeBudget;
+	float tileTime; // Moving average of the GPU time of one tile in milliseconds, zero until measured.
+
+	TimerQuery* traceTimer;
+
+protected:
 	SpheresSceneUniforms uniforms;
+
+private:
+	FrameUniforms frameUniforms;
+	FrameUniformsBuffer* frameUniformsBuffer;
+
+	void setupShaders();
+	void selectPathTracerVariant();
+	void updateMaterialMask();
+
+	void createMeshBuffers();
+	void cleanMeshBuffers();
+
+	std::vector<ShaderDefine> getPathTracerDefines() const;
+
+	void createAccumulationBuffers();
+	void cleanAccumulationBuffers();
+	void resetAccumulation();
+
+	void denoiseAccumulation(FrameBuffer* accumulationBuffer);
+
+	void createReservoirBuffers();
+	void cleanReservoirBuffers();
+	void resampleReservoirs();
+
+	int getNumberOfTiles() const;
+	int getTilesThisFrame();
 };
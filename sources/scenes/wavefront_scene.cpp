@@ -0,0 +1,636 @@
+#include "wavefront_scene.h"
+
+// Stages of the "KERNEL_DISPATCH" kernel, see "wavefront.comp".
+static const int STAGE_EXTEND = 0;
+static const int STAGE_SHADE = 1;
+static const int STAGE_SHADOW = 2;
+
+static const int DISPATCH_EXTEND = 0;
+static const int DISPATCH_SHADE = 1;
+static const int DISPATCH_SHADOW = 4;
+
+WavefrontScene::WavefrontScene(int screenWidth, int screenHeight)
+	: Scene(), screenWidth(screenWidth), screenHeight(screenHeight),
+	  generateShader(nullptr), dispatchShader(nullptr), extendShader(nullptr), shadeShaders(), shadowShader(nullptr), accumulateShader(nullptr), presentShader(nullptr),
+	  generateSampleIndexUniform(), generateFrameIndexUniform(), dispatchStageUniform(), dispatchRayQueueUniform(), extendRayQueueUniform(), shadeRayQueueUniforms(), accumulateFrameIndexUniform(),
+	  quadVAO(nullptr), quadVBO(nullptr), quadIBO(nullptr), spheres(), lights(), lightTable(), spheresBVH(), spheresSSBO(nullptr), lightsSSBO(nullptr), bvhSSBO(nullptr),
+	  pathsSSBO(nullptr), queuesSSBO(nullptr), shadowSSBO(nullptr), countersSSBO(nullptr), statisticsSSBO(nullptr),
+	  accumulationBuffer(nullptr), frameIndex(0), lastViewMatrix(0.0f), lastProjectionMatrix(0.0f),
+	  profiledFrames(), firstProfiledFrame(0), profiledFramesInFlight(0), currentProfiledFrame(nullptr), kernelStatistics(),
+	  uniforms({ 0.0f, glm::vec3(0.5f, 0.7f, 1.0f), 16, 1 }), frameUniforms(), frameUniformsBuffer(nullptr)
+{
+}
+
+void WavefrontScene::setup()
+{
+	float vertices[] = {
+		-1.0f, -1.0f,
+		 1.0f, -1.0f,
+		 1.0f,  1.0f,
+		-1.0f,  1.0f
+	};
+
+	unsigned int indices[] = {
+		0, 1, 2,
+		2, 3, 0
+	};
+
+	const char* kernelsFilepath = "sources/shaders/wavefront.comp";
+
+	generateShader = new ShaderProgram(kernelsFilepath, { { "KERNEL_GENERATE", "1" } });
+	dispatchShader = new ShaderProgram(kernelsFilepath, { { "KERNEL_DISPATCH", "1" } });
+	extendShader = new ShaderProgram(kernelsFilepath, { { "KERNEL_EXTEND", "1" } });
+	shadowShader = new ShaderProgram(kernelsFilepath, { { "KERNEL_SHADOW", "1" } });
+	accumulateShader = new ShaderProgram(kernelsFilepath, { { "KERNEL_ACCUMULATE", "1" } });
+
+	// Every material gets a kernel of its own, so a warp only ever runs one scatter function.
+	for (int i = 0; i < 3; i++)
+	{
+		shadeShaders[i] = new ShaderProgram(kernelsFilepath, { { "KERNEL_SHADE", "1" }, { "MATERIAL_TYPE", std::to_string(i) } });
+	}
+
+	presentShader = new ShaderProgram("sources/shaders/path_tracer.vert", "sources/shaders/present.frag");
+
+	setupShaders();
+
+	frameUniformsBuffer = new FrameUniformsBuffer();
+
+	SpheresScene::createSpheres(spheres, lights);
+	SphereBVH::build(spheres, spheresBVH);
+
+	spheresSSBO = new SSBO(spheres.data(), int(spheres.size() * sizeof(Sphere)));
+	bvhSSBO = new SSBO(spheresBVH.getNodes().data(), int(spheresBVH.getNodes().size() * sizeof(BVHNode)));
+	lightTable.build(spheres, lights);
+	lightsSSBO = new SSBO(lightTable.getLights().data(), int(lightTable.getLights().size() * sizeof(Light)), GL_DYNAMIC_DRAW);
+
+	countersSSBO = new SSBO(nullptr, sizeof(WavefrontCounters), GL_DYNAMIC_COPY);
+	statisticsSSBO = new SSBO(nullptr, PROFILED_FRAMES * sizeof(WavefrontCounters), GL_STREAM_READ);
+
+	quadVAO = new VAO();
+	quadVBO = new VBO(vertices, sizeof(vertices));
+	quadIBO = new IBO(indices, sizeof(indices));
+
+	quadVAO->bind();
+	quadVBO->bind();
+	quadIBO->bind();
+
+	quadVAO->setVertexAttribute(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)(0));
+
+	quadVAO->unbind(); // Unbind VAO before another buffer.
+	quadVBO->unbind();
+	quadIBO->unbind();
+
+	createPathBuffers();
+}
+
+void WavefrontScene::watchShaders(ShaderReloader& reloader)
+{
+	reloader.watch(generateShader);
+	reloader.watch(dispatchShader);
+	reloader.watch(extendShader);
+	reloader.watch(shadowShader);
+	reloader.watch(accumulateShader);
+
+	for (int i = 0; i < 3; i++)
+	{
+		reloader.watch(shadeShaders[i]);
+	}
+
+	reloader.watch(presentShader);
+}
+
+void WavefrontScene::onShadersReloaded()
+{
+	setupShaders();
+
+	// Samples of the previous version would blend with the new ones.
+	resetAccumulation();
+}
+
+void WavefrontScene::clean()
+{
+	generateShader->clean();
+	dispatchShader->clean();
+	extendShader->clean();
+	shadowShader->clean();
+	accumulateShader->clean();
+	presentShader->clean();
+
+	for (int i = 0; i < 3; i++)
+	{
+		shadeShaders[i]->clean();
+	}
+
+	cleanPathBuffers();
+
+	quadVBO->clean();
+	quadVAO->clean();
+	quadIBO->clean();
+
+	spheresSSBO->clean();
+	lightsSSBO->clean();
+	bvhSSBO->clean();
+	countersSSBO->clean();
+	statisticsSSBO->clean();
+
+	for (ProfiledFrame& profiledFrame : profiledFrames)
+	{
+		if (!profiledFrame.queryIDs.empty())
+		{
+			glDeleteQueries(int(profiledFrame.queryIDs.size()), profiledFrame.queryIDs.data());
+		}
+	}
+
+	frameUniformsBuffer->clean();
+
+	delete frameUniformsBuffer;
+}
+
+void WavefrontScene::update(float deltaTime)
+{
+	uniforms.time += deltaTime;
+}
+
+void WavefrontScene::render(const Camera& camera, float)
+{
+	// Any camera movement invalidates the samples gathered so far.
+	if (camera.getViewMatrix() != lastViewMatrix || camera.getProjectionMatrix() != lastProjectionMatrix)
+	{
+		lastViewMatrix = camera.getViewMatrix();
+		lastProjectionMatrix = camera.getProjectionMatrix();
+
+		frameUniforms.inverseProjectionMatrix = glm::inverse(lastProjectionMatrix);
+		frameUniforms.inverseViewMatrix = glm::inverse(lastViewMatrix);
+		frameUniforms.cameraPosition = camera.getPosition();
+
+		resetAccumulation();
+	}
+
+	frameUniforms.skyColor = uniforms.skyColor;
+	frameUniforms.viewportSize = glm::ivec2(screenWidth, screenHeight);
+	frameUniforms.maxBounces = uniforms.maxBounces;
+	frameUniforms.samplesPerPixel = uniforms.samplesPerPixel;
+	frameUniforms.numSpheres = int(spheres.size());
+	frameUniforms.numLights = int(lightTable.getLights().size());
+	frameUniforms.numNodes = int(spheresBVH.getNodes().size());
+
+	frameUniformsBuffer->update(frameUniforms);
+	frameUniformsBuffer->bindBase();
+
+	retrieveStatistics();
+
+	// Measure this frame unless every slot is still waiting for the GPU.
+	currentProfiledFrame = nullptr;
+
+	if (profiledFramesInFlight < PROFILED_FRAMES)
+	{
+		currentProfiledFrame = &profiledFrames[(firstProfiledFrame + profiledFramesInFlight) % PROFILED_FRAMES];
+		currentProfiledFrame->numberOfQueries = 0;
+		currentProfiledFrame->kernels.clear();
+		currentProfiledFrame->numberOfPaths = screenWidth * screenHeight;
+		currentProfiledFrame->samplesPerPixel = uniforms.samplesPerPixel;
+	}
+
+	int numberOfPaths = screenWidth * screenHeight;
+
+	WavefrontCounters counters = {};
+	countersSSBO->update(&counters, sizeof(WavefrontCounters));
+
+	spheresSSBO->bindBase(0);
+	lightsSSBO->bindBase(1);
+	bvhSSBO->bindBase(2);
+	pathsSSBO->bindBase(3);
+	queuesSSBO->bindBase(4);
+	shadowSSBO->bindBase(5);
+	countersSSBO->bindBase(6);
+	countersSSBO->bindIndirect();
+
+	GpuProfiler::beginScope("Trace");
+
+	for (int s = 0; s < uniforms.samplesPerPixel; s++)
+	{
+		generateShader->bind();
+		generateShader->setUniform(generateSampleIndexUniform, s);
+		generateShader->setUniform(generateFrameIndexUniform, frameIndex);
+
+		dispatchKernel(WavefrontKernels::GENERATE, numberOfPaths);
+
+		int rayQueue = 0;
+
+		// Dead paths leave the queues, so late bounces dispatch (a lot) fewer groups than the first one.
+		for (int bounce = 0; bounce < uniforms.maxBounces; bounce++)
+		{
+			dispatchArguments(STAGE_EXTEND, rayQueue);
+
+			extendShader->bind();
+			extendShader->setUniform(extendRayQueueUniform, rayQueue);
+
+			dispatchKernelIndirect(WavefrontKernels::EXTEND, DISPATCH_EXTEND);
+
+			dispatchArguments(STAGE_SHADE, rayQueue);
+
+			for (int i = 0; i < 3; i++)
+			{
+				shadeShaders[i]->bind();
+				shadeShaders[i]->setUniform(shadeRayQueueUniforms[i], rayQueue);
+
+				dispatchKernelIndirect(WavefrontKernels(int(WavefrontKernels::SHADE_LAMBERTIAN) + i), DISPATCH_SHADE + i);
+			}
+
+			dispatchArguments(STAGE_SHADOW, rayQueue);
+
+			shadowShader->bind();
+
+			dispatchKernelIndirect(WavefrontKernels::SHADOW, DISPATCH_SHADOW);
+
+			rayQueue = 1 - rayQueue;
+		}
+	}
+
+	// The totals are complete, keep them with the timestamps of the frame.
+	if (currentProfiledFrame != nullptr)
+	{
+		int slot = int(currentProfiledFrame - profiledFrames);
+
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+		countersSSBO->copyTo(*statisticsSSBO, 0, slot * int(sizeof(WavefrontCounters)), sizeof(WavefrontCounters));
+	}
+
+	accumulationBuffer->bindColorBufferImage(0, GL_READ_WRITE, GL_RGBA32F);
+
+	accumulateShader->bind();
+	accumulateShader->setUniform(accumulateFrameIndexUniform, frameIndex);
+
+	dispatchKernel(WavefrontKernels::ACCUMULATE, numberOfPaths);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+
+	GpuProfiler::endScope();
+
+	if (currentProfiledFrame != nullptr)
+	{
+		profiledFramesInFlight += 1;
+	}
+
+	// Present pass: tone the accumulated (linear) radiance into the bound framebuffer.
+	GpuProfiler::beginScope("Present");
+
+	presentShader->bind();
+	quadVAO->bind();
+	accumulationBuffer->bindColorBuffer(0);
+
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+	quadVAO->unbind();
+	presentShader->unbind();
+
+	GpuProfiler::endScope();
+
+	frameIndex += 1;
+}
+
+void WavefrontScene::processGUI()
+{
+	bool dialogOpen = true;
+	bool changed = false;
+
+	ImGui::Begin("Wavefront Scene", &dialogOpen, ImGuiWindowFlags_MenuBar);
+
+	// Every bounce count runs the same kernels, so dragging them needs nothing more.
+	bool bouncesActive = false;
+
+	changed |= SpheresScene::processUniformsGUI(uniforms, bouncesActive);
+	changed |= SpheresScene::processLightsGUI(lights, spheres, lightTable, lightsSSBO);
+
+	ImGui::SeparatorText("Accumulation");
+	ImGui::Text("Frames: %d (%d samples per pixel)", frameIndex, frameIndex * uniforms.samplesPerPixel);
+
+	ImGui::SeparatorText("Kernels");
+
+	if (ImGui::BeginTable("Kernels", 4, ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Kernel");
+		ImGui::TableSetupColumn("GPU (ms)");
+		ImGui::TableSetupColumn("Rays");
+		ImGui::TableSetupColumn("MRays/s");
+		ImGui::TableHeadersRow();
+
+		for (int i = 0; i < int(WavefrontKernels::COUNT); i++)
+		{
+			const WavefrontKernelStatistics& statistics = kernelStatistics[i];
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::Text("%s", getKernelName(WavefrontKernels(i)));
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", statistics.time);
+			ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)statistics.rays);
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", statistics.raysPerSecond / 1.0e6);
+		}
+
+		ImGui::EndTable();
+	}
+
+	if (ImGui::Button("Reset") || changed)
+	{
+		resetAccumulation();
+	}
+
+	ImGui::End();
+}
+
+void WavefrontScene::setScreenDimensions(int width, int height)
+{
+	// Minimized windows report a zero sized framebuffer.
+	if (width <= 0 || height <= 0 || (width == screenWidth && height == screenHeight))
+	{
+		return;
+	}
+
+	screenWidth = width;
+	screenHeight = height;
+
+	cleanPathBuffers();
+	createPathBuffers();
+}
+
+RenderSettings WavefrontScene::getRenderSettings()
+{
+	// Every frame traces the whole screen, there is no time slicing, the kernels aren't specialized, every pixel is
+	// sampled evenly, there is no denoiser, the paths are sized with the screen, they only draw white noise and every
+	// path runs until it escapes or reaches the last bounce (the kernels count their rays without being asked).
+	return { uniforms.maxBounces, uniforms.samplesPerPixel, 0.0f, false, false, 0.0f, false, 1.0f, SamplerTypes::WHITE_NOISE, 0, false, false };
+}
+
+void WavefrontScene::setRenderSettings(const RenderSettings& settings)
+{
+	if (settings.maxBounces != uniforms.maxBounces || settings.samplesPerPixel != uniforms.samplesPerPixel)
+	{
+		uniforms.maxBounces = settings.maxBounces;
+		uniforms.samplesPerPixel = settings.samplesPerPixel;
+
+		resetAccumulation();
+	}
+}
+
+void WavefrontScene::readFrame(std::vector<float>& pixels)
+{
+	pixels.resize(size_t(accumulationBuffer->getWidth()) * accumulationBuffer->getHeight() * 4);
+
+	accumulationBuffer->readColorBuffer(pixels.data(), GL_RGBA, GL_FLOAT);
+}
+
+uint64_t WavefrontScene::getTracedRays()
+{
+	// Extension rays are the camera and scattered ones.
+	return kernelStatistics[int(WavefrontKernels::EXTEND)].rays + kernelStatistics[int(WavefrontKernels::SHADOW)].rays;
+}
+
+SamplingStatistics WavefrontScene::getSamplingStatistics()
+{
+	int pixels = screenWidth * screenHeight;
+	uint64_t samples = uint64_t(pixels) * uint64_t(frameIndex) * uint64_t(uniforms.samplesPerPixel);
+
+	return { samples, samples, pixels, 0 };
+}
+
+RayStatistics WavefrontScene::getRayStatistics()
+{
+	// Only totals of the frame are counted (see "getKernelStatistics").
+	return { {}, 0 };
+}
+
+const WavefrontKernelStatistics& WavefrontScene::getKernelStatistics(WavefrontKernels kernel) const
+{
+	return kernelStatistics[int(kernel)];
+}
+
+const char* WavefrontScene::getKernelName(WavefrontKernels kernel)
+{
+	switch (kernel)
+	{
+	case WavefrontKernels::GENERATE:
+		return "Generate";
+
+	case WavefrontKernels::EXTEND:
+		return "Extend";
+
+	case WavefrontKernels::SHADE_LAMBERTIAN:
+		return "Shade Lambertian";
+
+	case WavefrontKernels::SHADE_METAL:
+		return "Shade Metal";
+
+	case WavefrontKernels::SHADE_DIELECTRIC:
+		return "Shade Dielectric";
+
+	case WavefrontKernels::SHADOW:
+		return "Shadow";
+
+	case WavefrontKernels::ACCUMULATE:
+		return "Accumulate";
+
+	default:
+		return "Unknown";
+	}
+}
+
+void WavefrontScene::createPathBuffers()
+{
+	int numberOfPaths = screenWidth * screenHeight;
+
+	// Two ray queues (ping-pong between bounces) and one queue per material.
+	pathsSSBO = new SSBO(nullptr, numberOfPaths * int(sizeof(WavefrontPathState)), GL_DYNAMIC_COPY);
+	queuesSSBO = new SSBO(nullptr, 5 * numberOfPaths * int(sizeof(int)), GL_DYNAMIC_COPY);
+	shadowSSBO = new SSBO(nullptr, numberOfPaths * int(sizeof(WavefrontShadowRecord)), GL_DYNAMIC_COPY);
+
+	accumulationBuffer = new FrameBuffer(screenWidth, screenHeight, 1, GL_RGBA32F, GL_NEAREST, GL_CLAMP_TO_EDGE, DepthAndStencilType::NONE);
+
+	resetAccumulation();
+}
+
+void WavefrontScene::cleanPathBuffers()
+{
+	if (pathsSSBO != nullptr)
+	{
+		pathsSSBO->clean();
+		queuesSSBO->clean();
+		shadowSSBO->clean();
+		accumulationBuffer->clean();
+
+		delete pathsSSBO;
+		delete queuesSSBO;
+		delete shadowSSBO;
+		delete accumulationBuffer;
+
+		pathsSSBO = nullptr;
+		queuesSSBO = nullptr;
+		shadowSSBO = nullptr;
+		accumulationBuffer = nullptr;
+	}
+}
+
+void WavefrontScene::resetAccumulation()
+{
+	// The first frame after a reset overwrites the target instead of blending with it (see "wavefront.comp").
+	frameIndex = 0;
+}
+
+void WavefrontScene::dispatchKernel(WavefrontKernels kernel, int numberOfInvocations)
+{
+	beginKernelTimestamp(kernel);
+
+	glDispatchCompute((numberOfInvocations + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+
+	// The barrier is part of the measurement, some drivers (e.g. Mesa llvmpipe) only run the dispatch once it flushes.
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	endKernelTimestamp();
+}
+
+void WavefrontScene::dispatchKernelIndirect(WavefrontKernels kernel, int dispatchIndex)
+{
+	beginKernelTimestamp(kernel);
+
+	glDispatchComputeIndirect(GLintptr(offsetof(WavefrontCounters, dispatches) + dispatchIndex * 3 * sizeof(uint32_t)));
+
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	endKernelTimestamp();
+}
+
+void WavefrontScene::dispatchArguments(int stage, int rayQueue)
+{
+	dispatchShader->bind();
+	dispatchShader->setUniform(dispatchStageUniform, stage);
+	dispatchShader->setUniform(dispatchRayQueueUniform, rayQueue);
+
+	glDispatchCompute(1, 1, 1);
+
+	// The next dispatches read what this one writes as commands.
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
+
+void WavefrontScene::beginKernelTimestamp(WavefrontKernels kernel)
+{
+	if (currentProfiledFrame == nullptr)
+	{
+		return;
+	}
+
+	ProfiledFrame& frame = *currentProfiledFrame;
+
+	// Query objects are only ever added, a frame with more bounces than the previous ones grows the pool.
+	if (frame.numberOfQueries + 2 > int(frame.queryIDs.size()))
+	{
+		size_t previousSize = frame.queryIDs.size();
+
+		frame.queryIDs.resize(std::max<size_t>(64, previousSize * 2));
+
+		glGenQueries(int(frame.queryIDs.size() - previousSize), frame.queryIDs.data() + previousSize);
+	}
+
+	glQueryCounter(frame.queryIDs[frame.numberOfQueries], GL_TIMESTAMP);
+
+	frame.kernels.push_back(kernel);
+	frame.numberOfQueries += 1;
+}
+
+void WavefrontScene::endKernelTimestamp()
+{
+	if (currentProfiledFrame == nullptr)
+	{
+		return;
+	}
+
+	glQueryCounter(currentProfiledFrame->queryIDs[currentProfiledFrame->numberOfQueries], GL_TIMESTAMP);
+
+	currentProfiledFrame->numberOfQueries += 1;
+}
+
+void WavefrontScene::retrieveStatistics()
+{
+	// Frames finish in order, so only the oldest one in flight can be ready.
+	while (profiledFramesInFlight > 0)
+	{
+		int slot = firstProfiledFrame;
+		ProfiledFrame& frame = profiledFrames[slot];
+
+		int available = 0;
+		glGetQueryObjectiv(frame.queryIDs[frame.numberOfQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available)
+		{
+			return;
+		}
+
+		float times[int(WavefrontKernels::COUNT)] = {};
+
+		for (int i = 0; i < frame.numberOfQueries; i += 2)
+		{
+			uint64_t begin = 0, end = 0;
+
+			glGetQueryObjectui64v(frame.queryIDs[i], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame.queryIDs[i + 1], GL_QUERY_RESULT, &end);
+
+			times[int(frame.kernels[i / 2])] += float(double(end - begin) / 1.0e6);
+		}
+
+		WavefrontCounters counters;
+		statisticsSSBO->read(&counters, slot * int(sizeof(WavefrontCounters)), sizeof(WavefrontCounters));
+
+		uint64_t samples = uint64_t(frame.numberOfPaths) * frame.samplesPerPixel;
+		uint64_t rays[int(WavefrontKernels::COUNT)] = {
+			samples,
+			counters.extendedRays,
+			counters.shadedPaths[0],
+			counters.shadedPaths[1],
+			counters.shadedPaths[2],
+			counters.shadowRecordsTraced,
+			samples
+		};
+
+		for (int i = 0; i < int(WavefrontKernels::COUNT); i++)
+		{
+			kernelStatistics[i].time = times[i];
+			kernelStatistics[i].rays = rays[i];
+			kernelStatistics[i].raysPerSecond = times[i] > 0.0f ? double(rays[i]) / (double(times[i]) / 1000.0) : 0.0;
+		}
+
+		firstProfiledFrame = (firstProfiledFrame + 1) % PROFILED_FRAMES;
+		profiledFramesInFlight -= 1;
+	}
+}
+
+void WavefrontScene::setupShaders()
+{
+	// Every kernel but the dispatch one reads the frame constants.
+	FrameUniformsBuffer::attach(*generateShader);
+	FrameUniformsBuffer::attach(*extendShader);
+	FrameUniformsBuffer::attach(*shadowShader);
+	FrameUniformsBuffer::attach(*accumulateShader);
+
+	for (int i = 0; i < 3; i++)
+	{
+		FrameUniformsBuffer::attach(*shadeShaders[i]);
+	}
+
+	generateSampleIndexUniform = generateShader->getUniformHandle<int>("uSampleIndex");
+	generateFrameIndexUniform = generateShader->getUniformHandle<int>("uFrameIndex");
+	dispatchStageUniform = dispatchShader->getUniformHandle<int>("uStage");
+	dispatchRayQueueUniform = dispatchShader->getUniformHandle<int>("uRayQueue");
+	extendRayQueueUniform = extendShader->getUniformHandle<int>("uRayQueue");
+	accumulateFrameIndexUniform = accumulateShader->getUniformHandle<int>("uFrameIndex");
+
+	for (int i = 0; i < 3; i++)
+	{
+		shadeRayQueueUniforms[i] = shadeShaders[i]->getUniformHandle<int>("uRayQueue");
+	}
+
+	// The accumulation is presented as is, there are no pending tiles to fall back on.
+	presentShader->bind();
+	presentShader->setUniform1i("uAccumulationTexture", 0);
+	presentShader->setUniform1i("uPreviousTexture", 0);
+	presentShader->unbind();
+}
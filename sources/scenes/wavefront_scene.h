@@ -0,0 +1,210 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "../graphics/shader.h"
+#include "../graphics/buffer.h"
+#include "../graphics/framebuffer.h"
+#include "../graphics/gpu_profiler.h"
+#include "../scene.h"
+#include "../tracing/bvh.h"
+#include "../tracing/primitives.h"
+#include "../tracing/light_table.h"
+#include "../tracing/frame_uniforms.h"
+#include "../utils/common.h"
+
+#include "spheres_scene.h"
+
+// The structures below mirror the std430 blocks of "wavefront.comp".
+
+struct WavefrontPathState
+{
+	glm::vec3 origin;
+
+	uint32_t randState;
+
+	glm::vec3 direction;
+
+	int hitSphere;
+
+	glm::vec3 throughput;
+
+	float hitDistance;
+
+	glm::vec3 radiance;
+
+	float padding;
+};
+
+struct WavefrontShadowRecord
+{
+	glm::vec3 origin;
+
+	int pathIndex;
+
+	glm::vec3 direction;
+
+	float distance;
+
+	glm::vec3 contribution;
+
+	float padding;
+};
+
+struct WavefrontCounters
+{
+	uint32_t rayCounts[2];
+	uint32_t materialCounts[3];
+	uint32_t shadowCount;
+
+	// Totals of the frame.
+	uint32_t extendedRays;
+	uint32_t shadedPaths[3];
+	uint32_t shadowRecordsTraced;
+
+	uint32_t dispatches[5][3]; // "glDispatchComputeIndirect" arguments: extend, shade (one per material) and shadow.
+};
+
+static_assert(sizeof(WavefrontPathState) == 64, "WavefrontPathState must match its std430 layout.");
+static_assert(sizeof(WavefrontShadowRecord) == 48, "WavefrontShadowRecord must match its std430 layout.");
+static_assert(sizeof(WavefrontCounters) == 104, "WavefrontCounters must match its std430 layout.");
+
+enum class WavefrontKernels
+{
+	GENERATE, EXTEND, SHADE_LAMBERTIAN, SHADE_METAL, SHADE_DIELECTRIC, SHADOW, ACCUMULATE, COUNT
+};
+
+struct WavefrontKernelStatistics
+{
+	float time; // GPU milliseconds of every dispatch of the kernel in the frame.
+
+	uint64_t rays; // Rays (or samples, for the generate and accumulate kernels) processed in the frame.
+	double raysPerSecond;
+};
+
+// Same scene as "SpheresScene", traced by compute kernels instead of a single fragment shader.
+//
+// In the fragment shader every pixel runs its whole path, so the material switch diverges inside a warp and lanes
+// whose path ended idle until the longest one finishes. Here every bounce runs as separate dispatches: the extend
+// kernel sorts the live paths in one queue per material, each material is shaded by its own kernel, and the paths
+// they scatter are compacted in the ray queue of the next bounce. Queue sizes stay on the GPU: a single invocation
+// kernel turns the atomic counters into indirect dispatch arguments, so the host never waits for them.
+//
+class WavefrontScene : public Scene
+{
+public:
+	WavefrontScene(int screenWidth, int screenHeight);
+
+	void setup();
+	void clean();
+
+	void update(float deltaTime);
+	void render(const Camera& camera, float deltaTime);
+
+	void processGUI();
+
+	void setScreenDimensions(int width, int height);
+
+	RenderSettings getRenderSettings();
+	void setRenderSettings(const RenderSettings& settings);
+
+	void readFrame(std::vector<float>& pixels);
+
+	uint64_t getTracedRays();
+	SamplingStatistics getSamplingStatistics();
+	RayStatistics getRayStatistics();
+
+	void watchShaders(ShaderReloader& reloader);
+	void onShadersReloaded();
+
+	// Latest measured frame, a few frames behind the rendered one.
+	const WavefrontKernelStatistics& getKernelStatistics(WavefrontKernels kernel) const;
+
+	static const char* getKernelName(WavefrontKernels kernel);
+
+private:
+	static const int GROUP_SIZE = 64; // "local_size_x" of the kernels.
+	static const int PROFILED_FRAMES = 4; // Frames whose measurements can be in flight at once.
+
+	// Timestamps around every dispatch of a frame, and the counters copied at its end.
+	struct ProfiledFrame
+	{
+		std::vector<uint32_t> queryIDs;
+		std::vector<WavefrontKernels> kernels; // One per pair of queries.
+
+		int numberOfQueries, numberOfPaths, samplesPerPixel;
+	};
+
+	int screenWidth, screenHeight;
+
+	ShaderProgram* generateShader;
+	ShaderProgram* dispatchShader;
+	ShaderProgram* extendShader;
+	ShaderProgram* shadeShaders[3]; // One per material type.
+	ShaderProgram* shadowShader;
+	ShaderProgram* accumulateShader;
+	ShaderProgram* presentShader;
+
+	// Uniforms set every frame (or dispatch), resolved in "setup".
+	UniformHandle<int> generateSampleIndexUniform, generateFrameIndexUniform;
+	UniformHandle<int> dispatchStageUniform, dispatchRayQueueUniform;
+	UniformHandle<int> extendRayQueueUniform;
+	UniformHandle<int> shadeRayQueueUniforms[3];
+	UniformHandle<int> accumulateFrameIndexUniform;
+
+	VAO* quadVAO;
+	VBO* quadVBO;
+	IBO* quadIBO;
+
+	std::vector<Sphere> spheres;
+	std::vector<PointLight> lights;
+	LightTable lightTable; // Point lights and emissive spheres, uploaded to "lightsSSBO".
+
+	BVH spheresBVH;
+
+	SSBO* spheresSSBO;
+	SSBO* lightsSSBO;
+	SSBO* bvhSSBO;
+
+	// One path per pixel, sized with the screen.
+	SSBO* pathsSSBO;
+	SSBO* queuesSSBO;
+	SSBO* shadowSSBO;
+	SSBO* countersSSBO;
+	SSBO* statisticsSSBO; // "PROFILED_FRAMES" copies of the counters.
+
+	// The accumulate kernel blends in place, a single target is enough.
+	FrameBuffer* accumulationBuffer;
+	int frameIndex;
+
+	glm::mat4 lastViewMatrix, lastProjectionMatrix;
+
+	ProfiledFrame profiledFrames[PROFILED_FRAMES];
+	int firstProfiledFrame, profiledFramesInFlight;
+	ProfiledFrame* currentProfiledFrame; // Null when this frame isn't measured.
+
+	WavefrontKernelStatistics kernelStatistics[int(WavefrontKernels::COUNT)];
+
+	SpheresSceneUniforms uniforms;
+
+	FrameUniforms frameUniforms;
+	FrameUniformsBuffer* frameUniformsBuffer;
+
+	void setupShaders();
+
+	void createPathBuffers();
+	void cleanPathBuffers();
+	void resetAccumulation();
+
+	void dispatchKernel(WavefrontKernels kernel, int numberOfInvocations);
+	void dispatchKernelIndirect(WavefrontKernels kernel, int dispatchIndex);
+	void dispatchArguments(int stage, int rayQueue);
+
+	void beginKernelTimestamp(WavefrontKernels kernel);
+	void endKernelTimestamp();
+
+	void retrieveStatistics();
+};
@@ -0,0 +1,169 @@
+#version 460 core
+
+// One iteration of the edge-avoiding à-trous wavelet filter, guided like SVGF ("Spatiotemporal Variance-Guided
+// Filtering", Schied et al. 2017).
+//
+// Every iteration blurs with a 5x5 B3-spline kernel whose taps are "uStepSize" pixels apart (1, 2, 4...), so a few
+// iterations cover a wide footprint. Taps are weighted down across the edges of the first-hit G-buffer (normal, depth
+// and primitive) and across luminance differences larger than the noise expected at the pixel. That noise comes from
+// the temporal moments of the accumulation (a pass before the iterations estimates it), and each iteration filters it
+// along with the color.
+
+#include "include/adaptive.glsl"
+
+out vec4 FragColor; // Filtered color, and the variance of its luminance for the next iteration.
+
+uniform sampler2D uColorTexture; // Accumulated color on the variance pass, output of the previous pass afterwards.
+uniform sampler2D uMomentsTexture; // Luminance moments of the accumulation, read by the variance pass only.
+uniform sampler2D uNormalDepthTexture; // First-hit normal and distance, negative distance for the sky.
+uniform sampler2D uAlbedoIDTexture; // First-hit albedo and sphere index.
+
+uniform int uIteration = 0; // Zero estimates the variance, the wavelet iterations follow.
+uniform int uStepSize = 1;
+
+// Edge-stopping strengths, larger values blur more across the corresponding edges.
+uniform float uColorPhi = 4.0;
+uniform float uNormalPhi = 128.0; // Exponent of the normal similarity, larger values blur less.
+uniform float uDepthPhi = 1.0;
+
+const float KERNEL[3] = float[3](3.0 / 8.0, 1.0 / 4.0, 1.0 / 16.0);
+const int MIN_TEMPORAL_SAMPLES = 4; // Fewer samples estimate the variance spatially.
+
+// Edge-stopping weight of the normal and distance of "tap" seen from "center", "distance" in pixels.
+float getGeometryWeight(in vec4 center, in vec4 tap, in float distance)
+{
+    float normalWeight = pow(max(dot(center.xyz, tap.xyz), 0.0), uNormalPhi);
+
+    // Depth changes along a slanted surface grow with the distance of the tap, and with the depth itself.
+    float depthSigma = uDepthPhi * 0.05 * center.w * distance + 1.0e-6;
+
+    return normalWeight * exp(-abs(center.w - tap.w) / depthSigma);
+}
+
+// First pass: the color of the accumulation and the variance of its luminance (of the mean, not of single samples).
+// Pixels with a short history (e.g. right after the camera moved) don't have enough samples for their own moments,
+// their variance is estimated from the surrounding pixels of the same surface instead.
+vec4 estimateVariance(in ivec2 pixel, in ivec2 size, in vec4 centerNormalDepth, in float centerID)
+{
+    vec3 color = texelFetch(uColorTexture, pixel, 0).rgb;
+    vec4 moments = texelFetch(uMomentsTexture, pixel, 0);
+
+    if (moments.z >= float(MIN_TEMPORAL_SAMPLES))
+    {
+        return vec4(color, max(moments.y - moments.x * moments.x, 0.0) / moments.z);
+    }
+
+    vec2 spatialMoments = vec2(0.0);
+    float weightSum = 0.0;
+
+    for (int y = -3; y <= 3; y++)
+    {
+        for (int x = -3; x <= 3; x++)
+        {
+            ivec2 tap = pixel + ivec2(x, y);
+
+            if (any(lessThan(tap, ivec2(0))) || any(greaterThanEqual(tap, size)) || texelFetch(uAlbedoIDTexture, tap, 0).a != centerID)
+            {
+                continue;
+            }
+
+            float weight = getGeometryWeight(centerNormalDepth, texelFetch(uNormalDepthTexture, tap, 0), length(vec2(x, y)));
+            float luminance = texelFetch(uMomentsTexture, tap, 0).x;
+
+            spatialMoments += weight * vec2(luminance, luminance * luminance);
+            weightSum += weight;
+        }
+    }
+
+    spatialMoments /= weightSum;
+
+    return vec4(color, max(spatialMoments.y - spatialMoments.x * spatialMoments.x, 0.0));
+}
+
+// 3x3 Gaussian of the variance around the center, a single pixel estimate is too noisy to steer the luminance weight.
+float getFilteredVariance(in ivec2 pixel, in ivec2 size)
+{
+    const float gaussian[2] = float[2](1.0 / 2.0, 1.0 / 4.0);
+
+    float variance = 0.0;
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            ivec2 tap = clamp(pixel + ivec2(x, y), ivec2(0), size - 1);
+
+            variance += gaussian[abs(x)] * gaussian[abs(y)] * texelFetch(uColorTexture, tap, 0).a;
+        }
+    }
+
+    return variance;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 size = textureSize(uColorTexture, 0);
+
+    vec4 centerNormalDepth = texelFetch(uNormalDepthTexture, pixel, 0);
+    float centerID = texelFetch(uAlbedoIDTexture, pixel, 0).a;
+
+    // The sky is noise free, and has no surface to guide the weights.
+    if (centerNormalDepth.w < 0.0)
+    {
+        FragColor = vec4(texelFetch(uColorTexture, pixel, 0).rgb, 0.0);
+
+        return;
+    }
+
+    if (uIteration == 0)
+    {
+        FragColor = estimateVariance(pixel, size, centerNormalDepth, centerID);
+
+        return;
+    }
+
+    vec4 center = texelFetch(uColorTexture, pixel, 0);
+
+    float centerLuminance = getLuminance(center.rgb);
+    float luminanceSigma = uColorPhi * sqrt(getFilteredVariance(pixel, size)) + 1.0e-6;
+
+    vec3 colorSum = vec3(0.0);
+    float varianceSum = 0.0;
+    float weightSum = 0.0;
+
+    for (int y = -2; y <= 2; y++)
+    {
+        for (int x = -2; x <= 2; x++)
+        {
+            ivec2 tap = pixel + ivec2(x, y) * uStepSize;
+
+            if (any(lessThan(tap, ivec2(0))) || any(greaterThanEqual(tap, size)))
+            {
+                continue;
+            }
+
+            vec4 tapColor = texelFetch(uColorTexture, tap, 0);
+            vec4 tapNormalDepth = texelFetch(uNormalDepthTexture, tap, 0);
+            float tapID = texelFetch(uAlbedoIDTexture, tap, 0).a;
+
+            // Never across two spheres, or a sphere and the sky.
+            if (tapID != centerID)
+            {
+                continue;
+            }
+
+            float geometryWeight = getGeometryWeight(centerNormalDepth, tapNormalDepth, length(vec2(x, y) * float(uStepSize)));
+            float luminanceWeight = exp(-abs(centerLuminance - getLuminance(tapColor.rgb)) / luminanceSigma);
+
+            float weight = KERNEL[abs(x)] * KERNEL[abs(y)] * geometryWeight * luminanceWeight;
+
+            colorSum += weight * tapColor.rgb;
+            varianceSum += weight * weight * tapColor.a;
+            weightSum += weight;
+        }
+    }
+
+    // The center tap always has full weight, so the sum is never zero.
+    FragColor = vec4(colorSum / weightSum, varianceSum / (weightSum * weightSum));
+}
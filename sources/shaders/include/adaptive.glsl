@@ -0,0 +1,25 @@
+// Per-pixel convergence shared by "path_tracer_2.frag" (which stops sampling converged pixels) and "present.frag"
+// (which shows it as a heatmap).
+//
+// Next to its color, every pixel accumulates the moments of the luminance of its samples:
+//
+//  x: running mean of the luminance;
+//  y: running mean of the squared luminance;
+//  z: samples accumulated since the last reset;
+//  w: one while the pixel is sampled, zero once it converged.
+
+const float ADAPTIVE_MIN_LUMINANCE = 0.05; // Keeps dark pixels, whose relative error is unstable, from never converging.
+const int ADAPTIVE_MAX_BOOST = 16; // Most samples a noisy pixel gets per frame, in multiples of "uSamplesPerPixel".
+
+float getLuminance(in vec3 color)
+{
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Standard error of the mean luminance, relative to it.
+float getRelativeError(in vec4 moments)
+{
+    float variance = max(moments.y - moments.x * moments.x, 0.0);
+
+    return sqrt(variance / max(moments.z, 1.0)) / max(moments.x, ADAPTIVE_MIN_LUMINANCE);
+}
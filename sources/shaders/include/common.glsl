@@ -0,0 +1,230 @@
+// Scene layout, frame constants and random numbers shared by "path_tracer_2.frag" and "wavefront.comp".
+//
+// Specialization defines ("ShaderVariantCache"), each one replaces a uniform with a constant:
+//
+//  MAX_BOUNCES:   bounce count, so the loop can be unrolled;
+//  MATERIAL_MASK: bit "1 << type" for every material type in the scene, the other cases are compiled out;
+//  SAMPLER_TYPE:  sampler of the paths, see "sampler.glsl".
+
+struct Ray
+{
+    vec3 origin, direction;
+};
+
+struct Material
+{
+    vec3 albedo;
+
+    /* Acceptable types:
+     *
+     *  0: LAMBERTIAN;
+     *  1: METAL;
+     *  2: DIELECTRIC.
+     */
+    int type;
+
+    vec3 emission;
+
+    float roughness, indexOfRefraction;
+};
+
+struct Sphere
+{
+    vec3 center;
+
+    float radius;
+
+    Material material;
+};
+
+// Entry of the light table ("Light" in "primitives.h"), see "lights.glsl".
+struct Light
+{
+    vec3 position; // Center of the point light or of the sphere.
+
+    float radius;
+
+    vec3 emission; // Intensity of a point light ("color * power"), radiance of a sphere.
+
+    int type; // "LIGHT_POINT" or "LIGHT_SPHERE".
+
+    float probability; // Of drawing this light.
+
+    // Alias method: a draw landing on this entry keeps it under "aliasThreshold" and goes to "alias" above it.
+    float aliasThreshold;
+    int alias;
+};
+
+// Triangle of a mesh ("Triangle" in "primitives.h"), its corners index "meshVertices".
+struct Triangle
+{
+    uvec3 indices;
+};
+
+// Mesh shared by instances, as ranges of "meshNodes" (whose indices are relative to the range) and "triangles".
+struct MeshRange
+{
+    int firstNode, nodeCount;
+    int firstTriangle, triangleCount;
+};
+
+// Mesh (or unit sphere) placed in the world ("Instance" in "primitives.h").
+struct Instance
+{
+    mat3x4 worldToObject; // Columns are the rows of the inverse transform: "vec4(point, 1.0) * worldToObject".
+
+    int mesh; // Into "meshRanges", -1 for the unit sphere at the origin.
+    int material; // Into "meshMaterials".
+};
+
+struct BVHNode
+{
+    vec3 boundsMin;
+
+    int missIndex; // Next node when the box is missed or after a leaf.
+
+    vec3 boundsMax;
+
+    int primitives; // Zero for interior nodes, otherwise "(firstPrimitive << 4) | primitiveCount".
+};
+
+struct HitRecord
+{
+    vec3 point, normal;
+
+    float t;
+
+    Material material;
+
+    bool frontFace;
+};
+
+const float EPSILON = 0.001;
+const float MAX_DISTANCE = 1000.0; // Camera frustum distance.
+const float PI = 3.14159265359;
+
+// Per frame constants, uploaded only when they change ("FrameUniforms" in "frame_uniforms.h").
+layout(std140) uniform FrameUniforms
+{
+    mat4 uInverseProjectionMatrix; // To unproject screen coordinates.
+    mat4 uInverseViewMatrix; // To transform from camera to world space.
+    vec3 uCameraPosition;
+    vec3 uSkyColor; // Background color.
+    ivec2 uViewportSize; // Dimensions of the viewport (e.g., window width, window height).
+    int uMaxBounces; // Max number of ray bounces.
+    int uSamplesPerPixel; // Samples traced per pixel in this frame.
+    int uNumSpheres; // Number of valid entries in "spheres".
+    int uNumLights; // Number of valid entries in "lights", point lights and emissive spheres together.
+    int uNumNodes; // Number of valid entries in "nodes".
+    int uNumInstanceNodes; // Number of valid entries in "instanceNodes", zero without instances.
+};
+
+#ifdef MAX_BOUNCES
+#define BOUNCE_COUNT MAX_BOUNCES
+#else
+#define BOUNCE_COUNT uMaxBounces
+#endif
+
+#ifndef MATERIAL_MASK
+#define MATERIAL_MASK 7
+#endif
+
+layout(std430, binding = 0) readonly buffer SpheresBuffer
+{
+    Sphere spheres[]; // Sorted in BVH leaf order.
+};
+
+layout(std430, binding = 1) readonly buffer LightsBuffer
+{
+    Light lights[]; // Light table, see "lights.glsl".
+};
+
+layout(std430, binding = 2) readonly buffer BVHBuffer
+{
+    BVHNode nodes[]; // Depth-first order, the left child of an interior node is the next node.
+};
+
+// Instances traced along the spheres, see "intersection.glsl": a hierarchy over the instances ("instanceNodes") whose
+// leaves hold meshes (or spheres) shared by any number of them. The buffers are only bound with instances.
+layout(std430, binding = 7) readonly buffer MeshVerticesBuffer
+{
+    vec4 meshVertices[]; // "w" unused.
+};
+
+layout(std430, binding = 8) readonly buffer TrianglesBuffer
+{
+    Triangle triangles[]; // Every mesh sorted in the leaf order of its own nodes.
+};
+
+layout(std430, binding = 9) readonly buffer MeshBVHBuffer
+{
+    BVHNode meshNodes[]; // The hierarchies of every mesh one after the other, in object space.
+};
+
+layout(std430, binding = 10) readonly buffer MeshMaterialsBuffer
+{
+    Material meshMaterials[];
+};
+
+layout(std430, binding = 11) readonly buffer InstancesBuffer
+{
+    Instance instances[]; // Sorted in leaf order of "instanceNodes".
+};
+
+layout(std430, binding = 12) readonly buffer InstanceBVHBuffer
+{
+    BVHNode instanceNodes[]; // In world space.
+};
+
+layout(std430, binding = 13) readonly buffer MeshRangesBuffer
+{
+    MeshRange meshRanges[];
+};
+
+uint PCG(inout uint state) // PCG hashing function for high-quality random numbers.
+{
+    uint oldState = state;
+    uint word = ((oldState >> ((oldState >> 28u) + 4u)) ^ oldState) * 277803737u;
+
+    state = oldState * 747796405u + 2891336453u;
+
+    return (word >> 22u) ^ word;
+}
+
+float getRandomFloat(inout uint state) // Returns a random float in [0, 1) using the PRNG state.
+{
+    return float(PCG(state)) / float(0xffffffffu);
+}
+
+// Uniform direction from two numbers in [0, 1), e.g. a 2D draw of a sampler (see "sampler.glsl").
+vec3 getUnitSphereDirection(in vec2 u)
+{
+    float phi = 2.0 * PI * u.x;
+    float cosTheta = 2.0 * u.y - 1.0;
+    float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
+
+    return vec3(cos(phi) * sinTheta, sin(phi) * sinTheta, cosTheta);
+}
+
+vec3 getRandomVecInUnitSphere(inout uint state)
+{
+    float r1 = getRandomFloat(state);
+    float r2 = getRandomFloat(state);
+
+    return getUnitSphereDirection(vec2(r1, r2));
+}
+
+vec3 getRayDirection(in vec2 fragCoord)
+{
+    // Convert fragment coordinates to "Normalized Device Coordinates" (NDC).
+    vec2 ndc = (fragCoord / vec2(uViewportSize)) * 2.0 - 1.0;
+
+    // Create a ray in clip space.
+    vec4 clipCoords = vec4(ndc.x, ndc.y, -1.0, 1.0); // -1.0 for z: into the screen (OpenGL convention).
+
+    // Transform to eye/camera space.
+    vec4 eyeCoords = vec4((uInverseProjectionMatrix * clipCoords).xy, -1.0, 0.0); // Set z to -1 (forward), w to 0 for a direction vector.
+
+    // Transform to world space.
+    return normalize((uInverseViewMatrix * eyeCoords).xyz);
+}
@@ -0,0 +1,472 @@
+// Ray queries against the spheres, the instances and their BVHs (see "common.glsl" for the buffers).
+//
+// Hits are identified by a primitive index: spheres keep their own, instances follow them ("uNumSpheres + instance"),
+// along with the triangle hit inside the mesh of the instance (-1 for spheres and sphere instances).
+//
+// Instances are traced in two levels: the world hierarchy finds the instances whose box the ray crosses, then the ray is
+// brought into the space of each one and goes down the hierarchy of its mesh. Object rays keep the length of their
+// direction, so distances along them are the world ones and a single "closestSoFar" bounds both levels.
+
+void setHitRecordFaceNormal(in Ray r, in vec3 outwardNormal, inout HitRecord rec)
+{
+    rec.frontFace = dot(r.direction, outwardNormal) < 0;
+    rec.normal = rec.frontFace ? outwardNormal : -outwardNormal;
+}
+
+float sphereIntersection(in Ray r, in vec3 center, in float radius, in float tMin, in float tMax)
+{
+    vec3 oc = r.origin - center;
+
+    float a = dot(r.direction, r.direction);
+    float b = dot(oc, r.direction);
+    float c = dot(oc, oc) - radius * radius;
+    float discriminant = b * b - a * c;
+
+    if (discriminant >= 0.0)
+    {
+        float root = (-b - sqrt(discriminant)) / a;
+
+        if (root < tMax && root > tMin)
+        {
+            return root;
+        }
+
+        root = (-b + sqrt(discriminant)) / a;
+
+        if (root < tMax && root > tMin)
+        {
+            return root;
+        }
+    }
+
+    return -1.0; // No intersection inside (tMin, tMax).
+}
+
+float sphereIntersection(in Ray r, in Sphere s, in float tMin, in float tMax)
+{
+    return sphereIntersection(r, s.center, s.radius, tMin, tMax);
+}
+
+void setSphereHitRecord(in Ray r, in Sphere s, in float t, inout HitRecord rec)
+{
+    rec.t = t;
+    rec.point = r.origin + r.direction * rec.t;
+    rec.material = s.material;
+
+    vec3 outwardNormal = (rec.point - s.center) / s.radius;
+
+    setHitRecordFaceNormal(r, outwardNormal, rec);
+}
+
+// Moller-Trumbore, both faces are hit.
+float triangleIntersection(in Ray r, in Triangle triangle, in float tMin, in float tMax)
+{
+    vec3 v0 = meshVertices[triangle.indices.x].xyz;
+    vec3 edge1 = meshVertices[triangle.indices.y].xyz - v0;
+    vec3 edge2 = meshVertices[triangle.indices.z].xyz - v0;
+
+    vec3 p = cross(r.direction, edge2);
+    float determinant = dot(edge1, p);
+
+    // Ray parallel to the plane of the triangle (or degenerate triangle).
+    if (determinant == 0.0)
+    {
+        return -1.0;
+    }
+
+    float inverseDeterminant = 1.0 / determinant;
+    vec3 s = r.origin - v0;
+    float u = dot(s, p) * inverseDeterminant;
+
+    if (u < 0.0 || u > 1.0)
+    {
+        return -1.0;
+    }
+
+    vec3 q = cross(s, edge1);
+    float v = dot(r.direction, q) * inverseDeterminant;
+
+    if (v < 0.0 || u + v > 1.0)
+    {
+        return -1.0;
+    }
+
+    float t = dot(edge2, q) * inverseDeterminant;
+
+    return t > tMin && t < tMax ? t : -1.0;
+}
+
+// The ray in the space of "instance", not normalized (see above).
+Ray getObjectRay(in Ray r, in Instance instance)
+{
+    return Ray(vec4(r.origin, 1.0) * instance.worldToObject, vec4(r.direction, 0.0) * instance.worldToObject);
+}
+
+// Triangles are flat shaded, their normal follows the winding of the corners. Normals are found in object space and go
+// back to the world with the inverse transpose of the instance transform, the transpose of "worldToObject".
+void setInstanceHitRecord(in Ray r, in Instance instance, in int triangle, in float t, inout HitRecord rec)
+{
+    vec3 objectNormal;
+
+    if (triangle == -1)
+    {
+        Ray objectRay = getObjectRay(r, instance);
+
+        objectNormal = objectRay.origin + objectRay.direction * t; // Unit sphere at the origin.
+    }
+    else
+    {
+        vec3 v0 = meshVertices[triangles[triangle].indices.x].xyz;
+        vec3 v1 = meshVertices[triangles[triangle].indices.y].xyz;
+        vec3 v2 = meshVertices[triangles[triangle].indices.z].xyz;
+
+        objectNormal = cross(v1 - v0, v2 - v0);
+    }
+
+    mat3 normalMatrix = mat3(instance.worldToObject[0].xyz, instance.worldToObject[1].xyz, instance.worldToObject[2].xyz);
+
+    rec.t = t;
+    rec.point = r.origin + r.direction * rec.t;
+    rec.material = meshMaterials[instance.material];
+
+    setHitRecordFaceNormal(r, normalize(normalMatrix * objectNormal), rec);
+}
+
+// A zero direction component would make the slab test multiply 0 by infinity (NaN) for origins on a slab plane,
+// tiny components are clamped to a signed epsilon whose huge inverse still orders the slabs.
+vec3 getInverseDirection(in vec3 direction)
+{
+    const float epsilon = 1e-8;
+
+    vec3 signedEpsilon = mix(vec3(epsilon), vec3(-epsilon), lessThan(direction, vec3(0.0)));
+
+    return 1.0 / mix(direction, signedEpsilon, lessThan(abs(direction), vec3(epsilon)));
+}
+
+bool boxHit(in vec3 origin, in vec3 inverseDirection, in vec3 boundsMin, in vec3 boundsMax, in float tMin, in float tMax)
+{
+    // Slab test.
+    vec3 t0 = (boundsMin - origin) * inverseDirection;
+    vec3 t1 = (boundsMax - origin) * inverseDirection;
+    vec3 tNear = min(t0, t1);
+    vec3 tFar = max(t0, t1);
+
+    float tEnter = max(max(tNear.x, tNear.y), max(tNear.z, tMin));
+    float tExit = min(min(tFar.x, tFar.y), min(tFar.z, tMax));
+
+    return tEnter <= tExit;
+}
+
+// Index of the closest sphere, -1 on a miss. Only the index and distance are returned, so callers that don't
+// shade right away skip the material fetch and the normal.
+int findClosestSphere(in Ray r, in float tMin, in float tMax, out float t)
+{
+    float closestSoFar = tMax;
+    int closestSphere = -1;
+
+    vec3 inverseDirection = getInverseDirection(r.direction);
+    int nodeIndex = 0;
+
+    // Stackless traversal: boxes that are hit descend to the next node, misses and leaves skip the whole subtree.
+    while (nodeIndex < uNumNodes)
+    {
+        BVHNode node = nodes[nodeIndex];
+        int nextIndex = node.missIndex;
+
+        if (boxHit(r.origin, inverseDirection, node.boundsMin, node.boundsMax, tMin, closestSoFar))
+        {
+            if (node.primitives == 0)
+            {
+                nextIndex = nodeIndex + 1;
+            }
+            else
+            {
+                int first = node.primitives >> 4;
+                int count = node.primitives & 15;
+
+                for (int i = first; i < first + count; i++)
+                {
+                    float sphereT = sphereIntersection(r, spheres[i], tMin, closestSoFar);
+
+                    if (sphereT > 0.0)
+                    {
+                        closestSoFar = sphereT;
+                        closestSphere = i;
+                    }
+                }
+            }
+        }
+
+        nodeIndex = nextIndex;
+    }
+
+    t = closestSoFar;
+
+    return closestSphere;
+}
+
+// Same traversal as "findClosestSphere" over the hierarchy of "mesh", with an object ray. Returns the index of the
+// closest triangle in "triangles", -1 on a miss.
+int findClosestTriangle(in Ray r, in MeshRange mesh, in float tMin, in float tMax, out float t)
+{
+    float closestSoFar = tMax;
+    int closestTriangle = -1;
+
+    vec3 inverseDirection = getInverseDirection(r.direction);
+    int nodeIndex = 0;
+
+    while (nodeIndex < mesh.nodeCount)
+    {
+        BVHNode node = meshNodes[mesh.firstNode + nodeIndex];
+        int nextIndex = node.missIndex;
+
+        if (boxHit(r.origin, inverseDirection, node.boundsMin, node.boundsMax, tMin, closestSoFar))
+        {
+            if (node.primitives == 0)
+            {
+                nextIndex = nodeIndex + 1;
+            }
+            else
+            {
+                int first = mesh.firstTriangle + (node.primitives >> 4);
+                int count = node.primitives & 15;
+
+                for (int i = first; i < first + count; i++)
+                {
+                    float triangleT = triangleIntersection(r, triangles[i], tMin, closestSoFar);
+
+                    if (triangleT > 0.0)
+                    {
+                        closestSoFar = triangleT;
+                        closestTriangle = i;
+                    }
+                }
+            }
+        }
+
+        nodeIndex = nextIndex;
+    }
+
+    t = closestSoFar;
+
+    return closestTriangle;
+}
+
+// Same traversal as "findClosestSphere" over the instances, -1 on a miss (or without instances).
+int findClosestInstance(in Ray r, in float tMin, in float tMax, out float t, out int triangle)
+{
+    float closestSoFar = tMax;
+    int closestInstance = -1;
+
+    vec3 inverseDirection = getInverseDirection(r.direction);
+    int nodeIndex = 0;
+
+    triangle = -1;
+
+    while (nodeIndex < uNumInstanceNodes)
+    {
+        BVHNode node = instanceNodes[nodeIndex];
+        int nextIndex = node.missIndex;
+
+        if (boxHit(r.origin, inverseDirection, node.boundsMin, node.boundsMax, tMin, closestSoFar))
+        {
+            if (node.primitives == 0)
+            {
+                nextIndex = nodeIndex + 1;
+            }
+            else
+            {
+                int first = node.primitives >> 4;
+                int count = node.primitives & 15;
+
+                for (int i = first; i < first + count; i++)
+                {
+                    Instance instance = instances[i];
+                    Ray objectRay = getObjectRay(r, instance);
+
+                    if (instance.mesh == -1)
+                    {
+                        float sphereT = sphereIntersection(objectRay, vec3(0.0), 1.0, tMin, closestSoFar);
+
+                        if (sphereT > 0.0)
+                        {
+                            closestSoFar = sphereT;
+                            closestInstance = i;
+                            triangle = -1;
+                        }
+                    }
+                    else
+                    {
+                        float triangleT;
+                        int closestTriangle = findClosestTriangle(objectRay, meshRanges[instance.mesh], tMin, closestSoFar, triangleT);
+
+                        if (closestTriangle != -1)
+                        {
+                            closestSoFar = triangleT;
+                            closestInstance = i;
+                            triangle = closestTriangle;
+                        }
+                    }
+                }
+            }
+        }
+
+        nodeIndex = nextIndex;
+    }
+
+    t = closestSoFar;
+
+    return closestInstance;
+}
+
+// Closest sphere or instance (see the primitive indices above), -1 on a miss.
+int findClosestPrimitive(in Ray r, in float tMin, in float tMax, out float t, out int triangle)
+{
+    int closestPrimitive = findClosestSphere(r, tMin, tMax, t);
+
+    // Only instances in front of the closest sphere are looked for.
+    float instanceT;
+    int closestInstance = findClosestInstance(r, tMin, t, instanceT, triangle);
+
+    if (closestInstance != -1)
+    {
+        t = instanceT;
+        closestPrimitive = uNumSpheres + closestInstance;
+    }
+
+    return closestPrimitive;
+}
+
+void setPrimitiveHitRecord(in Ray r, in int primitive, in int triangle, in float t, inout HitRecord rec)
+{
+    if (primitive < uNumSpheres)
+    {
+        setSphereHitRecord(r, spheres[primitive], t, rec);
+    }
+    else
+    {
+        setInstanceHitRecord(r, instances[primitive - uNumSpheres], triangle, t, rec);
+    }
+}
+
+Material getPrimitiveMaterial(in int primitive)
+{
+    return primitive < uNumSpheres ? spheres[primitive].material : meshMaterials[instances[primitive - uNumSpheres].material];
+}
+
+bool meshOccluded(in Ray r, in MeshRange mesh, in float tMin, in float tMax)
+{
+    vec3 inverseDirection = getInverseDirection(r.direction);
+    int nodeIndex = 0;
+
+    while (nodeIndex < mesh.nodeCount)
+    {
+        BVHNode node = meshNodes[mesh.firstNode + nodeIndex];
+        int nextIndex = node.missIndex;
+
+        if (boxHit(r.origin, inverseDirection, node.boundsMin, node.boundsMax, tMin, tMax))
+        {
+            if (node.primitives == 0)
+            {
+                nextIndex = nodeIndex + 1;
+            }
+            else
+            {
+                int first = mesh.firstTriangle + (node.primitives >> 4);
+                int count = node.primitives & 15;
+
+                for (int i = first; i < first + count; i++)
+                {
+                    if (triangleIntersection(r, triangles[i], tMin, tMax) > 0.0)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        nodeIndex = nextIndex;
+    }
+
+    return false;
+}
+
+bool instancesOccluded(in Ray r, in float tMin, in float tMax)
+{
+    vec3 inverseDirection = getInverseDirection(r.direction);
+    int nodeIndex = 0;
+
+    while (nodeIndex < uNumInstanceNodes)
+    {
+        BVHNode node = instanceNodes[nodeIndex];
+        int nextIndex = node.missIndex;
+
+        if (boxHit(r.origin, inverseDirection, node.boundsMin, node.boundsMax, tMin, tMax))
+        {
+            if (node.primitives == 0)
+            {
+                nextIndex = nodeIndex + 1;
+            }
+            else
+            {
+                int first = node.primitives >> 4;
+                int count = node.primitives & 15;
+
+                for (int i = first; i < first + count; i++)
+                {
+                    Instance instance = instances[i];
+                    Ray objectRay = getObjectRay(r, instance);
+
+                    bool occluded = instance.mesh == -1 ? sphereIntersection(objectRay, vec3(0.0), 1.0, tMin, tMax) > 0.0 :
+                        meshOccluded(objectRay, meshRanges[instance.mesh], tMin, tMax);
+
+                    if (occluded)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        nodeIndex = nextIndex;
+    }
+
+    return false;
+}
+bool worldOccluded(in Ray r, in float tMin, in float tMax)
+{
+    vec3 inverseDirection = getInverseDirection(r.direction);
+    int nodeIndex = 0;
+
+    // Same traversal as "findClosestSphere", but any intersection is enough to stop. The instances come after the spheres.
+    while (nodeIndex < uNumNodes)
+    {
+        BVHNode node = nodes[nodeIndex];
+        int nextIndex = node.missIndex;
+
+        if (boxHit(r.origin, inverseDirection, node.boundsMin, node.boundsMax, tMin, tMax))
+        {
+            if (node.primitives == 0)
+            {
+                nextIndex = nodeIndex + 1;
+            }
+            else
+            {
+                int first = node.primitives >> 4;
+                int count = node.primitives & 15;
+
+                for (int i = first; i < first + count; i++)
+                {
+                    if (sphereIntersection(r, spheres[i], tMin, tMax) > 0.0)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        nodeIndex = nextIndex;
+    }
+
+    return instancesOccluded(r, tMin, tMax);
+}
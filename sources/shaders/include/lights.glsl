@@ -0,0 +1,137 @@
+// Next event estimation over the light table ("LightTable" in "light_table.h"): one light per shading point, drawn in
+// proportion to its power, so the cost stays the same however many lights the scene has.
+
+#include "common.glsl"
+
+const int LIGHT_POINT = 0;
+const int LIGHT_SPHERE = 1;
+
+// Same draw as "LightTable::sample", "u" in [0, 1).
+int sampleLightTable(in float u)
+{
+    float scaled = u * float(uNumLights);
+    int index = min(int(scaled), uNumLights - 1);
+
+    return scaled - float(index) < lights[index].aliasThreshold ? index : lights[index].alias;
+}
+
+// Orthonormal basis around the unit vector "w" ("Building an Orthonormal Basis, Revisited", Duff et al. 2017).
+void getBasis(in vec3 w, out vec3 tangent, out vec3 bitangent)
+{
+    float signZ = w.z >= 0.0 ? 1.0 : -1.0;
+    float a = -1.0 / (signZ + w.z);
+    float b = w.x * w.y * a;
+
+    tangent = vec3(1.0 + signZ * w.x * w.x * a, signZ * b, -signZ * w.x);
+    bitangent = vec3(b, signZ + w.y * w.y * a, -w.y);
+}
+
+// Direction from "point" towards a point of "light" drawn with "u", the distance a shadow ray covers before reaching
+// it, and the light it brings divided by the density of the direction. Lambertian surfaces multiply it by their albedo
+// and the cosine, the 1 / pi of their BRDF is folded in the way point lights always had it.
+//
+// Spheres are drawn uniformly over the cone they cover from "point", so the density is one over their solid angle.
+// Returns false when "point" is inside the light.
+bool sampleLight(in Light light, in vec3 point, in vec2 u, out vec3 direction, out float distance, out vec3 weight)
+{
+    if (light.type == LIGHT_POINT)
+    {
+        vec3 lightPoint = light.position + getUnitSphereDirection(u) * light.radius;
+
+        distance = length(lightPoint - point);
+        direction = (lightPoint - point) / distance;
+        weight = light.emission / (distance * distance);
+
+        return true;
+    }
+
+    vec3 toCenter = light.position - point;
+    float centerDistanceSquared = dot(toCenter, toCenter);
+    float radiusSquared = light.radius * light.radius;
+
+    if (centerDistanceSquared <= radiusSquared)
+    {
+        distance = 0.0;
+        direction = vec3(0.0);
+        weight = vec3(0.0);
+
+        return false;
+    }
+
+    float centerDistance = sqrt(centerDistanceSquared);
+    float sinThetaMaxSquared = radiusSquared / centerDistanceSquared;
+    float cosThetaMax = sqrt(max(1.0 - sinThetaMaxSquared, 0.0));
+
+    // "1 - cosThetaMax" without the cancellation of far (or small) spheres.
+    float coneHeight = sinThetaMaxSquared / (1.0 + cosThetaMax);
+
+    float oneMinusCosTheta = u.x * coneHeight;
+    float cosTheta = 1.0 - oneMinusCosTheta;
+    float sinTheta = sqrt(max(oneMinusCosTheta * (2.0 - oneMinusCosTheta), 0.0));
+    float phi = 2.0 * PI * u.y;
+
+    vec3 w = toCenter / centerDistance;
+    vec3 tangent, bitangent;
+    getBasis(w, tangent, bitangent);
+
+    direction = normalize((tangent * cos(phi) + bitangent * sin(phi)) * sinTheta + w * cosTheta);
+
+    // Near side of the sphere along the direction.
+    float projection = centerDistance * cosTheta;
+    distance = projection - sqrt(max(radiusSquared - (centerDistanceSquared - projection * projection), 0.0));
+
+    // Radiance over the density of the direction, 1 / (2 pi (1 - cosThetaMax)), and over pi.
+    weight = light.emission * 2.0 * coneHeight;
+
+    return true;
+}
+
+// Area measure counterparts of "sampleLight" for resampling (see "restir.glsl"), where samples of one shading point are
+// reused at others: a sample is the point "lightPoint" of the light rather than a direction.
+//
+// Density of drawing "lightPoint" with "sampleLight" from "point" (the table draw aside), per unit area of the light.
+// Point lights spread their samples over a sphere of their radius, which cancels out of every estimate.
+float getLightPointDensity(in Light light, in vec3 point, in vec3 lightPoint)
+{
+    if (light.type == LIGHT_POINT)
+    {
+        return 1.0 / (4.0 * PI * max(light.radius * light.radius, 1.0e-6));
+    }
+
+    vec3 toCenter = light.position - point;
+    float centerDistanceSquared = dot(toCenter, toCenter);
+    float radiusSquared = light.radius * light.radius;
+
+    if (centerDistanceSquared <= radiusSquared)
+    {
+        return 0.0;
+    }
+
+    float sinThetaMaxSquared = radiusSquared / centerDistanceSquared;
+    float coneHeight = sinThetaMaxSquared / (1.0 + sqrt(max(1.0 - sinThetaMaxSquared, 0.0)));
+
+    vec3 toPoint = point - lightPoint;
+    float distanceSquared = dot(toPoint, toPoint);
+    float cosLight = dot(normalize(lightPoint - light.position), toPoint) * inversesqrt(distanceSquared);
+
+    // Solid angle density over the cone, times the cosine at the light over the squared distance.
+    return max(cosLight, 0.0) / (distanceSquared * 2.0 * PI * coneHeight);
+}
+
+// Light "lightPoint" brings to a lambertian surface at "point" facing "normal" without occlusion, per unit area of the
+// light and before the albedo. Over "getLightPointDensity" it is "sampleLight"'s weight times the cosine.
+vec3 getLightPointEmission(in Light light, in vec3 point, in vec3 normal, in vec3 lightPoint)
+{
+    vec3 toLight = lightPoint - point;
+    float distanceSquared = dot(toLight, toLight);
+    float NdotL = max(dot(normal, toLight) * inversesqrt(distanceSquared), 0.0);
+
+    if (light.type == LIGHT_POINT)
+    {
+        return light.emission * NdotL / (distanceSquared * 4.0 * PI * max(light.radius * light.radius, 1.0e-6));
+    }
+
+    float cosLight = max(dot(normalize(lightPoint - light.position), -toLight) * inversesqrt(distanceSquared), 0.0);
+
+    return light.emission * NdotL * cosLight / (PI * distanceSquared);
+}
@@ -0,0 +1,66 @@
+// Scatter functions of the material types, each one compiled only when "MATERIAL_MASK" includes its type.
+
+#include "sampler.glsl"
+
+float getMaterialReflectance(in float indexOfRefraction, in float cosTheta)
+{
+    // Use Schlick's approximation for reflectance.
+    float r0 = pow((1.0 - indexOfRefraction) / (1.0 + indexOfRefraction), 2.0);
+
+    return r0 + (1.0 - r0) * pow((1 - cosTheta), 5.0);
+}
+
+#if (MATERIAL_MASK & 1) != 0
+bool scatterLambertian(in Ray r, in HitRecord rec, out vec3 attenuation, out Ray scattered, inout Sampler pathSampler)
+{
+    vec3 scatterDirection = rec.normal + getUnitSphereDirection(getSample2D(pathSampler));
+
+    attenuation = rec.material.albedo;
+    scattered = Ray(rec.point, normalize(scatterDirection));
+
+    return true;
+}
+#endif
+
+#if (MATERIAL_MASK & 2) != 0
+bool scatterMetal(in Ray r, in HitRecord rec, out vec3 attenuation, out Ray scattered, inout Sampler pathSampler)
+{
+    vec3 reflected = reflect(normalize(r.direction), rec.normal);
+    vec3 scatterDirection = reflected + (rec.material.roughness * getUnitSphereDirection(getSample2D(pathSampler)));
+
+    attenuation = rec.material.albedo;
+    scattered = Ray(rec.point, normalize(scatterDirection));
+
+    return dot(scattered.direction, rec.normal) > 0.0;
+}
+#endif
+
+#if (MATERIAL_MASK & 4) != 0
+bool scatterDielectric(in Ray r, in HitRecord rec, out vec3 attenuation, out Ray scattered, inout Sampler pathSampler)
+{
+    vec3 normalizedDirection = normalize(r.direction);
+    bool cannotRefract = false;
+    vec3 scatterDirection;
+    float cosTheta = min(dot(-normalizedDirection, rec.normal), 1.0);
+    float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
+    float refractionRatio = rec.frontFace ? (1.0 / rec.material.indexOfRefraction) : rec.material.indexOfRefraction;
+    float reflectance = getMaterialReflectance(rec.material.indexOfRefraction, cosTheta);
+
+    cannotRefract = cannotRefract || refractionRatio * sinTheta > 1.0;
+    cannotRefract = cannotRefract || reflectance > getSample1D(pathSampler);
+
+    if (cannotRefract)
+    {
+        scatterDirection = reflect(normalizedDirection, rec.normal);
+    }
+    else
+    {
+        scatterDirection = refract(normalizedDirection, rec.normal, refractionRatio);
+    }
+
+    attenuation = vec3(1.0);
+    scattered = Ray(rec.point, scatterDirection);
+
+    return true;
+}
+#endif
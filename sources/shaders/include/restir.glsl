@@ -0,0 +1,116 @@
+// Reservoirs of ReSTIR DI ("Spatiotemporal reservoir resampling for real-time ray tracing with dynamic direct
+// lighting", Bitterli et al. 2020), shared by "restir.comp" (which resamples them) and "path_tracer_2.frag" (which
+// shades the first hit of every pixel with its reservoir).
+//
+// A reservoir streams light samples of the table (weighted reservoir sampling) and keeps one of them, drawn in
+// proportion to its resampling weight. Its target function is the unshadowed light the sample brings to the surface
+// (see "getLightPointEmission"), so "contributionWeight" turns that light into an estimate of the direct lighting.
+// Reservoirs of nearby pixels (and of the previous frame) merge as if they were single samples worth "sampleCount".
+//
+// Visibility isn't part of the target, merging reservoirs across occluders darkens shadow edges a little (the biased
+// combination of the paper) in exchange for a single shadow ray per pixel.
+
+#include "common.glsl"
+#include "intersection.glsl"
+#include "lights.glsl"
+#include "adaptive.glsl"
+
+// "ReSTIRReservoir" in "spheres_scene.h".
+struct Reservoir
+{
+    vec3 lightPoint; // Sample kept, a point of "lights[lightIndex]".
+
+    int lightIndex; // -1 while empty.
+
+    vec3 hitPoint; // Camera hit the reservoir belongs to.
+
+    int hitPrimitive; // See "intersection.glsl", -1 when the camera ray missed.
+
+    vec3 hitNormal;
+
+    float weightSum; // Resampling weights seen so far.
+
+    vec3 rayDirection; // Camera ray of the pixel, jittered every frame.
+
+    float sampleCount; // Candidates behind the reservoir ("M").
+
+    float targetDensity; // Target function at the sample kept.
+
+    float contributionWeight; // "W", valid after "finalizeReservoir".
+
+    float padding[2];
+};
+
+Reservoir createReservoir(in vec3 rayDirection)
+{
+    Reservoir reservoir;
+
+    reservoir.lightPoint = vec3(0.0);
+    reservoir.lightIndex = -1;
+    reservoir.hitPoint = vec3(0.0);
+    reservoir.hitPrimitive = -1;
+    reservoir.hitNormal = vec3(0.0);
+    reservoir.weightSum = 0.0;
+    reservoir.rayDirection = rayDirection;
+    reservoir.sampleCount = 0.0;
+    reservoir.targetDensity = 0.0;
+    reservoir.contributionWeight = 0.0;
+    reservoir.padding[0] = 0.0;
+    reservoir.padding[1] = 0.0;
+
+    return reservoir;
+}
+
+// Luminance of the light "lightPoint" brings to the surface of the reservoir, unshadowed.
+float getTargetDensity(in Reservoir reservoir, in int lightIndex, in vec3 lightPoint)
+{
+    if (lightIndex < 0 || reservoir.hitPrimitive < 0)
+    {
+        return 0.0;
+    }
+
+    vec3 albedo = getPrimitiveMaterial(reservoir.hitPrimitive).albedo;
+
+    return getLuminance(albedo * getLightPointEmission(lights[lightIndex], reservoir.hitPoint, reservoir.hitNormal, lightPoint));
+}
+
+// Streams a sample of resampling weight "weight" standing for "sampleCount" candidates, "u" in [0, 1).
+void updateReservoir(inout Reservoir reservoir, in int lightIndex, in vec3 lightPoint, in float targetDensity, in float weight, in float sampleCount, in float u)
+{
+    reservoir.weightSum += weight;
+    reservoir.sampleCount += sampleCount;
+
+    if (weight > 0.0 && u * reservoir.weightSum < weight)
+    {
+        reservoir.lightIndex = lightIndex;
+        reservoir.lightPoint = lightPoint;
+        reservoir.targetDensity = targetDensity;
+    }
+}
+
+// Merges the finalized reservoir "other" (of another pixel or frame) into "reservoir", its sample weighted by the
+// target function of "reservoir"'s surface.
+void mergeReservoir(inout Reservoir reservoir, in Reservoir other, in float u)
+{
+    float targetDensity = getTargetDensity(reservoir, other.lightIndex, other.lightPoint);
+
+    updateReservoir(reservoir, other.lightIndex, other.lightPoint, targetDensity, targetDensity * other.contributionWeight * other.sampleCount, other.sampleCount, u);
+}
+
+void finalizeReservoir(inout Reservoir reservoir)
+{
+    reservoir.contributionWeight = reservoir.targetDensity > 0.0 ? reservoir.weightSum / (reservoir.sampleCount * reservoir.targetDensity) : 0.0;
+}
+
+// Reservoirs only merge across pixels seeing about the same surface, e.g. not across silhouettes.
+bool isSimilarSurface(in Reservoir reservoir, in Reservoir other)
+{
+    if (other.hitPrimitive < 0)
+    {
+        return false;
+    }
+
+    float planeDistance = abs(dot(other.hitPoint - reservoir.hitPoint, reservoir.hitNormal));
+
+    return dot(reservoir.hitNormal, other.hitNormal) > 0.9 && planeDistance < 0.05 * length(reservoir.hitPoint - uCameraPosition);
+}
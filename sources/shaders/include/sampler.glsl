@@ -0,0 +1,185 @@
+// Random numbers of a path, from one of three samplers ("SamplerTypes" in "scene.h"):
+//
+//  0: white noise, a PCG stream per sample;
+//  1: Owen-scrambled Sobol ("Practical Hash-based Owen Scrambling", Burley 2020). Only the first four Sobol
+//     dimensions are used, higher dimensions are padded with blocks of four that shuffle the sample index with a
+//     seed of their own, so blocks don't correlate;
+//  2: blue noise, a tileable mask ("BlueNoise") read at a different offset per dimension and moved along the golden
+//     ratio sequence every sample, which spreads the error of neighbouring pixels apart.
+//
+// Low discrepancy samples are indexed by dimension: the tracer sets the first dimension of every bounce, and 2D draws
+// start at an even dimension so they come from a single Sobol pair. White noise ignores dimensions and draws from its
+// stream in order, as the samplers always did.
+//
+// SAMPLER_TYPE replaces "uSamplerType" with a constant when defined, e.g. by a specialized variant.
+
+#include "common.glsl"
+
+#define SAMPLER_WHITE_NOISE 0
+#define SAMPLER_SOBOL 1
+#define SAMPLER_BLUE_NOISE 2
+
+#ifdef SAMPLER_TYPE
+#define SAMPLER SAMPLER_TYPE
+#else
+uniform int uSamplerType = SAMPLER_WHITE_NOISE;
+#define SAMPLER uSamplerType
+#endif
+
+uniform sampler2D uBlueNoiseTexture; // Ranks in [0, 1), repeated over the screen.
+
+struct Sampler
+{
+    uint randState; // PCG state, the only member white noise uses.
+
+    uint seed; // Scrambles the sequences of the pixel.
+    uint index; // Sample of the pixel, counted across the accumulated frames.
+    uint dimension; // Next dimension drawn.
+
+    ivec2 pixel;
+};
+
+// Direction numbers of Sobol dimensions 1 to 3 (Joe and Kuo), one per index bit. Dimension 0 is the bit reversal.
+const uint SOBOL_DIRECTIONS[96] = uint[96](
+    0x80000000u, 0xc0000000u, 0xa0000000u, 0xf0000000u, 0x88000000u, 0xcc000000u, 0xaa000000u, 0xff000000u,
+    0x80800000u, 0xc0c00000u, 0xa0a00000u, 0xf0f00000u, 0x88880000u, 0xcccc0000u, 0xaaaa0000u, 0xffff0000u,
+    0x80008000u, 0xc000c000u, 0xa000a000u, 0xf000f000u, 0x88008800u, 0xcc00cc00u, 0xaa00aa00u, 0xff00ff00u,
+    0x80808080u, 0xc0c0c0c0u, 0xa0a0a0a0u, 0xf0f0f0f0u, 0x88888888u, 0xccccccccu, 0xaaaaaaaau, 0xffffffffu,
+
+    0x80000000u, 0xc0000000u, 0x60000000u, 0x90000000u, 0xe8000000u, 0x5c000000u, 0x8e000000u, 0xc5000000u,
+    0x68800000u, 0x9cc00000u, 0xee600000u, 0x55900000u, 0x80680000u, 0xc09c0000u, 0x60ee0000u, 0x90550000u,
+    0xe8808000u, 0x5cc0c000u, 0x8e606000u, 0xc5909000u, 0x6868e800u, 0x9c9c5c00u, 0xeeee8e00u, 0x5555c500u,
+    0x8000e880u, 0xc0005cc0u, 0x60008e60u, 0x9000c590u, 0xe8006868u, 0x5c009c9cu, 0x8e00eeeeu, 0xc5005555u,
+
+    0x80000000u, 0xc0000000u, 0x20000000u, 0x50000000u, 0xf8000000u, 0x74000000u, 0xa2000000u, 0x93000000u,
+    0xd8800000u, 0x25400000u, 0x59e00000u, 0xe6d00000u, 0x78080000u, 0xb40c0000u, 0x82020000u, 0xc3050000u,
+    0x208f8000u, 0x51474000u, 0xfbea2000u, 0x75d93000u, 0xa0858800u, 0x914e5400u, 0xdbe79e00u, 0x25db6d00u,
+    0x58800080u, 0xe54000c0u, 0x79e00020u, 0xb6d00050u, 0x800800f8u, 0xc00c0074u, 0x200200a2u, 0x50050093u
+);
+
+const uint GOLDEN_RATIO_FIXED = 2654435769u; // Fractional part of the golden ratio, as 0.32 fixed point.
+
+uint getHash(in uint value)
+{
+    // The first PCG output is a plain function of the seed, the second one mixes it.
+    uint state = value;
+    PCG(state);
+
+    return PCG(state);
+}
+
+uint combineHashes(in uint seed, in uint value)
+{
+    return seed ^ (value + 0x9e3779b9u + (seed << 6u) + (seed >> 2u));
+}
+
+// Owen scrambling of the bits of "value" from the most significant one, with the hash permutation of Burley 2020.
+uint getNestedUniformScramble(in uint value, in uint seed)
+{
+    value = bitfieldReverse(value);
+
+    value += seed;
+    value ^= value * 0x6c50b47cu;
+    value ^= value * 0xb82f1e52u;
+    value ^= value * 0xc7afe638u;
+    value ^= value * 0x8d22f6e6u;
+
+    return bitfieldReverse(value);
+}
+
+uint getSobol(in uint index, in uint dimension)
+{
+    if (dimension == 0u)
+    {
+        return bitfieldReverse(index);
+    }
+
+    uint value = 0u;
+    uint offset = (dimension - 1u) * 32u;
+
+    for (uint bit = 0u; index != 0u; bit++, index >>= 1u)
+    {
+        if ((index & 1u) != 0u)
+        {
+            value ^= SOBOL_DIRECTIONS[offset + bit];
+        }
+    }
+
+    return value;
+}
+
+// 24 bits are all a float in [0, 1) can hold, and rounding the full 32 could reach one.
+float getUnitFloat(in uint value)
+{
+    return float(value >> 8u) * (1.0 / 16777216.0);
+}
+
+float getSobolSample(in Sampler pathSampler, in uint dimension)
+{
+    uint blockSeed = getHash(combineHashes(pathSampler.seed, dimension / 4u));
+    uint index = getNestedUniformScramble(pathSampler.index, blockSeed);
+
+    return getUnitFloat(getNestedUniformScramble(getSobol(index, dimension % 4u), combineHashes(pathSampler.seed, getHash(dimension))));
+}
+
+float getBlueNoiseSample(in Sampler pathSampler, in uint dimension)
+{
+    ivec2 size = textureSize(uBlueNoiseTexture, 0);
+
+    // R2 sequence offsets, the masks of nearby dimensions shouldn't overlap.
+    ivec2 offset = ivec2(fract(float(dimension) * vec2(0.7548776662, 0.5698402910)) * vec2(size));
+    float rank = texelFetch(uBlueNoiseTexture, (pathSampler.pixel + offset) % size, 0).r;
+
+    return fract(rank + getUnitFloat(pathSampler.index * GOLDEN_RATIO_FIXED));
+}
+
+Sampler createSampler(in ivec2 pixel, in uint sampleIndex, in uint randState)
+{
+    return Sampler(randState, getHash(uint(pixel.x) | (uint(pixel.y) << 16u)), sampleIndex, 0u, pixel);
+}
+
+// Without sample index and pixel, so white noise only (e.g. the wavefront kernels, whose paths only keep the PCG state
+// between bounces).
+Sampler createWhiteNoiseSampler(in uint randState)
+{
+    return Sampler(randState, 0u, 0u, 0u, ivec2(0));
+}
+
+void setSamplerDimension(inout Sampler pathSampler, in uint dimension)
+{
+    pathSampler.dimension = dimension;
+}
+
+float getSample1D(inout Sampler pathSampler)
+{
+    if (SAMPLER == SAMPLER_WHITE_NOISE)
+    {
+        return getRandomFloat(pathSampler.randState);
+    }
+
+    uint dimension = pathSampler.dimension;
+
+    pathSampler.dimension += 1u;
+
+    return SAMPLER == SAMPLER_SOBOL ? getSobolSample(pathSampler, dimension) : getBlueNoiseSample(pathSampler, dimension);
+}
+
+vec2 getSample2D(inout Sampler pathSampler)
+{
+    if (SAMPLER == SAMPLER_WHITE_NOISE)
+    {
+        // Arguments are evaluated left to right, x is drawn first.
+        return vec2(getRandomFloat(pathSampler.randState), getRandomFloat(pathSampler.randState));
+    }
+
+    uint dimension = pathSampler.dimension + (pathSampler.dimension & 1u);
+
+    pathSampler.dimension = dimension + 2u;
+
+    if (SAMPLER == SAMPLER_SOBOL)
+    {
+        return vec2(getSobolSample(pathSampler, dimension), getSobolSample(pathSampler, dimension + 1u));
+    }
+
+    return vec2(getBlueNoiseSample(pathSampler, dimension), getBlueNoiseSample(pathSampler, dimension + 1u));
+}
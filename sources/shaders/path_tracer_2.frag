@@ -1,351 +1,167 @@
 #version 460 core
 
-out vec4 FragColor;
+#include "include/common.glsl"
+#include "include/intersection.glsl"
+#include "include/sampler.glsl"
+#include "include/lights.glsl"
+#include "include/materials.glsl"
+#include "include/adaptive.glsl"
+#include "include/restir.glsl"
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 FragMoments; // Luminance moments of the pixel (see "adaptive.glsl").
+layout(location = 2) out vec4 FragNormalDepth; // First-hit normal and distance (negative for the sky), guides "denoise.frag".
+layout(location = 3) out vec4 FragAlbedoID; // First-hit albedo and object index (-1 for the sky).
+
+uniform int uFrameIndex = 0; // Frames accumulated since the last reset.
+uniform sampler2D uAccumulationTexture; // Running average of the previous frames.
+uniform sampler2D uMomentsTexture; // Moments of the previous frames.
+uniform float uAdaptiveThreshold = 0.0; // Relative error under which a pixel stops being sampled, zero samples every pixel.
+uniform int uAdaptiveMinSamples = 16; // Samples a pixel needs before its error is trusted.
+uniform int uWriteGBuffer = 0; // Traces the first hit of the pixel center for the denoiser, otherwise the G-buffer is cleared.
+uniform int uRouletteDepth = 0; // Bounces traced before Russian roulette may end a path, zero disables it.
+uniform int uCountRays = 0; // Adds the rays of the pass to "RayStatisticsBuffer".
+uniform int uReSTIR = 0; // The first sample of every pixel follows the camera ray of its reservoir and shades the hit with it.
+// uniform float uTime;
 
-struct Ray
+layout(std430, binding = 3) buffer AdaptiveBuffer
 {
-    vec3 origin, direction;
+    uint activePixels; // Pixels still sampled by the current pass.
+    uint previousActivePixels; // Same count for the previous pass, zero when unknown.
 };
 
-struct Material
-{
-    /* Acceptable types:
-     *
-     *  0: LAMBERTIAN;
-     *  1: METAL;
-     *  2: DIELECTRIC.
-     */
-    int type;
-
-    vec3 albedo, specular, emission;
+const int MAX_COUNTED_BOUNCES = 128; // "SpheresScene::MAX_COUNTED_BOUNCES".
 
-    float roughness, indexOfRefraction;
-};
-
-struct Sphere
+// A path adds itself once, to the entry of its length (the host turns the lengths into rays per bounce), so counting
+// costs an atomic per sample instead of one per ray.
+layout(std430, binding = 4) buffer RayStatisticsBuffer
 {
-    vec3 center;
-
-    float radius;
-
-    Material material;
+    uint shadowRays;
+    uint pathLengths[MAX_COUNTED_BOUNCES]; // Paths that traced "i + 1" extension rays, the last entry counts longer ones too.
 };
 
-struct PointLight
+// Resampled for this pass by "restir.comp", one per pixel.
+layout(std430, binding = 5) readonly buffer ReservoirBuffer
 {
-    vec3 position, color;
-
-    float radius, power;
+    Reservoir reservoirs[];
 };
 
-struct HitRecord
+bool worldHit(in Ray r, in float tMin, in float tMax, inout HitRecord rec)
 {
-    vec3 point, normal;
-
     float t;
+    int triangle;
+    int closestPrimitive = findClosestPrimitive(r, tMin, tMax, t, triangle);
 
-    Material material;
-
-    bool frontFace;
-};
-
-const int NUM_SPHERES = 5; // + 64;
-const int NUM_LIGHTS = 1;
-const float EPSILON = 0.001;
-const float MAX_DISTANCE = 1000.0; // Camera frustum distance.
-const float PI = 3.14159265359;
-
-uniform vec3 uCameraPosition;
-uniform mat4 uInverseProjectionMatrix; // To unproject screen coordinates.
-uniform mat4 uInverseViewMatrix; // To transform from camera to world space.
-uniform vec2 uViewportSize = vec2(1600, 900); // Dimensions of the viewport (e.g., window width, window height).
-uniform vec3 uSkyColor = vec3(0.5, 0.7, 1.0); // Background color.
-uniform int uMaxBounces = 16; // Max number of ray bounces.
-uniform int uSamplesPerPixel = 32;
-uniform Sphere uSpheres[NUM_SPHERES];
-uniform PointLight uLights[NUM_LIGHTS];
-// uniform float uTime;
-
-/*
-float getRandomFloat(vec2 seed)
-{
-    return fract(sin(dot(seed, vec2(12.9898, 78.2330))) * 43758.5453123);
-}
-
-vec3 getRandomVecInUnitSphere(vec2 seed)
-{
-    float r1 = random(seed);
-    float r2 = random(seed + vec2(0.1));
-    float phi = 2.0 * PI * r1;
-    float cosTheta = 2.0 * r2 - 1.0;
-    float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
-
-    return vec3(cos(phi) * sinTheta, sin(phi) * sinTheta, cosTheta);
-}
-*/
-
-uint PCG(inout uint state) // PCG hashing function for high-quality random numbers.
-{
-    uint oldState = state;
-    uint word = ((oldState >> ((oldState >> 28u) + 4u)) ^ oldState) * 277803737u;
-
-    state = oldState * 747796405u + 2891336453u;
-
-    return (word >> 22u) ^ word;
-}
-
-float getRandomFloat(inout uint state) // Returns a random float in [0, 1) using the PRNG state.
-{
-    return float(PCG(state)) / float(0xffffffffu);
-}
-
-vec3 getRandomVecInUnitSphere(inout uint state)
-{
-    float r1 = getRandomFloat(state);
-    float r2 = getRandomFloat(state);
-    float phi = 2.0 * PI * r1;
-    float cosTheta = 2.0 * r2 - 1.0;
-    float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
-
-    return vec3(cos(phi) * sinTheta, sin(phi) * sinTheta, cosTheta);
-
-    // vec3 p;
-
-    // do
-    // {
-    //     p = 2.0 * vec3(getRandomFloat(state), getRandomFloat(state), getRandomFloat(state)) - vec3(1.0);
-    // } while (dot(p, p) >= 1.0);
-
-    // return p;
-}
-
-mat3x3 getTangentSpace(in vec3 normal)
-{
-    vec3 helper = abs(normal.x) > 0.99 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
-    vec3 tangent = normalize(cross(normal, helper));
-    vec3 binormal = normalize(cross(normal, tangent));
-
-    return mat3x3(tangent, binormal, normal);
-}
-
-vec3 sampleHemisphere(in vec3 normal, in float roughness, inout uint state)
-{
-    float r1 = getRandomFloat(state);
-    float r2 = getRandomFloat(state);
-    float smoothness = 1.0 - roughness;
-    float alpha = pow(1000.0, smoothness * smoothness);
-    float cosTheta = pow(r1, 1.0 / (alpha + 1.0));
-    float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
-    float phi = 2.0 * PI * r2;
-
-    vec3 tangentSpaceDirection = vec3(cos(phi) * sinTheta, sin(phi) * sinTheta, cosTheta);
+    // Only the closest hit pays for the material fetch and the normal.
+    if (closestPrimitive != -1)
+    {
+        setPrimitiveHitRecord(r, closestPrimitive, triangle, t, rec);
 
-    return getTangentSpace(normal) * tangentSpaceDirection;
-}
+        return true;
+    }
 
-void setHitRecordFaceNormal(in Ray r, in vec3 outwardNormal, inout HitRecord rec)
-{
-    rec.frontFace = dot(r.direction, outwardNormal) < 0;
-    rec.normal = rec.frontFace ? outwardNormal : -outwardNormal;
+    return false;
 }
 
-bool sphereHit(in Ray r, in Sphere s, in float tMin, in float tMax, inout HitRecord rec)
+// One light of the table per shading point, weighted by the inverse probability of drawing it.
+vec3 getDirectIllumination(in HitRecord rec, inout Sampler pathSampler, inout uint shadowRayCount)
 {
-    vec3 oc = r.origin - s.center;
-
-    float a = dot(r.direction, r.direction);
-    float b = dot(oc, r.direction);
-    float c = dot(oc, oc) - s.radius * s.radius;
-    float discriminant = b * b - a * c;
-    float root;
-
-    if (discriminant >= 0.0)
+    if (uNumLights == 0)
     {
-        root = (-b - sqrt(discriminant)) / a;
+        return vec3(0.0);
+    }
 
-        if (root < tMax && root > tMin)
-        {
-            rec.t = root;
-            rec.point = r.origin + r.direction * rec.t;
-            rec.material = s.material;
+    Light light = lights[sampleLightTable(getSample1D(pathSampler))];
+    vec2 lightSample = getSample2D(pathSampler);
 
-            vec3 outwardNormal = (rec.point - s.center) / s.radius;
+    vec3 lightDirection, lightWeight;
+    float lightDistance;
 
-            setHitRecordFaceNormal(r, outwardNormal, rec);
+    if (!sampleLight(light, rec.point, lightSample, lightDirection, lightDistance, lightWeight))
+    {
+        return vec3(0.0);
+    }
 
-            return true;
-        }
+    float NdotL = max(0.0, dot(rec.normal, lightDirection));
 
-        root = (-b + sqrt(discriminant)) / a;
+    // Calculate difuse contribution.
+    if (NdotL > 0.0)
+    {
+        // Cast a shadow ray to check for occlusion.
+        shadowRayCount += 1u;
 
-        if (root < tMax && root > tMin)
+        if (!worldOccluded(Ray(rec.point, lightDirection), EPSILON, lightDistance - EPSILON))
         {
-            rec.t = root;
-            rec.point = r.origin + r.direction * rec.t;
-            rec.material = s.material;
-
-            vec3 outwardNormal = (rec.point - s.center) / s.radius;
-
-            setHitRecordFaceNormal(r, outwardNormal, rec);
-
-            return true;
+            return rec.material.albedo * lightWeight * NdotL / light.probability;
         }
     }
 
-    return false;
+    return vec3(0.0);
 }
 
-bool worldHit(in Ray r, in float tMin, in float tMax, inout HitRecord rec)
+// Same estimate with the light sample of a reservoir (see "restir.glsl"): its contribution weight stands for the
+// density of the sample, and a single shadow ray tests the visibility the resampling ignored.
+vec3 getReservoirIllumination(in HitRecord rec, in Reservoir reservoir, inout uint shadowRayCount)
 {
-    float closestSoFar = tMax;
-    HitRecord closestRec;
-    bool hit = false;
-
-    for (int i = 0; i < NUM_SPHERES; i++)
+    if (reservoir.lightIndex < 0 || reservoir.contributionWeight <= 0.0)
     {
-        if(sphereHit(r, uSpheres[i], tMin, closestSoFar, closestRec))
-        {
-            hit = true;
-            closestSoFar = closestRec.t;
-            rec = closestRec;
-        }
+        return vec3(0.0);
     }
 
-    return hit;
-}
-
-float getMaterialReflectance(in float indexOfRefraction, in float cosTheta)
-{
-    // Use Schlick's approximation for reflectance.
-    float r0 = pow((1.0 - indexOfRefraction) / (1.0 + indexOfRefraction), 2.0);
-
-    return r0 + (1.0 - r0) * pow((1 - cosTheta), 5.0);
-}
-
-bool scatterLambertian(in Ray r, in HitRecord rec, out vec3 attenuation, out Ray scattered, inout uint randState)
-{
-    vec3 scatterDirection = rec.normal + getRandomVecInUnitSphere(randState); // sampleHemisphere(rec.normal, 1.0, randState);
-
-    // if (length(scatterDirection) < EPSILON)
-    // {
-    //     scatterDirection = rec.normal;
-    // }
+    vec3 emission = getLightPointEmission(lights[reservoir.lightIndex], rec.point, rec.normal, reservoir.lightPoint);
 
-    attenuation = rec.material.albedo;
-    scattered = Ray(rec.point, normalize(scatterDirection));
-
-    return true;
-}
-
-bool scatterMetal(in Ray r, in HitRecord rec, out vec3 attenuation, out Ray scattered, inout uint randState)
-{
-    vec3 reflected = reflect(normalize(r.direction), rec.normal);
-    vec3 scatterDirection = reflected + (rec.material.roughness * getRandomVecInUnitSphere(randState)); // sampleHemisphere(reflected, rec.material.roughness, randState);
-
-    attenuation = rec.material.albedo;
-    scattered = Ray(rec.point, normalize(scatterDirection));
-
-    return dot(scattered.direction, rec.normal) > 0.0;
-}
-
-bool scatterDielectric(in Ray r, in HitRecord rec, out vec3 attenuation, out Ray scattered, inout uint randState)
-{
-    vec3 normalizedDirection = normalize(r.direction);
-    bool cannotRefract = false;
-    vec3 scatterDirection;
-    float cosTheta = min(dot(-normalizedDirection, rec.normal), 1.0);
-    float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
-    float refractionRatio = rec.frontFace ? (1.0 / rec.material.indexOfRefraction) : rec.material.indexOfRefraction;
-    float reflectance = getMaterialReflectance(rec.material.indexOfRefraction, cosTheta);
-
-    cannotRefract = cannotRefract || refractionRatio * sinTheta > 1.0;
-    cannotRefract = cannotRefract || reflectance > getRandomFloat(randState);
-
-    if (cannotRefract)
+    if (emission == vec3(0.0))
     {
-        scatterDirection = reflect(normalizedDirection, rec.normal);
+        return vec3(0.0);
     }
-    else
-    {
-        scatterDirection = refract(normalizedDirection, rec.normal, refractionRatio);
-    }
-
-    attenuation = vec3(1.0);
-    scattered = Ray(rec.point, scatterDirection);
 
-    return true;
+    float lightDistance = length(reservoir.lightPoint - rec.point);
+    vec3 lightDirection = (reservoir.lightPoint - rec.point) / lightDistance;
 
-    /*
-    float refractionRatio = rec.frontFace ? (1.0 / rec.material.indexOfRefraction) : rec.material.indexOfRefraction;
-    float reflectance = 1.0;
-    vec3 normalizedDirection = normalize(r.direction);
-    vec3 refracted = refract(normalizedDirection, rec.normal, refractionRatio);
-    vec3 scatterDirection;
+    shadowRayCount += 1u;
 
-    if (length(refracted) >= EPSILON)
+    if (worldOccluded(Ray(rec.point, lightDirection), EPSILON, lightDistance - EPSILON))
     {
-        // Only calculate Schlick's approximation if refraction is possible.
-        float cosTheta = min(dot(-normalizedDirection, rec.normal), 1.0);
-
-        reflectance = getMaterialReflectance(rec.material.indexOfRefraction, cosTheta);
+        return vec3(0.0);
     }
 
-    if (reflectance > getRandomFloat(randState))
-    {
-        scatterDirection = reflect(normalizedDirection, rec.normal);
-    }
-    else
-    {
-        scatterDirection = refracted;
-    }
-
-    attenuation = vec3(1.0);
-    scattered = Ray(rec.point, scatterDirection);
-
-    return true;
-    */
+    return rec.material.albedo * emission * reservoir.contributionWeight;
 }
 
-vec3 getDirectIllumination(in HitRecord rec, inout uint randState)
+// Dimensions of the sampler: the pixel jitter takes the first two, then every bounce draws the light (1D), the roulette
+// sample (1D), a point of the light (2D) and the scatter sample (2D, or 1D for dielectrics).
+uint getBounceDimension(in int bounce)
 {
-    vec3 accumulatedContribution = vec3(0.0);
-
-    for (int i = 0; i < NUM_LIGHTS; i++)
-    {
-        PointLight light = uLights[i];
-        vec3 lightPoint = light.position + getRandomVecInUnitSphere(randState) * light.radius;
-        vec3 lightDirection = normalize(lightPoint - rec.point);
-        float NdotL = max(0.0, dot(rec.normal, lightDirection));
-        float lightDistance = length(lightPoint - rec.point);
-
-        // Calculate difuse contribution.
-        if (NdotL > 0.0)
-        {
-            HitRecord shadowRec;
-
-            // Cast a shadow ray to check for occlusion.
-            if (!worldHit(Ray(rec.point, lightDirection), EPSILON, lightDistance - EPSILON, shadowRec))
-            {
-                // If not in shadow, add the light's contribution.
-                float attenuation = lightDistance * lightDistance;
+    return uint(2 + bounce * 6);
+}
 
-                accumulatedContribution += rec.material.albedo * light.color * light.power * NdotL / attenuation;
-            }
-        }
-    }
+uint getRouletteDimension(in int bounce)
+{
+    return getBounceDimension(bounce) + 1u;
+}
 
-    return accumulatedContribution;
+uint getScatterDimension(in int bounce)
+{
+    return getBounceDimension(bounce) + 4u;
 }
 
-vec3 getColor(in Ray r, inout uint randState)
+// "extensionRays" is the number of closest hit rays the path traced, "shadowRayCount" is increased by its shadow rays.
+// The first hit is lit by "reservoirs[reservoirIndex]" instead of a light sample, unless the index is -1.
+vec3 getColor(in Ray r, in int reservoirIndex, inout Sampler pathSampler, out int extensionRays, inout uint shadowRayCount)
 {
     vec3 accumulatedColor = vec3(0.0);
     vec3 accumulatedAttenuation = vec3(1.0);
 
-    for (int bounce = 0; bounce < uMaxBounces; bounce++)
+    extensionRays = 0;
+
+    for (int bounce = 0; bounce < BOUNCE_COUNT; bounce++)
     {
         HitRecord rec;
 
+        setSamplerDimension(pathSampler, getBounceDimension(bounce));
+
+        extensionRays = bounce + 1;
+
         if (worldHit(r, EPSILON, MAX_DISTANCE, rec))
         {
             vec3 attenuation;
@@ -358,7 +174,14 @@ vec3 getColor(in Ray r, inout uint randState)
             // }
 
             // Add direct illumination using "Next Event Estimation".
-            accumulatedColor += accumulatedAttenuation * getDirectIllumination(rec, randState);
+            if (bounce == 0 && reservoirIndex != -1)
+            {
+                accumulatedColor += getReservoirIllumination(rec, reservoirs[reservoirIndex], shadowRayCount);
+            }
+            else
+            {
+                accumulatedColor += accumulatedAttenuation * getDirectIllumination(rec, pathSampler, shadowRayCount);
+            }
 
             if (length(rec.material.emission) > 0.0)
             {
@@ -366,18 +189,23 @@ vec3 getColor(in Ray r, inout uint randState)
             }
 
             // Scatter a ray for the next bounce (indirect illumination).
+            setSamplerDimension(pathSampler, getScatterDimension(bounce));
+
             switch (rec.material.type)
             {
+#if (MATERIAL_MASK & 1) != 0
             case 0: // Lambertian material.
-                if (scatterLambertian(r, rec, attenuation, scattered, randState))
+                if (scatterLambertian(r, rec, attenuation, scattered, pathSampler))
                 {
                     accumulatedAttenuation *= attenuation;
                     r = scattered;
                 }
                 break;
+#endif
 
+#if (MATERIAL_MASK & 2) != 0
             case 1: // Metal material.
-                if (scatterMetal(r, rec, attenuation, scattered, randState))
+                if (scatterMetal(r, rec, attenuation, scattered, pathSampler))
                 {
                     accumulatedAttenuation *= attenuation;
                     r = scattered;
@@ -387,18 +215,43 @@ vec3 getColor(in Ray r, inout uint randState)
                     return accumulatedColor;
                 }
                 break;
+#endif
 
+#if (MATERIAL_MASK & 4) != 0
             case 2: // Dielectric material.
-                if (scatterDielectric(r, rec, attenuation, scattered, randState))
+                if (scatterDielectric(r, rec, attenuation, scattered, pathSampler))
                 {
                     accumulatedAttenuation *= attenuation;
                     r = scattered;
                 }
                 break;
+#endif
 
             default:
                 break;
             }
+
+            float survival = min(max(accumulatedAttenuation.r, max(accumulatedAttenuation.g, accumulatedAttenuation.b)), 1.0);
+
+            // Nothing the path finds anymore can reach the camera (e.g. a black albedo).
+            if (survival == 0.0)
+            {
+                break;
+            }
+
+            // Russian roulette: past the first bounces, paths go on with the probability of their throughput and carry
+            // its inverse, so dim paths end early without biasing the image.
+            if (uRouletteDepth > 0 && bounce + 1 >= uRouletteDepth && bounce + 1 < BOUNCE_COUNT)
+            {
+                setSamplerDimension(pathSampler, getRouletteDimension(bounce));
+
+                if (getSample1D(pathSampler) >= survival)
+                {
+                    break;
+                }
+
+                accumulatedAttenuation /= survival;
+            }
         }
         else
         {
@@ -414,46 +267,127 @@ vec3 getColor(in Ray r, inout uint randState)
     return accumulatedColor;
 }
 
-vec3 getRayDirection(in vec2 fragCoord)
+int getAdaptiveSampleCount(in vec4 previousMoments)
 {
-    // Convert fragment coordinates to "Normalized Device Coordinates" (NDC).
-    vec2 ndc = (fragCoord / uViewportSize) * 2.0 - 1.0;
-    // ndc.y = -ndc.y; // Uncomment if your Y is flipped.
+    if (uAdaptiveThreshold <= 0.0)
+    {
+        return uSamplesPerPixel;
+    }
+
+    if (previousMoments.z >= float(uAdaptiveMinSamples) && getRelativeError(previousMoments) < uAdaptiveThreshold)
+    {
+        return 0;
+    }
+
+    atomicAdd(activePixels, 1u);
+
+    // Converged pixels hand their samples to the ones still sampled, so a pass costs about as much as a uniform one.
+    float budgetScale = previousActivePixels > 0u ? float(uViewportSize.x * uViewportSize.y) / float(previousActivePixels) : 1.0;
+
+    return clamp(int(float(uSamplesPerPixel) * budgetScale + 0.5), uSamplesPerPixel, uSamplesPerPixel * ADAPTIVE_MAX_BOOST);
+}
+
+void writeGBuffer()
+{
+    FragNormalDepth = vec4(0.0, 0.0, 0.0, -1.0);
+    FragAlbedoID = vec4(0.0, 0.0, 0.0, -1.0);
+
+    if (uWriteGBuffer == 0)
+    {
+        return;
+    }
+
+    // Not jittered, so the edges the denoiser preserves stay put from frame to frame.
+    Ray r = Ray(uCameraPosition, getRayDirection(gl_FragCoord.xy));
 
-    // Create a ray in clip space.
-    vec4 clipCoords = vec4(ndc.x, ndc.y, -1.0, 1.0); // -1.0 for z: into the screen (OpenGL convention).
+    float t;
+    int triangle;
+    int primitive = findClosestPrimitive(r, EPSILON, MAX_DISTANCE, t, triangle);
 
-    // Transform to eye/camera space.
-    vec4 eyeCoords = vec4((uInverseProjectionMatrix * clipCoords).xy, -1.0, 0.0); // Set z to -1 (forward), w to 0 for a direction vector.
+    if (primitive != -1)
+    {
+        HitRecord rec;
+        setPrimitiveHitRecord(r, primitive, triangle, t, rec);
 
-    // Transform to world space.
-    return normalize((uInverseViewMatrix * eyeCoords).xyz);
+        // Instances are told apart rather than triangles, so the denoiser filters across the triangles of a surface.
+        FragNormalDepth = vec4(rec.normal, t);
+        FragAlbedoID = vec4(rec.material.albedo, float(primitive));
+    }
 }
 
 void main()
 {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    writeGBuffer();
+
+    // The first frame after a reset ignores the previous frames.
+    vec3 previousColor = uFrameIndex > 0 ? texelFetch(uAccumulationTexture, pixel, 0).rgb : vec3(0.0);
+    vec4 previousMoments = uFrameIndex > 0 ? texelFetch(uMomentsTexture, pixel, 0) : vec4(0.0);
+
+    int numSamples = getAdaptiveSampleCount(previousMoments);
+
+    if (numSamples == 0)
+    {
+        FragColor = vec4(previousColor, 1.0);
+        FragMoments = vec4(previousMoments.xyz, 0.0);
+
+        return;
+    }
+
     vec3 color = vec3(0.0);
+    vec2 moments = vec2(0.0);
+    uint shadowRayCount = 0u;
 
-    for (int s = 0; s < uSamplesPerPixel; s++)
+    for (int s = 0; s < numSamples; s++)
     {
-        // Initialize PRNG state uniquely for each pixel AND each sample.
-        uint randState = uint(gl_FragCoord.x) * 196314165u + uint(gl_FragCoord.y) * 937197125u + uint(s) * 497196613u;
+        // Initialize PRNG state uniquely for each pixel, each sample AND each accumulated frame.
+        uint randState = uint(gl_FragCoord.x) * 196314165u + uint(gl_FragCoord.y) * 937197125u + uint(s) * 497196613u + uint(uFrameIndex) * 1297038473u;
+
+        PCG(randState); // Scramble the linear seed before the first draw.
+
+        // Samples of the pixel are numbered across frames, so low discrepancy sequences continue where they stopped.
+        Sampler pathSampler = createSampler(pixel, uint(previousMoments.z) + uint(s), randState);
 
         // Jitter the pixel coordinate for each sample.
-        vec2 fragCoordOffset = 2.0 * vec2(getRandomFloat(randState), getRandomFloat(randState)) - vec2(1.0);
+        vec2 fragCoordOffset = 2.0 * getSample2D(pathSampler) - vec2(1.0);
         vec2 fragCoord = gl_FragCoord.xy + fragCoordOffset;
         vec3 rayDirection = getRayDirection(fragCoord);
 
+        // The reservoir was resampled at the hit of its own (jittered) camera ray.
+        int reservoirIndex = uReSTIR != 0 && s == 0 ? pixel.y * uViewportSize.x + pixel.x : -1;
+
+        if (reservoirIndex != -1)
+        {
+            rayDirection = reservoirs[reservoirIndex].rayDirection;
+        }
+
         Ray r = Ray(uCameraPosition, rayDirection);
 
-        color += getColor(r, randState);
+        int extensionRays;
+        vec3 sampleColor = getColor(r, reservoirIndex, pathSampler, extensionRays, shadowRayCount);
+        float luminance = getLuminance(sampleColor);
+
+        color += sampleColor;
+        moments += vec2(luminance, luminance * luminance);
+
+        if (uCountRays != 0)
+        {
+            atomicAdd(pathLengths[clamp(extensionRays, 1, MAX_COUNTED_BOUNCES) - 1], 1u);
+        }
+    }
+
+    if (uCountRays != 0)
+    {
+        atomicAdd(shadowRays, shadowRayCount);
     }
 
-    color = color / float(uSamplesPerPixel);
+    // Blend with the previous frames, weighted by their sample count (pixels are sampled unevenly when adaptive).
+    float sampleCount = previousMoments.z + float(numSamples);
+    float weight = float(numSamples) / sampleCount;
 
-    // Apply gamma correction.
-    float gamma = 2.2;
-    color = pow(color, vec3(1.0 / gamma));
+    color = mix(previousColor, color / float(numSamples), weight);
 
-    FragColor = vec4(color, 1.0); // Final pixel color.
+    FragColor = vec4(color, 1.0); // Linear radiance, gamma is applied by "present.frag".
+    FragMoments = vec4(mix(previousMoments.xy, moments / float(numSamples), weight), sampleCount, 1.0);
 }
@@ -0,0 +1,93 @@
+#version 460 core
+
+#include "include/adaptive.glsl"
+
+out vec4 FragColor;
+
+uniform sampler2D uAccumulationTexture; // Linear radiance averaged over the accumulated frames.
+uniform sampler2D uPreviousTexture; // Previous average, still shown by the tiles the current pass hasn't traced.
+uniform sampler2D uMomentsTexture; // Luminance moments matching "uAccumulationTexture".
+uniform sampler2D uPreviousMomentsTexture; // Luminance moments matching "uPreviousTexture".
+uniform int uTileSize = 1;
+uniform int uTilesX = 1;
+uniform int uCompletedTiles = 0x7fffffff; // Tiles of the current pass already traced, in row order.
+uniform vec2 uRenderScale = vec2(1.0); // Render resolution over the screen resolution, the textures are upscaled.
+
+// Debug views: 0 shows the image, 1 the samples of every pixel and 2 its relative error.
+uniform int uDebugView = 0;
+uniform float uUniformSamples = 1.0; // Samples of a pixel under uniform sampling, the middle of the samples heatmap.
+uniform float uErrorScale = 0.1; // Relative error at the middle of the error heatmap.
+
+// Blue (0) to green (0.5) to red (1).
+vec3 getHeatmapColor(in float t)
+{
+    t = clamp(t, 0.0, 1.0);
+
+    return t < 0.5 ? mix(vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0), t * 2.0) : mix(vec3(0.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0), t * 2.0 - 1.0);
+}
+
+bool isTraced(in ivec2 pixel)
+{
+    ivec2 tile = pixel / uTileSize;
+
+    return tile.y * uTilesX + tile.x < uCompletedTiles;
+}
+
+vec3 getColor(in ivec2 pixel)
+{
+    return isTraced(pixel) ? texelFetch(uAccumulationTexture, pixel, 0).rgb : texelFetch(uPreviousTexture, pixel, 0).rgb;
+}
+
+// Bilinear by hand, every tap picks its own texture (a filter across the edge of the traced tiles would mix both).
+// At full resolution the taps land on the pixel centers, and the result is the pixel itself.
+vec3 getUpscaledColor(in vec2 position)
+{
+    ivec2 size = textureSize(uAccumulationTexture, 0);
+
+    vec2 texel = position - 0.5;
+    ivec2 base = ivec2(floor(texel));
+    vec2 weight = texel - vec2(base);
+
+    ivec2 p0 = clamp(base, ivec2(0), size - 1);
+    ivec2 p1 = clamp(base + 1, ivec2(0), size - 1);
+
+    vec3 bottom = mix(getColor(p0), getColor(ivec2(p1.x, p0.y)), weight.x);
+    vec3 top = mix(getColor(ivec2(p0.x, p1.y)), getColor(p1), weight.x);
+
+    return mix(bottom, top, weight.y);
+}
+
+void main()
+{
+    // Position in render pixels, the nearest one for the debug views.
+    vec2 position = gl_FragCoord.xy * uRenderScale;
+    ivec2 pixel = ivec2(position);
+    bool traced = isTraced(pixel);
+
+    vec3 color = getUpscaledColor(position);
+
+    if (uDebugView == 1)
+    {
+        vec4 moments = traced ? texelFetch(uMomentsTexture, pixel, 0) : texelFetch(uPreviousMomentsTexture, pixel, 0);
+
+        // Logarithmic, a sixteenth of the uniform count is blue and sixteen times it is red.
+        FragColor = vec4(getHeatmapColor(0.5 + log2(max(moments.z, 1.0) / max(uUniformSamples, 1.0)) / 8.0), 1.0);
+
+        return;
+    }
+
+    if (uDebugView == 2)
+    {
+        vec4 moments = traced ? texelFetch(uMomentsTexture, pixel, 0) : texelFetch(uPreviousMomentsTexture, pixel, 0);
+
+        FragColor = vec4(getHeatmapColor(0.5 * getRelativeError(moments) / uErrorScale), 1.0);
+
+        return;
+    }
+
+    // Apply gamma correction.
+    float gamma = 2.2;
+    color = pow(color, vec3(1.0 / gamma));
+
+    FragColor = vec4(color, 1.0); // Final pixel color.
+}
@@ -0,0 +1,146 @@
+#include "blue_noise.h"
+
+std::vector<float> BlueNoise::generate(int size, uint32_t seed, float sigma)
+{
+	int numberOfPixels = size * size;
+	int initialPoints = std::max(numberOfPixels / 10, 1);
+
+	std::vector<uint8_t> pattern(numberOfPixels, 0);
+	std::vector<int> ranks(numberOfPixels, 0);
+
+	EnergyField field(size, sigma);
+	std::mt19937 generator(seed);
+
+	// Initial pattern: a tenth of the pixels at random, then relaxed by moving the point of the tightest cluster to
+	// the largest void until the same pixel is both.
+	for (int placed = 0; placed < initialPoints;)
+	{
+		int pixel = int(generator() % uint32_t(numberOfPixels));
+
+		if (pattern[pixel] == 0)
+		{
+			pattern[pixel] = 1;
+			field.add(pixel, 1.0f);
+
+			placed++;
+		}
+	}
+
+	while (true)
+	{
+		int cluster = field.findTightestCluster(pattern);
+
+		pattern[cluster] = 0;
+		field.add(cluster, -1.0f);
+
+		int largestVoid = field.findLargestVoid(pattern);
+
+		pattern[largestVoid] = 1;
+		field.add(largestVoid, 1.0f);
+
+		if (largestVoid == cluster)
+		{
+			break;
+		}
+	}
+
+	// Phase 1: the initial points are ranked from the last, taking them out of a copy by tightest cluster.
+	std::vector<uint8_t> initialPattern = pattern;
+	EnergyField initialField = field;
+
+	for (int rank = initialPoints - 1; rank >= 0; rank--)
+	{
+		int cluster = initialField.findTightestCluster(initialPattern);
+
+		initialPattern[cluster] = 0;
+		initialField.add(cluster, -1.0f);
+
+		ranks[cluster] = rank;
+	}
+
+	// Phases 2 and 3: the remaining pixels are ranked in order, filling the largest void every time.
+	for (int rank = initialPoints; rank < numberOfPixels; rank++)
+	{
+		int largestVoid = field.findLargestVoid(pattern);
+
+		pattern[largestVoid] = 1;
+		field.add(largestVoid, 1.0f);
+
+		ranks[largestVoid] = rank;
+	}
+
+	std::vector<float> values(numberOfPixels);
+
+	for (int i = 0; i < numberOfPixels; i++)
+	{
+		values[i] = (float(ranks[i]) + 0.5f) / float(numberOfPixels);
+	}
+
+	return values;
+}
+
+BlueNoise::EnergyField::EnergyField(int size, float sigma) : size(size), kernel(size_t(size) * size), energy(size_t(size) * size, 0.0f)
+{
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			// Shortest offset on the torus.
+			float dx = float(std::min(x, size - x));
+			float dy = float(std::min(y, size - y));
+
+			kernel[y * size + x] = std::exp(-(dx * dx + dy * dy) / (2.0f * sigma * sigma));
+		}
+	}
+}
+
+void BlueNoise::EnergyField::add(int pixel, float sign)
+{
+	int pixelX = pixel % size;
+	int pixelY = pixel / size;
+
+	for (int y = 0; y < size; y++)
+	{
+		const float* kernelRow = &kernel[size_t((y - pixelY + size) % size) * size];
+		float* energyRow = &energy[size_t(y) * size];
+
+		for (int x = 0; x < size; x++)
+		{
+			energyRow[x] += sign * kernelRow[(x - pixelX + size) % size];
+		}
+	}
+}
+
+int BlueNoise::EnergyField::findTightestCluster(const std::vector<uint8_t>& pattern) const
+{
+	int best = 0;
+	float bestEnergy = -1.0f;
+
+	for (size_t i = 0; i < energy.size(); i++)
+	{
+		if (pattern[i] != 0 && energy[i] > bestEnergy)
+		{
+			best = int(i);
+			bestEnergy = energy[i];
+		}
+	}
+
+	return best;
+}
+
+int BlueNoise::EnergyField::findLargestVoid(const std::vector<uint8_t>& pattern) const
+{
+	int best = 0;
+	float bestEnergy = INFINITY;
+
+	for (size_t i = 0; i < energy.size(); i++)
+	{
+		if (pattern[i] == 0 && energy[i] < bestEnergy)
+		{
+			best = int(i);
+			bestEnergy = energy[i];
+		}
+	}
+
+	return best;
+}
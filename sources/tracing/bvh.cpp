@@ -0,0 +1,439 @@
+#include "bvh.h"
+
+void AABB::grow(const glm::vec3& point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void AABB::grow(const AABB& box)
+{
+	min = glm::min(min, box.min);
+	max = glm::max(max, box.max);
+}
+
+glm::vec3 AABB::getCentroid() const
+{
+	return 0.5f * (min + max);
+}
+
+float AABB::getSurfaceArea() const
+{
+	glm::vec3 extent = max - min;
+
+	if (extent.x < 0.0f || extent.y < 0.0f || extent.z < 0.0f)
+	{
+		return 0.0f; // Empty box.
+	}
+
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+BVH::BVH() : nodes(), primitiveIndices(), statistics()
+{
+}
+
+void BVH::build(const std::vector<AABB>& primitivesBounds, int primitivesPerTest, ThreadPool* threadPool)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	std::vector<BuildPrimitive> primitives(primitivesBounds.size());
+	std::vector<BuildNode> buildNodes;
+	std::vector<BuildTask> deferredTasks;
+
+	nodes.clear();
+	primitiveIndices.resize(primitivesBounds.size());
+	statistics = {};
+
+	for (uint32_t i = 0; i < primitives.size(); i++)
+	{
+		primitives[i] = { primitivesBounds[i], primitivesBounds[i].getCentroid(), i };
+		primitiveIndices[i] = i;
+	}
+
+	if (primitivesBounds.empty())
+	{
+		return;
+	}
+
+	primitivesPerTest = std::max(1, primitivesPerTest);
+
+	buildNodes.reserve(2 * primitivesBounds.size());
+	buildNodes.push_back({ AABB(), -1, -1, 0, int(primitivesBounds.size()), 1 });
+
+	// The first levels are split here, until there are enough subtrees (a few per thread) to balance the workers.
+	int threads = threadPool != nullptr ? threadPool->getNumberOfThreads() : 1;
+	int deferredCount = threads > 1 ? int(primitivesBounds.size() / (4 * size_t(threads))) : 0;
+
+	statistics.depth = splitNodes(primitives, buildNodes, { { 0, 1 } }, primitivesPerTest, deferredCount, threads > 1 ? &deferredTasks : nullptr);
+
+	if (!deferredTasks.empty())
+	{
+		std::vector<std::vector<BuildNode>> subtrees(deferredTasks.size());
+		std::vector<int> depths(deferredTasks.size(), 0);
+
+		// Subtrees own disjoint ranges of "primitives", and build their nodes apart from the others.
+		threadPool->dispatch(int(deferredTasks.size()), [&](int taskIndex, int)
+		{
+			const BuildTask& task = deferredTasks[taskIndex];
+
+			subtrees[taskIndex].push_back(buildNodes[task.nodeIndex]);
+			depths[taskIndex] = splitNodes(primitives, subtrees[taskIndex], { { 0, task.depth } }, primitivesPerTest, 0, nullptr);
+		});
+
+		// The roots replace their deferred nodes, the other nodes are appended, still after their parents.
+		for (size_t i = 0; i < subtrees.size(); i++)
+		{
+			int offset = int(buildNodes.size()) - 1;
+
+			for (size_t j = 0; j < subtrees[i].size(); j++)
+			{
+				BuildNode node = subtrees[i][j];
+
+				if (node.left != -1)
+				{
+					node.left += offset;
+					node.right += offset;
+				}
+
+				if (j == 0)
+				{
+					buildNodes[deferredTasks[i].nodeIndex] = node;
+				}
+				else
+				{
+					buildNodes.push_back(node);
+				}
+			}
+
+			statistics.depth = std::max(statistics.depth, depths[i]);
+		}
+	}
+
+	// Children are always created after their parents, so a reverse sweep accumulates the subtree sizes bottom-up.
+	for (int i = int(buildNodes.size()) - 1; i >= 0; i--)
+	{
+		BuildNode& node = buildNodes[i];
+
+		if (node.left != -1)
+		{
+			node.subtreeSize = 1 + buildNodes[node.left].subtreeSize + buildNodes[node.right].subtreeSize;
+		}
+	}
+
+	for (size_t i = 0; i < primitives.size(); i++)
+	{
+		primitiveIndices[i] = primitives[i].index;
+	}
+
+	flatten(buildNodes);
+
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+	statistics.nodeCount = int(nodes.size());
+	statistics.buildTime = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void BVH::assign(const BVHNode* nodes, size_t count)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	std::vector<int> subtreeEnds; // "missIndex" of the interior nodes above the current one.
+
+	this->nodes.assign(nodes, nodes + count);
+	primitiveIndices.clear();
+	statistics = { int(count), 0, 0, 0.0f };
+
+	for (int i = 0; i < int(count); i++)
+	{
+		while (!subtreeEnds.empty() && subtreeEnds.back() <= i)
+		{
+			subtreeEnds.pop_back();
+		}
+
+		statistics.depth = std::max(statistics.depth, int(subtreeEnds.size()) + 1);
+
+		if (nodes[i].primitives != 0)
+		{
+			statistics.leafCount += 1;
+		}
+		else
+		{
+			subtreeEnds.push_back(nodes[i].missIndex);
+		}
+	}
+
+	statistics.buildTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+const std::vector<BVHNode>& BVH::getNodes() const
+{
+	return nodes;
+}
+
+const std::vector<uint32_t>& BVH::getPrimitiveIndices() const
+{
+	return primitiveIndices;
+}
+
+const BVHStatistics& BVH::getStatistics() const
+{
+	return statistics;
+}
+
+int BVH::getLeafFirstPrimitive(const BVHNode& node)
+{
+	return node.primitives >> 4;
+}
+
+int BVH::getLeafPrimitiveCount(const BVHNode& node)
+{
+	return node.primitives & 15;
+}
+
+bool BVH::isValid(const BVHNode* nodes, size_t count, size_t primitiveCount)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const BVHNode& node = nodes[i];
+
+		// Every step moves forward (to the left child or past the subtree), so the traversal always ends.
+		if (node.missIndex <= int64_t(i) || size_t(node.missIndex) > count || node.primitives < 0)
+		{
+			return false;
+		}
+
+		if (node.primitives == 0)
+		{
+			if (size_t(node.missIndex) < i + 2)
+			{
+				return false;
+			}
+		}
+		else if (getLeafPrimitiveCount(node) == 0 || size_t(getLeafFirstPrimitive(node)) + getLeafPrimitiveCount(node) > primitiveCount)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int BVH::splitNodes(std::vector<BuildPrimitive>& primitives, std::vector<BuildNode>& buildNodes, std::vector<BuildTask> tasks, int primitivesPerTest, int deferredCount, std::vector<BuildTask>* deferredTasks)
+{
+	int depth = 0;
+
+	// The tree is built iteratively, so very unbalanced splits can't overflow the call stack.
+	while (!tasks.empty())
+	{
+		BuildTask task = tasks.back();
+		tasks.pop_back();
+
+		BuildNode& node = buildNodes[task.nodeIndex];
+
+		if (deferredTasks != nullptr && node.count < deferredCount)
+		{
+			deferredTasks->push_back(task);
+
+			continue;
+		}
+
+		AABB centroidsBounds;
+
+		for (int i = node.first; i < node.first + node.count; i++)
+		{
+			node.bounds.grow(primitives[i].bounds);
+			centroidsBounds.grow(primitives[i].centroid);
+		}
+
+		depth = std::max(depth, task.depth);
+
+		int splitAxis = 0;
+		float splitPosition = 0.0f;
+		int middle = node.first;
+
+		if (findBestSplit(primitives, centroidsBounds, node.first, node.count, node.bounds, primitivesPerTest, splitAxis, splitPosition))
+		{
+			BuildPrimitive* begin = primitives.data() + node.first;
+			BuildPrimitive* end = begin + node.count;
+
+			middle = int(std::partition(begin, end, [&](const BuildPrimitive& primitive) { return primitive.centroid[splitAxis] < splitPosition; }) - primitives.data());
+		}
+		else if (node.count <= MAX_LEAF_PRIMITIVES)
+		{
+			continue; // Cheaper as a leaf.
+		}
+
+		// Leaves can't hold that many primitives (or the binned split was degenerate), so fall back to a median split.
+		if (middle == node.first || middle == node.first + node.count)
+		{
+			glm::vec3 extent = centroidsBounds.max - centroidsBounds.min;
+
+			splitAxis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+			middle = node.first + node.count / 2;
+
+			std::nth_element(primitives.begin() + node.first, primitives.begin() + middle, primitives.begin() + node.first + node.count,
+				[&](const BuildPrimitive& a, const BuildPrimitive& b) { return a.centroid[splitAxis] < b.centroid[splitAxis]; });
+		}
+
+		int first = node.first, count = node.count;
+		int leftIndex = int(buildNodes.size());
+		int rightIndex = leftIndex + 1;
+
+		// "node" is invalidated by the insertions below.
+		buildNodes[task.nodeIndex].left = leftIndex;
+		buildNodes[task.nodeIndex].right = rightIndex;
+
+		buildNodes.push_back({ AABB(), -1, -1, first, middle - first, 1 });
+		buildNodes.push_back({ AABB(), -1, -1, middle, first + count - middle, 1 });
+
+		tasks.push_back({ rightIndex, task.depth + 1 });
+		tasks.push_back({ leftIndex, task.depth + 1 });
+	}
+
+	return depth;
+}
+
+bool BVH::findBestSplit(const std::vector<BuildPrimitive>& primitives, const AABB& centroidsBounds, int first, int count, const AABB& bounds, int primitivesPerTest, int& splitAxis, float& splitPosition)
+{
+	struct Bin
+	{
+		AABB bounds;
+
+		int count = 0;
+	};
+
+	const float traversalCost = 1.0f; // Relative to the cost of one primitive intersection test.
+
+	// Number of tests needed to intersect "n" primitives.
+	auto getTests = [primitivesPerTest](int n) { return float((n + primitivesPerTest - 1) / primitivesPerTest); };
+
+	float parentArea = bounds.getSurfaceArea();
+	float bestCost = getTests(count); // Cost of keeping all primitives in a leaf.
+	bool found = false;
+
+	if (count <= 1 || parentArea <= 0.0f)
+	{
+		return false;
+	}
+
+	// Every axis is binned in the same pass over the primitives.
+	Bin bins[3][NUMBER_OF_BINS];
+	glm::vec3 scale(0.0f);
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float axisExtent = centroidsBounds.max[axis] - centroidsBounds.min[axis];
+
+		scale[axis] = axisExtent > 0.0f ? float(NUMBER_OF_BINS) / axisExtent : 0.0f;
+	}
+
+	for (int i = first; i < first + count; i++)
+	{
+		const BuildPrimitive& primitive = primitives[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			int binIndex = std::min(NUMBER_OF_BINS - 1, int((primitive.centroid[axis] - centroidsBounds.min[axis]) * scale[axis]));
+
+			bins[axis][binIndex].count += 1;
+			bins[axis][binIndex].bounds.grow(primitive.bounds);
+		}
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float axisMin = centroidsBounds.min[axis];
+
+		if (scale[axis] == 0.0f)
+		{
+			continue; // All centroids lie on the same plane.
+		}
+
+		// Only the occupied bins are swept: the splits between two of them all cost the same and the first one is kept,
+		// which spares most of the work on the many small nodes near the leaves.
+		int occupiedBins[NUMBER_OF_BINS];
+		int occupiedCount = 0;
+
+		for (int i = 0; i < NUMBER_OF_BINS; i++)
+		{
+			if (bins[axis][i].count > 0)
+			{
+				occupiedBins[occupiedCount++] = i;
+			}
+		}
+
+		// Sweep from both sides to get the area and count of every partition in linear time.
+		float rightAreas[NUMBER_OF_BINS - 1];
+		int rightCounts[NUMBER_OF_BINS - 1];
+		AABB leftBounds, rightBounds;
+		int leftCount = 0, rightCount = 0;
+
+		for (int i = occupiedCount - 1; i > 0; i--)
+		{
+			rightCount += bins[axis][occupiedBins[i]].count;
+			rightBounds.grow(bins[axis][occupiedBins[i]].bounds);
+			rightCounts[i - 1] = rightCount;
+			rightAreas[i - 1] = rightBounds.getSurfaceArea();
+		}
+
+		for (int i = 0; i < occupiedCount - 1; i++)
+		{
+			leftCount += bins[axis][occupiedBins[i]].count;
+			leftBounds.grow(bins[axis][occupiedBins[i]].bounds);
+
+			float cost = traversalCost + (leftBounds.getSurfaceArea() * getTests(leftCount) + rightAreas[i] * getTests(rightCounts[i])) / parentArea;
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				splitAxis = axis;
+				splitPosition = axisMin + float(occupiedBins[i] + 1) / scale[axis];
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+void BVH::flatten(const std::vector<BuildNode>& buildNodes)
+{
+	struct FlattenTask
+	{
+		int buildNodeIndex, nodeIndex;
+	};
+
+	std::vector<FlattenTask> tasks;
+
+	nodes.resize(buildNodes[0].subtreeSize);
+	tasks.push_back({ 0, 0 });
+
+	// With depth-first order a subtree occupies "subtreeSize" contiguous nodes, which gives every index up front.
+	while (!tasks.empty())
+	{
+		FlattenTask task = tasks.back();
+		tasks.pop_back();
+
+		const BuildNode& buildNode = buildNodes[task.buildNodeIndex];
+		BVHNode& node = nodes[task.nodeIndex];
+
+		node.boundsMin = buildNode.bounds.min;
+		node.boundsMax = buildNode.bounds.max;
+		node.missIndex = task.nodeIndex + buildNode.subtreeSize;
+
+		if (buildNode.left == -1)
+		{
+			node.primitives = (buildNode.first << 4) | buildNode.count;
+
+			statistics.leafCount += 1;
+		}
+		else
+		{
+			node.primitives = 0;
+
+			tasks.push_back({ buildNode.right, task.nodeIndex + 1 + buildNodes[buildNode.left].subtreeSize });
+			tasks.push_back({ buildNode.left, task.nodeIndex + 1 });
+		}
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "../utils/thread_pool.h"
+
+struct AABB
+{
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+	void grow(const glm::vec3& point);
+	void grow(const AABB& box);
+
+	glm::vec3 getCentroid() const;
+	float getSurfaceArea() const;
+};
+
+// Flattened node uploaded as-is to the shaders (std430 "BVHNode", 32 bytes).
+//
+// Nodes are stored in depth-first order, so the left child of an interior node is always the next node and the traversal
+// doesn't need a stack: a missed box (or a visited leaf) jumps to "missIndex", which points to the first node after its subtree.
+//
+struct BVHNode
+{
+	glm::vec3 boundsMin;
+
+	int missIndex; // Equal to the number of nodes when there is nothing left to visit.
+
+	glm::vec3 boundsMax;
+
+	int primitives; // Zero for interior nodes, otherwise "(firstPrimitive << 4) | primitiveCount".
+};
+
+static_assert(sizeof(BVHNode) == 32, "BVHNode must match its std430 layout.");
+
+struct BVHStatistics
+{
+	int nodeCount, leafCount, depth;
+
+	float buildTime; // In milliseconds.
+};
+
+class BVH
+{
+public:
+	BVH();
+
+	static const int MAX_LEAF_PRIMITIVES = 8; // Must fit in the 4 bits reserved by "BVHNode::primitives".
+	static const int NUMBER_OF_BINS = 16;
+
+	// Builds the hierarchy over the primitives bounds with a binned "Surface Area Heuristic".
+	// Leaves reference contiguous ranges of "getPrimitiveIndices()", so callers usually reorder their primitives with it.
+	//
+	// "primitivesPerTest" is how many primitives the traversal intersects at once (e.g. the SIMD width of the CPU kernels):
+	// leaves are costed per group of tests instead of per primitive, which favours leaves that fill the vector lanes.
+	//
+	// With a "threadPool", the subtrees below the first levels are built in parallel (into the very same tree).
+	//
+	void build(const std::vector<AABB>& primitivesBounds, int primitivesPerTest = 1, ThreadPool* threadPool = nullptr);
+
+	// Takes nodes built before (e.g. read from a scene file) instead of building them, the primitives must already be in
+	// their leaf order. "getPrimitiveIndices()" is empty then.
+	void assign(const BVHNode* nodes, size_t count);
+
+	const std::vector<BVHNode>& getNodes() const;
+	const std::vector<uint32_t>& getPrimitiveIndices() const;
+	const BVHStatistics& getStatistics() const;
+
+	static int getLeafFirstPrimitive(const BVHNode& node);
+	static int getLeafPrimitiveCount(const BVHNode& node);
+
+	// Whether the stackless traversal of the nodes ends and stays within them and "primitiveCount" primitives, for
+	// nodes that come from outside the program.
+	static bool isValid(const BVHNode* nodes, size_t count, size_t primitiveCount);
+
+private:
+	// Primitives are partitioned by value rather than through "primitiveIndices", so every pass over a node reads
+	// contiguous memory (large meshes would otherwise spend most of the build in cache misses).
+	struct BuildPrimitive
+	{
+		AABB bounds;
+
+		glm::vec3 centroid;
+
+		uint32_t index;
+	};
+
+	struct BuildNode
+	{
+		AABB bounds;
+
+		int left, right; // Children indices, -1 on leaves.
+		int first, count; // Primitives range, only valid on leaves.
+		int subtreeSize;
+	};
+
+	struct BuildTask
+	{
+		int nodeIndex, depth;
+	};
+
+	std::vector<BVHNode> nodes;
+	std::vector<uint32_t> primitiveIndices;
+
+	BVHStatistics statistics;
+
+	// Splits the nodes of "tasks" (and their children) until they become leaves. Nodes with fewer than "deferredCount"
+	// primitives go to "deferredTasks" instead, when given. Returns the depth of the deepest node.
+	int splitNodes(std::vector<BuildPrimitive>& primitives, std::vector<BuildNode>& buildNodes, std::vector<BuildTask> tasks, int primitivesPerTest, int deferredCount, std::vector<BuildTask>* deferredTasks);
+
+	bool findBestSplit(const std::vector<BuildPrimitive>& primitives, const AABB& centroidsBounds, int first, int count, const AABB& bounds, int primitivesPerTest, int& splitAxis, float& splitPosition);
+
+	void flatten(const std::vector<BuildNode>& buildNodes);
+};
@@ -0,0 +1,512 @@
+#include "cpu_path_tracer.h"
+
+static const float EPSILON = 0.001f;
+static const float MAX_DISTANCE = 1000.0f; // Camera frustum distance.
+static const float PI = 3.14159265359f;
+
+// The helpers below are line by line ports of their GLSL counterparts, the unsigned arithmetic wraps the same way.
+
+static uint32_t PCG(uint32_t& state)
+{
+	uint32_t oldState = state;
+	uint32_t word = ((oldState >> ((oldState >> 28u) + 4u)) ^ oldState) * 277803737u;
+
+	state = oldState * 747796405u + 2891336453u;
+
+	return (word >> 22u) ^ word;
+}
+
+static float getRandomFloat(uint32_t& state)
+{
+	return float(PCG(state)) / float(0xffffffffu);
+}
+
+static glm::vec3 getUnitSphereDirection(const glm::vec2& u)
+{
+	float phi = 2.0f * PI * u.x;
+	float cosTheta = 2.0f * u.y - 1.0f;
+	float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+
+	return glm::vec3(std::cos(phi) * sinTheta, std::sin(phi) * sinTheta, cosTheta);
+}
+
+static glm::vec3 getRandomVecInUnitSphere(uint32_t& state)
+{
+	float r1 = getRandomFloat(state);
+	float r2 = getRandomFloat(state);
+
+	return getUnitSphereDirection(glm::vec2(r1, r2));
+}
+
+static void getBasis(const glm::vec3& w, glm::vec3& tangent, glm::vec3& bitangent)
+{
+	float signZ = w.z >= 0.0f ? 1.0f : -1.0f;
+	float a = -1.0f / (signZ + w.z);
+	float b = w.x * w.y * a;
+
+	tangent = glm::vec3(1.0f + signZ * w.x * w.x * a, signZ * b, -signZ * w.x);
+	bitangent = glm::vec3(b, signZ + w.y * w.y * a, -w.y);
+}
+
+static bool sampleLight(const Light& light, const glm::vec3& point, const glm::vec2& u, glm::vec3& direction, float& distance, glm::vec3& weight)
+{
+	if (light.type == 0)
+	{
+		glm::vec3 lightPoint = light.position + getUnitSphereDirection(u) * light.radius;
+
+		distance = glm::length(lightPoint - point);
+		direction = (lightPoint - point) / distance;
+		weight = light.emission / (distance * distance);
+
+		return true;
+	}
+
+	glm::vec3 toCenter = light.position - point;
+	float centerDistanceSquared = glm::dot(toCenter, toCenter);
+	float radiusSquared = light.radius * light.radius;
+
+	if (centerDistanceSquared <= radiusSquared)
+	{
+		return false;
+	}
+
+	float centerDistance = std::sqrt(centerDistanceSquared);
+	float sinThetaMaxSquared = radiusSquared / centerDistanceSquared;
+	float cosThetaMax = std::sqrt(std::max(1.0f - sinThetaMaxSquared, 0.0f));
+	float coneHeight = sinThetaMaxSquared / (1.0f + cosThetaMax);
+
+	float oneMinusCosTheta = u.x * coneHeight;
+	float cosTheta = 1.0f - oneMinusCosTheta;
+	float sinTheta = std::sqrt(std::max(oneMinusCosTheta * (2.0f - oneMinusCosTheta), 0.0f));
+	float phi = 2.0f * PI * u.y;
+
+	glm::vec3 w = toCenter / centerDistance;
+	glm::vec3 tangent, bitangent;
+	getBasis(w, tangent, bitangent);
+
+	direction = glm::normalize((tangent * std::cos(phi) + bitangent * std::sin(phi)) * sinTheta + w * cosTheta);
+
+	float projection = centerDistance * cosTheta;
+	distance = projection - std::sqrt(std::max(radiusSquared - (centerDistanceSquared - projection * projection), 0.0f));
+	weight = light.emission * 2.0f * coneHeight;
+
+	return true;
+}
+
+static float getMaterialReflectance(float indexOfRefraction, float cosTheta)
+{
+	// Use Schlick's approximation for reflectance.
+	float r0 = std::pow((1.0f - indexOfRefraction) / (1.0f + indexOfRefraction), 2.0f);
+
+	return r0 + (1.0f - r0) * std::pow((1.0f - cosTheta), 5.0f);
+}
+
+// Same as the shaders: tiny components are clamped to a signed epsilon, a zero one would make the slab test
+// multiply 0 by infinity (NaN).
+static glm::vec3 getInverseDirection(const glm::vec3& direction)
+{
+	const float epsilon = 1e-8f;
+
+	glm::vec3 clamped = direction;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (std::abs(clamped[axis]) < epsilon)
+		{
+			clamped[axis] = clamped[axis] < 0.0f ? -epsilon : epsilon;
+		}
+	}
+
+	return 1.0f / clamped;
+}
+
+static bool boxHit(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& boundsMin, const glm::vec3& boundsMax, float tMin, float tMax)
+{
+	// Slab test.
+	glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+	glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+
+	float tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+	float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+
+	return tEnter <= tExit;
+}
+
+CPUPathTracer::CPUPathTracer(int numberOfThreads)
+	: threadPool(numberOfThreads), spheres(), lightTable(), nodes(), sphereStore(), sphereArrays(), kernels(&SphereKernels::get(getPreferredSimdLevel())),
+	  frame(), statistics(), rayCounter(0)
+{
+}
+
+void CPUPathTracer::setScene(const std::vector<Sphere>& spheres, const LightTable& lightTable, const std::vector<BVHNode>& nodes)
+{
+	this->spheres = spheres;
+	this->lightTable = lightTable;
+	this->nodes = nodes;
+
+	sphereStore.build(spheres);
+	sphereArrays = sphereStore.getArrays();
+}
+
+void CPUPathTracer::setSimdLevel(SimdLevel level)
+{
+	kernels = &SphereKernels::get(std::min(level, getSupportedSimdLevel()));
+}
+
+SimdLevel CPUPathTracer::getSimdLevel() const
+{
+	return kernels->level;
+}
+
+SimdLevel CPUPathTracer::getPreferredSimdLevel()
+{
+	return std::min(getSupportedSimdLevel(), SimdLevel::AVX2);
+}
+
+void CPUPathTracer::render(const Camera& camera, const CPURenderSettings& settings, int width, int height, int frameIndex, std::vector<float>& pixels)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	pixels.resize(size_t(width) * height * 4);
+
+	frame.settings = settings;
+	frame.inverseProjectionMatrix = glm::inverse(camera.getProjectionMatrix());
+	frame.inverseViewMatrix = glm::inverse(camera.getViewMatrix());
+	frame.cameraPosition = camera.getPosition();
+	frame.width = width;
+	frame.height = height;
+	frame.frameIndex = frameIndex;
+	frame.pixels = pixels.data();
+
+	rayCounter = 0;
+
+	int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+	threadPool.dispatch(tilesX * tilesY, [this](int tileIndex, int) { renderTile(tileIndex); });
+
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+	statistics.rays = rayCounter.load();
+	statistics.renderTime = std::chrono::duration<float, std::milli>(end - start).count();
+	statistics.raysPerSecond = double(statistics.rays) / std::max(1.0e-9, std::chrono::duration<double>(end - start).count());
+}
+
+const CPURenderStatistics& CPUPathTracer::getStatistics() const
+{
+	return statistics;
+}
+
+int CPUPathTracer::getNumberOfThreads() const
+{
+	return threadPool.getNumberOfThreads();
+}
+
+void CPUPathTracer::renderTile(int tileIndex)
+{
+	int tilesX = (frame.width + TILE_SIZE - 1) / TILE_SIZE;
+	int startX = (tileIndex % tilesX) * TILE_SIZE;
+	int startY = (tileIndex / tilesX) * TILE_SIZE;
+	int endX = std::min(startX + TILE_SIZE, frame.width);
+	int endY = std::min(startY + TILE_SIZE, frame.height);
+
+	// Counted locally, the shared counter is only touched once per tile.
+	uint64_t rays = 0;
+
+	for (int y = startY; y < endY; y++)
+	{
+		for (int x = startX; x < endX; x++)
+		{
+			glm::vec3 color(0.0f);
+
+			for (int s = 0; s < frame.settings.samplesPerPixel; s++)
+			{
+				// Same seed as "path_tracer_2.frag", where "gl_FragCoord" holds the pixel center.
+				uint32_t randState = uint32_t(x) * 196314165u + uint32_t(y) * 937197125u + uint32_t(s) * 497196613u + uint32_t(frame.frameIndex) * 1297038473u;
+
+				PCG(randState); // Scramble the linear seed before the first draw.
+
+				glm::vec2 fragCoordOffset = 2.0f * glm::vec2(getRandomFloat(randState), getRandomFloat(randState)) - glm::vec2(1.0f);
+				glm::vec2 fragCoord = glm::vec2(float(x) + 0.5f, float(y) + 0.5f) + fragCoordOffset;
+
+				color += getColor({ frame.cameraPosition, getRayDirection(fragCoord) }, randState, rays);
+			}
+
+			color = color / float(frame.settings.samplesPerPixel);
+
+			float* pixel = frame.pixels + (size_t(y) * frame.width + x) * 4;
+			glm::vec3 previousColor(pixel[0], pixel[1], pixel[2]);
+
+			// The first frame after a reset ignores whatever the buffer held.
+			color = frame.frameIndex == 0 ? color : glm::mix(previousColor, color, 1.0f / float(frame.frameIndex + 1));
+
+			pixel[0] = color.r;
+			pixel[1] = color.g;
+			pixel[2] = color.b;
+			pixel[3] = 1.0f;
+		}
+	}
+
+	rayCounter.fetch_add(rays, std::memory_order_relaxed);
+}
+
+glm::vec3 CPUPathTracer::getRayDirection(const glm::vec2& fragCoord) const
+{
+	// Convert fragment coordinates to "Normalized Device Coordinates" (NDC).
+	glm::vec2 ndc = (fragCoord / glm::vec2(frame.width, frame.height)) * 2.0f - 1.0f;
+
+	// Unproject to eye space (forward is -z), then transform the direction to world space.
+	glm::vec4 clipCoords(ndc.x, ndc.y, -1.0f, 1.0f);
+	glm::vec4 eyeCoords(glm::vec2(frame.inverseProjectionMatrix * clipCoords), -1.0f, 0.0f);
+
+	return glm::normalize(glm::vec3(frame.inverseViewMatrix * eyeCoords));
+}
+
+glm::vec3 CPUPathTracer::getColor(Ray r, uint32_t& randState, uint64_t& rays) const
+{
+	glm::vec3 accumulatedColor(0.0f);
+	glm::vec3 accumulatedAttenuation(1.0f);
+
+	for (int bounce = 0; bounce < frame.settings.maxBounces; bounce++)
+	{
+		HitRecord rec;
+
+		rays += 1;
+
+		if (worldHit(r, EPSILON, MAX_DISTANCE, rec))
+		{
+			glm::vec3 attenuation;
+			Ray scattered;
+
+			// Add direct illumination using "Next Event Estimation".
+			accumulatedColor += accumulatedAttenuation * getDirectIllumination(rec, randState, rays);
+
+			if (glm::length(rec.material->emission) > 0.0f)
+			{
+				break;
+			}
+
+			// Scatter a ray for the next bounce (indirect illumination).
+			switch (rec.material->type)
+			{
+			case 0: // Lambertian material.
+				if (scatterLambertian(r, rec, attenuation, scattered, randState))
+				{
+					accumulatedAttenuation *= attenuation;
+					r = scattered;
+				}
+				break;
+
+			case 1: // Metal material.
+				if (scatterMetal(r, rec, attenuation, scattered, randState))
+				{
+					accumulatedAttenuation *= attenuation;
+					r = scattered;
+				}
+				else
+				{
+					return accumulatedColor;
+				}
+				break;
+
+			case 2: // Dielectric material.
+				if (scatterDielectric(r, rec, attenuation, scattered, randState))
+				{
+					accumulatedAttenuation *= attenuation;
+					r = scattered;
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+		else
+		{
+			float alpha = 0.5f * (glm::normalize(r.direction).y + 1.0f);
+
+			// Ray missed all objects, add sky/background color.
+			accumulatedColor += accumulatedAttenuation * ((1.0f - alpha) * glm::vec3(1.0f) + alpha * frame.settings.skyColor);
+
+			break;
+		}
+	}
+
+	return accumulatedColor;
+}
+
+glm::vec3 CPUPathTracer::getDirectIllumination(const HitRecord& rec, uint32_t& randState, uint64_t& rays) const
+{
+	const std::vector<Light>& lights = lightTable.getLights();
+
+	if (lights.empty())
+	{
+		return glm::vec3(0.0f);
+	}
+
+	// Drawn in the order of "getSample1D" then "getSample2D" with white noise.
+	const Light& light = lights[lightTable.sample(getRandomFloat(randState))];
+
+	float u1 = getRandomFloat(randState);
+	float u2 = getRandomFloat(randState);
+
+	glm::vec3 lightDirection, lightWeight;
+	float lightDistance;
+
+	if (!sampleLight(light, rec.point, glm::vec2(u1, u2), lightDirection, lightDistance, lightWeight))
+	{
+		return glm::vec3(0.0f);
+	}
+
+	float NdotL = std::max(0.0f, glm::dot(rec.normal, lightDirection));
+
+	if (NdotL > 0.0f)
+	{
+		rays += 1;
+
+		// Cast a shadow ray to check for occlusion.
+		if (!worldOccluded({ rec.point, lightDirection }, EPSILON, lightDistance - EPSILON))
+		{
+			return rec.material->albedo * lightWeight * NdotL / light.probability;
+		}
+	}
+
+	return glm::vec3(0.0f);
+}
+
+bool CPUPathTracer::worldHit(const Ray& r, float tMin, float tMax, HitRecord& rec) const
+{
+	float closestSoFar = tMax;
+	int closestSphere = -1;
+
+	glm::vec3 inverseDirection = getInverseDirection(r.direction);
+	int nodeIndex = 0;
+	int numberOfNodes = int(nodes.size());
+
+	// Stackless traversal: boxes that are hit descend to the next node, misses and leaves skip the whole subtree.
+	while (nodeIndex < numberOfNodes)
+	{
+		const BVHNode& node = nodes[nodeIndex];
+		int nextIndex = node.missIndex;
+
+		if (boxHit(r.origin, inverseDirection, node.boundsMin, node.boundsMax, tMin, closestSoFar))
+		{
+			if (node.primitives == 0)
+			{
+				nextIndex = nodeIndex + 1;
+			}
+			else
+			{
+				int hit = kernels->closestHit(sphereArrays, &r.origin.x, &r.direction.x, BVH::getLeafFirstPrimitive(node), BVH::getLeafPrimitiveCount(node), tMin, closestSoFar);
+
+				if (hit != -1)
+				{
+					closestSphere = hit;
+				}
+			}
+		}
+
+		nodeIndex = nextIndex;
+	}
+
+	if (closestSphere == -1)
+	{
+		return false;
+	}
+
+	const Sphere& sphere = spheres[closestSphere];
+
+	rec.t = closestSoFar;
+	rec.point = r.origin + r.direction * rec.t;
+	rec.material = &sphere.material;
+
+	glm::vec3 outwardNormal = (rec.point - sphere.center) / sphere.radius;
+
+	rec.frontFace = glm::dot(r.direction, outwardNormal) < 0.0f;
+	rec.normal = rec.frontFace ? outwardNormal : -outwardNormal;
+
+	return true;
+}
+
+bool CPUPathTracer::worldOccluded(const Ray& r, float tMin, float tMax) const
+{
+	glm::vec3 inverseDirection = getInverseDirection(r.direction);
+	int nodeIndex = 0;
+	int numberOfNodes = int(nodes.size());
+
+	while (nodeIndex < numberOfNodes)
+	{
+		const BVHNode& node = nodes[nodeIndex];
+		int nextIndex = node.missIndex;
+
+		if (boxHit(r.origin, inverseDirection, node.boundsMin, node.boundsMax, tMin, tMax))
+		{
+			if (node.primitives == 0)
+			{
+				nextIndex = nodeIndex + 1;
+			}
+			else
+			{
+				if (kernels->anyHit(sphereArrays, &r.origin.x, &r.direction.x, BVH::getLeafFirstPrimitive(node), BVH::getLeafPrimitiveCount(node), tMin, tMax))
+				{
+					return true;
+				}
+			}
+		}
+
+		nodeIndex = nextIndex;
+	}
+
+	return false;
+}
+
+bool CPUPathTracer::scatterLambertian(const Ray&, const HitRecord& rec, glm::vec3& attenuation, Ray& scattered, uint32_t& randState) const
+{
+	glm::vec3 scatterDirection = rec.normal + getRandomVecInUnitSphere(randState);
+
+	attenuation = rec.material->albedo;
+	scattered = { rec.point, glm::normalize(scatterDirection) };
+
+	return true;
+}
+
+bool CPUPathTracer::scatterMetal(const Ray& r, const HitRecord& rec, glm::vec3& attenuation, Ray& scattered, uint32_t& randState) const
+{
+	glm::vec3 reflected = glm::reflect(glm::normalize(r.direction), rec.normal);
+	glm::vec3 scatterDirection = reflected + (rec.material->roughness * getRandomVecInUnitSphere(randState));
+
+	attenuation = rec.material->albedo;
+	scattered = { rec.point, glm::normalize(scatterDirection) };
+
+	return glm::dot(scattered.direction, rec.normal) > 0.0f;
+}
+
+bool CPUPathTracer::scatterDielectric(const Ray& r, const HitRecord& rec, glm::vec3& attenuation, Ray& scattered, uint32_t& randState) const
+{
+	glm::vec3 normalizedDirection = glm::normalize(r.direction);
+	glm::vec3 scatterDirection;
+	float cosTheta = std::min(glm::dot(-normalizedDirection, rec.normal), 1.0f);
+	float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+	float refractionRatio = rec.frontFace ? (1.0f / rec.material->indexOfRefraction) : rec.material->indexOfRefraction;
+	float reflectance = getMaterialReflectance(rec.material->indexOfRefraction, cosTheta);
+
+	// Short-circuits like the shader, so total internal reflection doesn't consume a random number.
+	bool cannotRefract = refractionRatio * sinTheta > 1.0f;
+	cannotRefract = cannotRefract || reflectance > getRandomFloat(randState);
+
+	if (cannotRefract)
+	{
+		scatterDirection = glm::reflect(normalizedDirection, rec.normal);
+	}
+	else
+	{
+		scatterDirection = glm::refract(normalizedDirection, rec.normal, refractionRatio);
+	}
+
+	attenuation = glm::vec3(1.0f);
+	scattered = { rec.point, scatterDirection };
+
+	return true;
+}
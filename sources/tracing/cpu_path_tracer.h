@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "bvh.h"
+#include "primitives.h"
+#include "light_table.h"
+#include "sphere_store.h"
+#include "sphere_kernels.h"
+#include "../camera.h"
+#include "../utils/cpu_features.h"
+#include "../utils/thread_pool.h"
+
+struct CPURenderSettings
+{
+	glm::vec3 skyColor;
+
+	int maxBounces, samplesPerPixel;
+};
+
+struct CPURenderStatistics
+{
+	uint64_t rays; // Camera, scattered and shadow rays of the last frame.
+
+	float renderTime; // In milliseconds.
+	double raysPerSecond;
+};
+
+// Reference implementation of "path_tracer_2.frag" on the CPU.
+//
+// It traces the same scene buffers with the same PCG seeds and the same float math, so its frames can be compared
+// against the GPU ones, and it renders on machines without a usable GPU. The image is split in square tiles which
+// are spread over a work-stealing thread pool, and BVH leaves are tested with SIMD kernels over a SoA copy of the spheres.
+//
+class CPUPathTracer
+{
+public:
+	CPUPathTracer(int numberOfThreads = 0); // Zero uses every hardware thread.
+
+	static const int TILE_SIZE = 16;
+
+	// Spheres must be sorted in the leaf order of "nodes" (see "SphereBVH::build").
+	void setScene(const std::vector<Sphere>& spheres, const LightTable& lightTable, const std::vector<BVHNode>& nodes);
+
+	// Traces one frame and blends it into "pixels" (RGBA, bottom-up rows like "glReadPixels") the same way the shader
+	// blends with its accumulation texture: frame 0 overwrites, frame N weighs 1 / (N + 1).
+	void render(const Camera& camera, const CPURenderSettings& settings, int width, int height, int frameIndex, std::vector<float>& pixels);
+
+	// Intersection kernels default to "getPreferredSimdLevel()", this picks others (capped to what the processor supports).
+	void setSimdLevel(SimdLevel level);
+	SimdLevel getSimdLevel() const;
+
+	// Leaves hold at most "BVH::MAX_LEAF_PRIMITIVES" (8) spheres, so 16 lanes are never filled and AVX-512 only pays off
+	// on brute force tests: the best supported level up to AVX2.
+	static SimdLevel getPreferredSimdLevel();
+
+	const CPURenderStatistics& getStatistics() const;
+	int getNumberOfThreads() const;
+
+private:
+	struct Ray
+	{
+		glm::vec3 origin, direction;
+	};
+
+	struct HitRecord
+	{
+		glm::vec3 point, normal;
+
+		float t;
+
+		const Material* material;
+
+		bool frontFace;
+	};
+
+	// Per frame constants, read by every tile.
+	struct FrameState
+	{
+		CPURenderSettings settings;
+
+		glm::mat4 inverseProjectionMatrix, inverseViewMatrix;
+		glm::vec3 cameraPosition;
+
+		int width, height, frameIndex;
+
+		float* pixels;
+	};
+
+	ThreadPool threadPool;
+
+	std::vector<Sphere> spheres;
+	LightTable lightTable;
+	std::vector<BVHNode> nodes;
+
+	SphereStore sphereStore;
+	SphereArrays sphereArrays;
+	const SphereKernels* kernels;
+
+	FrameState frame;
+	CPURenderStatistics statistics;
+
+	std::atomic<uint64_t> rayCounter;
+
+	void renderTile(int tileIndex);
+
+	glm::vec3 getRayDirection(const glm::vec2& fragCoord) const;
+	glm::vec3 getColor(Ray r, uint32_t& randState, uint64_t& rays) const;
+	glm::vec3 getDirectIllumination(const HitRecord& rec, uint32_t& randState, uint64_t& rays) const;
+
+	bool worldHit(const Ray& r, float tMin, float tMax, HitRecord& rec) const;
+	bool worldOccluded(const Ray& r, float tMin, float tMax) const;
+
+	bool scatterLambertian(const Ray& r, const HitRecord& rec, glm::vec3& attenuation, Ray& scattered, uint32_t& randState) const;
+	bool scatterMetal(const Ray& r, const HitRecord& rec, glm::vec3& attenuation, Ray& scattered, uint32_t& randState) const;
+	bool scatterDielectric(const Ray& r, const HitRecord& rec, glm::vec3& attenuation, Ray& scattered, uint32_t& randState) const;
+};
@@ -0,0 +1,46 @@
+#include "frame_uniforms.h"
+
+FrameUniformsBuffer::FrameUniformsBuffer() : buffer(nullptr), uploadedUniforms(), uploaded(false)
+{
+	buffer = new UBO(nullptr, sizeof(FrameUniforms));
+}
+
+bool FrameUniformsBuffer::update(const FrameUniforms& uniforms)
+{
+	// The struct has no implicit padding (see the "static_assert"), so comparing bytes compares members.
+	if (uploaded && std::memcmp(&uniforms, &uploadedUniforms, sizeof(FrameUniforms)) == 0)
+	{
+		return false;
+	}
+
+	buffer->update(&uniforms, sizeof(FrameUniforms));
+
+	uploadedUniforms = uniforms;
+	uploaded = true;
+
+	return true;
+}
+
+void FrameUniformsBuffer::bindBase()
+{
+	buffer->bindBase(BINDING);
+}
+
+void FrameUniformsBuffer::attach(ShaderProgram& program)
+{
+	program.setUniformBlockBinding("FrameUniforms", BINDING);
+
+	int blockSize = program.getUniformBlockSize("FrameUniforms");
+
+	if (blockSize != int(sizeof(FrameUniforms)))
+	{
+		std::cout << "[ERROR] FRAME UNIFORMS: The shader block takes " << blockSize << " bytes, the struct " << sizeof(FrameUniforms) << "." << std::endl;
+	}
+}
+
+void FrameUniformsBuffer::clean()
+{
+	buffer->clean();
+
+	delete buffer;
+}
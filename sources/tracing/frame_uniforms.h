@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstring>
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+#include "../graphics/buffer.h"
+#include "../graphics/shader.h"
+
+// Per frame constants of the path tracing shaders, mirrors the std140 "FrameUniforms" block (mat4 and vec3 members
+// are 16 bytes aligned, the vec3 ones are padded by a scalar).
+struct FrameUniforms
+{
+	glm::mat4 inverseProjectionMatrix; // To unproject screen coordinates.
+	glm::mat4 inverseViewMatrix; // To transform from camera to world space.
+
+	glm::vec3 cameraPosition;
+
+	float padding0;
+
+	glm::vec3 skyColor;
+
+	float padding1;
+
+	glm::ivec2 viewportSize;
+
+	int maxBounces, samplesPerPixel;
+
+	// Number of valid entries in the spheres, lights, BVH and instances BVH storage buffers.
+	int numSpheres, numLights, numNodes, numInstanceNodes;
+};
+
+static_assert(sizeof(FrameUniforms) == 192, "FrameUniforms must match its std140 layout.");
+
+// Uniform buffer holding "FrameUniforms", only uploaded when its content changed since the last upload.
+class FrameUniformsBuffer
+{
+public:
+	static const uint32_t BINDING = 0; // Uniform block binding point shared by every path tracing program.
+
+	FrameUniformsBuffer();
+
+	// Returns true if the buffer was uploaded.
+	bool update(const FrameUniforms& uniforms);
+
+	void bindBase();
+
+	// Binds the "FrameUniforms" block of "program" to "BINDING" and checks that its layout matches the struct.
+	static void attach(ShaderProgram& program);
+
+	void clean();
+
+private:
+	UBO* buffer;
+
+	FrameUniforms uploadedUniforms;
+	bool uploaded;
+};
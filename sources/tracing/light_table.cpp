@@ -0,0 +1,122 @@
+#include "light_table.h"
+
+LightTable::LightTable() : lights(), statistics()
+{
+}
+
+void LightTable::build(const std::vector<Sphere>& spheres, const std::vector<PointLight>& pointLights)
+{
+	lights.clear();
+	statistics = { int(pointLights.size()), 0, 0.0f };
+
+	for (const PointLight& pointLight : pointLights)
+	{
+		lights.push_back({ pointLight.position, pointLight.radius, pointLight.color * pointLight.power, 0, 0.0f, 1.0f, 0, 0.0f });
+	}
+
+	for (const Sphere& sphere : spheres)
+	{
+		if (glm::length(sphere.material.emission) > 0.0f)
+		{
+			lights.push_back({ sphere.center, sphere.radius, sphere.material.emission, 1, 0.0f, 1.0f, 0, 0.0f });
+
+			statistics.emissiveSpheres += 1;
+		}
+	}
+
+	buildAliasTable();
+}
+
+void LightTable::assign(const Light* lights, size_t count)
+{
+	this->lights.assign(lights, lights + count);
+	statistics = { 0, 0, 0.0f };
+
+	for (const Light& light : this->lights)
+	{
+		(light.type == 0 ? statistics.pointLights : statistics.emissiveSpheres) += 1;
+
+		statistics.totalPower += getPower(light);
+	}
+}
+
+int LightTable::sample(float u) const
+{
+	float scaled = u * float(lights.size());
+	int index = std::min(int(scaled), int(lights.size()) - 1);
+
+	return scaled - float(index) < lights[index].aliasThreshold ? index : lights[index].alias;
+}
+
+const std::vector<Light>& LightTable::getLights() const
+{
+	return lights;
+}
+
+const LightTableStatistics& LightTable::getStatistics() const
+{
+	return statistics;
+}
+
+float LightTable::getPower(const Light& light)
+{
+	float luminance = glm::dot(light.emission, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+
+	return light.type == 0 ? luminance : luminance * light.radius * light.radius;
+}
+
+void LightTable::buildAliasTable()
+{
+	int numberOfLights = int(lights.size());
+
+	for (const Light& light : lights)
+	{
+		statistics.totalPower += getPower(light);
+	}
+
+	// Probabilities scaled by the light count, so the average entry is worth exactly one.
+	std::vector<float> scaled(numberOfLights);
+	std::vector<int> small, large;
+
+	for (int i = 0; i < numberOfLights; i++)
+	{
+		// Lights that emit nothing are never drawn, unless none emits anything.
+		lights[i].probability = statistics.totalPower > 0.0f ? getPower(lights[i]) / statistics.totalPower : 1.0f / float(numberOfLights);
+		lights[i].alias = i;
+
+		scaled[i] = lights[i].probability * float(numberOfLights);
+
+		(scaled[i] < 1.0f ? small : large).push_back(i);
+	}
+
+	// Every small entry is topped up to one by a large entry, which becomes small itself once it falls under one.
+	while (!small.empty() && !large.empty())
+	{
+		int smallIndex = small.back();
+		int largeIndex = large.back();
+
+		small.pop_back();
+
+		lights[smallIndex].aliasThreshold = scaled[smallIndex];
+		lights[smallIndex].alias = largeIndex;
+
+		scaled[largeIndex] -= 1.0f - scaled[smallIndex];
+
+		if (scaled[largeIndex] < 1.0f)
+		{
+			large.pop_back();
+			small.push_back(largeIndex);
+		}
+	}
+
+	// Whatever is left is one up to rounding errors.
+	for (int index : small)
+	{
+		lights[index].aliasThreshold = 1.0f;
+	}
+
+	for (int index : large)
+	{
+		lights[index].aliasThreshold = 1.0f;
+	}
+}
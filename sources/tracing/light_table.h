@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "primitives.h"
+
+struct LightTableStatistics
+{
+	int pointLights, emissiveSpheres;
+
+	float totalPower; // Sum of the weights, in the units of "getPower".
+};
+
+// Every light of a scene in one table, drawn in constant time with the alias method ("A Linear Algorithm for
+// Generating Random Numbers with a Given Distribution", Vose 1991).
+//
+// Lights are drawn in proportion to the power they emit, so next event estimation picks a single light per shading
+// point and its cost doesn't grow with the light count. The direction towards an emissive sphere is then drawn over
+// the solid angle it covers (see "lights.glsl"), which accounts for its distance and size at the shading point.
+//
+class LightTable
+{
+public:
+	LightTable();
+
+	void build(const std::vector<Sphere>& spheres, const std::vector<PointLight>& pointLights);
+
+	// Takes a table built before (e.g. read from a scene file), with its probabilities and aliases.
+	void assign(const Light* lights, size_t count);
+
+	// Index of the light drawn with "u" in [0, 1), same as "sampleLightTable" in "lights.glsl". The table can't be empty.
+	int sample(float u) const;
+
+	const std::vector<Light>& getLights() const;
+	const LightTableStatistics& getStatistics() const;
+
+	// Emitted power up to a common factor (4 pi^2): a point light's "color * power" seen from every direction is worth
+	// a sphere of radiance "color * power / radius^2".
+	static float getPower(const Light& light);
+
+private:
+	std::vector<Light> lights;
+
+	LightTableStatistics statistics;
+
+	void buildAliasTable();
+};
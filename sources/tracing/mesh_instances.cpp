@@ -0,0 +1,196 @@
+#include "mesh_instances.h"
+
+MeshInstances::MeshInstances() : vertices(), triangles(), meshNodes(), meshes(), instances(), bvh(), statistics()
+{
+}
+
+int MeshInstances::addMesh(const TriangleMesh& mesh)
+{
+	const std::vector<BVHNode>& nodes = mesh.getBVH().getNodes();
+
+	uint32_t firstVertex = uint32_t(vertices.size());
+
+	// Nodes keep their indices relative to the mesh, the traversal adds the start of its ranges.
+	MeshRange range = { int(meshNodes.size()), int(nodes.size()), int(triangles.size()), int(mesh.getTriangles().size()) };
+
+	vertices.insert(vertices.end(), mesh.getVertices().begin(), mesh.getVertices().end());
+	meshNodes.insert(meshNodes.end(), nodes.begin(), nodes.end());
+
+	for (const Triangle& triangle : mesh.getTriangles())
+	{
+		triangles.push_back({ triangle.indices + firstVertex, 0 });
+	}
+
+	meshes.push_back(range);
+
+	updateStatistics();
+
+	return int(meshes.size()) - 1;
+}
+
+void MeshInstances::addInstance(int mesh, const glm::mat4& transform, int material)
+{
+	Instance instance = {};
+
+	// The columns of the transposed inverse are the rows the shaders multiply points with.
+	instance.worldToObject = glm::mat3x4(glm::transpose(glm::inverse(transform)));
+	instance.mesh = mesh;
+	instance.material = material;
+
+	instances.push_back(instance);
+}
+
+void MeshInstances::buildBVH()
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	std::vector<AABB> instancesBounds(instances.size());
+	std::vector<Instance> orderedInstances(instances.size());
+
+	ThreadPool threadPool;
+
+	// Boxes of the transformed corners of every mesh box, in batches so the pool dispatch stays cheap next to them.
+	const int BATCH_SIZE = 4096;
+
+	threadPool.dispatch(int((instances.size() + BATCH_SIZE - 1) / BATCH_SIZE), [&](int batch, int)
+	{
+		size_t end = std::min(instances.size(), size_t(batch + 1) * BATCH_SIZE);
+
+		for (size_t i = size_t(batch) * BATCH_SIZE; i < end; i++)
+		{
+			AABB meshBounds = getMeshBounds(instances[i].mesh);
+			glm::mat4 objectToWorld = getObjectToWorld(instances[i]);
+
+			for (int corner = 0; corner < 8; corner++)
+			{
+				glm::vec3 point((corner & 1) ? meshBounds.max.x : meshBounds.min.x, (corner & 2) ? meshBounds.max.y : meshBounds.min.y,
+					(corner & 4) ? meshBounds.max.z : meshBounds.min.z);
+
+				instancesBounds[i].grow(glm::vec3(objectToWorld * glm::vec4(point, 1.0f)));
+			}
+		}
+	});
+
+	bvh.build(instancesBounds, 1, &threadPool);
+
+	// Store the instances in leaf order, so every leaf references a contiguous range of them.
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		orderedInstances[i] = instances[bvh.getPrimitiveIndices()[i]];
+	}
+
+	instances.swap(orderedInstances);
+
+	updateStatistics();
+
+	statistics.buildTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void MeshInstances::assign(const glm::vec4* vertices, size_t vertexCount, const Triangle* triangles, size_t triangleCount, const BVHNode* meshNodes, size_t meshNodeCount,
+	const MeshRange* meshes, size_t meshCount, const Instance* instances, size_t instanceCount, const BVHNode* instanceNodes, size_t instanceNodeCount)
+{
+	this->vertices.assign(vertices, vertices + vertexCount);
+	this->triangles.assign(triangles, triangles + triangleCount);
+	this->meshNodes.assign(meshNodes, meshNodes + meshNodeCount);
+	this->meshes.assign(meshes, meshes + meshCount);
+	this->instances.assign(instances, instances + instanceCount);
+
+	bvh.assign(instanceNodes, instanceNodeCount);
+
+	updateStatistics();
+
+	statistics.buildTime = 0.0f;
+}
+
+void MeshInstances::clear()
+{
+	vertices.clear();
+	triangles.clear();
+	meshNodes.clear();
+	meshes.clear();
+	instances.clear();
+
+	bvh = BVH();
+	statistics = {};
+}
+
+bool MeshInstances::isEmpty() const
+{
+	return instances.empty();
+}
+
+const std::vector<glm::vec4>& MeshInstances::getVertices() const
+{
+	return vertices;
+}
+
+const std::vector<Triangle>& MeshInstances::getTriangles() const
+{
+	return triangles;
+}
+
+const std::vector<BVHNode>& MeshInstances::getMeshNodes() const
+{
+	return meshNodes;
+}
+
+const std::vector<MeshRange>& MeshInstances::getMeshes() const
+{
+	return meshes;
+}
+
+const std::vector<Instance>& MeshInstances::getInstances() const
+{
+	return instances;
+}
+
+const BVH& MeshInstances::getBVH() const
+{
+	return bvh;
+}
+
+const InstanceStatistics& MeshInstances::getStatistics() const
+{
+	return statistics;
+}
+
+glm::mat4 MeshInstances::getObjectToWorld(const Instance& instance)
+{
+	const glm::mat3x4& rows = instance.worldToObject;
+
+	return glm::inverse(glm::transpose(glm::mat4(rows[0], rows[1], rows[2], glm::vec4(0.0f, 0.0f, 0.0f, 1.0f))));
+}
+
+AABB MeshInstances::getMeshBounds(int mesh) const
+{
+	AABB bounds;
+
+	if (mesh == -1)
+	{
+		bounds.min = glm::vec3(-1.0f);
+		bounds.max = glm::vec3(1.0f);
+	}
+	else if (meshes[mesh].nodeCount > 0)
+	{
+		const BVHNode& root = meshNodes[meshes[mesh].firstNode];
+
+		bounds.min = root.boundsMin;
+		bounds.max = root.boundsMax;
+	}
+	else
+	{
+		bounds.min = bounds.max = glm::vec3(0.0f); // Empty mesh, never hit.
+	}
+
+	return bounds;
+}
+
+void MeshInstances::updateStatistics()
+{
+	statistics.meshCount = int(meshes.size());
+	statistics.triangleCount = int(triangles.size());
+	statistics.instanceCount = int(instances.size());
+
+	statistics.geometryBytes = vertices.size() * sizeof(glm::vec4) + triangles.size() * sizeof(Triangle) + meshNodes.size() * sizeof(BVHNode) + meshes.size() * sizeof(MeshRange);
+	statistics.instanceBytes = instances.size() * sizeof(Instance) + bvh.getNodes().size() * sizeof(BVHNode);
+}
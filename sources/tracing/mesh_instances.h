@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "bvh.h"
+#include "primitives.h"
+#include "triangle_mesh.h"
+#include "../utils/thread_pool.h"
+
+struct InstanceStatistics
+{
+	int meshCount, triangleCount, instanceCount;
+
+	// Shader buffers of the shared meshes (vertices, triangles, hierarchies), then of the instances and their hierarchy.
+	size_t geometryBytes, instanceBytes;
+
+	float buildTime; // Of the instances hierarchy, in milliseconds.
+};
+
+// Two level acceleration structure: meshes stored once, and instances placing them (or a unit sphere) in the world
+// with a transform and a material, uploaded as-is to the shaders (see "intersection.glsl").
+//
+// Every mesh keeps the hierarchy "TriangleMesh::buildBVH" built in object space, and the instances get their own
+// hierarchy in world space, over the boxes of their meshes once transformed. Rays found in an instance leaf are brought
+// into its object space and go down the hierarchy of its mesh, so memory grows with the unique geometry and an instance
+// only costs an "Instance" (64 bytes) and its share of the world hierarchy.
+//
+class MeshInstances
+{
+public:
+	MeshInstances();
+
+	// Adds the vertices, triangles and hierarchy of "mesh" (after its "buildBVH") to the shared arrays and returns
+	// its index, for "addInstance".
+	int addMesh(const TriangleMesh& mesh);
+
+	// Places "mesh" (-1 for a unit sphere at the origin) in the world with "transform", which must be invertible.
+	// "material" indexes the mesh materials of the scene. Needs "buildBVH" before tracing.
+	void addInstance(int mesh, const glm::mat4& transform, int material);
+
+	// Builds the hierarchy over the instances and sorts them in its leaf order, as expected by the traversals.
+	void buildBVH();
+
+	// Replaces the content with arrays laid out like the shader buffers (e.g. read from a scene file), the instances
+	// already in the leaf order of "instanceNodes". Nothing is checked.
+	void assign(const glm::vec4* vertices, size_t vertexCount, const Triangle* triangles, size_t triangleCount, const BVHNode* meshNodes, size_t meshNodeCount,
+		const MeshRange* meshes, size_t meshCount, const Instance* instances, size_t instanceCount, const BVHNode* instanceNodes, size_t instanceNodeCount);
+
+	void clear();
+
+	bool isEmpty() const; // Without instances, even if meshes were added.
+
+	const std::vector<glm::vec4>& getVertices() const;
+	const std::vector<Triangle>& getTriangles() const; // Corners index the shared vertices.
+	const std::vector<BVHNode>& getMeshNodes() const;
+	const std::vector<MeshRange>& getMeshes() const;
+	const std::vector<Instance>& getInstances() const;
+	const BVH& getBVH() const; // Over the instances.
+	const InstanceStatistics& getStatistics() const;
+
+	// Transform that "addInstance" was given.
+	static glm::mat4 getObjectToWorld(const Instance& instance);
+
+private:
+	std::vector<glm::vec4> vertices;
+	std::vector<Triangle> triangles;
+	std::vector<BVHNode> meshNodes;
+	std::vector<MeshRange> meshes;
+	std::vector<Instance> instances;
+
+	BVH bvh;
+
+	InstanceStatistics statistics;
+
+	// Object space box of "mesh", the root of its hierarchy (or the unit sphere box for -1).
+	AABB getMeshBounds(int mesh) const;
+
+	void updateStatistics();
+};
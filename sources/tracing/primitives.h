@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// The structures below are uploaded as-is to shader storage buffers, so their members follow the std430 layout
+// of the GLSL declarations in "path_tracer_2.frag" (vec3 members are 16 bytes aligned and padded by a scalar).
+// The CPU path tracer reads the very same arrays.
+
+struct Material
+{
+	glm::vec3 albedo;
+
+	/* Acceptable types:
+	 *
+	 *  0: LAMBERTIAN;
+	 *  1: METAL;
+	 *  2: DIELECTRIC.
+	 */
+	int type;
+
+	glm::vec3 emission;
+
+	float roughness, indexOfRefraction;
+
+	float padding[3];
+};
+
+struct Sphere
+{
+	glm::vec3 center;
+
+	float radius;
+
+	Material material;
+};
+
+struct PointLight
+{
+	glm::vec3 position;
+
+	float radius;
+
+	glm::vec3 color;
+
+	float power;
+};
+
+// Entry of the light table ("LightTable"), built from the point lights and the emissive spheres.
+struct Light
+{
+	glm::vec3 position; // Center of the point light or of the sphere.
+
+	float radius;
+
+	glm::vec3 emission; // Intensity of a point light ("color * power"), radiance of a sphere.
+
+	int type; // 0: point light, 1: emissive sphere.
+
+	float probability; // Of drawing this light.
+
+	// Alias method: a draw landing on this entry keeps it under "aliasThreshold" and goes to "alias" above it.
+	float aliasThreshold;
+	int alias;
+
+	float padding;
+};
+
+// Triangle of a "TriangleMesh", its corners index the vertices of the mesh (stored as "glm::vec4", "w" unused).
+struct Triangle
+{
+	glm::uvec3 indices;
+
+	int padding;
+};
+
+// Mesh of a "MeshInstances", as ranges of its shared arrays: the nodes of the mesh hierarchy (indices relative to
+// "firstNode" and "firstTriangle") and the triangles.
+struct MeshRange
+{
+	int firstNode, nodeCount;
+	int firstTriangle, triangleCount;
+};
+
+// Placement of a mesh (or of a unit sphere at the origin) in the world.
+struct Instance
+{
+	glm::mat3x4 worldToObject; // Rows of the inverse transform, "vec4(point, 1) * worldToObject" in the shaders.
+
+	int mesh; // Into the "MeshRange" array, -1 for the unit sphere.
+	int material; // Into the mesh materials.
+
+	int padding[2];
+};
+
+static_assert(sizeof(Material) == 48, "Material must match its std430 layout.");
+static_assert(sizeof(Sphere) == 64, "Sphere must match its std430 layout.");
+static_assert(sizeof(PointLight) == 32, "PointLight must match its std430 layout.");
+static_assert(sizeof(Light) == 48, "Light must match its std430 layout.");
+static_assert(sizeof(Triangle) == 16, "Triangle must match its std430 layout.");
+static_assert(sizeof(MeshRange) == 16, "MeshRange must match its std430 layout.");
+static_assert(sizeof(Instance) == 64, "Instance must match its std430 layout.");
@@ -0,0 +1,300 @@
+#include "scene_file.h"
+
+static const char SCENE_FILE_MAGIC[8] = "RTSCENE";
+
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + SceneFile::ALIGNMENT - 1) / SceneFile::ALIGNMENT * SceneFile::ALIGNMENT;
+}
+
+SceneFile::SceneFile() : file(), sections()
+{
+}
+
+bool SceneFile::open(const std::string& path)
+{
+	close();
+
+	if (!file.open(path))
+	{
+		return false;
+	}
+
+	const char* data = file.getData();
+	uint64_t size = file.getSize();
+
+	bool valid = size >= sizeof(SceneFileHeader);
+
+	SceneFileHeader header = {};
+
+	if (valid)
+	{
+		std::memcpy(&header, data, sizeof(header));
+
+		valid = std::memcmp(header.magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC)) == 0;
+	}
+
+	if (!valid)
+	{
+		std::cout << "[ERROR] SCENE FILE: \"" << path << "\" isn't a scene file." << std::endl;
+
+		close();
+
+		return false;
+	}
+
+	if (header.version != VERSION)
+	{
+		std::cout << "[ERROR] SCENE FILE: \"" << path << "\" has version " << header.version << ", expected " << VERSION << "." << std::endl;
+
+		close();
+
+		return false;
+	}
+
+	// The table follows the 16 bytes header, so its entries are aligned like the mapping.
+	valid = sizeof(SceneFileHeader) + uint64_t(header.sectionCount) * sizeof(SceneFileSection) <= size;
+
+	const SceneFileSection* table = reinterpret_cast<const SceneFileSection*>(data + sizeof(SceneFileHeader));
+
+	for (uint32_t i = 0; valid && i < header.sectionCount; i++)
+	{
+		const SceneFileSection& section = table[i];
+
+		// Sections of later versions are skipped, known ones must match the structures of this build.
+		if (section.type >= uint32_t(SceneSection::COUNT))
+		{
+			continue;
+		}
+
+		valid = sections[section.type] == nullptr && section.elementSize == getElementSize(SceneSection(section.type)) && section.offset % ALIGNMENT == 0 &&
+			section.offset <= size && section.count <= (size - section.offset) / section.elementSize;
+
+		sections[section.type] = &section;
+	}
+
+	if (!valid)
+	{
+		std::cout << "[ERROR] SCENE FILE: The section table of \"" << path << "\" is damaged." << std::endl;
+
+		close();
+
+		return false;
+	}
+
+	if (!checkContent(path))
+	{
+		close();
+
+		return false;
+	}
+
+	return true;
+}
+
+void SceneFile::close()
+{
+	file.close();
+
+	std::fill(std::begin(sections), std::end(sections), nullptr);
+}
+
+size_t SceneFile::getSize() const
+{
+	return file.getSize();
+}
+
+bool SceneFile::write(const std::string& path, const SceneContent& content)
+{
+	struct SectionData
+	{
+		SceneSection type;
+
+		const void* data;
+		size_t count;
+	};
+
+	const std::vector<BVHNode>& spheresNodes = content.spheresBVH.getNodes();
+	const std::vector<Light>& lights = content.lightTable.getLights();
+	const std::vector<glm::vec4>& vertices = content.instances.getVertices();
+	const std::vector<Triangle>& triangles = content.instances.getTriangles();
+	const std::vector<BVHNode>& meshNodes = content.instances.getMeshNodes();
+	const std::vector<MeshRange>& meshes = content.instances.getMeshes();
+	const std::vector<Instance>& instances = content.instances.getInstances();
+	const std::vector<BVHNode>& instanceNodes = content.instances.getBVH().getNodes();
+
+	const SectionData sectionData[] = {
+		{ SceneSection::SETTINGS, &content.settings, 1 },
+		{ SceneSection::SPHERES, content.spheres.data(), content.spheres.size() },
+		{ SceneSection::POINT_LIGHTS, content.pointLights.data(), content.pointLights.size() },
+		{ SceneSection::LIGHTS, lights.data(), lights.size() },
+		{ SceneSection::SPHERES_BVH, spheresNodes.data(), spheresNodes.size() },
+		{ SceneSection::MESH_VERTICES, vertices.data(), vertices.size() },
+		{ SceneSection::TRIANGLES, triangles.data(), triangles.size() },
+		{ SceneSection::MESH_BVH, meshNodes.data(), meshNodes.size() },
+		{ SceneSection::MESH_MATERIALS, content.meshMaterials.data(), content.meshMaterials.size() },
+		{ SceneSection::MESH_RANGES, meshes.data(), meshes.size() },
+		{ SceneSection::INSTANCES, instances.data(), instances.size() },
+		{ SceneSection::INSTANCES_BVH, instanceNodes.data(), instanceNodes.size() }
+	};
+
+	const uint32_t sectionCount = uint32_t(std::size(sectionData));
+
+	SceneFileHeader header = {};
+	std::vector<SceneFileSection> table(sectionCount);
+
+	std::memcpy(header.magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC));
+	header.version = VERSION;
+	header.sectionCount = sectionCount;
+
+	uint64_t offset = alignOffset(sizeof(header) + sectionCount * sizeof(SceneFileSection));
+
+	for (uint32_t i = 0; i < sectionCount; i++)
+	{
+		table[i] = { uint32_t(sectionData[i].type), getElementSize(sectionData[i].type), offset, sectionData[i].count };
+
+		offset = alignOffset(offset + sectionData[i].count * table[i].elementSize);
+	}
+
+	std::ofstream stream(path, std::ios::binary);
+
+	if (!stream.is_open())
+	{
+		std::cout << "[ERROR] SCENE FILE: Failed to create \"" << path << "\"." << std::endl;
+
+		return false;
+	}
+
+	const char padding[ALIGNMENT] = {};
+
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(table.data()), std::streamsize(table.size() * sizeof(SceneFileSection)));
+
+	for (uint32_t i = 0; i < sectionCount; i++)
+	{
+		uint64_t position = uint64_t(stream.tellp());
+
+		stream.write(padding, std::streamsize(table[i].offset - position));
+		stream.write(static_cast<const char*>(sectionData[i].data), std::streamsize(table[i].count * table[i].elementSize));
+	}
+
+	// The last section is padded too, so every section can be read in whole aligned blocks.
+	stream.write(padding, std::streamsize(offset - uint64_t(stream.tellp())));
+
+	if (!stream.good())
+	{
+		std::cout << "[ERROR] SCENE FILE: Failed to write \"" << path << "\"." << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+bool SceneFile::checkContent(const std::string& path) const
+{
+	size_t settingsCount = 0, sphereCount = 0, lightCount = 0, spheresNodeCount = 0;
+	size_t vertexCount = 0, triangleCount = 0, meshNodeCount = 0, meshMaterialCount = 0, meshCount = 0, instanceCount = 0, instanceNodeCount = 0;
+
+	getSection<SceneSettings>(SceneSection::SETTINGS, settingsCount);
+	getSection<Sphere>(SceneSection::SPHERES, sphereCount);
+
+	const Light* lights = getSection<Light>(SceneSection::LIGHTS, lightCount);
+	const BVHNode* spheresNodes = getSection<BVHNode>(SceneSection::SPHERES_BVH, spheresNodeCount);
+
+	getSection<glm::vec4>(SceneSection::MESH_VERTICES, vertexCount);
+
+	const Triangle* triangles = getSection<Triangle>(SceneSection::TRIANGLES, triangleCount);
+	const BVHNode* meshNodes = getSection<BVHNode>(SceneSection::MESH_BVH, meshNodeCount);
+
+	getSection<Material>(SceneSection::MESH_MATERIALS, meshMaterialCount);
+
+	const MeshRange* meshes = getSection<MeshRange>(SceneSection::MESH_RANGES, meshCount);
+	const Instance* instances = getSection<Instance>(SceneSection::INSTANCES, instanceCount);
+	const BVHNode* instanceNodes = getSection<BVHNode>(SceneSection::INSTANCES_BVH, instanceNodeCount);
+
+	const char* error = nullptr;
+
+	if (settingsCount != 1)
+	{
+		error = "has no settings";
+	}
+	else if ((sphereCount == 0) != (spheresNodeCount == 0) || !BVH::isValid(spheresNodes, spheresNodeCount, sphereCount))
+	{
+		error = "has an invalid spheres hierarchy";
+	}
+	else if ((instanceCount == 0) != (instanceNodeCount == 0) || !BVH::isValid(instanceNodes, instanceNodeCount, instanceCount))
+	{
+		error = "has an invalid instances hierarchy";
+	}
+
+	// Draws land on any entry and may jump to its alias.
+	for (size_t i = 0; error == nullptr && i < lightCount; i++)
+	{
+		if (lights[i].alias < 0 || size_t(lights[i].alias) >= lightCount)
+		{
+			error = "has an invalid light table";
+		}
+	}
+
+	for (size_t i = 0; error == nullptr && i < triangleCount; i++)
+	{
+		const glm::uvec3& indices = triangles[i].indices;
+
+		if (indices.x >= vertexCount || indices.y >= vertexCount || indices.z >= vertexCount)
+		{
+			error = "has a triangle with a missing vertex";
+		}
+	}
+
+	// Each mesh traverses its own range of nodes, which must only reference its own range of triangles.
+	for (size_t i = 0; error == nullptr && i < meshCount; i++)
+	{
+		const MeshRange& mesh = meshes[i];
+
+		bool inside = mesh.firstNode >= 0 && mesh.nodeCount >= 0 && size_t(mesh.firstNode) <= meshNodeCount && size_t(mesh.nodeCount) <= meshNodeCount - size_t(mesh.firstNode) &&
+			mesh.firstTriangle >= 0 && mesh.triangleCount >= 0 && size_t(mesh.firstTriangle) <= triangleCount && size_t(mesh.triangleCount) <= triangleCount - size_t(mesh.firstTriangle);
+
+		if (!inside || (mesh.triangleCount == 0) != (mesh.nodeCount == 0) || !BVH::isValid(meshNodes + mesh.firstNode, size_t(mesh.nodeCount), size_t(mesh.triangleCount)))
+		{
+			error = "has an invalid mesh hierarchy";
+		}
+	}
+
+	for (size_t i = 0; error == nullptr && i < instanceCount; i++)
+	{
+		if (instances[i].mesh < -1 || instances[i].mesh >= int64_t(meshCount) || instances[i].material < 0 || size_t(instances[i].material) >= meshMaterialCount)
+		{
+			error = "has an instance with a missing mesh or material";
+		}
+	}
+
+	if (error != nullptr)
+	{
+		std::cout << "[ERROR] SCENE FILE: \"" << path << "\" " << error << "." << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t SceneFile::getElementSize(SceneSection section)
+{
+	switch (section)
+	{
+	case SceneSection::SETTINGS: return sizeof(SceneSettings);
+	case SceneSection::SPHERES: return sizeof(Sphere);
+	case SceneSection::POINT_LIGHTS: return sizeof(PointLight);
+	case SceneSection::LIGHTS: return sizeof(Light);
+	case SceneSection::SPHERES_BVH: return sizeof(BVHNode);
+	case SceneSection::MESH_VERTICES: return sizeof(glm::vec4);
+	case SceneSection::TRIANGLES: return sizeof(Triangle);
+	case SceneSection::MESH_BVH: return sizeof(BVHNode);
+	case SceneSection::MESH_MATERIALS: return sizeof(Material);
+	case SceneSection::MESH_RANGES: return sizeof(MeshRange);
+	case SceneSection::INSTANCES: return sizeof(Instance);
+	case SceneSection::INSTANCES_BVH: return sizeof(BVHNode);
+	default: return 0;
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "bvh.h"
+#include "primitives.h"
+#include "light_table.h"
+#include "mesh_instances.h"
+#include "../utils/mapped_file.h"
+
+// Sections of a scene file, each one an array of the structure uploaded to the matching shader buffer.
+enum class SceneSection : uint32_t
+{
+	SETTINGS,       // One "SceneSettings".
+	SPHERES,        // "Sphere", in the leaf order of "SPHERES_BVH".
+	POINT_LIGHTS,   // "PointLight", kept to build the light table again when edited.
+	LIGHTS,         // "Light", the light table built from the point lights and the emissive spheres.
+	SPHERES_BVH,    // "BVHNode".
+	MESH_VERTICES,  // "glm::vec4".
+	TRIANGLES,      // "Triangle", every mesh in the leaf order of its hierarchy.
+	MESH_BVH,       // "BVHNode", the hierarchies of every mesh (see "MeshInstances").
+	MESH_MATERIALS, // "Material", indexed by the instances.
+	MESH_RANGES,    // "MeshRange", the nodes and triangles of every mesh.
+	INSTANCES,      // "Instance", in the leaf order of "INSTANCES_BVH".
+	INSTANCES_BVH,  // "BVHNode".
+	COUNT
+};
+
+struct SceneSettings
+{
+	glm::vec3 skyColor;
+
+	float padding;
+};
+
+struct SceneFileHeader
+{
+	char magic[8]; // "RTSCENE" and a null.
+
+	uint32_t version;
+	uint32_t sectionCount; // Entries of the section table, which follows the header.
+};
+
+struct SceneFileSection
+{
+	uint32_t type; // "SceneSection".
+	uint32_t elementSize; // Size of the structure when written, files of another layout are rejected.
+
+	uint64_t offset; // From the start of the file, a multiple of "SceneFile::ALIGNMENT".
+	uint64_t count;
+};
+
+static_assert(sizeof(SceneSettings) == 16, "SceneSettings must match its file layout.");
+static_assert(sizeof(SceneFileHeader) == 16, "SceneFileHeader must match its file layout.");
+static_assert(sizeof(SceneFileSection) == 24, "SceneFileSection must match its file layout.");
+
+// What a scene file holds, as built by "SceneConverter" before it is written.
+struct SceneContent
+{
+	SceneSettings settings;
+
+	std::vector<Sphere> spheres;
+	std::vector<PointLight> pointLights;
+	LightTable lightTable;
+	BVH spheresBVH;
+
+	MeshInstances instances; // Empty without instances.
+	std::vector<Material> meshMaterials;
+};
+
+// Binary scene, laid out to be mapped and uploaded as it is: a header, a table of sections, then every section as an
+// aligned array of the structures the shaders read (see "primitives.h" and "bvh.h"), in the byte order of the writer.
+// Loading costs about one read of the file: "open" only checks the table and the indices (so a damaged file can't send
+// the traversals out of their buffers), and the sections are used where they lie in the mapping.
+//
+class SceneFile
+{
+public:
+	static const uint32_t VERSION = 2;
+	static const uint64_t ALIGNMENT = 64; // Of every section, a cache line (and more than any structure needs).
+
+	SceneFile();
+
+	// Maps "path" and checks it, false (and a closed file) on errors.
+	bool open(const std::string& path);
+	void close();
+
+	// Elements of "section" inside the mapping, valid until "close". Null (and zero elements) when missing.
+	template <typename T>
+	const T* getSection(SceneSection section, size_t& count) const
+	{
+		const SceneFileSection* entry = sections[size_t(section)];
+
+		count = entry != nullptr ? size_t(entry->count) : 0;
+
+		return entry != nullptr && entry->count > 0 ? reinterpret_cast<const T*>(file.getData() + entry->offset) : nullptr;
+	}
+
+	size_t getSize() const;
+
+	static bool write(const std::string& path, const SceneContent& content);
+
+private:
+	MappedFile file;
+
+	const SceneFileSection* sections[size_t(SceneSection::COUNT)]; // Into the table of the mapping, null when missing.
+
+	bool checkContent(const std::string& path) const;
+
+	static uint32_t getElementSize(SceneSection section);
+};
@@ -0,0 +1,23 @@
+#include "sphere_bvh.h"
+
+void SphereBVH::build(std::vector<Sphere>& spheres, BVH& bvh, int primitivesPerTest)
+{
+	std::vector<AABB> spheresBounds(spheres.size());
+	std::vector<Sphere> orderedSpheres(spheres.size());
+
+	for (size_t i = 0; i < spheres.size(); i++)
+	{
+		spheresBounds[i].min = spheres[i].center - glm::vec3(spheres[i].radius);
+		spheresBounds[i].max = spheres[i].center + glm::vec3(spheres[i].radius);
+	}
+
+	bvh.build(spheresBounds, primitivesPerTest);
+
+	// Store the spheres in leaf order, so every leaf references a contiguous range of them.
+	for (size_t i = 0; i < spheres.size(); i++)
+	{
+		orderedSpheres[i] = spheres[bvh.getPrimitiveIndices()[i]];
+	}
+
+	spheres.swap(orderedSpheres);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vector>
+
+#include "bvh.h"
+#include "primitives.h"
+
+// Hierarchy over the spheres of a scene, shared by the GPU scenes, the CPU path tracer and the scene files.
+class SphereBVH
+{
+public:
+	// Builds the hierarchy and sorts the spheres in its leaf order, as expected by the traversals.
+	static void build(std::vector<Sphere>& spheres, BVH& bvh, int primitivesPerTest = 1);
+};
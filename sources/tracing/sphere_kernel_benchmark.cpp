@@ -0,0 +1,123 @@
+#include "sphere_kernel_benchmark.h"
+
+// The array of structures loop the CPU backend started with.
+static int closestHitAoS(const std::vector<Sphere>& spheres, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax)
+{
+	int closest = -1;
+
+	for (int i = 0; i < int(spheres.size()); i++)
+	{
+		glm::vec3 oc = origin - spheres[i].center;
+
+		float a = glm::dot(direction, direction);
+		float b = glm::dot(oc, direction);
+		float c = glm::dot(oc, oc) - spheres[i].radius * spheres[i].radius;
+		float discriminant = b * b - a * c;
+
+		if (discriminant >= 0.0f)
+		{
+			float root = (-b - std::sqrt(discriminant)) / a;
+
+			if (!(root < tMax && root > tMin))
+			{
+				root = (-b + std::sqrt(discriminant)) / a;
+			}
+
+			if (root < tMax && root > tMin)
+			{
+				tMax = root;
+				closest = i;
+			}
+		}
+	}
+
+	return closest;
+}
+
+SphereKernelBenchmark::SphereKernelBenchmark(int numberOfSpheres, int numberOfRays) : numberOfSpheres(numberOfSpheres), numberOfRays(numberOfRays)
+{
+}
+
+int SphereKernelBenchmark::run()
+{
+	if (numberOfSpheres <= 0 || numberOfRays <= 0)
+	{
+		std::cout << "[ERROR] KERNEL BENCHMARK: Spheres and rays must be positive." << std::endl;
+
+		return -1;
+	}
+
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<float> position(-10.0f, 10.0f), radius(0.05f, 0.5f), unit(-1.0f, 1.0f);
+
+	std::vector<Sphere> spheres(numberOfSpheres);
+	std::vector<glm::vec3> origins(numberOfRays), directions(numberOfRays);
+	std::vector<int> referenceHits(numberOfRays), hits(numberOfRays);
+
+	for (Sphere& sphere : spheres)
+	{
+		sphere = { glm::vec3(position(generator), position(generator), position(generator)), radius(generator), {} };
+	}
+
+	for (int i = 0; i < numberOfRays; i++)
+	{
+		origins[i] = glm::vec3(position(generator), position(generator), position(generator));
+		directions[i] = glm::normalize(glm::vec3(unit(generator), unit(generator), unit(generator)) + glm::vec3(0.0f, 0.0f, 1.0e-3f));
+	}
+
+	SphereStore store;
+	store.build(spheres);
+
+	SphereArrays arrays = store.getArrays();
+	SimdLevel supportedLevel = getSupportedSimdLevel();
+
+	std::cout << "Kernel benchmark: " << numberOfRays << " rays x " << numberOfSpheres << " spheres, best supported \"" << getSimdLevelName(supportedLevel) << "\"." << std::endl;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < numberOfRays; i++)
+	{
+		referenceHits[i] = closestHitAoS(spheres, origins[i], directions[i], 0.001f, 1000.0f);
+	}
+
+	double referenceSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	double tests = double(numberOfRays) * numberOfSpheres;
+
+	std::cout << "  scalar (AoS): " << numberOfRays / referenceSeconds / 1.0e6 << " Mrays/s, " << tests / referenceSeconds / 1.0e9 << " G tests/s." << std::endl;
+
+	bool matching = true;
+
+	for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE4, SimdLevel::AVX2, SimdLevel::AVX512 })
+	{
+		if (level > supportedLevel)
+		{
+			break;
+		}
+
+		const SphereKernels& kernels = SphereKernels::get(level);
+		int mismatches = 0;
+
+		start = std::chrono::high_resolution_clock::now();
+
+		for (int i = 0; i < numberOfRays; i++)
+		{
+			float tMax = 1000.0f;
+
+			hits[i] = kernels.closestHit(arrays, &origins[i].x, &directions[i].x, 0, numberOfSpheres, 0.001f, tMax);
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		for (int i = 0; i < numberOfRays; i++)
+		{
+			mismatches += hits[i] != referenceHits[i] ? 1 : 0;
+		}
+
+		std::cout << "  " << getSimdLevelName(level) << " (SoA, " << kernels.width << " wide): " << numberOfRays / seconds / 1.0e6 << " Mrays/s, ";
+		std::cout << tests / seconds / 1.0e9 << " G tests/s, " << referenceSeconds / seconds << "x, " << mismatches << " mismatches." << std::endl;
+
+		matching = matching && mismatches == 0;
+	}
+
+	return matching ? 0 : -1;
+}
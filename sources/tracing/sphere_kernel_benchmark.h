@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+#include "primitives.h"
+#include "sphere_store.h"
+#include "sphere_kernels.h"
+#include "../utils/cpu_features.h"
+
+// Micro-benchmark of the closest hit kernels: random rays against every sphere of a random cloud (no BVH), timed
+// for the original one sphere at a time loop over "Sphere" and for each SoA kernel the processor supports.
+// Every kernel must return the same spheres as the reference loop.
+//
+class SphereKernelBenchmark
+{
+public:
+	SphereKernelBenchmark(int numberOfSpheres, int numberOfRays);
+
+	int run();
+
+private:
+	int numberOfSpheres, numberOfRays;
+};
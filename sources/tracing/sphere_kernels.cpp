@@ -0,0 +1,89 @@
+#include "sphere_kernels.h"
+
+#include <cmath>
+
+// Same operations, in the same order, as "sphereIntersection" in "path_tracer_2.frag".
+static float sphereIntersection(const SphereArrays& spheres, int index, const float origin[3], const float direction[3], float a, float tMin, float tMax)
+{
+	float ocX = origin[0] - spheres.centerX[index];
+	float ocY = origin[1] - spheres.centerY[index];
+	float ocZ = origin[2] - spheres.centerZ[index];
+
+	float b = ocX * direction[0] + ocY * direction[1] + ocZ * direction[2];
+	float c = (ocX * ocX + ocY * ocY + ocZ * ocZ) - spheres.radiusSquared[index];
+	float discriminant = b * b - a * c;
+
+	if (discriminant >= 0.0f)
+	{
+		float root = (-b - std::sqrt(discriminant)) / a;
+
+		if (root < tMax && root > tMin)
+		{
+			return root;
+		}
+
+		root = (-b + std::sqrt(discriminant)) / a;
+
+		if (root < tMax && root > tMin)
+		{
+			return root;
+		}
+	}
+
+	return -1.0f; // No intersection inside (tMin, tMax).
+}
+
+int closestHitScalar(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax)
+{
+	float a = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+	int closest = -1;
+
+	for (int i = first; i < first + count; i++)
+	{
+		float t = sphereIntersection(spheres, i, origin, direction, a, tMin, tMax);
+
+		if (t > 0.0f)
+		{
+			tMax = t;
+			closest = i;
+		}
+	}
+
+	return closest;
+}
+
+bool anyHitScalar(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax)
+{
+	float a = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+
+	for (int i = first; i < first + count; i++)
+	{
+		if (sphereIntersection(spheres, i, origin, direction, a, tMin, tMax) > 0.0f)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const SphereKernels& SphereKernels::get(SimdLevel level)
+{
+	static const SphereKernels scalar = { SimdLevel::SCALAR, 1, closestHitScalar, anyHitScalar };
+
+#ifdef SPHERE_KERNELS_X86
+	static const SphereKernels sse4 = { SimdLevel::SSE4, 4, closestHitSSE4, anyHitSSE4 };
+	static const SphereKernels avx2 = { SimdLevel::AVX2, 8, closestHitAVX2, anyHitAVX2 };
+	static const SphereKernels avx512 = { SimdLevel::AVX512, 16, closestHitAVX512, anyHitAVX512 };
+
+	switch (level)
+	{
+	case SimdLevel::AVX512: return avx512;
+	case SimdLevel::AVX2:   return avx2;
+	case SimdLevel::SSE4:   return sse4;
+	default:                return scalar;
+	}
+#else
+	return scalar;
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../utils/cpu_features.h"
+
+// Read-only view over the structure-of-arrays sphere store (see "SphereStore").
+//
+// Kept free of glm and of any inline code: the vector kernels live in translation units compiled for wider
+// instruction sets, and sharing inline functions with them could leak those instructions into the scalar path.
+//
+struct SphereArrays
+{
+	const float* centerX;
+	const float* centerY;
+	const float* centerZ;
+	const float* radiusSquared;
+
+	int count; // The arrays are readable SPHERE_ARRAYS_PADDING floats past this count.
+};
+
+const int SPHERE_ARRAYS_PADDING = 16;
+
+// Returns the closest sphere of [first, first + count) hit inside (tMin, tMax) and shrinks "tMax" to it, or -1 on a miss.
+// Matches the sequential "sphereIntersection" loop of "path_tracer_2.frag", ties included.
+using ClosestHitKernel = int (*)(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax);
+
+// Returns whether any sphere of [first, first + count) is hit inside (tMin, tMax).
+using AnyHitKernel = bool (*)(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax);
+
+// One ray against several spheres per instruction: 1 (scalar), 4 (SSE4), 8 (AVX2) or 16 (AVX-512) lanes.
+struct SphereKernels
+{
+	SimdLevel level;
+
+	int width; // Spheres tested per instruction.
+
+	ClosestHitKernel closestHit;
+	AnyHitKernel anyHit;
+
+	// Best kernels at or below "level" that were compiled in, e.g. "get(getSupportedSimdLevel())".
+	static const SphereKernels& get(SimdLevel level);
+};
+
+int closestHitScalar(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax);
+bool anyHitScalar(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax);
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SPHERE_KERNELS_X86
+
+int closestHitSSE4(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax);
+bool anyHitSSE4(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax);
+
+int closestHitAVX2(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax);
+bool anyHitAVX2(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax);
+
+int closestHitAVX512(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax);
+bool anyHitAVX512(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax);
+#endif
@@ -0,0 +1,99 @@
+#include "sphere_kernels.h"
+
+#ifdef SPHERE_KERNELS_X86
+
+#include <bit>
+#include <cmath>
+#include <immintrin.h>
+
+// Only these functions use AVX2, so nothing else in the program can end up requiring it.
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+// Intersects one ray with 8 spheres, see "sphereIntersection" for the scalar version of the same steps.
+// Returns the lanes that hit inside (tMin, tMax), with their distances in "t" (infinity elsewhere).
+AVX2_TARGET static inline __m256 intersect8(const SphereArrays& spheres, int index, int remaining, const __m256 origin[3], const __m256 direction[3], __m256 a, __m256 tMin, __m256 tMax, __m256& t)
+{
+	__m256 active = _mm256_cmp_ps(_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f), _mm256_set1_ps(float(remaining)), _CMP_LT_OQ);
+
+	__m256 ocX = _mm256_sub_ps(origin[0], _mm256_loadu_ps(spheres.centerX + index));
+	__m256 ocY = _mm256_sub_ps(origin[1], _mm256_loadu_ps(spheres.centerY + index));
+	__m256 ocZ = _mm256_sub_ps(origin[2], _mm256_loadu_ps(spheres.centerZ + index));
+
+	__m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocX, direction[0]), _mm256_mul_ps(ocY, direction[1])), _mm256_mul_ps(ocZ, direction[2]));
+	__m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocX, ocX), _mm256_mul_ps(ocY, ocY)), _mm256_mul_ps(ocZ, ocZ)), _mm256_loadu_ps(spheres.radiusSquared + index));
+	__m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+
+	__m256 valid = _mm256_and_ps(active, _mm256_cmp_ps(discriminant, _mm256_setzero_ps(), _CMP_GE_OQ));
+	__m256 squareRoot = _mm256_sqrt_ps(discriminant);
+	__m256 negativeB = _mm256_xor_ps(b, _mm256_set1_ps(-0.0f));
+
+	__m256 nearRoot = _mm256_div_ps(_mm256_sub_ps(negativeB, squareRoot), a);
+	__m256 farRoot = _mm256_div_ps(_mm256_add_ps(negativeB, squareRoot), a);
+
+	__m256 nearHit = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(nearRoot, tMax, _CMP_LT_OQ), _mm256_cmp_ps(nearRoot, tMin, _CMP_GT_OQ)));
+	__m256 farHit = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(farRoot, tMax, _CMP_LT_OQ), _mm256_cmp_ps(farRoot, tMin, _CMP_GT_OQ)));
+
+	t = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_set1_ps(INFINITY), farRoot, farHit), nearRoot, nearHit);
+
+	return _mm256_or_ps(nearHit, farHit);
+}
+
+AVX2_TARGET int closestHitAVX2(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax)
+{
+	__m256 originV[3] = { _mm256_set1_ps(origin[0]), _mm256_set1_ps(origin[1]), _mm256_set1_ps(origin[2]) };
+	__m256 directionV[3] = { _mm256_set1_ps(direction[0]), _mm256_set1_ps(direction[1]), _mm256_set1_ps(direction[2]) };
+	__m256 a = _mm256_set1_ps(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+	__m256 tMinV = _mm256_set1_ps(tMin);
+	int closest = -1;
+
+	// Groups are visited in order and shrink "tMax" as they go, like the sequential loop.
+	for (int i = 0; i < count; i += 8)
+	{
+		__m256 t;
+		int hitMask = _mm256_movemask_ps(intersect8(spheres, first + i, count - i, originV, directionV, a, tMinV, _mm256_set1_ps(tMax), t));
+
+		if (hitMask == 0)
+		{
+			continue;
+		}
+
+		__m256 minimum = _mm256_min_ps(t, _mm256_permute2f128_ps(t, t, 1));
+		minimum = _mm256_min_ps(minimum, _mm256_shuffle_ps(minimum, minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+		minimum = _mm256_min_ps(minimum, _mm256_shuffle_ps(minimum, minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		// The lowest lane wins ties, as the first sphere would in the sequential loop.
+		int lane = std::countr_zero(unsigned(_mm256_movemask_ps(_mm256_cmp_ps(t, minimum, _CMP_EQ_OQ)) & hitMask));
+
+		tMax = _mm256_cvtss_f32(minimum);
+		closest = first + i + lane;
+	}
+
+	return closest;
+}
+
+AVX2_TARGET bool anyHitAVX2(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax)
+{
+	__m256 originV[3] = { _mm256_set1_ps(origin[0]), _mm256_set1_ps(origin[1]), _mm256_set1_ps(origin[2]) };
+	__m256 directionV[3] = { _mm256_set1_ps(direction[0]), _mm256_set1_ps(direction[1]), _mm256_set1_ps(direction[2]) };
+	__m256 a = _mm256_set1_ps(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+	__m256 tMinV = _mm256_set1_ps(tMin);
+	__m256 tMaxV = _mm256_set1_ps(tMax);
+
+	for (int i = 0; i < count; i += 8)
+	{
+		__m256 t;
+
+		if (_mm256_movemask_ps(intersect8(spheres, first + i, count - i, originV, directionV, a, tMinV, tMaxV, t)) != 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include "sphere_kernels.h"
+
+#ifdef SPHERE_KERNELS_X86
+
+#include <bit>
+#include <cmath>
+#include <immintrin.h>
+
+// Only these functions use AVX-512, so nothing else in the program can end up requiring it.
+// AVX-512 brings FMA along, and GCC would fuse the products and sums, rounding differently from the other kernels.
+#if defined(__clang__)
+#define AVX512_TARGET __attribute__((target("avx512f")))
+#elif defined(__GNUC__)
+#define AVX512_TARGET __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#else
+#define AVX512_TARGET
+#endif
+
+// Intersects one ray with 16 spheres, see "sphereIntersection" for the scalar version of the same steps.
+// Lanes past the range are masked out of the loads, so they never touch memory. Returns the lanes that hit
+// inside (tMin, tMax), with their distances in "t" (infinity elsewhere).
+AVX512_TARGET static inline __mmask16 intersect16(const SphereArrays& spheres, int index, int remaining, const __m512 origin[3], const __m512 direction[3], __m512 a, __m512 tMin, __m512 tMax, __m512& t)
+{
+	__mmask16 active = remaining >= 16 ? __mmask16(0xffff) : __mmask16((1u << remaining) - 1u);
+
+	__m512 ocX = _mm512_sub_ps(origin[0], _mm512_maskz_loadu_ps(active, spheres.centerX + index));
+	__m512 ocY = _mm512_sub_ps(origin[1], _mm512_maskz_loadu_ps(active, spheres.centerY + index));
+	__m512 ocZ = _mm512_sub_ps(origin[2], _mm512_maskz_loadu_ps(active, spheres.centerZ + index));
+
+	__m512 b = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(ocX, direction[0]), _mm512_mul_ps(ocY, direction[1])), _mm512_mul_ps(ocZ, direction[2]));
+	__m512 c = _mm512_sub_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(ocX, ocX), _mm512_mul_ps(ocY, ocY)), _mm512_mul_ps(ocZ, ocZ)), _mm512_maskz_loadu_ps(active, spheres.radiusSquared + index));
+	__m512 discriminant = _mm512_sub_ps(_mm512_mul_ps(b, b), _mm512_mul_ps(a, c));
+
+	__mmask16 valid = _mm512_mask_cmp_ps_mask(active, discriminant, _mm512_setzero_ps(), _CMP_GE_OQ);
+	__m512 squareRoot = _mm512_sqrt_ps(discriminant);
+	__m512 negativeB = _mm512_sub_ps(_mm512_setzero_ps(), b);
+
+	__m512 nearRoot = _mm512_div_ps(_mm512_sub_ps(negativeB, squareRoot), a);
+	__m512 farRoot = _mm512_div_ps(_mm512_add_ps(negativeB, squareRoot), a);
+
+	__mmask16 nearHit = _mm512_mask_cmp_ps_mask(_mm512_mask_cmp_ps_mask(valid, nearRoot, tMax, _CMP_LT_OQ), nearRoot, tMin, _CMP_GT_OQ);
+	__mmask16 farHit = _mm512_mask_cmp_ps_mask(_mm512_mask_cmp_ps_mask(valid, farRoot, tMax, _CMP_LT_OQ), farRoot, tMin, _CMP_GT_OQ);
+
+	t = _mm512_mask_blend_ps(nearHit, _mm512_mask_blend_ps(farHit, _mm512_set1_ps(INFINITY), farRoot), nearRoot);
+
+	return nearHit | farHit;
+}
+
+AVX512_TARGET int closestHitAVX512(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax)
+{
+	__m512 originV[3] = { _mm512_set1_ps(origin[0]), _mm512_set1_ps(origin[1]), _mm512_set1_ps(origin[2]) };
+	__m512 directionV[3] = { _mm512_set1_ps(direction[0]), _mm512_set1_ps(direction[1]), _mm512_set1_ps(direction[2]) };
+	__m512 a = _mm512_set1_ps(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+	__m512 tMinV = _mm512_set1_ps(tMin);
+	int closest = -1;
+
+	// Groups are visited in order and shrink "tMax" as they go, like the sequential loop.
+	for (int i = 0; i < count; i += 16)
+	{
+		__m512 t;
+		__mmask16 hitMask = intersect16(spheres, first + i, count - i, originV, directionV, a, tMinV, _mm512_set1_ps(tMax), t);
+
+		if (hitMask == 0)
+		{
+			continue;
+		}
+
+		float minimum = _mm512_reduce_min_ps(t);
+
+		// The lowest lane wins ties, as the first sphere would in the sequential loop.
+		int lane = std::countr_zero(unsigned(_mm512_mask_cmp_ps_mask(hitMask, t, _mm512_set1_ps(minimum), _CMP_EQ_OQ)));
+
+		tMax = minimum;
+		closest = first + i + lane;
+	}
+
+	return closest;
+}
+
+AVX512_TARGET bool anyHitAVX512(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax)
+{
+	__m512 originV[3] = { _mm512_set1_ps(origin[0]), _mm512_set1_ps(origin[1]), _mm512_set1_ps(origin[2]) };
+	__m512 directionV[3] = { _mm512_set1_ps(direction[0]), _mm512_set1_ps(direction[1]), _mm512_set1_ps(direction[2]) };
+	__m512 a = _mm512_set1_ps(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+	__m512 tMinV = _mm512_set1_ps(tMin);
+	__m512 tMaxV = _mm512_set1_ps(tMax);
+
+	for (int i = 0; i < count; i += 16)
+	{
+		__m512 t;
+
+		if (intersect16(spheres, first + i, count - i, originV, directionV, a, tMinV, tMaxV, t) != 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "sphere_kernels.h"
+
+#ifdef SPHERE_KERNELS_X86
+
+#include <bit>
+#include <cmath>
+#include <immintrin.h>
+
+// Only these functions use SSE4.1, so nothing else in the program can end up requiring it.
+#if defined(__GNUC__) || defined(__clang__)
+#define SSE4_TARGET __attribute__((target("sse4.1")))
+#else
+#define SSE4_TARGET
+#endif
+
+// Intersects one ray with 4 spheres, see "sphereIntersection" for the scalar version of the same steps.
+// Returns the lanes that hit inside (tMin, tMax), with their distances in "t" (infinity elsewhere).
+SSE4_TARGET static inline __m128 intersect4(const SphereArrays& spheres, int index, int remaining, const __m128 origin[3], const __m128 direction[3], __m128 a, __m128 tMin, __m128 tMax, __m128& t)
+{
+	__m128 active = _mm_cmplt_ps(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_set1_ps(float(remaining)));
+
+	__m128 ocX = _mm_sub_ps(origin[0], _mm_loadu_ps(spheres.centerX + index));
+	__m128 ocY = _mm_sub_ps(origin[1], _mm_loadu_ps(spheres.centerY + index));
+	__m128 ocZ = _mm_sub_ps(origin[2], _mm_loadu_ps(spheres.centerZ + index));
+
+	__m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocX, direction[0]), _mm_mul_ps(ocY, direction[1])), _mm_mul_ps(ocZ, direction[2]));
+	__m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ocX, ocX), _mm_mul_ps(ocY, ocY)), _mm_mul_ps(ocZ, ocZ)), _mm_loadu_ps(spheres.radiusSquared + index));
+	__m128 discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+
+	__m128 valid = _mm_and_ps(active, _mm_cmpge_ps(discriminant, _mm_setzero_ps()));
+	__m128 squareRoot = _mm_sqrt_ps(discriminant);
+	__m128 negativeB = _mm_xor_ps(b, _mm_set1_ps(-0.0f));
+
+	__m128 nearRoot = _mm_div_ps(_mm_sub_ps(negativeB, squareRoot), a);
+	__m128 farRoot = _mm_div_ps(_mm_add_ps(negativeB, squareRoot), a);
+
+	__m128 nearHit = _mm_and_ps(valid, _mm_and_ps(_mm_cmplt_ps(nearRoot, tMax), _mm_cmpgt_ps(nearRoot, tMin)));
+	__m128 farHit = _mm_and_ps(valid, _mm_and_ps(_mm_cmplt_ps(farRoot, tMax), _mm_cmpgt_ps(farRoot, tMin)));
+
+	t = _mm_blendv_ps(_mm_blendv_ps(_mm_set1_ps(INFINITY), farRoot, farHit), nearRoot, nearHit);
+
+	return _mm_or_ps(nearHit, farHit);
+}
+
+SSE4_TARGET int closestHitSSE4(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float& tMax)
+{
+	__m128 originV[3] = { _mm_set1_ps(origin[0]), _mm_set1_ps(origin[1]), _mm_set1_ps(origin[2]) };
+	__m128 directionV[3] = { _mm_set1_ps(direction[0]), _mm_set1_ps(direction[1]), _mm_set1_ps(direction[2]) };
+	__m128 a = _mm_set1_ps(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+	__m128 tMinV = _mm_set1_ps(tMin);
+	int closest = -1;
+
+	// Groups are visited in order and shrink "tMax" as they go, like the sequential loop.
+	for (int i = 0; i < count; i += 4)
+	{
+		__m128 t;
+		int hitMask = _mm_movemask_ps(intersect4(spheres, first + i, count - i, originV, directionV, a, tMinV, _mm_set1_ps(tMax), t));
+
+		if (hitMask == 0)
+		{
+			continue;
+		}
+
+		__m128 minimum = _mm_min_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 3, 0, 1)));
+		minimum = _mm_min_ps(minimum, _mm_shuffle_ps(minimum, minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		// The lowest lane wins ties, as the first sphere would in the sequential loop.
+		int lane = std::countr_zero(unsigned(_mm_movemask_ps(_mm_cmpeq_ps(t, minimum)) & hitMask));
+
+		tMax = _mm_cvtss_f32(minimum);
+		closest = first + i + lane;
+	}
+
+	return closest;
+}
+
+SSE4_TARGET bool anyHitSSE4(const SphereArrays& spheres, const float origin[3], const float direction[3], int first, int count, float tMin, float tMax)
+{
+	__m128 originV[3] = { _mm_set1_ps(origin[0]), _mm_set1_ps(origin[1]), _mm_set1_ps(origin[2]) };
+	__m128 directionV[3] = { _mm_set1_ps(direction[0]), _mm_set1_ps(direction[1]), _mm_set1_ps(direction[2]) };
+	__m128 a = _mm_set1_ps(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+	__m128 tMinV = _mm_set1_ps(tMin);
+	__m128 tMaxV = _mm_set1_ps(tMax);
+
+	for (int i = 0; i < count; i += 4)
+	{
+		__m128 t;
+
+		if (_mm_movemask_ps(intersect4(spheres, first + i, count - i, originV, directionV, a, tMinV, tMaxV, t)) != 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include "sphere_store.h"
+
+SphereStore::SphereStore() : centerX(), centerY(), centerZ(), radiusSquared(), count(0)
+{
+}
+
+void SphereStore::build(const std::vector<Sphere>& spheres)
+{
+	count = int(spheres.size());
+
+	// The padding lets the vector kernels load whole groups past the end, those lanes are masked out anyway
+	// but a negative squared radius guarantees a miss.
+	size_t paddedCount = spheres.size() + SPHERE_ARRAYS_PADDING;
+
+	centerX.assign(paddedCount, 0.0f);
+	centerY.assign(paddedCount, 0.0f);
+	centerZ.assign(paddedCount, 0.0f);
+	radiusSquared.assign(paddedCount, -std::numeric_limits<float>::max());
+
+	for (size_t i = 0; i < spheres.size(); i++)
+	{
+		centerX[i] = spheres[i].center.x;
+		centerY[i] = spheres[i].center.y;
+		centerZ[i] = spheres[i].center.z;
+		radiusSquared[i] = spheres[i].radius * spheres[i].radius;
+	}
+}
+
+SphereArrays SphereStore::getArrays() const
+{
+	return { centerX.data(), centerY.data(), centerZ.data(), radiusSquared.data(), count };
+}
+
+int SphereStore::getCount() const
+{
+	return count;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+
+#include "primitives.h"
+#include "sphere_kernels.h"
+#include "../utils/aligned_allocator.h"
+
+// Structure-of-arrays copy of the sphere geometry for the CPU kernels.
+//
+// The "Sphere" array interleaves each center with 48 bytes of material, so a vector load of centers would need a
+// gather and most of every cache line would be wasted. Here each coordinate lives in its own cache aligned array
+// (with the squared radius precomputed), and materials are only fetched for the closest hit.
+//
+class SphereStore
+{
+public:
+	SphereStore();
+
+	// Keeps the order of "spheres", so indices (and BVH leaf ranges) are shared with it.
+	void build(const std::vector<Sphere>& spheres);
+
+	SphereArrays getArrays() const;
+	int getCount() const;
+
+private:
+	using AlignedFloats = std::vector<float, AlignedAllocator<float, 64>>;
+
+	AlignedFloats centerX, centerY, centerZ, radiusSquared;
+
+	int count;
+};
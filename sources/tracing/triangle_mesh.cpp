@@ -0,0 +1,623 @@
+#include "triangle_mesh.h"
+
+static bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* skipSpaces(const char* data, const char* end)
+{
+	while (data < end && isSpace(*data))
+	{
+		data++;
+	}
+
+	return data;
+}
+
+static const char* skipLine(const char* data, const char* end)
+{
+	const char* newline = static_cast<const char*>(std::memchr(data, '\n', size_t(end - data)));
+
+	return newline != nullptr ? newline + 1 : end;
+}
+
+// "std::from_chars" rejects the explicit plus sign some exporters write.
+template <typename T>
+static const char* parseNumber(const char* data, const char* end, T& value)
+{
+	if (data < end && *data == '+')
+	{
+		data++;
+	}
+
+	std::from_chars_result result = std::from_chars(data, end, value);
+
+	return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+TriangleMesh::TriangleMesh() : vertices(), triangles(), bvh(), statistics()
+{
+}
+
+bool TriangleMesh::load(const std::string& path)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	clear();
+
+	MappedFile file;
+
+	if (!file.open(path))
+	{
+		return false;
+	}
+
+	const char* data = file.getData();
+	const char* end = data + file.getSize();
+
+	std::string extension = path.substr(path.find_last_of('.') + 1);
+
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return char(std::tolower(c)); });
+
+	bool loaded = false;
+
+	if (extension == "obj")
+	{
+		loaded = loadOBJ(data, end);
+	}
+	else if (extension == "ply")
+	{
+		loaded = loadPLY(data, end);
+	}
+	else
+	{
+		std::cout << "[ERROR] TRIANGLE MESH: Unknown format of \"" << path << "\", expected \".obj\" or \".ply\"." << std::endl;
+	}
+
+	// Faces may reference vertices declared after them, so the indices are only checked once everything is read.
+	for (size_t i = 0; loaded && i < triangles.size(); i++)
+	{
+		const glm::uvec3& indices = triangles[i].indices;
+
+		if (indices.x >= vertices.size() || indices.y >= vertices.size() || indices.z >= vertices.size())
+		{
+			std::cout << "[ERROR] TRIANGLE MESH: Triangle " << i << " references a missing vertex." << std::endl;
+
+			loaded = false;
+		}
+	}
+
+	if (loaded && triangles.empty())
+	{
+		std::cout << "[ERROR] TRIANGLE MESH: \"" << path << "\" has no triangles." << std::endl;
+
+		loaded = false;
+	}
+
+	if (!loaded)
+	{
+		std::cout << "[ERROR] TRIANGLE MESH: Failed to load \"" << path << "\"." << std::endl;
+
+		clear();
+
+		return false;
+	}
+
+	statistics.vertexCount = int(vertices.size());
+	statistics.triangleCount = int(triangles.size());
+	statistics.loadTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return true;
+}
+
+void TriangleMesh::transform(const glm::mat4& matrix)
+{
+	for (glm::vec4& vertex : vertices)
+	{
+		vertex = glm::vec4(glm::vec3(matrix * glm::vec4(glm::vec3(vertex), 1.0f)), 0.0f);
+	}
+}
+
+void TriangleMesh::buildBVH()
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	std::vector<AABB> trianglesBounds(triangles.size());
+	std::vector<Triangle> orderedTriangles(triangles.size());
+
+	for (size_t i = 0; i < triangles.size(); i++)
+	{
+		const glm::uvec3& indices = triangles[i].indices;
+
+		trianglesBounds[i].grow(glm::vec3(vertices[indices.x]));
+		trianglesBounds[i].grow(glm::vec3(vertices[indices.y]));
+		trianglesBounds[i].grow(glm::vec3(vertices[indices.z]));
+	}
+
+	// Every hardware thread helps with the lower levels, which hold most of the work on large meshes.
+	ThreadPool threadPool;
+
+	bvh.build(trianglesBounds, 1, &threadPool);
+
+	// Store the triangles in leaf order, so every leaf references a contiguous range of them. Vertices are shared by
+	// several leaves and keep their order.
+	for (size_t i = 0; i < triangles.size(); i++)
+	{
+		orderedTriangles[i] = triangles[bvh.getPrimitiveIndices()[i]];
+	}
+
+	triangles.swap(orderedTriangles);
+
+	statistics.buildTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void TriangleMesh::clear()
+{
+	vertices.clear();
+	triangles.clear();
+
+	bvh = BVH();
+	statistics = {};
+}
+
+bool TriangleMesh::isEmpty() const
+{
+	return triangles.empty();
+}
+
+const std::vector<glm::vec4>& TriangleMesh::getVertices() const
+{
+	return vertices;
+}
+
+const std::vector<Triangle>& TriangleMesh::getTriangles() const
+{
+	return triangles;
+}
+
+const BVH& TriangleMesh::getBVH() const
+{
+	return bvh;
+}
+
+const MeshStatistics& TriangleMesh::getStatistics() const
+{
+	return statistics;
+}
+
+bool TriangleMesh::loadOBJ(const char* data, const char* end)
+{
+	std::vector<uint32_t> corners; // Of the current face, reused by every face.
+
+	int lineNumber = 1;
+
+	for (; data < end; lineNumber++)
+	{
+		data = skipSpaces(data, end);
+
+		if (end - data < 2 || !isSpace(data[1]))
+		{
+			data = skipLine(data, end);
+
+			continue;
+		}
+
+		if (data[0] == 'v')
+		{
+			glm::vec4 vertex(0.0f);
+
+			data += 2;
+
+			// Extra values (the "w" coordinate or vertex colors) are skipped with the end of the line.
+			for (int i = 0; i < 3 && data != nullptr; i++)
+			{
+				data = parseNumber(skipSpaces(data, end), end, vertex[i]);
+			}
+
+			if (data == nullptr)
+			{
+				std::cout << "[ERROR] TRIANGLE MESH: Malformed vertex on line " << lineNumber << "." << std::endl;
+
+				return false;
+			}
+
+			vertices.push_back(vertex);
+		}
+		else if (data[0] == 'f')
+		{
+			corners.clear();
+
+			data = skipSpaces(data + 2, end);
+
+			// Corners are "v", "v/vt", "v//vn" or "v/vt/vn", only the position index is read.
+			while (data < end && *data != '\n' && *data != '#')
+			{
+				int64_t index = 0;
+
+				data = parseNumber(data, end, index);
+
+				// Wrapped indices would silently reference other vertices.
+				if (data == nullptr || index == 0 || index > int64_t(UINT32_MAX) || index < -int64_t(vertices.size()))
+				{
+					std::cout << "[ERROR] TRIANGLE MESH: Malformed face on line " << lineNumber << "." << std::endl;
+
+					return false;
+				}
+
+				// Negative indices count back from the last vertex read so far.
+				corners.push_back(uint32_t(index > 0 ? index - 1 : int64_t(vertices.size()) + index));
+
+				while (data < end && !isSpace(*data) && *data != '\n')
+				{
+					data++;
+				}
+
+				data = skipSpaces(data, end);
+			}
+
+			addPolygon(corners.data(), int(corners.size()));
+		}
+
+		data = skipLine(data, end);
+	}
+
+	return true;
+}
+
+bool TriangleMesh::loadPLY(const char* data, const char* end)
+{
+	PLYFormat format;
+	std::vector<PLYElement> elements;
+
+	if (!readPLYHeader(data, end, format, elements))
+	{
+		return false;
+	}
+
+	// Counts come from the header, so the ones the rest of the file can't hold (every element takes at least one byte
+	// per ASCII value, or its fixed size in binary) are rejected before anything is reserved for them.
+	size_t remainingBytes = size_t(end - data);
+
+	for (const PLYElement& element : elements)
+	{
+		size_t minimumSize = 0;
+
+		for (const PLYProperty& property : element.properties)
+		{
+			minimumSize += format == PLYFormat::ASCII ? 1 : getPLYTypeSize(property.list ? property.countType : property.type);
+		}
+
+		minimumSize = std::max<size_t>(minimumSize, 1);
+
+		if (element.count > remainingBytes / minimumSize)
+		{
+			std::cout << "[ERROR] TRIANGLE MESH: The PLY header declares " << element.count << " \"" << element.name << "\" elements, more than the file holds." << std::endl;
+
+			return false;
+		}
+
+		remainingBytes -= element.count * minimumSize;
+	}
+
+	std::vector<uint32_t> corners;
+
+	for (const PLYElement& element : elements)
+	{
+		int positionProperties[3] = { -1, -1, -1 };
+		int indicesProperty = -1;
+
+		for (int i = 0; i < int(element.properties.size()); i++)
+		{
+			const PLYProperty& property = element.properties[i];
+
+			if (element.name == "vertex" && !property.list && property.name.size() == 1 && property.name[0] >= 'x' && property.name[0] <= 'z')
+			{
+				positionProperties[property.name[0] - 'x'] = i;
+			}
+			else if (element.name == "face" && property.list && (property.name == "vertex_indices" || property.name == "vertex_index"))
+			{
+				indicesProperty = i;
+			}
+		}
+
+		if (element.name == "vertex" && (positionProperties[0] == -1 || positionProperties[1] == -1 || positionProperties[2] == -1))
+		{
+			std::cout << "[ERROR] TRIANGLE MESH: The PLY vertices have no \"x\", \"y\" and \"z\" properties." << std::endl;
+
+			return false;
+		}
+
+		if (element.name == "vertex")
+		{
+			vertices.reserve(vertices.size() + element.count);
+		}
+		else if (element.name == "face")
+		{
+			triangles.reserve(triangles.size() + element.count);
+		}
+
+		// Every value is read, the ones of other elements and properties are dropped.
+		for (size_t i = 0; i < element.count; i++)
+		{
+			glm::vec4 vertex(0.0f);
+
+			for (int j = 0; j < int(element.properties.size()); j++)
+			{
+				const PLYProperty& property = element.properties[j];
+				double value = 0.0;
+
+				if (!property.list)
+				{
+					if (!readPLYValue(data, end, format, property.type, value))
+					{
+						return false;
+					}
+
+					for (int axis = 0; axis < 3; axis++)
+					{
+						vertex[axis] = positionProperties[axis] == j ? float(value) : vertex[axis];
+					}
+
+					continue;
+				}
+
+				double count = 0.0;
+
+				if (!readPLYValue(data, end, format, property.countType, count))
+				{
+					return false;
+				}
+
+				if (!(count >= 0.0 && count <= double(INT32_MAX)))
+				{
+					std::cout << "[ERROR] TRIANGLE MESH: Malformed PLY list of " << count << " values." << std::endl;
+
+					return false;
+				}
+
+				corners.clear();
+
+				for (int k = 0; k < int(count); k++)
+				{
+					if (!readPLYValue(data, end, format, property.type, value))
+					{
+						return false;
+					}
+
+					// Other lists (e.g. texture coordinates) aren't indices.
+					if (j == indicesProperty && !(value >= 0.0 && value <= double(UINT32_MAX)))
+					{
+						std::cout << "[ERROR] TRIANGLE MESH: PLY index " << value << " out of range." << std::endl;
+
+						return false;
+					}
+
+					corners.push_back(uint32_t(value));
+				}
+
+				if (j == indicesProperty)
+				{
+					addPolygon(corners.data(), int(corners.size()));
+				}
+			}
+
+			if (element.name == "vertex")
+			{
+				vertices.push_back(vertex);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool TriangleMesh::readPLYHeader(const char*& data, const char* end, PLYFormat& format, std::vector<PLYElement>& elements)
+{
+	const char* headerEnd = nullptr;
+
+	// The header is a few lines of text, the only part of the file read into strings.
+	for (const char* line = data; line < end; line = skipLine(line, end))
+	{
+		if (end - line >= 10 && std::memcmp(line, "end_header", 10) == 0)
+		{
+			headerEnd = skipLine(line, end);
+
+			break;
+		}
+	}
+
+	if (end - data < 3 || std::memcmp(data, "ply", 3) != 0 || headerEnd == nullptr)
+	{
+		std::cout << "[ERROR] TRIANGLE MESH: Missing PLY header." << std::endl;
+
+		return false;
+	}
+
+	std::istringstream header(std::string(data, headerEnd));
+	std::string line;
+	bool formatFound = false;
+
+	while (std::getline(header, line))
+	{
+		std::istringstream tokens(line);
+		std::string keyword;
+
+		tokens >> keyword;
+
+		if (keyword == "format")
+		{
+			std::string formatName;
+
+			tokens >> formatName;
+
+			if (formatName == "ascii")
+			{
+				format = PLYFormat::ASCII;
+			}
+			else if (formatName == "binary_little_endian")
+			{
+				format = PLYFormat::BINARY_LITTLE_ENDIAN;
+			}
+			else if (formatName == "binary_big_endian")
+			{
+				format = PLYFormat::BINARY_BIG_ENDIAN;
+			}
+			else
+			{
+				std::cout << "[ERROR] TRIANGLE MESH: Unknown PLY format \"" << formatName << "\"." << std::endl;
+
+				return false;
+			}
+
+			formatFound = true;
+		}
+		else if (keyword == "element")
+		{
+			PLYElement element = { "", 0, {} };
+
+			tokens >> element.name >> element.count;
+
+			elements.push_back(element);
+		}
+		else if (keyword == "property")
+		{
+			PLYProperty property = { "", PLYType::FLOAT32, false, PLYType::UINT8 };
+			std::string typeName;
+
+			tokens >> typeName;
+
+			if (typeName == "list")
+			{
+				std::string countTypeName;
+
+				tokens >> countTypeName >> typeName;
+
+				property.list = true;
+
+				if (!parsePLYType(countTypeName, property.countType))
+				{
+					return false;
+				}
+			}
+
+			tokens >> property.name;
+
+			if (elements.empty() || !parsePLYType(typeName, property.type))
+			{
+				std::cout << "[ERROR] TRIANGLE MESH: Malformed PLY property \"" << line << "\"." << std::endl;
+
+				return false;
+			}
+
+			elements.back().properties.push_back(property);
+		}
+	}
+
+	if (!formatFound)
+	{
+		std::cout << "[ERROR] TRIANGLE MESH: The PLY header has no format." << std::endl;
+
+		return false;
+	}
+
+	data = headerEnd;
+
+	return true;
+}
+
+bool TriangleMesh::readPLYValue(const char*& data, const char* end, PLYFormat format, PLYType type, double& value)
+{
+	if (format == PLYFormat::ASCII)
+	{
+		while (data < end && (isSpace(*data) || *data == '\n'))
+		{
+			data++;
+		}
+
+		data = parseNumber(data, end, value);
+
+		if (data == nullptr)
+		{
+			std::cout << "[ERROR] TRIANGLE MESH: Malformed PLY value." << std::endl;
+
+			return false;
+		}
+
+		return true;
+	}
+
+	size_t size = getPLYTypeSize(type);
+	unsigned char bytes[8];
+
+	if (size_t(end - data) < size)
+	{
+		std::cout << "[ERROR] TRIANGLE MESH: The PLY file ends before its last element." << std::endl;
+
+		return false;
+	}
+
+	std::memcpy(bytes, data, size);
+
+	data += size;
+
+	// Hosts are little endian (x86 and ARM).
+	if (format == PLYFormat::BINARY_BIG_ENDIAN)
+	{
+		for (size_t i = 0; i < size / 2; i++)
+		{
+			std::swap(bytes[i], bytes[size - 1 - i]);
+		}
+	}
+
+	switch (type)
+	{
+	case PLYType::INT8: { int8_t v; std::memcpy(&v, bytes, size); value = v; break; }
+	case PLYType::UINT8: { uint8_t v; std::memcpy(&v, bytes, size); value = v; break; }
+	case PLYType::INT16: { int16_t v; std::memcpy(&v, bytes, size); value = v; break; }
+	case PLYType::UINT16: { uint16_t v; std::memcpy(&v, bytes, size); value = v; break; }
+	case PLYType::INT32: { int32_t v; std::memcpy(&v, bytes, size); value = v; break; }
+	case PLYType::UINT32: { uint32_t v; std::memcpy(&v, bytes, size); value = v; break; }
+	case PLYType::FLOAT32: { float v; std::memcpy(&v, bytes, size); value = v; break; }
+	case PLYType::FLOAT64: { double v; std::memcpy(&v, bytes, size); value = v; break; }
+	}
+
+	return true;
+}
+
+size_t TriangleMesh::getPLYTypeSize(PLYType type)
+{
+	static const size_t TYPE_SIZES[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+	return TYPE_SIZES[int(type)];
+}
+
+bool TriangleMesh::parsePLYType(const std::string& name, PLYType& type)
+{
+	static const char* TYPE_NAMES[][2] = {
+		{ "char", "int8" }, { "uchar", "uint8" }, { "short", "int16" }, { "ushort", "uint16" },
+		{ "int", "int32" }, { "uint", "uint32" }, { "float", "float32" }, { "double", "float64" }
+	};
+
+	for (int i = 0; i < 8; i++)
+	{
+		if (name == TYPE_NAMES[i][0] || name == TYPE_NAMES[i][1])
+		{
+			type = PLYType(i);
+
+			return true;
+		}
+	}
+
+	std::cout << "[ERROR] TRIANGLE MESH: Unknown PLY type \"" << name << "\"." << std::endl;
+
+	return false;
+}
+
+void TriangleMesh::addPolygon(const uint32_t* corners, int count)
+{
+	for (int i = 1; i + 1 < count; i++)
+	{
+		triangles.push_back({ glm::uvec3(corners[0], corners[i], corners[i + 1]), 0 });
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <charconv>
+#include <iostream>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "bvh.h"
+#include "primitives.h"
+#include "../utils/mapped_file.h"
+
+struct MeshStatistics
+{
+	int vertexCount, triangleCount;
+
+	float loadTime, buildTime; // In milliseconds.
+};
+
+// Indexed triangles loaded from a Wavefront OBJ or a PLY (ASCII or binary) file, traced through the instances of a
+// "MeshInstances" that shares them.
+//
+// Files are memory mapped and parsed in place with "std::from_chars" in a single pass, so loading costs about one
+// read of the file and nothing per line. Only the positions and the faces are read (polygons are split in fans),
+// normals, texture coordinates and materials are skipped.
+//
+class TriangleMesh
+{
+public:
+	TriangleMesh();
+
+	// Replaces the content of the mesh. False (and an empty mesh) on errors.
+	bool load(const std::string& path);
+
+	// Applies "matrix" to every vertex, before "buildBVH".
+	void transform(const glm::mat4& matrix);
+
+	// Builds the hierarchy over the triangles and sorts them in its leaf order, as expected by the traversals.
+	void buildBVH();
+
+	void clear();
+
+	bool isEmpty() const;
+
+	const std::vector<glm::vec4>& getVertices() const;
+	const std::vector<Triangle>& getTriangles() const;
+	const BVH& getBVH() const;
+	const MeshStatistics& getStatistics() const;
+
+private:
+	enum class PLYFormat { ASCII, BINARY_LITTLE_ENDIAN, BINARY_BIG_ENDIAN };
+	enum class PLYType { INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64 };
+
+	struct PLYProperty
+	{
+		std::string name;
+
+		PLYType type;
+
+		bool list;
+		PLYType countType; // Type of the element count of list properties.
+	};
+
+	struct PLYElement
+	{
+		std::string name;
+
+		size_t count;
+
+		std::vector<PLYProperty> properties;
+	};
+
+	std::vector<glm::vec4> vertices;
+	std::vector<Triangle> triangles;
+
+	BVH bvh;
+
+	MeshStatistics statistics;
+
+	bool loadOBJ(const char* data, const char* end);
+	bool loadPLY(const char* data, const char* end);
+
+	// Parses the header and moves "data" to the first element.
+	static bool readPLYHeader(const char*& data, const char* end, PLYFormat& format, std::vector<PLYElement>& elements);
+	static bool readPLYValue(const char*& data, const char* end, PLYFormat format, PLYType type, double& value);
+	static bool parsePLYType(const std::string& name, PLYType& type);
+	static size_t getPLYTypeSize(PLYType type);
+
+	// Splits a polygon of "count" corners (starting at "corners") in a fan of triangles.
+	void addPolygon(const uint32_t* corners, int count);
+};
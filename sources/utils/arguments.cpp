@@ -0,0 +1,79 @@
+#include "arguments.h"
+
+Arguments::Arguments(int argc, char** argv) : values(argv + 1, argv + argc)
+{
+}
+
+bool Arguments::has(const char* name) const
+{
+	for (const std::string& value : values)
+	{
+		if (value == name)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::string Arguments::getString(const char* name, const std::string& fallback) const
+{
+	const std::string* value = find(name);
+
+	return value != nullptr ? *value : fallback;
+}
+
+int Arguments::getInt(const char* name, int fallback) const
+{
+	const std::string* value = find(name);
+
+	return value != nullptr ? std::atoi(value->c_str()) : fallback;
+}
+
+float Arguments::getFloat(const char* name, float fallback) const
+{
+	const std::string* value = find(name);
+
+	return value != nullptr ? float(std::atof(value->c_str())) : fallback;
+}
+
+glm::vec3 Arguments::getVec3(const char* name, const glm::vec3& fallback) const
+{
+	const std::string* value = find(name);
+	glm::vec3 result = fallback;
+
+	if (value != nullptr)
+	{
+		size_t start = 0;
+
+		for (int i = 0; i < 3 && start <= value->size(); i++)
+		{
+			size_t end = value->find(',', start);
+
+			result[i] = float(std::atof(value->substr(start, end - start).c_str()));
+
+			if (end == std::string::npos)
+			{
+				break;
+			}
+
+			start = end + 1;
+		}
+	}
+
+	return result;
+}
+
+const std::string* Arguments::find(const char* name) const
+{
+	for (size_t i = 0; i + 1 < values.size(); i++)
+	{
+		if (values[i] == name)
+		{
+			return &values[i + 1];
+		}
+	}
+
+	return nullptr;
+}
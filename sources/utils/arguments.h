@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include <glm/glm.hpp>
+
+// Minimal command-line reader for "--name value" pairs and "--flag" switches.
+class Arguments
+{
+public:
+	Arguments(int argc, char** argv);
+
+	bool has(const char* name) const;
+
+	std::string getString(const char* name, const std::string& fallback) const;
+	int getInt(const char* name, int fallback) const;
+	float getFloat(const char* name, float fallback) const;
+	glm::vec3 getVec3(const char* name, const glm::vec3& fallback) const; // Written as "x,y,z".
+
+private:
+	std::vector<std::string> values;
+
+	const std::string* find(const char* name) const;
+};
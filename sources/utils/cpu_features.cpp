@@ -0,0 +1,120 @@
+#include "cpu_features.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_FEATURES_X86
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef CPU_FEATURES_X86
+static void cpuid(int leaf, int subleaf, unsigned int registers[4])
+{
+#ifdef _MSC_VER
+	__cpuidex((int*)registers, leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+static unsigned long long getEnabledRegisterStates()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int low = 0, high = 0;
+
+	__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+
+	return (unsigned long long)(high) << 32 | low;
+#endif
+}
+#endif
+
+SimdLevel getSupportedSimdLevel()
+{
+#ifdef CPU_FEATURES_X86
+	unsigned int registers[4] = {};
+
+	cpuid(0, 0, registers);
+
+	int maxLeaf = int(registers[0]);
+
+	if (maxLeaf < 1)
+	{
+		return SimdLevel::SCALAR;
+	}
+
+	cpuid(1, 0, registers);
+
+	bool sse41 = (registers[2] & (1u << 19)) != 0;
+	bool osxsave = (registers[2] & (1u << 27)) != 0;
+	bool avx = (registers[2] & (1u << 28)) != 0;
+
+	if (!sse41)
+	{
+		return SimdLevel::SCALAR;
+	}
+
+	if (!osxsave || !avx || maxLeaf < 7)
+	{
+		return SimdLevel::SSE4;
+	}
+
+	unsigned long long registerStates = getEnabledRegisterStates();
+
+	// XMM and YMM states must both be enabled by the OS, then opmask, ZMM0-15 upper halves and ZMM16-31 for AVX-512.
+	if ((registerStates & 0x6) != 0x6)
+	{
+		return SimdLevel::SSE4;
+	}
+
+	cpuid(7, 0, registers);
+
+	bool avx2 = (registers[1] & (1u << 5)) != 0;
+	bool avx512f = (registers[1] & (1u << 16)) != 0;
+
+	if (!avx2)
+	{
+		return SimdLevel::SSE4;
+	}
+
+	if (avx512f && (registerStates & 0xe6) == 0xe6)
+	{
+		return SimdLevel::AVX512;
+	}
+
+	return SimdLevel::AVX2;
+#else
+	return SimdLevel::SCALAR;
+#endif
+}
+
+const char* getSimdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SSE4:   return "sse4";
+	case SimdLevel::AVX2:   return "avx2";
+	case SimdLevel::AVX512: return "avx512";
+	default:                return "scalar";
+	}
+}
+
+bool parseSimdLevel(const std::string& name, SimdLevel& level)
+{
+	for (SimdLevel candidate : { SimdLevel::SCALAR, SimdLevel::SSE4, SimdLevel::AVX2, SimdLevel::AVX512 })
+	{
+		if (name == getSimdLevelName(candidate))
+		{
+			level = candidate;
+
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+// Vector instruction sets the CPU kernels are compiled for, in increasing order.
+enum class SimdLevel
+{
+	SCALAR,
+	SSE4,
+	AVX2,
+	AVX512
+};
+
+// Highest level supported by both the processor and the operating system (which must save the wider registers).
+SimdLevel getSupportedSimdLevel();
+
+const char* getSimdLevelName(SimdLevel level);
+bool parseSimdLevel(const std::string& name, SimdLevel& level);
@@ -0,0 +1,394 @@
+#include "json.h"
+
+static const char* skipWhitespace(const char* data, const char* end)
+{
+	while (data < end && (*data == ' ' || *data == '\t' || *data == '\n' || *data == '\r'))
+	{
+		data++;
+	}
+
+	return data;
+}
+
+static bool parseHexCode(const char*& data, const char* end, uint32_t& code)
+{
+	if (end - data < 4)
+	{
+		return false;
+	}
+
+	std::from_chars_result result = std::from_chars(data, data + 4, code, 16);
+
+	if (result.ec != std::errc() || result.ptr != data + 4)
+	{
+		return false;
+	}
+
+	data += 4;
+
+	return true;
+}
+
+static void appendUTF8(std::string& string, uint32_t code)
+{
+	if (code < 0x80)
+	{
+		string += char(code);
+	}
+	else if (code < 0x800)
+	{
+		string += char(0xC0 | (code >> 6));
+		string += char(0x80 | (code & 0x3F));
+	}
+	else if (code < 0x10000)
+	{
+		string += char(0xE0 | (code >> 12));
+		string += char(0x80 | ((code >> 6) & 0x3F));
+		string += char(0x80 | (code & 0x3F));
+	}
+	else
+	{
+		string += char(0xF0 | (code >> 18));
+		string += char(0x80 | ((code >> 12) & 0x3F));
+		string += char(0x80 | ((code >> 6) & 0x3F));
+		string += char(0x80 | (code & 0x3F));
+	}
+}
+
+JSONValue::JSONValue() : type(JSONType::NULL_VALUE), boolean(false), number(0.0), string(), elements(), keys()
+{
+}
+
+bool JSONValue::parse(const char* data, const char* end, JSONValue& value)
+{
+	const char* position = skipWhitespace(data, end);
+
+	value = JSONValue();
+
+	bool parsed = parseValue(position, end, 0, value);
+
+	if (parsed)
+	{
+		position = skipWhitespace(position, end);
+	}
+
+	if (!parsed || position != end)
+	{
+		int line = 1 + int(std::count(data, position, '\n'));
+
+		std::cout << "[ERROR] JSON: Malformed document at line " << line << "." << std::endl;
+
+		value = JSONValue();
+
+		return false;
+	}
+
+	return true;
+}
+
+JSONType JSONValue::getType() const
+{
+	return type;
+}
+
+bool JSONValue::isNumber() const
+{
+	return type == JSONType::NUMBER;
+}
+
+bool JSONValue::isString() const
+{
+	return type == JSONType::STRING;
+}
+
+bool JSONValue::isArray() const
+{
+	return type == JSONType::ARRAY;
+}
+
+bool JSONValue::isObject() const
+{
+	return type == JSONType::OBJECT;
+}
+
+bool JSONValue::getBoolean() const
+{
+	return boolean;
+}
+
+double JSONValue::getNumber() const
+{
+	return number;
+}
+
+const std::string& JSONValue::getString() const
+{
+	return string;
+}
+
+const std::vector<JSONValue>& JSONValue::getElements() const
+{
+	return elements;
+}
+
+const std::vector<std::string>& JSONValue::getKeys() const
+{
+	return keys;
+}
+
+const JSONValue* JSONValue::find(const std::string& key) const
+{
+	// Objects are small, and duplicated keys resolve to the last one like most parsers do.
+	for (size_t i = keys.size(); i > 0; i--)
+	{
+		if (keys[i - 1] == key)
+		{
+			return &elements[i - 1];
+		}
+	}
+
+	return nullptr;
+}
+
+bool JSONValue::parseValue(const char*& data, const char* end, int depth, JSONValue& value)
+{
+	if (data == end || depth > MAX_DEPTH)
+	{
+		return false;
+	}
+
+	switch (*data)
+	{
+	case 'n':
+		value.type = JSONType::NULL_VALUE;
+
+		return parseLiteral(data, end, "null");
+
+	case 't':
+		value.type = JSONType::BOOLEAN;
+		value.boolean = true;
+
+		return parseLiteral(data, end, "true");
+
+	case 'f':
+		value.type = JSONType::BOOLEAN;
+		value.boolean = false;
+
+		return parseLiteral(data, end, "false");
+
+	case '"':
+		value.type = JSONType::STRING;
+
+		return parseString(data, end, value.string);
+
+	case '[':
+		value.type = JSONType::ARRAY;
+		data = skipWhitespace(data + 1, end);
+
+		if (data < end && *data == ']')
+		{
+			data++;
+
+			return true;
+		}
+
+		while (true)
+		{
+			value.elements.emplace_back();
+
+			if (!parseValue(data, end, depth + 1, value.elements.back()))
+			{
+				return false;
+			}
+
+			data = skipWhitespace(data, end);
+
+			if (data < end && *data == ',')
+			{
+				data = skipWhitespace(data + 1, end);
+			}
+			else if (data < end && *data == ']')
+			{
+				data++;
+
+				return true;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+	case '{':
+		value.type = JSONType::OBJECT;
+		data = skipWhitespace(data + 1, end);
+
+		if (data < end && *data == '}')
+		{
+			data++;
+
+			return true;
+		}
+
+		while (true)
+		{
+			value.keys.emplace_back();
+			value.elements.emplace_back();
+
+			if (!parseString(data, end, value.keys.back()))
+			{
+				return false;
+			}
+
+			data = skipWhitespace(data, end);
+
+			if (data == end || *data != ':')
+			{
+				return false;
+			}
+
+			data = skipWhitespace(data + 1, end);
+
+			if (!parseValue(data, end, depth + 1, value.elements.back()))
+			{
+				return false;
+			}
+
+			data = skipWhitespace(data, end);
+
+			if (data < end && *data == ',')
+			{
+				data = skipWhitespace(data + 1, end);
+			}
+			else if (data < end && *data == '}')
+			{
+				data++;
+
+				return true;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+	default:
+	{
+		// "std::from_chars" also takes "inf" and "nan", which JSON doesn't have.
+		if (*data != '-' && (*data < '0' || *data > '9'))
+		{
+			return false;
+		}
+
+		std::from_chars_result result = std::from_chars(data, end, value.number);
+
+		if (result.ec != std::errc())
+		{
+			return false;
+		}
+
+		value.type = JSONType::NUMBER;
+		data = result.ptr;
+
+		return true;
+	}
+	}
+}
+
+bool JSONValue::parseString(const char*& data, const char* end, std::string& string)
+{
+	if (data == end || *data != '"')
+	{
+		return false;
+	}
+
+	data++;
+
+	while (data < end && *data != '"')
+	{
+		// Control characters must be escaped.
+		if (static_cast<unsigned char>(*data) < 0x20)
+		{
+			return false;
+		}
+
+		if (*data != '\\')
+		{
+			string += *data++;
+
+			continue;
+		}
+
+		if (++data == end)
+		{
+			return false;
+		}
+
+		char escaped = *data++;
+
+		switch (escaped)
+		{
+		case '"': string += '"'; break;
+		case '\\': string += '\\'; break;
+		case '/': string += '/'; break;
+		case 'b': string += '\b'; break;
+		case 'f': string += '\f'; break;
+		case 'n': string += '\n'; break;
+		case 'r': string += '\r'; break;
+		case 't': string += '\t'; break;
+
+		case 'u':
+		{
+			uint32_t code = 0;
+
+			if (!parseHexCode(data, end, code))
+			{
+				return false;
+			}
+
+			// Characters outside the basic plane are written as a pair of surrogates.
+			if (code >= 0xD800 && code < 0xDC00 && end - data >= 2 && data[0] == '\\' && data[1] == 'u')
+			{
+				const char* lowSurrogate = data + 2;
+				uint32_t low = 0;
+
+				if (parseHexCode(lowSurrogate, end, low) && low >= 0xDC00 && low < 0xE000)
+				{
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+					data = lowSurrogate;
+				}
+			}
+
+			appendUTF8(string, code);
+
+			break;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+	if (data == end)
+	{
+		return false;
+	}
+
+	data++;
+
+	return true;
+}
+
+bool JSONValue::parseLiteral(const char*& data, const char* end, const char* literal)
+{
+	size_t length = std::strlen(literal);
+
+	if (size_t(end - data) < length || std::memcmp(data, literal, length) != 0)
+	{
+		return false;
+	}
+
+	data += length;
+
+	return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <iostream>
+#include <algorithm>
+
+enum class JSONType
+{
+	NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT
+};
+
+// Value of a JSON document (RFC 8259), read by "parse" into a tree the callers walk with "find" and the getters.
+// Meant for small hand-written files (e.g. scene descriptions), not for bulk data.
+class JSONValue
+{
+public:
+	JSONValue();
+
+	// Reads the whole of [data, end), false (with the line of the error) on malformed documents.
+	static bool parse(const char* data, const char* end, JSONValue& value);
+
+	JSONType getType() const;
+
+	bool isNumber() const;
+	bool isString() const;
+	bool isArray() const;
+	bool isObject() const;
+
+	bool getBoolean() const;
+	double getNumber() const;
+	const std::string& getString() const;
+
+	// Elements of an array, or member values of an object (in the order of the document).
+	const std::vector<JSONValue>& getElements() const;
+
+	// Member names of an object, "getElements()[i]" is the value of "getKeys()[i]".
+	const std::vector<std::string>& getKeys() const;
+
+	// Value of the member "key", null when missing or when this isn't an object.
+	const JSONValue* find(const std::string& key) const;
+
+private:
+	static const int MAX_DEPTH = 256; // Of nested arrays and objects, deeper documents are rejected.
+
+	JSONType type;
+
+	bool boolean;
+	double number;
+	std::string string;
+
+	std::vector<JSONValue> elements;
+	std::vector<std::string> keys;
+
+	static bool parseValue(const char*& data, const char* end, int depth, JSONValue& value);
+	static bool parseString(const char*& data, const char* end, std::string& string);
+	static bool parseLiteral(const char*& data, const char* end, const char* literal);
+};
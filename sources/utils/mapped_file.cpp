@@ -0,0 +1,143 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile() : data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#else
+MappedFile::MappedFile() : data(nullptr), size(0), fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+#ifdef _WIN32
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "[ERROR] MAPPED FILE: Failed to open \"" << path << "\"." << std::endl;
+
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	GetFileSizeEx(fileHandle, &fileSize);
+
+	size = size_t(fileSize.QuadPart);
+
+	// Empty files can't be mapped, they are valid with a null view.
+	if (size == 0)
+	{
+		return true;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	data = mappingHandle != nullptr ? static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+	fileDescriptor = ::open(path.c_str(), O_RDONLY);
+
+	if (fileDescriptor == -1)
+	{
+		std::cout << "[ERROR] MAPPED FILE: Failed to open \"" << path << "\"." << std::endl;
+
+		return false;
+	}
+
+	struct stat fileStatus = {};
+	fstat(fileDescriptor, &fileStatus);
+
+	size = size_t(fileStatus.st_size);
+
+	if (size == 0)
+	{
+		return true;
+	}
+
+	void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+	if (view != MAP_FAILED)
+	{
+		// Loaders read their files front to back.
+		madvise(view, size, MADV_SEQUENTIAL);
+
+		data = static_cast<const char*>(view);
+	}
+#endif
+
+	if (data == nullptr)
+	{
+		std::cout << "[ERROR] MAPPED FILE: Failed to map \"" << path << "\"." << std::endl;
+
+		close();
+
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+	{
+		UnmapViewOfFile(data);
+	}
+
+	if (mappingHandle != nullptr)
+	{
+		CloseHandle(mappingHandle);
+	}
+
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle);
+	}
+
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+#else
+	if (data != nullptr)
+	{
+		munmap(const_cast<char*>(data), size);
+	}
+
+	if (fileDescriptor != -1)
+	{
+		::close(fileDescriptor);
+	}
+
+	fileDescriptor = -1;
+#endif
+
+	data = nullptr;
+	size = 0;
+}
+
+const char* MappedFile::getData() const
+{
+	return data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return size;
+}
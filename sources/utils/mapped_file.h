@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+// Read-only view of a whole file through the virtual memory of the process, so loaders parse the bytes where they
+// are instead of copying them into buffers (pages are read on first access).
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	// Null for empty (or closed) files.
+	const char* getData() const;
+	size_t getSize() const;
+
+private:
+	const char* data;
+	size_t size;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
@@ -0,0 +1,165 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int numberOfThreads) : threads(), queues(), mutex(), workAvailable(), workFinished(), task(nullptr), remainingTasks(0), generation(0), stopping(false)
+{
+	if (numberOfThreads <= 0)
+	{
+		numberOfThreads = std::max(1, int(std::thread::hardware_concurrency()));
+	}
+
+	for (int i = 0; i < numberOfThreads; i++)
+	{
+		queues.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	for (int i = 0; i < numberOfThreads; i++)
+	{
+		threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	clean();
+}
+
+void ThreadPool::dispatch(int numberOfTasks, const Task& task)
+{
+	if (numberOfTasks <= 0 || threads.empty())
+	{
+		return;
+	}
+
+	int numberOfQueues = int(queues.size());
+
+	// Published before the queues are filled: workers only read it after popping a task under a queue lock.
+	this->task = &task;
+	remainingTasks = numberOfTasks;
+
+	for (int i = 0; i < numberOfQueues; i++)
+	{
+		std::lock_guard<std::mutex> lock(queues[i]->mutex);
+
+		int first = int(int64_t(numberOfTasks) * i / numberOfQueues);
+		int last = int(int64_t(numberOfTasks) * (i + 1) / numberOfQueues);
+
+		for (int j = first; j < last; j++)
+		{
+			queues[i]->tasks.push_back(j);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		generation += 1;
+	}
+
+	workAvailable.notify_all();
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	workFinished.wait(lock, [this]() { return remainingTasks.load() == 0; });
+
+	this->task = nullptr;
+}
+
+int ThreadPool::getNumberOfThreads() const
+{
+	return int(threads.size());
+}
+
+void ThreadPool::clean()
+{
+	if (threads.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		stopping = true;
+	}
+
+	workAvailable.notify_all();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	threads.clear();
+	queues.clear();
+}
+
+void ThreadPool::workerLoop(int workerIndex)
+{
+	uint64_t lastGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			workAvailable.wait(lock, [&]() { return stopping || generation != lastGeneration; });
+
+			if (stopping)
+			{
+				return;
+			}
+
+			lastGeneration = generation;
+		}
+
+		int taskIndex = 0;
+
+		while (popTask(workerIndex, taskIndex))
+		{
+			(*task)(taskIndex, workerIndex);
+
+			// The last task of the batch releases the dispatching thread.
+			if (remainingTasks.fetch_sub(1) == 1)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				workFinished.notify_all();
+			}
+		}
+	}
+}
+
+bool ThreadPool::popTask(int workerIndex, int& taskIndex)
+{
+	int numberOfQueues = int(queues.size());
+
+	{
+		WorkerQueue& queue = *queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.tasks.empty())
+		{
+			taskIndex = queue.tasks.back();
+			queue.tasks.pop_back();
+
+			return true;
+		}
+	}
+
+	// Own queue is empty, steal from the opposite end of the others so the owners keep their locality.
+	for (int i = 1; i < numberOfQueues; i++)
+	{
+		WorkerQueue& victim = *queues[(workerIndex + i) % numberOfQueues];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.tasks.empty())
+		{
+			taskIndex = victim.tasks.front();
+			victim.tasks.pop_front();
+
+			return true;
+		}
+	}
+
+	return false;
+}
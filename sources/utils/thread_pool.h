@@ -0,0 +1,57 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of worker threads running batches of indexed tasks.
+//
+// Every batch is split in contiguous ranges, one per worker queue. Workers pop from the back of their own queue
+// and, once it runs dry, steal from the front of the others, so uneven tasks (e.g. tiles of sky next to tiles
+// of glass) don't leave threads idle while a single one finishes its range.
+//
+class ThreadPool
+{
+public:
+	ThreadPool(int numberOfThreads = 0); // Zero uses every hardware thread.
+	~ThreadPool(); // Stops and joins the workers, unless "clean" already did.
+
+	using Task = std::function<void(int taskIndex, int workerIndex)>;
+
+	// Runs "task" for every index in [0, numberOfTasks) and returns once all of them are done.
+	void dispatch(int numberOfTasks, const Task& task);
+
+	int getNumberOfThreads() const;
+
+	// Stops and joins the workers before the pool goes out of scope, it can't dispatch afterwards.
+	void clean();
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<int> tasks;
+	};
+
+	std::vector<std::thread> threads;
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+	std::mutex mutex;
+	std::condition_variable workAvailable, workFinished;
+
+	const Task* task;
+	std::atomic<int> remainingTasks;
+	uint64_t generation; // Bumped for every batch, wakes the workers up.
+	bool stopping;
+
+	void workerLoop(int workerIndex);
+
+	bool popTask(int workerIndex, int& taskIndex);
+};